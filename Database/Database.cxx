@@ -27,6 +27,8 @@
 #include <algorithm>
 #include <type_traits>
 #include <iostream>
+#include <fstream>
+#include <mutex>
 
 // This is a well-known problem with strerror_r
 #if defined(__linux__) && (defined(_GNU_SOURCE) || !(_POSIX_C_SOURCE >= 200112L || _XOPEN_SOURCE > 600))
@@ -35,6 +37,10 @@
 
 using namespace std;
 
+// Serializes the gSystem calls below, which modules may make concurrently
+// while reading their databases (see Podd::InitScheduler)
+static mutex gDBSystemMutex;
+
 //_____________________________________________________________________________
 const char* Here( const char* method, const char* prefix )
 {
@@ -118,6 +124,7 @@ vector<string> GetDBFileList( const char* name, const TDatime& date,
   // Try to open the database directories in the search list.
   // The first directory that can be opened is taken as the database
   // directory. Subsequent directories are ignored.
+  unique_lock<mutex> lock(gDBSystemMutex);
   auto it = dnames.begin();
   void* dirp = nullptr;
   while( !(dirp = gSystem->OpenDirectory((*it).c_str())) &&
@@ -148,6 +155,7 @@ vector<string> GetDBFileList( const char* name, const TDatime& date,
       have_defaultdir = true;
   }
   gSystem->FreeDirectory(dirp);
+  lock.unlock();
 
   // Search a date-coded subdirectory that corresponds to the requested date.
   bool found = false;
@@ -205,6 +213,36 @@ vector<string> GetDBFileList( const char* name, const TDatime& date,
   return fnames;
 }
 
+// Currently active DBFileRecorder's list of files, if any
+static thread_local DBFileRecords* dbfile_records = nullptr;
+
+//_____________________________________________________________________________
+static string AbsolutePath( string path )
+{
+  // Return 'path' as an absolute path name
+
+  if( !gSystem->IsAbsoluteFileName(path.c_str()) ) {
+    lock_guard<mutex> lock(gDBSystemMutex);
+    const char* wd = gSystem->WorkingDirectory();
+    if( wd && *wd )
+      path.insert(0, string(wd) + "/");
+  }
+  return path;
+}
+
+//_____________________________________________________________________________
+static Long_t ModTime( const string& path )
+{
+  // Modification time of file 'path', or 0 if unavailable
+
+  Long_t id = 0, flags = 0, modtime = 0;
+  Long64_t size = 0;
+  if( path.empty() ||
+      gSystem->GetPathInfo(path.c_str(), &id, &size, &flags, &modtime) != 0 )
+    return 0;
+  return modtime;
+}
+
 //_____________________________________________________________________________
 FILE* OpenDBFile( const char* name, const TDatime& date, const char* here,
                   const char* filemode, int debug_flag, string& openpath )
@@ -238,16 +276,7 @@ FILE* OpenDBFile( const char* name, const TDatime& date, const char* here,
       else if( verbose )
 	::Info(here, "Opened database file %s", fpath.c_str());
 
-      if( gSystem->IsAbsoluteFileName(fpath.c_str()) )
-	openpath = std::move(fpath);
-      else {
-	const char* wd = gSystem->WorkingDirectory();
-	if( wd && *wd ) {
-	  openpath = wd;
-	  openpath += "/";
-	}
-	openpath += fpath;
-      }
+      openpath = AbsolutePath(std::move(fpath));
       break;
     }
     else if( detailed )
@@ -259,6 +288,9 @@ FILE* OpenDBFile( const char* name, const TDatime& date, const char* here,
     ::Error(here, "Cannot open database file db_%s%sdat", name,
             (name[strlen(name) - 1] == '.' ? "" : "."));
   }
+  // Failed attempts are recorded as well. The file may appear later.
+  if( dbfile_records )
+    dbfile_records->push_back({name, openpath, ModTime(openpath)});
   return fi;
 }
 
@@ -1316,6 +1348,68 @@ Bool_t IsDBtimestamp( const string& line, TDatime& date )
   return IsDBdate(line, date, true);
 }
 
+//_____________________________________________________________________________
+DBFileRecorder::DBFileRecorder( DBFileRecords& rec )
+  : fPrev(dbfile_records)
+{
+  dbfile_records = &rec;
+}
+
+//_____________________________________________________________________________
+DBFileRecorder::~DBFileRecorder()
+{
+  dbfile_records = fPrev;
+}
+
+//_____________________________________________________________________________
+Bool_t DBInputsDiffer( const DBFileRecords& files, const TDatime& a,
+                       const TDatime& b )
+{
+  // Determine if the database contents read from 'files' for date 'a' may
+  // differ for date 'b'. This is the case if, for date 'b',
+  //  - OpenDBFile would open a different file, e.g. from another
+  //    date-coded directory, or
+  //  - any of the files has been modified since it was read, or
+  //  - any of the files contains a time stamp between 'a' and 'b'.
+  // An empty list of files is considered unknown and always differs.
+
+  if( !DBDatesDiffer(a, b) )
+    return false;
+  if( files.empty() )
+    return true;
+  const TDatime& lo = (a < b) ? a : b;
+  const TDatime& hi = (a < b) ? b : a;
+  for( const auto& rec : files ) {
+    string path;
+    for( auto& fpath : GetDBFileList(rec.name.c_str(), b) ) {
+      if( !gSystem->AccessPathName(fpath.c_str(), kReadPermission) ) {
+        path = AbsolutePath(std::move(fpath));
+        break;
+      }
+    }
+    if( path != rec.path || ModTime(path) != rec.modtime )
+      return true;
+    if( path.empty() )
+      continue;
+    // Values with time stamps in (lo,hi] apply to one date but not the other
+    ifstream ifs(path);
+    if( !ifs )
+      return true;
+    string line;
+    TDatime tagdate;
+    while( getline(ifs, line) ) {
+      if( line.find('[') == string::npos )
+        continue;
+      auto lpos = line.find_first_of("!#");
+      if( lpos != string::npos )
+        line.erase(lpos);
+      if( IsDBdate(line, tagdate, false) && lo < tagdate && tagdate <= hi )
+        return true;
+    }
+  }
+  return false;
+}
+
 //_____________________________________________________________________________
 #ifdef __clang__
 // Clang appears to make implicitly instantiated template functions private
@@ -64,6 +64,30 @@ Int_t    SeekDBconfig( FILE* file, const char* tag, const char* label = "config"
 Int_t    SeekDBdate( std::istream& istr, const TDatime& date, Bool_t end_on_tag = false );
 Bool_t   IsDBtimestamp( const std::string& line, TDatime& keydate );
 
+// Tracking of database files, used to decide whether database contents
+// may differ between two dates
+struct DBFileRecord {
+  std::string name;     // Name passed to OpenDBFile
+  std::string path;     // Path of the opened file (empty if none found)
+  Long_t      modtime;  // Modification time of file
+};
+using DBFileRecords = std::vector<DBFileRecord>;
+
+// Record all files opened with OpenDBFile by the current thread in 'rec'
+// while in scope
+class DBFileRecorder {
+public:
+  explicit DBFileRecorder( DBFileRecords& rec );
+  DBFileRecorder( const DBFileRecorder& ) = delete;
+  DBFileRecorder& operator=( const DBFileRecorder& ) = delete;
+  ~DBFileRecorder();
+private:
+  DBFileRecords* fPrev;
+};
+
+Bool_t   DBInputsDiffer( const DBFileRecords& files, const TDatime& a,
+                         const TDatime& b );
+
 }  // namespace Podd
 
 #endif //Podd_Database_h_
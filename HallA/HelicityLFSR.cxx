@@ -0,0 +1,227 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// HallA::HelicityLFSR
+//
+// The helicity electronics generate the helicity sequence with a linear
+// feedback shift register (LFSR). One step of the generator is a linear
+// map M over GF(2) of the register state, given here by its columns,
+// i.e. the images of the unit vectors. The state after n steps is M^n
+// applied to the initial state. Precomputing M^(2^k) for all k, M^n is
+// applied as the product of those powers corresponding to the bits set
+// in n, i.e. with O(log n) matrix-vector products. This allows predicting
+// the helicity for arbitrary delays without iterating the generator.
+//
+// Both generators shift the new bit into bit 0 of the state, so the
+// helicity bit generated by step n is bit 0 of M^n applied to the state.
+// Each generated bit is thus a fixed linear combination of the bits
+// of the initial state. Inverting the linear map from the initial state
+// to the GetNbits() consecutive bits following it gives a table that
+// recovers the state directly from the observed bits. Recovery from bits
+// observed at arbitrary steps, i.e. after gaps, solves the corresponding
+// linear system.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "HelicityLFSR.h"
+#include <cassert>
+
+using namespace std;
+
+namespace HallA {
+
+// Number of powers of M needed for 64-bit step counts
+static const UInt_t kNpow = 64;
+
+//_____________________________________________________________________________
+static Bool_t SolveGF2( vector<UInt_t>& rows, vector<UInt_t>& rhs,
+                        UInt_t nbits )
+{
+  // Gauss-Jordan elimination over GF(2). 'rows' are the bit masks of the
+  // coefficients, 'rhs' the right-hand sides, which may be bit masks
+  // themselves (to invert a matrix). On success, rows[j] = bit j and
+  // rhs[j] is the solution for bit j, j < nbits. Returns false if the
+  // system is underdetermined or inconsistent.
+
+  assert(rows.size() == rhs.size());
+  size_t nrows = rows.size();
+  for( UInt_t j = 0; j < nbits; ++j ) {
+    UInt_t bit = 1U << j;
+    size_t p = j;
+    while( p < nrows && !(rows[p] & bit) )
+      ++p;
+    if( p == nrows )
+      return false;
+    swap(rows[p], rows[j]);
+    swap(rhs[p], rhs[j]);
+    for( size_t i = 0; i < nrows; ++i ) {
+      if( i != j && (rows[i] & bit) ) {
+        rows[i] ^= rows[j];
+        rhs[i] ^= rhs[j];
+      }
+    }
+  }
+  // Any surplus equations must now read 0 = 0
+  for( size_t i = nbits; i < nrows; ++i ) {
+    if( rhs[i] != 0 )
+      return false;
+  }
+  return true;
+}
+
+//_____________________________________________________________________________
+HelicityLFSR::HelicityLFSR( UInt_t nbits, StepFunc_t step )
+  : fNbits(nbits)
+  , fMask(nbits < 32 ? (1U << nbits) - 1 : ~0U)
+  , fStep(step)
+{
+  // Constructor. Computes the transition matrices and the seed recovery
+  // table for the generator 'step' with a state of 'nbits' bits.
+
+  assert(fNbits > 0 && fNbits <= 32 && fStep);
+
+  // M^1 from the images of the unit vectors, then M^(2^(k+1)) = (M^(2^k))^2
+  fPow.resize(kNpow*fNbits);
+  for( UInt_t j = 0; j < fNbits; ++j )
+    fPow[j] = Step(1U << j);
+  for( UInt_t k = 1; k < kNpow; ++k ) {
+    const UInt_t* prev = &fPow[(k-1)*fNbits];
+    UInt_t* cur = &fPow[k*fNbits];
+    for( UInt_t j = 0; j < fNbits; ++j )
+      cur[j] = Apply(prev, prev[j]);
+  }
+
+  // Map from the initial state to the next fNbits generated bits, with
+  // the first bit in the most significant position. Its inverse is the
+  // recovery table.
+  vector<UInt_t> rows(fNbits), rhs(fNbits);
+  for( UInt_t i = 0; i < fNbits; ++i ) {
+    rows[i] = OutputRow(fNbits - i);
+    rhs[i] = 1U << i;
+  }
+  if( SolveGF2(rows, rhs, fNbits) ) {
+    // rhs[j] = mask of the generated bits whose sum is state bit j.
+    // Convert to columns.
+    fRecover.assign(fNbits, 0);
+    for( UInt_t j = 0; j < fNbits; ++j ) {
+      for( UInt_t i = 0; i < fNbits; ++i ) {
+        if( rhs[j] & (1U << i) )
+          fRecover[i] |= 1U << j;
+      }
+    }
+  }
+}
+
+//_____________________________________________________________________________
+UInt_t HelicityLFSR::Apply( const UInt_t* cols, UInt_t v )
+{
+  UInt_t res = 0;
+  for( ; v; v >>= 1, ++cols ) {
+    if( v & 1 )
+      res ^= *cols;
+  }
+  return res;
+}
+
+//_____________________________________________________________________________
+UInt_t HelicityLFSR::Jump( UInt_t state, ULong64_t n ) const
+{
+  // Return the state of the generator n steps after 'state'
+
+  state &= fMask;
+  for( const UInt_t* pow = fPow.data(); n; n >>= 1, pow += fNbits ) {
+    if( n & 1 )
+      state = Apply(pow, state);
+  }
+  return state;
+}
+
+//_____________________________________________________________________________
+UInt_t HelicityLFSR::OutputRow( ULong64_t n ) const
+{
+  // Return the mask of the state bits whose sum gives the bit generated
+  // at step n
+
+  UInt_t row = 0;
+  for( UInt_t j = 0; j < fNbits; ++j ) {
+    if( Jump(1U << j, n) & 1 )
+      row |= 1U << j;
+  }
+  return row;
+}
+
+//_____________________________________________________________________________
+UInt_t HelicityLFSR::Recover( UInt_t bits ) const
+{
+  // Return the state from which the generator produces the GetNbits() bits
+  // in 'bits', the first bit in the most significant position.
+  // Jump(Recover(bits), GetNbits()) is the state after the last bit.
+
+  if( fRecover.empty() )
+    return 0;  // Degenerate generator
+  return Apply(fRecover.data(), bits & fMask);
+}
+
+//_____________________________________________________________________________
+Bool_t HelicityLFSR::Recover( const vector<pair<ULong64_t,UInt_t>>& bits,
+                              UInt_t& state ) const
+{
+  // Find the state from which the generator produced the given bits at
+  // the given steps (step numbers > 0, in any order). At least GetNbits()
+  // bits are needed. This allows resynchronizing after missed windows,
+  // as long as the number of missed steps is known.
+
+  vector<UInt_t> rows, rhs;
+  rows.reserve(bits.size());
+  rhs.reserve(bits.size());
+  for( const auto& b : bits ) {
+    rows.push_back(OutputRow(b.first));
+    rhs.push_back(b.second & 1);
+  }
+  if( !SolveGF2(rows, rhs, fNbits) )
+    return false;
+
+  state = 0;
+  for( UInt_t j = 0; j < fNbits; ++j ) {
+    if( rhs[j] )
+      state |= 1U << j;
+  }
+  return true;
+}
+
+//_____________________________________________________________________________
+UInt_t HelicityLFSR::StepQWEAK( UInt_t state )
+{
+  // One step of the QWEAK generator, see THaQWEAKHelicity::RanBit30
+
+  UInt_t newbit = ((state >> 6) ^ (state >> 27) ^ (state >> 28) ^
+                   (state >> 29)) & 1;
+  return ((state << 1) | newbit) & 0x3FFFFFFF;
+}
+
+//_____________________________________________________________________________
+UInt_t HelicityLFSR::StepG0( UInt_t state )
+{
+  // One step of the G0 generator, see THaG0Helicity::RanBit
+
+  const UInt_t MASK = BIT(0)+BIT(2)+BIT(3)+BIT(23);
+
+  if( state & BIT(23) )
+    return (((state ^ MASK) << 1) | BIT(0)) & 0xFFFFFF;
+  return (state << 1) & 0xFFFFFF;
+}
+
+//_____________________________________________________________________________
+const HelicityLFSR& HelicityLFSR::QWEAK()
+{
+  static const HelicityLFSR lfsr(30, StepQWEAK);
+  return lfsr;
+}
+
+//_____________________________________________________________________________
+const HelicityLFSR& HelicityLFSR::G0()
+{
+  static const HelicityLFSR lfsr(24, StepG0);
+  return lfsr;
+}
+
+} // namespace HallA
@@ -0,0 +1,69 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// HallA::HelicityLFSR
+//
+// Jump-ahead and seed recovery for the pseudo-random helicity generators
+// of the QWEAK and G0 helicity electronics
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef HALLA_HELICITYLFSR_H
+#define HALLA_HELICITYLFSR_H
+
+#include "Rtypes.h"
+#include <vector>
+#include <utility>
+
+namespace HallA {
+
+class HelicityLFSR {
+public:
+  // One step of a bitwise generator. Must be linear over GF(2) and shift
+  // the newly generated bit into bit 0 of the state.
+  using StepFunc_t = UInt_t (*)( UInt_t state );
+
+  HelicityLFSR( UInt_t nbits, StepFunc_t step );
+
+  UInt_t GetNbits() const { return fNbits; }
+  UInt_t GetMask()  const { return fMask; }
+
+  // State after one step, using the bitwise generator
+  UInt_t Step( UInt_t state ) const { return fStep(state & fMask) & fMask; }
+  // State after n steps, in O(log n)
+  UInt_t Jump( UInt_t state, ULong64_t n ) const;
+  // Bit generated by the n-th step (n > 0) starting from 'state'
+  UInt_t Bit( UInt_t state, ULong64_t n ) const { return Jump(state,n) & 1; }
+
+  // State from which the generator produces the GetNbits() bits in 'bits',
+  // the first bit produced in the most significant bit, the last in bit 0
+  UInt_t Recover( UInt_t bits ) const;
+  // Same, from bits observed at arbitrary steps (first = step number > 0,
+  // second = bit), e.g. with gaps. Returns false if the observed bits
+  // do not determine the state or are inconsistent.
+  Bool_t Recover( const std::vector<std::pair<ULong64_t,UInt_t>>& bits,
+                  UInt_t& state ) const;
+
+  // The generators of the QWEAK (30 bits) and G0 (24 bits) electronics
+  static UInt_t StepQWEAK( UInt_t state );
+  static UInt_t StepG0( UInt_t state );
+  static const HelicityLFSR& QWEAK();
+  static const HelicityLFSR& G0();
+
+private:
+  UInt_t              fNbits;    // Number of bits of the state
+  UInt_t              fMask;     // Mask of the state bits
+  StepFunc_t          fStep;     // Bitwise generator
+  // Columns of the transition matrices M^(2^k), k = 0...63
+  std::vector<UInt_t> fPow;
+  // Columns of the matrix that maps generated bits to the initial state
+  std::vector<UInt_t> fRecover;
+
+  // Product of a matrix, given by its columns, and a vector
+  static UInt_t Apply( const UInt_t* cols, UInt_t v );
+  // Bit mask of the state bits that form the bit generated at step n
+  UInt_t        OutputRow( ULong64_t n ) const;
+};
+
+} // namespace HallA
+
+#endif
@@ -10,17 +10,17 @@ libname = 'HallA'
 
 # Sources and headers
 src = """
-FADCData.cxx               FadcBPM.cxx                 FadcCherenkov.cxx
-FadcRaster.cxx             FadcRasteredBeam.cxx        FadcUnRasteredBeam.cxx
-FadcScintillator.cxx       FadcShower.cxx
-THaADCHelicity.cxx         THaDecData.cxx              THaG0Helicity.cxx
-THaG0HelicityReader.cxx    THaHelicity.cxx             THaHRS.cxx
-THaQWEAKHelicity.cxx       THaQWEAKHelicityReader.cxx  THaS2CoincTime.cxx
-THaVDCAnalyticTTDConv.cxx  THaVDCChamber.cxx           THaVDCCluster.cxx
-THaVDC.cxx                 THaVDCHit.cxx               THaVDCPlane.cxx
-THaVDCPoint.cxx            THaVDCPointPair.cxx         THaVDCTimeToDistConv.cxx
-THaVDCTrackID.cxx          THaVDCWire.cxx              TrigBitLoc.cxx
-VDCeff.cxx                 TwoarmVDCTimeCorrection.cxx
+FADCData.cxx                 FadcBPM.cxx                  FadcCherenkov.cxx
+FadcRaster.cxx               FadcRasteredBeam.cxx         FadcScintillator.cxx
+FadcShower.cxx               FadcUnRasteredBeam.cxx       HelicityLFSR.cxx
+THaADCHelicity.cxx           THaDecData.cxx               THaG0Helicity.cxx
+THaG0HelicityReader.cxx      THaHRS.cxx                   THaHelicity.cxx
+THaQWEAKHelicity.cxx         THaQWEAKHelicityReader.cxx   THaS2CoincTime.cxx
+THaVDC.cxx                   THaVDCAnalyticTTDConv.cxx    THaVDCChamber.cxx
+THaVDCCluster.cxx            THaVDCHit.cxx                THaVDCPlane.cxx
+THaVDCPoint.cxx              THaVDCPointPair.cxx          THaVDCTimeToDistConv.cxx
+THaVDCTrackID.cxx            THaVDCWire.cxx               TrigBitLoc.cxx
+TwoarmVDCTimeCorrection.cxx  VDCeff.cxx
 """
 
 build_library(baseenv, libname, src, useenv = False, versioned = True)
@@ -140,6 +140,16 @@ void THaADCHelicity::Clear( Option_t* opt )
   fADC_Hel   = kUnknown;
 }
 
+//____________________________________________________________________
+Bool_t THaADCHelicity::GetUsedCrateSlots( CrateSlots_t& crateslots ) const
+{
+  // Add the crates/slots of the helicity and gate ADC channels
+
+  for( UInt_t i = 0; i < fNchan; ++i )
+    crateslots.emplace(fAddr[i].roc, fAddr[i].slot);
+  return DetMapCrateSlots(crateslots);
+}
+
 //____________________________________________________________________
 Int_t THaADCHelicity::Decode( const THaEvData& evdata )
 {
@@ -24,6 +24,7 @@ public:
 
   virtual void   Clear( Option_t* opt = "" );
   virtual Int_t  Decode( const THaEvData& evdata );
+  virtual Bool_t GetUsedCrateSlots( CrateSlots_t& crateslots ) const;
 
   THaADCHelicity()
     : fADC_hdata(0), fADC_Gate(0), fADC_Hel(kUnknown),
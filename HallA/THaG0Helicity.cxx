@@ -12,6 +12,7 @@
 ////////////////////////////////////////////////////////////////////////
 
 #include "THaG0Helicity.h"
+#include "HelicityLFSR.h"
 #include "THaEvData.h"
 #include "TH1F.h"
 #include "TMath.h"
@@ -19,6 +20,7 @@
 #include <cmath>
 
 using namespace std;
+using HallA::HelicityLFSR;
 
 // Default parameters
 static const Double_t kDefaultTdavg = 14050.;
@@ -231,6 +233,68 @@ Int_t THaG0Helicity::End( THaRunBase* )
   return 0;
 }
 
+//_____________________________________________________________________________
+void THaG0Helicity::SaveState( vector<Double_t>& state ) const
+{
+  // Save the state of the helicity prediction carried from event to event
+
+  state = {
+    fTimestamp, fOldT1, fOldT2, fOldT3,
+    fT0, fT9, Double_t(fT0T9), Double_t(fQuad_calibrated),
+    Double_t(fRecovery_flag), fTlastquad, Double_t(fFirstquad),
+    fLastTimestamp, fTimeLastQ1, Double_t(fT9count),
+    Double_t(fPredicted_reading), Double_t(fQ1_reading),
+    Double_t(fSaved_helicity), Double_t(fQ1_present_helicity),
+    Double_t(fNqrt), Double_t(fNB), Double_t(fIseed),
+    Double_t(fIseed_earlier), Double_t(fInquad),
+    Double_t(fTET9Index), Double_t(fTELastEvtQrt), fTELastEvtTime,
+    fTELastTime, Double_t(fTEPresentReadingQ1), Double_t(fTEStartup),
+    fTETime, Double_t(fTEType9)
+  };
+  state.insert(state.end(), fHbits, fHbits + kNbits);
+}
+
+//_____________________________________________________________________________
+Int_t THaG0Helicity::RestoreState( const vector<Double_t>& state )
+{
+  // Restore state saved with SaveState()
+
+  if( state.size() != 31 + kNbits ) {
+    Error( Here("RestoreState"), "Invalid state size %lu",
+           static_cast<unsigned long>(state.size()) );
+    return -1;
+  }
+  auto it = state.begin();
+  fTimestamp = *it++; fOldT1 = *it++; fOldT2 = *it++; fOldT3 = *it++;
+  fT0 = *it++; fT9 = *it++;
+  fT0T9 = (*it++ != 0);
+  fQuad_calibrated = (*it++ != 0);
+  fRecovery_flag = (*it++ != 0);
+  fTlastquad = *it++;
+  fFirstquad = static_cast<Int_t>(*it++);
+  fLastTimestamp = *it++; fTimeLastQ1 = *it++;
+  fT9count = static_cast<Int_t>(*it++);
+  fPredicted_reading = static_cast<Int_t>(*it++);
+  fQ1_reading = static_cast<Int_t>(*it++);
+  fSaved_helicity = static_cast<EHelicity>(static_cast<Int_t>(*it++));
+  fQ1_present_helicity = static_cast<EHelicity>(static_cast<Int_t>(*it++));
+  fNqrt = static_cast<UInt_t>(*it++);
+  fNB = static_cast<Int_t>(*it++);
+  fIseed = static_cast<UInt_t>(*it++);
+  fIseed_earlier = static_cast<UInt_t>(*it++);
+  fInquad = static_cast<Int_t>(*it++);
+  fTET9Index = static_cast<Int_t>(*it++);
+  fTELastEvtQrt = static_cast<Int_t>(*it++);
+  fTELastEvtTime = *it++; fTELastTime = *it++;
+  fTEPresentReadingQ1 = static_cast<Int_t>(*it++);
+  fTEStartup = static_cast<Int_t>(*it++);
+  fTETime = *it++;
+  fTEType9 = (*it++ != 0);
+  for( auto& bit : fHbits )
+    bit = static_cast<Int_t>(*it++);
+  return 0;
+}
+
 //_____________________________________________________________________________
 void THaG0Helicity::SetDebug( Int_t level )
 {
@@ -403,26 +467,31 @@ void THaG0Helicity::QuadCalib()
       Info( Here(here), "Recovering large DT, nqmiss = %d "
 	    "at timestamp %f, tdiff %f", nqmiss, fTimestamp, fTdiff );
     if (fQuad_calibrated && nqmiss < fMaxMissed) {
-      for (Int_t i = 0; i < nqmiss; i++) {
-	if (fQrt && fT9 > 0 && fTimestamp - fT9 < 8*fTdavg) {
-	  fT0 = TMath::Floor((fTimestamp-fT9)/(.25*fTdavg))
-	    *(.25*fTdavg) + fT9;
-	  fT0T9 = true;
-	  }
-	else {
-	  fT0 += fTdavg;
-	  fT0T9 = false;
-	}
-	QuadHelicity(1);
-	fNqrt++;
-
-	fQ1_reading = (fPredicted_reading == -1) ? 0 : 1;
-
-	fQ1_present_helicity = fPresent_helicity;
-	if (fDebug>=1) {
-	  Info(Here(here)," %5d  M  M %1d %2d  %10.0f  %10.0f  %10.0f Missing",
-	       fNqrt,fQ1_reading,fQ1_present_helicity,fTimestamp,fT0,fTdiff);
-	}
+      if (fQrt && fT9 > 0 && fTimestamp - fT9 < 8*fTdavg) {
+	fT0 = TMath::Floor((fTimestamp-fT9)/(.25*fTdavg))
+	  *(.25*fTdavg) + fT9;
+	fT0T9 = true;
+      }
+      else {
+	fT0 += nqmiss*fTdavg;
+	fT0T9 = false;
+      }
+      // Jump the predictor ahead by the missed quads
+      const HelicityLFSR& lfsr = HelicityLFSR::G0();
+      fTlastquad = fT0;
+      fIseed_earlier = lfsr.Jump(fIseed_earlier, nqmiss);
+      fIseed = lfsr.Jump(fIseed, nqmiss);
+      fPredicted_reading = (fIseed_earlier & 1) ? kPlus : kMinus;
+      fSaved_helicity = fPresent_helicity = (fIseed & 1) ? kPlus : kMinus;
+      fNqrt += nqmiss;
+
+      fQ1_reading = (fPredicted_reading == -1) ? 0 : 1;
+
+      fQ1_present_helicity = fPresent_helicity;
+      if (fDebug>=1) {
+	Info(Here(here)," %5d  M  M %1d %2d  %10.0f  %10.0f  %10.0f Missing %d",
+	     fNqrt,fQ1_reading,fQ1_present_helicity,fTimestamp,fT0,fTdiff,
+	     nqmiss);
       }
       fTdiff = fTimestamp - fT0;
     } else { 
@@ -629,12 +698,11 @@ void THaG0Helicity::QuadHelicity( Int_t cond )
     fNB++;
     fQuad_calibrated = false;
   } else if (fNB == kNbits) {   // Have finished loading
-    fIseed_earlier = GetSeed();
+    // Seed from the loaded readings, advanced to the present quad
+    const HelicityLFSR& lfsr = HelicityLFSR::G0();
+    fIseed_earlier = lfsr.Jump(GetSeed(), kNbits+1);
     fIseed = fIseed_earlier;
-    for( int i = 0; i < kNbits+1; i++) {
-      fPredicted_reading = RanBit(0);
-      RanBit(1);
-    }
+    fPredicted_reading = (fIseed_earlier & 1) ? kPlus : kMinus;
 
     if( fPredicted_reading > 0 )
       fPresent_helicity = kPlus;
@@ -644,8 +712,11 @@ void THaG0Helicity::QuadHelicity( Int_t cond )
       fPresent_helicity = kUnknown;
 
     // Delay by fG0delay windows which is fG0delay/4 quads
-    for( int i = 0; i < fG0delay/4; i++)
-      fPresent_helicity = RanBit(1);
+    Int_t nqdelay = fG0delay/4;
+    if( nqdelay > 0 ) {
+      fIseed = lfsr.Jump(fIseed, nqdelay);
+      fPresent_helicity = (fIseed & 1) ? kPlus : kMinus;
+    }
     fNB++;
     fSaved_helicity = fPresent_helicity;
     fQuad_calibrated = true;
@@ -705,18 +776,13 @@ THaHelicityDet::EHelicity THaG0Helicity::RanBit( int which )
 //_____________________________________________________________________________
 UInt_t THaG0Helicity::GetSeed()
 {
-  int seedbits[kNbits];
-  UInt_t ranseed = 0;
-  for (int i = 0; i < 20; i++)
-    seedbits[23-i] = fHbits[i];
-  seedbits[3] = fHbits[20]^seedbits[23];
-  seedbits[2] = fHbits[21]^seedbits[22]^seedbits[23];
-  seedbits[1] = fHbits[22]^seedbits[21]^seedbits[22];
-  seedbits[0] = fHbits[23]^seedbits[20]^seedbits[21]^seedbits[23];
-  for (int i=kNbits-1; i >= 0; i--) 
-    ranseed = ranseed<<1|(seedbits[i]&1);
-  ranseed &= 0xFFFFFF;
-  return ranseed;
+  // Return the state of the generator before the kNbits loaded readings,
+  // using the precomputed seed recovery table
+
+  UInt_t bits = 0;
+  for (int i = 0; i < kNbits; i++)
+    bits = (bits<<1) | (fHbits[i] & 1);
+  return HelicityLFSR::G0().Recover(bits);
 }
 
 //_____________________________________________________________________________
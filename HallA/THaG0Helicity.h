@@ -11,6 +11,7 @@
 
 #include "THaHelicityDet.h"
 #include "THaG0HelicityReader.h"
+#include <vector>
 
 class TH1F;
 
@@ -29,6 +30,8 @@ public:
   virtual Int_t  End( THaRunBase* r=nullptr );
   virtual void   SetDebug( Int_t level );
   virtual Bool_t HelicityValid() const { return fValidHel; }
+  virtual void   SaveState( std::vector<Double_t>& state ) const;
+  virtual Int_t  RestoreState( const std::vector<Double_t>& state );
 
   Int_t     GetQuad()  const { return fQuad; }
   Double_t  GetTdiff() const { return fTdiff; }
@@ -20,6 +20,7 @@ public:
   virtual Int_t   FindVertices( TClonesArray& tracks );
   virtual Int_t   TrackCalc();
   virtual Int_t   TrackTimes( TClonesArray* tracks );
+  virtual Bool_t  GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
 
   virtual Int_t   SetRefDet( const char* name );
   virtual Int_t   SetRefDet( const THaNonTrackingDetector* obj );
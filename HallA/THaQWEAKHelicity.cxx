@@ -12,12 +12,14 @@
 ////////////////////////////////////////////////////////////////////////
 
 #include "THaQWEAKHelicity.h"
+#include "HelicityLFSR.h"
 #include "THaEvData.h"
 #include "TH1F.h"
 #include "TMath.h"
 #include <iostream>
 
 using namespace std;
+using HallA::HelicityLFSR;
 
 //_____________________________________________________________________________
 THaQWEAKHelicity::THaQWEAKHelicity( const char* name, const char* description,
@@ -199,6 +201,44 @@ void THaQWEAKHelicity::SetErrorCode(Int_t error)
   // only one reported error at the time
 }
 
+//_____________________________________________________________________________
+void THaQWEAKHelicity::SaveState( vector<Double_t>& state ) const
+{
+  // Save the state of the helicity prediction carried from event to event
+
+  state = {
+    Double_t(fHelicityLastTIR), Double_t(fPatternLastTIR),
+    Double_t(fRing_NSeed), Double_t(fRingSeed_reported),
+    Double_t(fRingSeed_actual), Double_t(fRingPhase_reported),
+    Double_t(fRing_reported_polarity), Double_t(fRing_actual_polarity),
+    Double_t(fValidHel), Double_t(fOldTimeStampTir)
+  };
+}
+
+//_____________________________________________________________________________
+Int_t THaQWEAKHelicity::RestoreState( const vector<Double_t>& state )
+{
+  // Restore state saved with SaveState()
+
+  if( state.size() != 10 ) {
+    Error( Here("RestoreState"), "Invalid state size %lu",
+           static_cast<unsigned long>(state.size()) );
+    return -1;
+  }
+  auto it = state.begin();
+  fHelicityLastTIR         = static_cast<UInt_t>(*it++);
+  fPatternLastTIR          = static_cast<UInt_t>(*it++);
+  fRing_NSeed              = static_cast<UInt_t>(*it++);
+  fRingSeed_reported       = static_cast<UInt_t>(*it++);
+  fRingSeed_actual         = static_cast<UInt_t>(*it++);
+  fRingPhase_reported      = static_cast<UInt_t>(*it++);
+  fRing_reported_polarity  = static_cast<UInt_t>(*it++);
+  fRing_actual_polarity    = static_cast<UInt_t>(*it++);
+  fValidHel                = (*it++ != 0);
+  fOldTimeStampTir         = static_cast<UInt_t>(*it++);
+  return 0;
+}
+
 //_____________________________________________________________________________
 void THaQWEAKHelicity::Clear( Option_t* opt ) {
   // Clear event-by-event data
@@ -387,16 +427,14 @@ void THaQWEAKHelicity::LoadHelicity( UInt_t eventnumber )
 	  if (fRing_NSeed==fMAXBIT)
 	    {
 	      fRingSeed_actual=fRingSeed_reported;
-	      UInt_t advance=0;
-	      //take the delay into account
-	      for(UInt_t j=0;j<fQWEAKDelay;j++)
-		{	      
-		  advance+=1;
-		  if( advance == fQWEAKNPattern)
-		    {
-		      fRing_actual_polarity=RanBit30(fRingSeed_actual);
-		      advance=0;
-		    }
+	      //take the delay into account: the generator advances
+	      //once per pattern
+	      UInt_t npat = (fQWEAKNPattern > 0) ? fQWEAKDelay/fQWEAKNPattern : 0;
+	      if( npat > 0 )
+		{
+		  fRingSeed_actual=
+		    HelicityLFSR::QWEAK().Jump(fRingSeed_actual,npat);
+		  fRing_actual_polarity=fRingSeed_actual & 1;
 		}
 	    }
 	}
@@ -463,18 +501,21 @@ void THaQWEAKHelicity::LoadHelicity( UInt_t eventnumber )
 	{
 	  fTSettle=0;
 	  UInt_t localfPhase=fRingPhase_reported;
-	  UInt_t localfSeed=fRingSeed_actual;
 	  UInt_t localfPolarity=fRing_actual_polarity;
-	  
-	  for(UInt_t i=0; i<fOffsetTIRvsRing;i++)
+
+	  // advance by fOffsetTIRvsRing windows, jumping the generator
+	  // ahead by the number of new patterns started
+	  if( localfPhase < fQWEAKNPattern )
 	    {
-	      localfPhase+=1;
-	      if( localfPhase == fQWEAKNPattern)
-		{
-		  localfPhase=0;
-		  localfPolarity=RanBit30(localfSeed);
-		}
+	      UInt_t nwin = localfPhase+fOffsetTIRvsRing;
+	      UInt_t npat = nwin/fQWEAKNPattern;
+	      localfPhase = nwin%fQWEAKNPattern;
+	      if( npat > 0 )
+		localfPolarity=
+		  HelicityLFSR::QWEAK().Bit(fRingSeed_actual,npat);
 	    }
+	  else
+	    localfPhase+=fOffsetTIRvsRing;
 	  fHelicity=SetHelicity(localfPolarity,localfPhase);
 	  if(fPatternTir==1)
 	    fQrt=1;
@@ -30,6 +30,10 @@ public:
   virtual Int_t  End( THaRunBase* r=nullptr );
   virtual void   SetDebug( Int_t level );
   virtual Bool_t HelicityValid() const { return fValidHel; }
+  virtual void   SaveState( std::vector<Double_t>& state ) const;
+  virtual Int_t  RestoreState( const std::vector<Double_t>& state );
+  // The helicity words are found by header search in the ROC data
+  virtual Bool_t UsesRawEventData() const { return true; }
 
   void PrintEvent( UInt_t evtnum );
 
@@ -24,6 +24,7 @@
 #include "THaEvData.h"
 #include "THaVarList.h"
 #include "THaGlobals.h"
+#include "AnalysisContext.h"
 #include <vector>
 #include <cassert>
 
@@ -90,26 +91,27 @@ THaAnalysisObject::EStatus THaS2CoincTime::Init( const TDatime& run_time )
 
   if (!fSpect1 || !fSpect2) return kInitError;
   
-  fTrPads1  = gHaVars->Find(Form("%s.%s.trpad",fSpect1->GetName(),
-				 fDetName1.Data()));
-  fS2TrPath1= gHaVars->Find(Form("%s.%s.trpath",fSpect1->GetName(),
-				 fDetName1.Data()));
-  fS2Times1 = gHaVars->Find(Form("%s.%s.time",fSpect1->GetName(),
-				 fDetName1.Data()));
-  fTrPath1  = gHaVars->Find(Form("%s.tr.pathl",fSpect1->GetName()));
+  THaVarList* vars = fContext->GetVars();
+  fTrPads1  = vars->Find(Form("%s.%s.trpad",fSpect1->GetName(),
+			fDetName1.Data()));
+  fS2TrPath1= vars->Find(Form("%s.%s.trpath",fSpect1->GetName(),
+			fDetName1.Data()));
+  fS2Times1 = vars->Find(Form("%s.%s.time",fSpect1->GetName(),
+			fDetName1.Data()));
+  fTrPath1  = vars->Find(Form("%s.tr.pathl",fSpect1->GetName()));
   if (!fTrPads1 || !fS2TrPath1 || !fS2Times1 || !fTrPath1) {
     Error(Here("Init"),"Cannot get variables for spectrometer %s detector %s",
 	  fSpect1->GetName(),fDetName1.Data());
     return kInitError;
   }
 
-  fTrPads2  = gHaVars->Find(Form("%s.%s.trpad",fSpect2->GetName(),
-				 fDetName2.Data()));
-  fS2TrPath2= gHaVars->Find(Form("%s.%s.trpath",fSpect2->GetName(),
-				 fDetName2.Data()));
-  fS2Times2 = gHaVars->Find(Form("%s.%s.time",fSpect2->GetName(),
-				 fDetName2.Data()));
-  fTrPath2  = gHaVars->Find(Form("%s.tr.pathl",fSpect2->GetName()));
+  fTrPads2  = vars->Find(Form("%s.%s.trpad",fSpect2->GetName(),
+			fDetName2.Data()));
+  fS2TrPath2= vars->Find(Form("%s.%s.trpath",fSpect2->GetName(),
+			fDetName2.Data()));
+  fS2Times2 = vars->Find(Form("%s.%s.time",fSpect2->GetName(),
+			fDetName2.Data()));
+  fTrPath2  = vars->Find(Form("%s.tr.pathl",fSpect2->GetName()));
   
   if (!fTrPads2 || !fS2TrPath2 || !fS2Times2 || !fTrPath2) {
     Error(Here("Init"),"Cannot get variables for spectrometer %s detector %s",
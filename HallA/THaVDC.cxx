@@ -27,7 +27,11 @@
 #include "TROOT.h"
 #include "THaString.h"
 #include "TimeCorrectionModule.h"
+#include "THaVar.h"
 #include <map>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <cstdio>
 #include <cstdlib>
 #include <cassert>
@@ -60,7 +64,8 @@ THaVDC::THaVDC( const char* name, const char* description,
   fLower{new THaVDCChamber("uv1", "Lower VDC chamber", this)},
   fUpper{new THaVDCChamber("uv2", "Upper VDC chamber", this)},
   fLUpairs{new TClonesArray("THaVDCPointPair", 20)},
-  fNtracks(0), fEvNum(0),
+  fTrackIDs(20), fNtrackIDs(0),
+  fNtracks(0), fEvNum(0), fDoTargetRecon(true),
   // Default geometry parameters. Exact values are read in ReadDatabase.
   fVDCAngle(-TMath::PiOver4()), fSin_vdc(-0.5*TMath::Sqrt2()),
   fCos_vdc(0.5*TMath::Sqrt2()), fTan_vdc(-1.0),
@@ -630,7 +635,7 @@ Int_t THaVDC::ConstructTracks( TClonesArray* tracks, Int_t mode )
 
       // Decide whether this is a new track or an old track
       // that is being updated
-      auto* thisID = new THaVDCTrackID(lowerPoint,upperPoint);
+      THaVDCTrackID thisID(lowerPoint,upperPoint);
       THaTrack* theTrack = nullptr;
       bool found = false;
       int t = 0;
@@ -639,7 +644,7 @@ Int_t THaVDC::ConstructTracks( TClonesArray* tracks, Int_t mode )
         // This test is true if an existing track has exactly the same clusters
         // as the current one (defined by lowerPoint/upperPoint)
         if( theTrack && theTrack->GetCreator() == this &&
-            *thisID == *theTrack->GetID() ) {
+            thisID == *theTrack->GetID() ) {
           found = true;
           break;
         }
@@ -658,16 +663,21 @@ Int_t THaVDC::ConstructTracks( TClonesArray* tracks, Int_t mode )
         if( fDebug>1 )
           cout << "Track " << t << " modified.\n";
 #endif
-        delete thisID;
         ++n_mod;
       } else {
 #ifdef WITH_DEBUG
         if( fDebug>1 )
           cout << "Track " << tracks->GetLast()+1 << " added.\n";
 #endif
-        theTrack = AddTrack(*tracks, 0.0, 0.0, 0.0, 0.0, thisID );
-        //	theTrack->SetID( thisID );
-        //	theTrack->SetCreator( this );
+        theTrack = AddTrack(*tracks, 0.0, 0.0, 0.0, 0.0 );
+        // Use a recycled ID if available. Once all are in use, allocate
+        // new ones for this event; Clear() then enlarges the pool.
+        if( fNtrackIDs < fTrackIDs.size() ) {
+          fTrackIDs[fNtrackIDs] = thisID;
+          theTrack->SetID( &fTrackIDs[fNtrackIDs], false );
+        } else
+          theTrack->SetID( new THaVDCTrackID(thisID) );
+        ++fNtrackIDs;
         theTrack->AddCluster( lowerPoint );
         theTrack->AddCluster( upperPoint );
         assert( tracks->IndexOf(theTrack) >= 0 );
@@ -764,6 +774,13 @@ void THaVDC::Clear( Option_t* opt )
   THaTrackingDetector::Clear(opt);
   fLower->Clear(opt);
   fUpper->Clear(opt);
+
+  // Make room for the track IDs that did not fit last time. The tracks
+  // of the previous event, which may still point to the IDs, do not
+  // access them any more.
+  if( fNtrackIDs > fTrackIDs.size() )
+    fTrackIDs.resize(fNtrackIDs);
+  fNtrackIDs = 0;
 }
 
 //_____________________________________________________________________________
@@ -835,6 +852,9 @@ Int_t THaVDC::FindVertices( TClonesArray& tracks )
   // Calculate the target location and momentum at the target.
   // Assumes that CoarseTrack() and FineTrack() have both been called.
 
+  if( !fDoTargetRecon )
+    return 0;
+
   Int_t n_exist = tracks.GetLast()+1;
   for( Int_t t = 0; t < n_exist; t++ ) {
     auto* theTrack = static_cast<THaTrack*>( tracks.At(t) );
@@ -844,6 +864,43 @@ Int_t THaVDC::FindVertices( TClonesArray& tracks )
   return 0;
 }
 
+//_____________________________________________________________________________
+void THaVDC::SetUsedOutputs( const set<const THaVar*>& vars, Bool_t all )
+{
+  // Disable the reconstruction of target coordinates if no results that
+  // depend on it are used. 'vars' are the used variables of the apparatus.
+  // Focal plane track variables and detector variables do not depend on
+  // it. Any other apparatus variable is assumed to do so.
+
+  // Spectrometer track variables computed without target reconstruction
+  static const char* const fp_vars[] = {
+    "tr.n", "tr.x", "tr.y", "tr.th", "tr.ph", "tr.flag", "tr.chi2",
+    "tr.ndof", "tr.d_x", "tr.d_y", "tr.d_th", "tr.d_ph",
+    "tr.r_x", "tr.r_y", "tr.r_th", "tr.r_ph", "status"
+  };
+
+  fDoTargetRecon = true;
+  THaApparatus* app = GetApparatus();
+  if( all || !app || !app->GetPrefix() )
+    return;
+  size_t plen = strlen(app->GetPrefix());
+  for( const auto* var : vars ) {
+    const char* name = var->GetName();
+    if( strncmp(name, app->GetPrefix(), plen) != 0 )
+      return;
+    string rest = name + plen;
+    if( find_if(begin(fp_vars), end(fp_vars), [&rest]( const char* v ) {
+          return rest == v; }) != end(fp_vars) )
+      continue;
+    auto dot = rest.find('.');
+    if( dot != string::npos && dot > 0 &&
+        app->GetDetector(rest.substr(0, dot).c_str()) )
+      continue;
+    return;
+  }
+  fDoTargetRecon = false;
+}
+
 #if 0
 //_____________________________________________________________________________
 void THaVDC::DetToTrackTransportCoords( Double_t& x, Double_t& y,
@@ -9,6 +9,7 @@
 
 #include "THaTrackingDetector.h"
 #include "TimeCorrectionModule.h"
+#include "THaVDCTrackID.h"
 #include <cassert>
 #include <utility>
 #include <string>
@@ -34,16 +35,23 @@ public:
 
   virtual void  Clear( Option_t* opt="" );
   virtual Int_t Decode( const THaEvData& );
+  virtual Bool_t GetUsedCrateSlots( CrateSlots_t& cs ) const
+  { return DetMapCrateSlots(cs); }
   virtual Int_t CoarseTrack( TClonesArray& tracks );
   virtual Int_t FineTrack( TClonesArray& tracks );
   virtual Int_t FindVertices( TClonesArray& tracks );
   virtual EStatus Init( const TDatime& date );
   virtual void  SetDebug( Int_t level );
+  virtual void  SetUsedOutputs( const std::set<const THaVar*>& vars,
+                                Bool_t all );
 
   // Get and Set Functions
   THaVDCChamber* GetUpper() const { return fUpper; }
   THaVDCChamber* GetLower() const { return fLower; }
 
+  // False if target coordinates are not reconstructed (see SetUsedOutputs)
+  Bool_t   IsTargetReconEnabled() const { return fDoTargetRecon; }
+
   Double_t GetVDCAngle() const { return fVDCAngle; }
   Double_t GetSpacing()  const { return fSpacing;  }
 
@@ -108,8 +116,11 @@ protected:
 
   // Event data
   TClonesArray*  fLUpairs;  // Candidate pairs of lower/upper points
+  std::vector<THaVDCTrackID> fTrackIDs; //! Recycled IDs of tracks
+  UInt_t   fNtrackIDs;      // Track IDs used in current event
   Int_t    fNtracks;        // Number of tracks found in ConstructTracks
   UInt_t   fEvNum;          // Event number from decoder (for diagnostics)
+  Bool_t   fDoTargetRecon;  //! Reconstruct target coordinates in FindVertices
 
   // Geometry
   Double_t fVDCAngle;       // Angle from the VDC cs to TRANSPORT cs (rad)
@@ -162,6 +173,7 @@ protected:
   void FindBadTracks(TClonesArray &tracks);
 
   virtual Int_t ReadDatabase( const TDatime& date );
+  virtual Bool_t IsDBReadThreadSafe() const { return true; }
   virtual Int_t ReadGeometry( FILE* file, const TDatime& date,
 			      Bool_t required = false );
   virtual Int_t DefineVariables( EMode mode = kDefine );
@@ -34,6 +34,8 @@ public:
 
   virtual void    Clear( Option_t* opt="" );    // Reset event-by-event data
   virtual Int_t   Decode( const THaEvData& evData );
+  virtual Bool_t  GetUsedCrateSlots( CrateSlots_t& cs ) const
+  { return DetMapCrateSlots(cs); }
   virtual Int_t   CoarseTrack();          // Find clusters & estimate track
   virtual Int_t   FineTrack();            // More precisely calculate track
   virtual EStatus Init( const TDatime& date );
@@ -61,6 +61,7 @@ void THaVDCCluster::Clear( Option_t* )
   fPointPair = nullptr;
   fTrack   = nullptr;
   fTrkNum  = 0;
+  fTimeCorrection = 0;
   fClsBeg  = kMaxInt-1;
   fClsEnd  = -1;
 }
@@ -490,7 +490,9 @@ void THaVDCPlane::Clear( Option_t* opt )
   THaSubDetector::Clear(opt);
   fNHits = fNWiresHit = 0;
   fHits->Clear();
-  fClusters->Delete();
+  // Keep the cluster objects and the memory they hold for the next event.
+  // FindClusters() reuses them via ConstructedAt().
+  fClusters->Clear("C");
 }
 
 //_____________________________________________________________________________
@@ -720,7 +722,7 @@ Int_t THaVDCPlane::FindClusters()
   Int_t nextClust = 0;            // Current cluster number
   assert(GetNClusters() == 0);
 
-  vector<THaVDCHit*> clushits;
+  auto& clushits = fClusHits;
   clushits.reserve(nHits);
 
   fNpass = 0;
@@ -833,7 +835,9 @@ Int_t THaVDCPlane::FindClusters()
       // Also, make sure that we did indeed see the time
       // spectrum turn around at some point
       if( nwires >= fMinClustSize && !falling ) {
-        auto* clust = new((*fClusters)[nextClust++]) THaVDCCluster(this);
+        auto* clust =
+          static_cast<THaVDCCluster*>(fClusters->ConstructedAt(nextClust++));
+        clust->SetPlane(this);
         for( auto* clushit : clushits ) {
           clushit->SetClsNum(nextClust - 1);
           clust->AddHit(clushit);
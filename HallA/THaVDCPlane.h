@@ -32,6 +32,8 @@ public:
 
   virtual void    Clear( Option_t* opt="" );
   virtual Int_t   Decode( const THaEvData& ); // Raw data -> hits
+  virtual Bool_t  GetUsedCrateSlots( CrateSlots_t& cs ) const
+  { return DetMapCrateSlots(cs); }
   virtual Int_t   ApplyTimeCorrection();      // Drift time correction
   virtual Int_t   FindClusters();             // Hits -> clusters
   virtual Int_t   FitTracks();                // Clusters -> tracks
@@ -130,9 +132,11 @@ protected:
   UInt_t fMaxData;
   Int_t  fNextHit;
   THaVDCWire* fPrevWire;
+  std::vector<THaVDCHit*> fClusHits;  //! Hits of cluster being built
 
   virtual void  MakePrefix();
   virtual Int_t ReadDatabase( const TDatime& date );
+  virtual Bool_t IsDBReadThreadSafe() const { return true; }
   virtual Int_t DefineVariables( EMode mode = kDefine );
   virtual Int_t ReadGeometry( FILE* file, const TDatime& date,
 			      Bool_t required = false );
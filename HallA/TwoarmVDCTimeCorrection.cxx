@@ -17,6 +17,7 @@
 #include "THaCut.h"
 #include "THaGlobals.h"
 #include "TError.h"
+#include "AnalysisContext.h"
 #include <vector>
 
 using namespace std;
@@ -91,7 +92,7 @@ TwoarmVDCTimeCorrection::Init( const TDatime& run_time )
       { detdef.fName + ".lt_c",   detdef.fLT }
     };
     for( const auto& vardef : vardefs ) {
-      vardef.pvar = gHaVars->Find(vardef.name); // sets the relevant THaVar
+      vardef.pvar = fContext->GetVars()->Find(vardef.name); // sets the relevant THaVar
                                            // pointer in the current detdef
       if( !vardef.pvar ) {
         Error(Here(here), "Global variable %s not found. "
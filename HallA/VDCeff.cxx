@@ -27,6 +27,7 @@
 #include "TMath.h"
 #include "TDirectory.h"
 #include "TClass.h"
+#include "AnalysisContext.h"
 
 #include <stdexcept>
 #include <memory>
@@ -158,7 +159,7 @@ THaAnalysisObject::EStatus VDCeff::Init( const TDatime& run_time )
   // at every reinitialization (pointers in VDC class may have changed)
   for( auto& thePlane : fVDCvar ) {
     assert( !thePlane.name.IsNull() );
-    thePlane.pvar = gHaVars->Find( thePlane.name );
+    thePlane.pvar = fContext->GetVars()->Find( thePlane.name );
     if( !thePlane.pvar ) {
       Warning( Here(here), "Cannot find global VDC variable %s. Ignoring.",
 	       thePlane.name.Data() );
@@ -22,6 +22,7 @@ public:
   virtual Int_t   End( THaRunBase* r=nullptr );
   virtual EStatus Init( const TDatime& run_time );
   virtual Int_t   Process( const THaEvData& );
+  virtual Bool_t  GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
 
   void            Reset( Option_t* opt="" );
 
@@ -0,0 +1,121 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::AllocCounter
+//
+// Interface to the allocation counters of libPoddAllocHooks, which
+// replaces the global operator new (see AllocHooks.cxx). That library
+// must be linked ahead of all other libraries or preloaded. If it is
+// absent, or loaded too late to replace the operators, Enable() warns and
+// all counts stay zero.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "AllocCounter.h"
+#include "TError.h"
+#include <atomic>
+#include <new>
+#include <dlfcn.h>
+
+namespace {
+
+//_____________________________________________________________________________
+struct AllocHooks {
+  AllocHooks();
+  void               (*enable)( bool );
+  bool               (*is_enabled)();
+  unsigned long long (*get_count)();
+  unsigned long long (*get_bytes)();
+};
+
+//_____________________________________________________________________________
+template<typename T>
+inline void FindSymbol( T& func, const char* name )
+{
+  func = reinterpret_cast<T>(dlsym(RTLD_DEFAULT, name));
+}
+
+//_____________________________________________________________________________
+AllocHooks::AllocHooks()
+{
+  FindSymbol(enable,     "PoddAllocHooks_Enable");
+  FindSymbol(is_enabled, "PoddAllocHooks_IsEnabled");
+  FindSymbol(get_count,  "PoddAllocHooks_GetCount");
+  FindSymbol(get_bytes,  "PoddAllocHooks_GetBytes");
+  if( !enable || !is_enabled || !get_count || !get_bytes )
+    enable = nullptr;
+}
+
+//_____________________________________________________________________________
+inline const AllocHooks& Hooks()
+{
+  static const AllocHooks hooks;
+  return hooks;
+}
+
+std::atomic<bool> gActive{false};   // Hooks verified to be active
+std::atomic<bool> gWarned{false};   // Warning about inactive hooks printed
+
+//_____________________________________________________________________________
+void WarnInactive( const char* why )
+{
+  if( !gWarned.exchange(true) )
+    ::Warning("AllocCounter::Enable", "%s. Link libPoddAllocHooks ahead of "
+              "all other libraries or preload it (LD_PRELOAD). Allocations "
+              "will not be counted.", why);
+}
+
+} // namespace
+
+namespace Podd {
+
+//_____________________________________________________________________________
+Bool_t AllocCounter::Enable( Bool_t enable )
+{
+  // Enable/disable counting in all threads. Returns false if counting
+  // was requested but the allocation hooks are not active.
+
+  const AllocHooks& hooks = Hooks();
+  if( !hooks.enable ) {
+    if( enable )
+      WarnInactive("Allocation hooks not loaded");
+    return !enable;
+  }
+  hooks.enable(enable);
+  if( !enable || gActive.load() )
+    return true;
+
+  // Self-test. If the hooks library was loaded after the C++ runtime,
+  // e.g. with gSystem->Load, operator new still resolves to the default.
+  unsigned long long n = hooks.get_count();
+  ::operator delete(::operator new(1));
+  if( hooks.get_count() == n ) {
+    hooks.enable(false);
+    WarnInactive("Allocation hooks loaded but not active");
+    return false;
+  }
+  gActive = true;
+  return true;
+}
+
+//_____________________________________________________________________________
+Bool_t AllocCounter::IsEnabled()
+{
+  const AllocHooks& hooks = Hooks();
+  return hooks.enable && hooks.is_enabled();
+}
+
+//_____________________________________________________________________________
+ULong64_t AllocCounter::GetCount()
+{
+  const AllocHooks& hooks = Hooks();
+  return hooks.enable ? hooks.get_count() : 0;
+}
+
+//_____________________________________________________________________________
+ULong64_t AllocCounter::GetBytes()
+{
+  const AllocHooks& hooks = Hooks();
+  return hooks.enable ? hooks.get_bytes() : 0;
+}
+
+} // namespace Podd
@@ -0,0 +1,33 @@
+#ifndef Podd_AllocCounter_h_
+#define Podd_AllocCounter_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::AllocCounter
+//
+// Process-wide heap allocation counter, enabled at run time. Requires
+// libPoddAllocHooks to be linked ahead of all other libraries or
+// preloaded, see AllocHooks.cxx.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+
+namespace Podd {
+
+class AllocCounter {
+public:
+  // Enable/disable counting in all threads. Returns false (and warns)
+  // if the allocation hooks are not active.
+  static Bool_t    Enable( Bool_t enable = true );
+  static Bool_t    IsEnabled();
+
+  // Number of allocations/bytes requested by the calling thread while
+  // counting was enabled. Counts are never reset; take differences.
+  static ULong64_t GetCount();
+  static ULong64_t GetBytes();
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,220 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// libPoddAllocHooks
+//
+// Replacement global allocation functions that count allocations for
+// Podd::AllocCounter. They simply forward to malloc/free (or
+// posix_memalign for over-aligned types), as the default ones do.
+// When counting is disabled, the only overhead is one relaxed atomic load
+// per allocation.
+//
+// This code is deliberately not part of libPodd. Replacement operators
+// only take effect if the dynamic linker finds them before those of the
+// C++ runtime, i.e. if this library is linked ahead of all other
+// libraries (as done for the analyzer executables) or preloaded,
+//
+//   LD_PRELOAD=libPoddAllocHooks.so analyzer      (macOS:
+//   DYLD_INSERT_LIBRARIES=libPoddAllocHooks.dylib analyzer)
+//
+// Loading it later, e.g. with gSystem->Load, has no effect.
+// AllocCounter finds the counters below at run time and checks whether
+// the hooks are active.
+//
+// Counters are kept per thread, so differences of the counts taken
+// around a piece of code measure the allocations made by that code alone,
+// even if other threads are active.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> gAllocCountEnabled{false};
+thread_local unsigned long long tAllocCount = 0;
+thread_local unsigned long long tAllocBytes = 0;
+
+//_____________________________________________________________________________
+inline void Count( std::size_t size )
+{
+  if( gAllocCountEnabled.load(std::memory_order_relaxed) ) {
+    ++tAllocCount;
+    tAllocBytes += size;
+  }
+}
+
+//_____________________________________________________________________________
+inline void* CountedAlloc( std::size_t size )
+{
+  Count(size);
+  return std::malloc(size ? size : 1);
+}
+
+#if __cpp_aligned_new
+//_____________________________________________________________________________
+inline void* CountedAlignedAlloc( std::size_t size, std::align_val_t al )
+{
+  Count(size);
+  auto align = static_cast<std::size_t>(al);
+  if( align < sizeof(void*) )
+    align = sizeof(void*);
+  void* p = nullptr;
+  if( posix_memalign(&p, align, size ? size : 1) != 0 )
+    return nullptr;
+  return p;
+}
+#endif
+
+} // namespace
+
+//_____________________________________________________________________________
+// Interface to Podd::AllocCounter, looked up with dlsym
+
+extern "C" {
+
+void PoddAllocHooks_Enable( bool enable )
+{
+  gAllocCountEnabled.store(enable, std::memory_order_relaxed);
+}
+
+bool PoddAllocHooks_IsEnabled()
+{
+  return gAllocCountEnabled.load(std::memory_order_relaxed);
+}
+
+unsigned long long PoddAllocHooks_GetCount()
+{
+  return tAllocCount;
+}
+
+unsigned long long PoddAllocHooks_GetBytes()
+{
+  return tAllocBytes;
+}
+
+} // extern "C"
+
+//_____________________________________________________________________________
+// Replacement global allocation functions
+
+void* operator new( std::size_t size )
+{
+  void* p = CountedAlloc(size);
+  if( !p )
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[]( std::size_t size )
+{
+  void* p = CountedAlloc(size);
+  if( !p )
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new( std::size_t size, const std::nothrow_t& ) noexcept
+{
+  return CountedAlloc(size);
+}
+
+void* operator new[]( std::size_t size, const std::nothrow_t& ) noexcept
+{
+  return CountedAlloc(size);
+}
+
+void operator delete( void* p ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[]( void* p ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete( void* p, const std::nothrow_t& ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[]( void* p, const std::nothrow_t& ) noexcept
+{
+  std::free(p);
+}
+
+#if __cpp_sized_deallocation
+void operator delete( void* p, std::size_t ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[]( void* p, std::size_t ) noexcept
+{
+  std::free(p);
+}
+#endif
+
+#if __cpp_aligned_new
+void* operator new( std::size_t size, std::align_val_t al )
+{
+  void* p = CountedAlignedAlloc(size, al);
+  if( !p )
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[]( std::size_t size, std::align_val_t al )
+{
+  void* p = CountedAlignedAlloc(size, al);
+  if( !p )
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new( std::size_t size, std::align_val_t al,
+                    const std::nothrow_t& ) noexcept
+{
+  return CountedAlignedAlloc(size, al);
+}
+
+void* operator new[]( std::size_t size, std::align_val_t al,
+                      const std::nothrow_t& ) noexcept
+{
+  return CountedAlignedAlloc(size, al);
+}
+
+void operator delete( void* p, std::align_val_t ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[]( void* p, std::align_val_t ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete( void* p, std::align_val_t,
+                      const std::nothrow_t& ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[]( void* p, std::align_val_t,
+                        const std::nothrow_t& ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete( void* p, std::size_t, std::align_val_t ) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[]( void* p, std::size_t, std::align_val_t ) noexcept
+{
+  std::free(p);
+}
+#endif
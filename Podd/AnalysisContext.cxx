@@ -0,0 +1,181 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::AnalysisContext
+//
+// The lists of global variables, cuts, apparatuses, physics modules and
+// event type handlers, the current run, the decoder class and the
+// analyzer of one analysis. Traditionally, these are process-wide
+// globals (gHaVars, gHaCuts, gHaApps, gHaPhysics, gHaEvtHandlers, gHaRun,
+// gHaDecoder, see THaGlobals.h). The default context refers to these
+// globals, so existing scripts and modules work unchanged.
+//
+// To run several analyses concurrently in one process, give each its own
+// context, which owns its lists. A context is made current in a thread
+// with AnalysisContext::Scope. Modules, cuts and formulas use the lists
+// of the context that was current when they were created. THaAnalyzer
+// makes its context current while processing a run. For example,
+//
+//   Podd::AnalysisContext ctx;
+//   std::thread job( [&ctx] {
+//     Podd::AnalysisContext::Scope scope(&ctx);
+//     THaAnalyzer analyzer;                 // uses ctx
+//     auto* hrs = new THaHRS("R", "Right HRS");
+//     ctx.GetApps()->Add(hrs);
+//     ...
+//     analyzer.Process(run);
+//   });
+//
+// Database files and crate maps are read independently by each analysis.
+// Initialization of concurrent analyses is serialized (see
+// THaAnalyzer::Init), while their event loops run in parallel. Each
+// analysis must write its own output file. The event loop only writes
+// state owned by the analysis; process-wide defaults such as
+// THaOutput::SetVerbosity and THaVhist::EnableFillBuffers/SetFlushInterval
+// must be set before the analyses are started.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "AnalysisContext.h"
+#include "THaGlobals.h"
+#include "THaVarList.h"
+#include "THaCutList.h"
+#include "THaRunBase.h"
+#include "TList.h"
+#include "TROOT.h"
+
+namespace Podd {
+
+// Context made current in the calling thread, if any
+static thread_local AnalysisContext* tCurrent = nullptr;
+
+//_____________________________________________________________________________
+AnalysisContext::AnalysisContext()
+  : fIsDefault(false)
+  , fVars(new THaVarList)
+  , fCuts(new THaCutList(fVars))
+  , fApps(new TList)
+  , fPhysics(new TList)
+  , fEvtHandlers(new TList)
+  , fRun(nullptr)
+  , fDecoder(gHaDecoder)
+  , fAnalyzer(nullptr)
+{
+  // Create a new context with its own, empty lists. The decoder class is
+  // initialized from the global default.
+
+  // Several analyses may now run concurrently
+  ROOT::EnableThreadSafety();
+}
+
+//_____________________________________________________________________________
+AnalysisContext::AnalysisContext( Bool_t is_default )
+  : fIsDefault(is_default)
+  , fVars(nullptr)
+  , fCuts(nullptr)
+  , fApps(nullptr)
+  , fPhysics(nullptr)
+  , fEvtHandlers(nullptr)
+  , fRun(nullptr)
+  , fDecoder(nullptr)
+  , fAnalyzer(nullptr)
+{
+  // Constructor of the default context
+}
+
+//_____________________________________________________________________________
+AnalysisContext::~AnalysisContext()
+{
+  // Delete the lists owned by this context. As with the global lists, the
+  // modules in the lists are not deleted.
+
+  if( tCurrent == this )
+    tCurrent = nullptr;
+  delete fEvtHandlers;
+  delete fPhysics;
+  delete fApps;
+  delete fCuts;
+  delete fVars;
+}
+
+//_____________________________________________________________________________
+THaVarList* AnalysisContext::GetVars() const
+{
+  return fIsDefault ? gHaVars : fVars;
+}
+
+//_____________________________________________________________________________
+THaCutList* AnalysisContext::GetCuts() const
+{
+  return fIsDefault ? gHaCuts : fCuts;
+}
+
+//_____________________________________________________________________________
+TList* AnalysisContext::GetApps() const
+{
+  return fIsDefault ? gHaApps : fApps;
+}
+
+//_____________________________________________________________________________
+TList* AnalysisContext::GetPhysics() const
+{
+  return fIsDefault ? gHaPhysics : fPhysics;
+}
+
+//_____________________________________________________________________________
+TList* AnalysisContext::GetEvtHandlers() const
+{
+  return fIsDefault ? gHaEvtHandlers : fEvtHandlers;
+}
+
+//_____________________________________________________________________________
+THaRunBase* AnalysisContext::GetRun() const
+{
+  return fIsDefault ? gHaRun : fRun;
+}
+
+//_____________________________________________________________________________
+TClass* AnalysisContext::GetDecoderClass() const
+{
+  return fIsDefault ? gHaDecoder : fDecoder;
+}
+
+//_____________________________________________________________________________
+void AnalysisContext::SetRun( THaRunBase* run )
+{
+  if( fIsDefault )
+    gHaRun = run;
+  else
+    fRun = run;
+}
+
+//_____________________________________________________________________________
+void AnalysisContext::SetDecoderClass( TClass* cl )
+{
+  if( fIsDefault )
+    gHaDecoder = cl;
+  else
+    fDecoder = cl;
+}
+
+//_____________________________________________________________________________
+AnalysisContext* AnalysisContext::Default()
+{
+  static AnalysisContext default_context(true);
+  return &default_context;
+}
+
+//_____________________________________________________________________________
+AnalysisContext* AnalysisContext::Current()
+{
+  return tCurrent ? tCurrent : Default();
+}
+
+//_____________________________________________________________________________
+AnalysisContext* AnalysisContext::SetCurrent( AnalysisContext* ctx )
+{
+  AnalysisContext* prev = Current();
+  tCurrent = ctx;
+  return prev;
+}
+
+} // namespace Podd
@@ -0,0 +1,80 @@
+#ifndef Podd_AnalysisContext_h_
+#define Podd_AnalysisContext_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::AnalysisContext
+//
+// Lists and objects shared by the modules of one analysis: global
+// variables, cuts, module lists, current run, decoder class and analyzer.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+
+class THaVarList;
+class THaCutList;
+class THaRunBase;
+class THaAnalyzer;
+class TList;
+class TClass;
+
+namespace Podd {
+
+class AnalysisContext {
+public:
+  AnalysisContext();
+  AnalysisContext( const AnalysisContext& ) = delete;
+  AnalysisContext& operator=( const AnalysisContext& ) = delete;
+  ~AnalysisContext();
+
+  THaVarList*   GetVars()         const;
+  THaCutList*   GetCuts()         const;
+  TList*        GetApps()         const;
+  TList*        GetPhysics()      const;
+  TList*        GetEvtHandlers()  const;
+  THaRunBase*   GetRun()          const;
+  TClass*       GetDecoderClass() const;
+  THaAnalyzer*  GetAnalyzer()     const { return fAnalyzer; }
+  Bool_t        IsDefault()       const { return fIsDefault; }
+
+  void          SetRun( THaRunBase* run );
+  void          SetDecoderClass( TClass* cl );
+  void          SetAnalyzer( THaAnalyzer* analyzer ) { fAnalyzer = analyzer; }
+
+  // Context of the analysis set up or running in the calling thread.
+  // The default context if none has been made current.
+  static AnalysisContext* Current();
+  // The context of the global lists gHaVars, gHaCuts etc.
+  static AnalysisContext* Default();
+  // Make 'ctx' current in the calling thread. Returns previous context.
+  static AnalysisContext* SetCurrent( AnalysisContext* ctx );
+
+  // Make a context current in the calling thread while in scope
+  class Scope {
+  public:
+    explicit Scope( AnalysisContext* ctx ) : fPrev(SetCurrent(ctx)) {}
+    Scope( const Scope& ) = delete;
+    Scope& operator=( const Scope& ) = delete;
+    ~Scope() { SetCurrent(fPrev); }
+  private:
+    AnalysisContext* fPrev;
+  };
+
+private:
+  explicit AnalysisContext( Bool_t is_default );
+
+  Bool_t        fIsDefault;    // Refers to the global lists
+  THaVarList*   fVars;         // Global variables
+  THaCutList*   fCuts;         // Cuts/tests
+  TList*        fApps;         // Apparatuses
+  TList*        fPhysics;      // Physics modules
+  TList*        fEvtHandlers;  // Event type handlers
+  THaRunBase*   fRun;          // Run being analyzed
+  TClass*       fDecoder;      // Class of decoder to use
+  THaAnalyzer*  fAnalyzer;     // Analyzer of this context
+};
+
+} // namespace Podd
+
+#endif
@@ -14,6 +14,7 @@
 #include "THaVarList.h"
 #include "CodaDecoder.h"
 #include "THaGlobals.h"
+#include "AnalysisContext.h"
 #include "Textvars.h"   // vsplit
 #include <sstream>
 #include <iterator>
@@ -170,7 +171,7 @@ Int_t BankData::DefineVariables( EMode mode )
 {
   // Define/delete global variables.
 
-  if (!gHaVars) {
+  if (!fContext->GetVars()) {
     cerr << "BankData::ERROR: No gHaVars ?!  Well, that's a problem !!"<<endl;
     return kInitError;
   }
@@ -183,9 +184,9 @@ Int_t BankData::DefineVariables( EMode mode )
     if (bankloc->numwords == 1) {
        if (fDebug) cout << "numwords = 1, svarname = " << svarname << endl;
        if( mode == kDefine )
-	 gHaVars->Define(svarname.c_str(), cdesc.c_str(), dvars[k]);
+	 fContext->GetVars()->Define(svarname.c_str(), cdesc.c_str(), dvars[k]);
        else
-	 gHaVars->RemoveName(svarname.c_str());
+	 fContext->GetVars()->RemoveName(svarname.c_str());
        k++;
     } else {
       for (Int_t j=0; j<bankloc->numwords; j++) {
@@ -193,9 +194,9 @@ Int_t BankData::DefineVariables( EMode mode )
 	os << svarname << j;
 	if (fDebug) cout << "numwords > 1, svarname = " << os.str() << endl;
 	if( mode == kDefine )
-	  gHaVars->Define(os.str().c_str(), cdesc.c_str(), dvars[k]);
+	  fContext->GetVars()->Define(os.str().c_str(), cdesc.c_str(), dvars[k]);
 	else
-	  gHaVars->RemoveName(os.str().c_str());
+	  fContext->GetVars()->RemoveName(os.str().c_str());
 	k++;
       }
     }
@@ -23,6 +23,7 @@ public:
   virtual ~BankData();
 
   virtual Int_t Process( const THaEvData& evdata );
+  virtual Bool_t UsesRawEventData() const { return true; }
 
 protected:
 
@@ -0,0 +1,200 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::BatchReplay
+//
+// Replays a list of runs with a single THaAnalyzer. Unlike a sequence of
+// independent replay jobs, the analysis is not torn down between runs:
+// modules, output definitions, compiled formulas, cuts and histograms are
+// kept. Modules re-read their databases only if the database files they
+// read have changes for the new run date (see
+// THaAnalysisObject::EnableDBValidityCheck). Each run is written to its
+// own output file.
+//
+// Example (with apparatuses etc. already set up):
+//
+//   Podd::BatchReplay batch(analyzer);
+//   batch.SetOutFilePattern("replay_%d.root");
+//   batch.AddRunList("runs.txt");   // one raw data file per line
+//   batch.Process();
+//
+// Output file names are generated from the pattern unless given
+// explicitly with AddRun(). Every "%d" in the pattern is replaced by the
+// run number.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "BatchReplay.h"
+#include "THaAnalyzer.h"
+#include "THaAnalysisObject.h"
+#include "THaRun.h"
+#include "TError.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+BatchReplay::BatchReplay( THaAnalyzer* analyzer )
+  : fAnalyzer(analyzer)
+  , fPattern("run_%d.root")
+  , fLastEvent(0)
+  , fContinue(true)
+{
+}
+
+//_____________________________________________________________________________
+BatchReplay::~BatchReplay()
+{
+  for( auto& info : fRuns )
+    delete info.run;
+}
+
+//_____________________________________________________________________________
+void BatchReplay::AddRun( THaRunBase* run, const char* outfile )
+{
+  // Add 'run' to the list of runs. Takes ownership of 'run'.
+  // If 'outfile' is empty, the output file name is generated from the
+  // pattern set with SetOutFilePattern().
+
+  if( run )
+    fRuns.push_back({run, outfile ? outfile : "", 0, 0.});
+}
+
+//_____________________________________________________________________________
+Int_t BatchReplay::AddRun( const char* filename, const char* outfile )
+{
+  // Add a CODA run for raw data file 'filename'
+
+  if( !filename || !*filename ) {
+    Error("BatchReplay::AddRun", "Must specify a file name");
+    return -1;
+  }
+  AddRun(new THaRun(filename), outfile);
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t BatchReplay::AddRunList( const char* listfile )
+{
+  // Add CODA runs from a text file with one raw data file name per line,
+  // optionally followed by the output file name. Blank lines and lines
+  // starting with '#' are ignored. Returns the number of runs added or -1
+  // if the file cannot be read.
+
+  ifstream ifs(listfile);
+  if( !ifs ) {
+    Error("BatchReplay::AddRunList", "Cannot open run list file %s",
+          listfile);
+    return -1;
+  }
+  Int_t n = 0;
+  string line;
+  while( getline(ifs, line) ) {
+    istringstream istr(line);
+    string rawfile, outfile;
+    if( !(istr >> rawfile) || rawfile[0] == '#' )
+      continue;
+    istr >> outfile;
+    AddRun(rawfile.c_str(), outfile.c_str());
+    ++n;
+  }
+  return n;
+}
+
+//_____________________________________________________________________________
+TString BatchReplay::OutFileName( RunInfo& info ) const
+{
+  // Output file name for the given run. Initializes the run, if necessary,
+  // since the run number is needed for the file name pattern.
+
+  if( !info.outfile.IsNull() )
+    return info.outfile;
+  if( fPattern.Contains("%d") && !info.run->IsInit() && info.run->Init() != 0 )
+    return "";
+  TString name(fPattern);
+  name.ReplaceAll("%d", Form("%u", info.run->GetNumber()));
+  return name;
+}
+
+//_____________________________________________________________________________
+Int_t BatchReplay::Process()
+{
+  // Replay all runs. Returns the number of runs that failed.
+
+  static const char* const here = "BatchReplay::Process";
+
+  if( !fAnalyzer ) {
+    Error(here, "No analyzer");
+    return -1;
+  }
+  Bool_t check_db = THaAnalysisObject::DBValidityCheckEnabled();
+  THaAnalysisObject::EnableDBValidityCheck();
+
+  Int_t nfail = 0;
+  Bool_t started = false;
+  for( size_t i = 0; i < fRuns.size(); ++i ) {
+    RunInfo& info = fRuns[i];
+    auto start = chrono::steady_clock::now();
+    info.status = 0;
+    TString outfile = OutFileName(info);
+    if( outfile.IsNull() ) {
+      Error(here, "Cannot initialize run %lu. Skipped.",
+            static_cast<unsigned long>(i));
+      info.status = -1;
+    } else {
+      info.outfile = outfile;
+      if( started )
+        info.status = fAnalyzer->SwitchOutputFile(outfile);
+      else
+        fAnalyzer->SetOutFile(outfile);
+      if( info.status == 0 ) {
+        if( fLastEvent > 0 )
+          info.run->SetLastEvent(fLastEvent);
+        info.status = fAnalyzer->Process(info.run);
+        started = true;
+      }
+    }
+    info.time = chrono::duration<Double_t>(
+      chrono::steady_clock::now() - start).count();
+    if( info.status < 0 ) {
+      ++nfail;
+      // Start over with a clean analysis for the next run
+      fAnalyzer->Close();
+      started = false;
+      if( !fContinue )
+        break;
+    }
+  }
+  fAnalyzer->Close();
+
+  THaAnalysisObject::EnableDBValidityCheck(check_db);
+  return nfail;
+}
+
+//_____________________________________________________________________________
+void BatchReplay::Print( Option_t* ) const
+{
+  // Print list of runs with replay status and time
+
+  auto fmt = cout.flags();
+  auto prec = cout.precision();
+  cout << "Batch replay of " << fRuns.size() << " runs:" << endl;
+  cout << setw(8) << "run" << setw(10) << "status" << setw(10) << "time(s)"
+       << "  output" << endl;
+  cout << fixed << setprecision(2);
+  for( const auto& info : fRuns ) {
+    cout << setw(8) << info.run->GetNumber()
+         << setw(10) << info.status
+         << setw(10) << info.time
+         << "  " << info.outfile << endl;
+  }
+  cout.flags(fmt);
+  cout.precision(prec);
+}
+
+} // namespace Podd
@@ -0,0 +1,64 @@
+#ifndef Podd_BatchReplay_h_
+#define Podd_BatchReplay_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::BatchReplay
+//
+// Replay a list of runs with one analyzer, keeping the analysis set up
+// between runs and writing one output file per run
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TString.h"
+#include <vector>
+
+class THaAnalyzer;
+class THaRunBase;
+
+namespace Podd {
+
+class BatchReplay {
+public:
+  struct RunInfo {
+    THaRunBase* run;      // Run to replay (owned)
+    TString     outfile;  // Output file name (empty: use pattern)
+    Int_t       status;   // Return value of THaAnalyzer::Process
+    Double_t    time;     // Wall-clock time for the replay (s)
+  };
+
+  explicit BatchReplay( THaAnalyzer* analyzer );
+  BatchReplay( const BatchReplay& ) = delete;
+  BatchReplay& operator=( const BatchReplay& ) = delete;
+  ~BatchReplay();
+
+  void   AddRun( THaRunBase* run, const char* outfile = "" );
+  Int_t  AddRun( const char* filename, const char* outfile = "" );
+  Int_t  AddRunList( const char* listfile );
+  Int_t  Process();
+  void   Print( Option_t* opt="" ) const;
+
+  // Output file name pattern. "%d" is replaced by the run number.
+  void   SetOutFilePattern( const char* pattern ) { fPattern = pattern; }
+  // Last event to analyze in each run. 0 = all events
+  void   SetLastEvent( UInt_t n )          { fLastEvent = n; }
+  // Keep going after a run fails (default true)
+  void   SetContinueOnError( Bool_t b = true ) { fContinue = b; }
+
+  const char* GetOutFilePattern() const    { return fPattern.Data(); }
+  const std::vector<RunInfo>& GetRuns() const { return fRuns; }
+
+private:
+  THaAnalyzer*         fAnalyzer;   // Analyzer to use (not owned)
+  std::vector<RunInfo> fRuns;       // Runs to replay
+  TString              fPattern;    // Output file name pattern
+  UInt_t               fLastEvent;  // Last event per run (0 = all)
+  Bool_t               fContinue;   // Continue after failed runs
+
+  TString OutFileName( RunInfo& info ) const;
+};
+
+} // namespace Podd
+
+#endif
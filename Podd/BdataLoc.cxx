@@ -16,6 +16,7 @@
 #include "TObjString.h"
 #include "TError.h"
 #include "TClass.h"
+#include "AnalysisContext.h"
 
 #include <cstring>   // for memchr
 #include <cstdlib>   // for strtoul
@@ -65,11 +66,12 @@ Int_t BdataLoc::DefineVariables( EMode mode )
   SetBit( kIsSetup, mode == kDefine );
 
   Int_t ret = kOK;
+  THaVarList* vars = Podd::AnalysisContext::Current()->GetVars();
   if( mode == kDefine ) {
-    if( !gHaVars->Define( GetName(), data ) )
+    if( !vars->Define( GetName(), data ) )
       ret = kInitError;
   } else 
-    gHaVars->RemoveName( GetName() );
+    vars->RemoveName( GetName() );
 
   return ret;
 }
@@ -235,7 +237,8 @@ Int_t CrateLocMulti::DefineVariables( EMode mode )
   if( mode == kDefine ) {
     TString comment = GetName();
     comment.Append(" multihit data");
-    if( !gHaVars->Define( GetName(), comment, rdata ) )
+    THaVarList* vars = Podd::AnalysisContext::Current()->GetVars();
+    if( !vars->Define( GetName(), comment, rdata ) )
       ret = kInitError;
   } else
     ret = CrateLoc::DefineVariables( mode );
@@ -307,13 +310,23 @@ void WordLoc::Load( const THaEvData& evdata )
 {
   // Load data at header/notoskip position from crate data buffer 
 
-  using rawdata_t = const UInt_t;
-
   UInt_t roclen = evdata.GetRocLength(crate);
   if( roclen < ntoskip+1 ) return;
 
-  rawdata_t* cratebuf = evdata.GetRawDataBuffer(crate);
-  assert(cratebuf);  // Must exist if roclen > 0
+  const UInt_t* cratebuf = evdata.GetRawDataBuffer(crate);
+  if( !cratebuf ) return;
+  Load( cratebuf, roclen );
+}
+
+//_____________________________________________________________________________
+void WordLoc::Load( const UInt_t* cratebuf, UInt_t roclen )
+{
+  // Load data at header/notoskip position from the given crate buffer,
+  // which holds roclen+1 words
+
+  using rawdata_t = const UInt_t;
+
+  if( roclen < ntoskip+1 ) return;
   rawdata_t* endp = cratebuf+roclen+1;
 
   // Accelerated search for the header word. Coded explicitly because there
@@ -361,6 +374,83 @@ void WordLoc::Print( Option_t* opt ) const
   cout << "\t data = " << data << endl;
 }
 
+//_____________________________________________________________________________
+void MultiWordLoc::Add( WordLoc* loc )
+{
+  // Add 'loc' to the WordLocs loaded by this object
+
+  assert(loc && loc->crate == crate);
+  UInt_t ihdr = 0;
+  while( ihdr < fHeaders.size() && fHeaders[ihdr] != loc->header )
+    ++ihdr;
+  if( ihdr == fHeaders.size() )
+    fHeaders.push_back(loc->header);
+  fLocs.push_back(loc);
+  fLocHdr.push_back(ihdr);
+  MakeTable();
+}
+
+//_____________________________________________________________________________
+void MultiWordLoc::MakeTable()
+{
+  // Build the open-addressing hash table of the header words, at most
+  // half full
+
+  UInt_t nbits = 1;
+  while( (1U << nbits) < 2*fHeaders.size() )
+    ++nbits;
+  fShift = 32-nbits;
+  fTable.assign(1U << nbits, Slot{0, -1});
+  UInt_t mask = fTable.size()-1;
+  for( UInt_t i = 0; i < fHeaders.size(); ++i ) {
+    UInt_t h = (fHeaders[i] * 2654435761U) >> fShift;
+    while( fTable[h].index >= 0 )
+      h = (h+1) & mask;
+    fTable[h] = Slot{fHeaders[i], static_cast<Int_t>(i)};
+  }
+  fPos.resize(fHeaders.size());
+}
+
+//_____________________________________________________________________________
+void MultiWordLoc::Load( const THaEvData& evdata )
+{
+  // Load all our WordLocs from the crate data buffer
+
+  UInt_t roclen = evdata.GetRocLength(crate);
+  if( roclen < 2 ) return;
+
+  const UInt_t* cratebuf = evdata.GetRawDataBuffer(crate);
+  if( !cratebuf ) return;
+  Load( cratebuf, roclen );
+}
+
+//_____________________________________________________________________________
+void MultiWordLoc::Load( const UInt_t* cratebuf, UInt_t roclen )
+{
+  // Find the first occurrence of each header word in one pass over the
+  // crate buffer, then fetch the data of each WordLoc. The results are
+  // the same as from calling WordLoc::Load for each WordLoc.
+
+  if( fLocs.empty() )
+    return;
+  fPos.assign(fHeaders.size(), 0);
+  size_t nleft = fHeaders.size();
+  for( UInt_t k = 2; k <= roclen; ++k ) {
+    Int_t i = Find(cratebuf[k]);
+    if( i >= 0 && fPos[i] == 0 ) {
+      fPos[i] = k;
+      if( --nleft == 0 )
+        break;
+    }
+  }
+  for( size_t j = 0; j < fLocs.size(); ++j ) {
+    WordLoc* loc = fLocs[j];
+    UInt_t k = fPos[fLocHdr[j]];
+    if( k != 0 && k+loc->ntoskip <= roclen )
+      loc->data = cratebuf[k+loc->ntoskip];
+  }
+}
+
 //_____________________________________________________________________________
 void RoclenLoc::Load( const THaEvData& evdata )
 {
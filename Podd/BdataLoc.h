@@ -54,6 +54,12 @@ public:
   virtual const char* GetTypeKey() const = 0;
   // Optional data passed in via generic pointer
   virtual Int_t   OptionPtr( void* ) { return 0; }
+  // Decoded crates/slots that Load() reads. Locations that only use the
+  // raw crate buffer (e.g. header words, ROC lengths) add nothing.
+  typedef THaAnalysisObject::CrateSlots_t CrateSlots_t;
+  virtual void    GetUsedCrateSlots( CrateSlots_t& ) const {}
+  // True if Load() reads the raw crate buffer
+  virtual Bool_t  UsesRawEventData() const { return false; }
 
   virtual void    Clear( const Option_t* ="" )  { data = kMaxUInt; }
   virtual Bool_t  DidLoad() const               { return (data != kMaxUInt); }
@@ -107,6 +113,8 @@ public:
   virtual Int_t  GetNparams() const       { return fgThisType->fNparams; }
   virtual const char* GetTypeKey() const  { return fgThisType->fDBkey; };
   virtual void    Print( Option_t* opt="" ) const;
+  virtual void    GetUsedCrateSlots( CrateSlots_t& cs ) const
+  { cs.emplace(crate, slot); }
 
   // virtual Bool_t operator==( const BdataLoc& rhs ) const
   // { return (crate == rhs.crate && slot == rhs.slot && chan == rhs.chan); }
@@ -163,10 +171,17 @@ public:
   virtual ~WordLoc() = default;
 
   virtual void   Load( const THaEvData& evt );
+  // Load from crate buffer with given ROC length
+          void   Load( const UInt_t* cratebuf, UInt_t roclen );
   virtual Int_t  Configure( const TObjArray* params, Int_t start = 0 );
   virtual Int_t  GetNparams() const       { return fgThisType->fNparams; }
   virtual const char* GetTypeKey() const  { return fgThisType->fDBkey; };
   virtual void    Print( Option_t* opt="" ) const;
+  virtual Bool_t  UsesRawEventData() const { return true; }
+
+  UInt_t  GetCrate()   const { return crate; }
+  UInt_t  GetHeader()  const { return header; }
+  UInt_t  GetNtoskip() const { return ntoskip; }
 
   // virtual Bool_t operator==( const BdataLoc& rhs ) const
   // { return (crate == rhs.crate &&
@@ -179,9 +194,54 @@ protected:
 private:
   static TypeIter_t fgThisType;
 
+  friend class MultiWordLoc;
+
   ClassDef(WordLoc,0)  
 };
 
+//___________________________________________________________________________
+class MultiWordLoc {
+public:
+  // Several WordLocs in the same crate, loaded with a single scan of the
+  // crate buffer. Used by Podd::DecData. Not a data location itself.
+  explicit MultiWordLoc( UInt_t cra = 0 ) : crate(cra), fShift(32) {}
+
+  // Add a WordLoc in our crate. The WordLoc is not owned.
+  void   Add( WordLoc* loc );
+  void   Clear() { fLocs.clear(); fHeaders.clear(); fTable.clear(); }
+  void   Load( const THaEvData& evt );
+  void   Load( const UInt_t* cratebuf, UInt_t roclen );
+
+  UInt_t GetCrate() const { return crate; }
+  size_t GetSize()  const { return fLocs.size(); }
+
+protected:
+  // Hash table slot for a distinct header word
+  struct Slot {
+    UInt_t header;
+    Int_t  index;   // Index into fHeaders, -1 = empty
+  };
+
+  UInt_t                 crate;    // Crate number of all our WordLocs
+  std::vector<WordLoc*>  fLocs;    // WordLocs to load
+  std::vector<UInt_t>    fLocHdr;  // Index into fHeaders for each WordLoc
+  std::vector<UInt_t>    fHeaders; // Distinct header words
+  std::vector<UInt_t>    fPos;     // Position of each header in buffer
+  std::vector<Slot>      fTable;   // Hash table of fHeaders
+  UInt_t                 fShift;   // Hash shift, 32-log2(table size)
+
+  void   MakeTable();
+  Int_t  Find( UInt_t word ) const
+  {
+    UInt_t mask = fTable.size()-1;
+    for( UInt_t h = (word * 2654435761U) >> fShift; ; h = (h+1) & mask ) {
+      const Slot& slot = fTable[h];
+      if( slot.index < 0 || slot.header == word )
+        return slot.index;
+    }
+  }
+};
+
 //___________________________________________________________________________
 class RoclenLoc : public BdataLoc {
 public:
@@ -193,6 +253,7 @@ public:
   virtual void   Load( const THaEvData& evt );
   virtual Int_t  GetNparams() const       { return fgThisType->fNparams; }
   virtual const char* GetTypeKey() const  { return fgThisType->fDBkey; };
+  virtual Bool_t UsesRawEventData() const { return true; }
 
 private:
   static TypeIter_t fgThisType;
@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::Checkpoint
+//
+// Snapshot of the state of a replay, written by THaAnalyzer to a
+// checkpoint file at regular intervals (see
+// THaAnalyzer::SetCheckpointInterval). It records
+//
+//  - the position in the input: the number of event buffers read and
+//    the current file segment,
+//  - the analyzer's event counters and cut statistics,
+//  - the number of entries of each output tree, which have been flushed
+//    to the output file together with the tree headers,
+//  - the event-to-event state of analysis modules and detectors that
+//    provide one (see THaAnalysisObject::SaveState), e.g. helicity
+//    predictors, keyed by their prefix.
+//
+// The checkpoint file also holds copies of the output histograms.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Checkpoint.h"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+Checkpoint::Checkpoint()
+  : fRunNumber(0), fNread(0), fSegment(-1), fNev(0), fNumAnalyzed(0)
+{
+}
+
+//_____________________________________________________________________________
+Checkpoint::Checkpoint( UInt_t run_number, const char* input )
+  : TNamed("Checkpoint", "Replay checkpoint")
+  , fRunNumber(run_number)
+  , fInput(input ? input : "")
+  , fNread(0)
+  , fSegment(-1)
+  , fNev(0)
+  , fNumAnalyzed(0)
+{
+}
+
+//_____________________________________________________________________________
+void Checkpoint::AddCut( const char* name, UInt_t ncalled, UInt_t npassed )
+{
+  fCutNames.emplace_back(name);
+  fCutCalled.push_back(ncalled);
+  fCutPassed.push_back(npassed);
+}
+
+//_____________________________________________________________________________
+void Checkpoint::AddState( const char* module, const vector<Double_t>& state )
+{
+  fModules.emplace_back(module);
+  fStateLen.push_back(static_cast<UInt_t>(state.size()));
+  fStateData.insert(fStateData.end(), state.begin(), state.end());
+}
+
+//_____________________________________________________________________________
+void Checkpoint::AddTree( const char* name, Long64_t entries )
+{
+  fTreeNames.emplace_back(name);
+  fTreeEntries.push_back(entries);
+}
+
+//_____________________________________________________________________________
+Bool_t Checkpoint::GetState( const char* module, vector<Double_t>& state ) const
+{
+  // Retrieve saved state of the given module. Returns false if none saved.
+
+  auto it = find(fModules.begin(), fModules.end(), module);
+  if( it == fModules.end() )
+    return false;
+  auto i = it - fModules.begin();
+  auto start = accumulate(fStateLen.begin(), fStateLen.begin() + i, 0UL);
+  state.assign(fStateData.begin() + start,
+               fStateData.begin() + start + fStateLen[i]);
+  return true;
+}
+
+//_____________________________________________________________________________
+void Checkpoint::SetPosition( ULong64_t nread, Int_t segment, UInt_t nev,
+                              UInt_t nanalyzed )
+{
+  fNread = nread;
+  fSegment = segment;
+  fNev = nev;
+  fNumAnalyzed = nanalyzed;
+  fTime.Set();
+}
+
+//_____________________________________________________________________________
+void Checkpoint::Print( Option_t* ) const
+{
+  // Print checkpoint summary
+
+  cout << "Checkpoint of run " << fRunNumber << " taken " << fTime.AsString()
+       << endl;
+  cout << "Input: " << fInput;
+  if( fSegment >= 0 )
+    cout << ", segment " << fSegment;
+  cout << ", " << fNread << " buffers read, event " << fNev << endl;
+  for( size_t i = 0; i < fTreeNames.size(); ++i )
+    cout << "Tree " << fTreeNames[i] << ": " << fTreeEntries[i]
+         << " entries" << endl;
+  if( !fModules.empty() ) {
+    cout << "Module state saved:";
+    for( const auto& m : fModules )
+      cout << " " << m;
+    cout << endl;
+  }
+}
+
+} // namespace Podd
+
+//_____________________________________________________________________________
+ClassImp(Podd::Checkpoint)
@@ -0,0 +1,71 @@
+#ifndef Podd_Checkpoint_h_
+#define Podd_Checkpoint_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::Checkpoint
+//
+// State of an analysis in progress, written periodically by THaAnalyzer
+// so that an interrupted replay can be resumed.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "TNamed.h"
+#include "TDatime.h"
+#include <string>
+#include <vector>
+
+namespace Podd {
+
+class Checkpoint : public TNamed {
+public:
+  Checkpoint();
+  Checkpoint( UInt_t run_number, const char* input );
+
+  void      AddCounter( ULong64_t count ) { fCounts.push_back(count); }
+  void      AddCut( const char* name, UInt_t ncalled, UInt_t npassed );
+  void      AddState( const char* module, const std::vector<Double_t>& state );
+  void      AddTree( const char* name, Long64_t entries );
+  virtual void Print( Option_t* opt="" ) const;
+  void      SetPosition( ULong64_t nread, Int_t segment, UInt_t nev,
+                         UInt_t nanalyzed );
+
+  UInt_t    GetRunNumber()   const { return fRunNumber; }
+  const char* GetInput()     const { return fInput.c_str(); }
+  ULong64_t GetNread()       const { return fNread; }
+  Int_t     GetSegment()     const { return fSegment; }
+  UInt_t    GetNev()         const { return fNev; }
+  UInt_t    GetNumAnalyzed() const { return fNumAnalyzed; }
+  const TDatime& GetTime()   const { return fTime; }
+  const std::vector<ULong64_t>&   GetCounts()      const { return fCounts; }
+  const std::vector<std::string>& GetCutNames()    const { return fCutNames; }
+  const std::vector<UInt_t>&      GetCutCalled()   const { return fCutCalled; }
+  const std::vector<UInt_t>&      GetCutPassed()   const { return fCutPassed; }
+  const std::vector<std::string>& GetTreeNames()   const { return fTreeNames; }
+  const std::vector<Long64_t>&    GetTreeEntries() const { return fTreeEntries; }
+  Bool_t    GetState( const char* module, std::vector<Double_t>& state ) const;
+
+protected:
+  UInt_t                   fRunNumber;   // Run number
+  std::string              fInput;       // Input file name
+  ULong64_t                fNread;       // Event buffers read from input
+  Int_t                    fSegment;     // Current file segment (-1 = none)
+  UInt_t                   fNev;         // Analyzer event count
+  UInt_t                   fNumAnalyzed; // Physics events analyzed
+  TDatime                  fTime;        // Time checkpoint was taken
+  std::vector<ULong64_t>   fCounts;      // Analyzer counter values
+  std::vector<std::string> fCutNames;    // Cut names
+  std::vector<UInt_t>      fCutCalled;   // Number of cut evaluations
+  std::vector<UInt_t>      fCutPassed;   // Number of cut evaluations passed
+  std::vector<std::string> fTreeNames;   // Output trees
+  std::vector<Long64_t>    fTreeEntries; // Saved entries of output trees
+  std::vector<std::string> fModules;     // Modules with saved state
+  std::vector<UInt_t>      fStateLen;    // Length of each module's state
+  std::vector<Double_t>    fStateData;   // Module states, concatenated
+
+  ClassDef(Checkpoint,1)  // Checkpoint of an analysis in progress
+};
+
+} // namespace Podd
+
+#endif
@@ -13,6 +13,7 @@
 #include "THaAnalysisObject.h"
 #include "THaVarList.h"
 #include "THaGlobals.h"
+#include "AnalysisContext.h"
 
 using namespace std;
 
@@ -24,7 +25,8 @@ CodaRawDecoder::CodaRawDecoder()
   const char* const here = "CodaRawDecoder::CodaRawDecoder";
 
   // Register standard global variables for event header data
-  if( gHaVars ) {
+  THaVarList* varlist = Podd::AnalysisContext::Current()->GetVars();
+  if( varlist ) {
     VarDef vars[] = {
         { "runnum",    "Run number",     kUInt,   0, &run_num },
         { "runtype",   "CODA run type",  kUInt,   0, &run_type },
@@ -42,7 +44,7 @@ CodaRawDecoder::CodaRawDecoder()
     if( fInstance > 1 )
       prefix.Append(Form("%d",fInstance));
     prefix.Append(".");
-    gHaVars->DefineVariables( vars, prefix, here );
+    varlist->DefineVariables( vars, prefix, here );
   } else
     Warning(here,"No global variable list found. Variables not registered.");
 }
@@ -52,12 +54,13 @@ CodaRawDecoder::~CodaRawDecoder()
 {
   // Destructor. Unregister global variables
 
-  if( gHaVars ) {
+  THaVarList* varlist = Podd::AnalysisContext::Current()->GetVars();
+  if( varlist ) {
     TString prefix("g");
     if( fInstance > 1 )
       prefix.Append(Form("%d",fInstance));
     prefix.Append(".*");
-    gHaVars->RemoveRegexp( prefix );
+    varlist->RemoveRegexp( prefix );
   }
 }
 
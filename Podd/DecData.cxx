@@ -82,6 +82,7 @@
 #include <cstdio>
 #include <cassert>
 #include <memory>
+#include <map>
 
 using namespace std;
 
@@ -130,6 +131,8 @@ void DecData::Reset( Option_t* opt )
   // Reset the class. Removes all data channel definitions
 
   Clear(opt);
+  fWordLocGroups.clear();
+  fLoadList.clear();
   fBdataLoc.Clear();
 }
 
@@ -317,6 +320,8 @@ Int_t DecData::ReadDatabase( const TDatime& date )
 
   Bool_t re_init = fIsInit;
   fIsInit = false;
+  fWordLocGroups.clear();
+  fLoadList.clear();
   if( !re_init ) {
     fBdataLoc.Clear();
   }
@@ -359,10 +364,43 @@ Int_t DecData::ReadDatabase( const TDatime& date )
   if( err )
     return kInitError;
 
+  GroupWordLocs();
+
   fIsInit = true;
   return kOK;
 }
 
+//_____________________________________________________________________________
+void DecData::GroupWordLocs()
+{
+  // Group the WordLocs of each crate with more than one WordLoc so that
+  // their header words are found in a single scan of the crate buffer.
+  // All other data channels are loaded individually.
+
+  fWordLocGroups.clear();
+  fLoadList.clear();
+  map<UInt_t, vector<WordLoc*>> wordlocs;
+  TIter next( &fBdataLoc );
+  while( auto* dataloc = static_cast<BdataLoc*>(next()) ) {
+    // Derived classes may load differently
+    if( dataloc->IsA() == WordLoc::Class() ) {
+      auto* loc = static_cast<WordLoc*>(dataloc);
+      wordlocs[loc->GetCrate()].push_back(loc);
+    } else
+      fLoadList.push_back(dataloc);
+  }
+  for( const auto& crate_locs : wordlocs ) {
+    const auto& locs = crate_locs.second;
+    if( locs.size() == 1 ) {
+      fLoadList.push_back(locs.front());
+      continue;
+    }
+    fWordLocGroups.emplace_back(crate_locs.first);
+    for( auto* loc : locs )
+      fWordLocGroups.back().Add(loc);
+  }
+}
+
 
 //_____________________________________________________________________________
 THaAnalysisObject::EStatus DecData::Init( const TDatime& run_time )
@@ -389,15 +427,13 @@ Int_t DecData::Decode(const THaEvData& evdata)
 
   // For each raw data source registered in fBdataLoc, get the data
 
-  //TODO: accelerate search for multiple header words in same crate
-  //- group WordLoc objects by crate
-  //- for each crate with >1 WordLoc defs, make a MultiWordLoc
-  //- MultiWordLoc uses faster search algo to scan crate buffer
+  // Header words of several WordLocs in the same crate are found in a
+  // single scan of the crate buffer (see GroupWordLocs)
 
-  TIter next( &fBdataLoc );
-  while( auto* dataloc = static_cast<BdataLoc*>(next()) ) {
+  for( auto* dataloc : fLoadList )
     dataloc->Load( evdata );
-  }
+  for( auto& group : fWordLocGroups )
+    group.Load( evdata );
 
   if( fDebug>1 )
     Print();
@@ -405,6 +441,31 @@ Int_t DecData::Decode(const THaEvData& evdata)
   return 0;
 }
 
+//_____________________________________________________________________________
+Bool_t DecData::GetUsedCrateSlots( CrateSlots_t& crateslots ) const
+{
+  // Add the crates/slots of all raw data channels to 'crateslots'
+
+  TIter next( &fBdataLoc );
+  while( auto* dataloc = static_cast<const BdataLoc*>(next()) ) {
+    dataloc->GetUsedCrateSlots( crateslots );
+  }
+  return true;
+}
+
+//_____________________________________________________________________________
+Bool_t DecData::UsesRawEventData() const
+{
+  // True if any channel is a raw-word location (header word, ROC length)
+
+  TIter next( &fBdataLoc );
+  while( auto* dataloc = static_cast<const BdataLoc*>(next()) ) {
+    if( dataloc->UsesRawEventData() )
+      return true;
+  }
+  return false;
+}
+
 //_____________________________________________________________________________
 void DecData::Print( Option_t* opt ) const
 {
@@ -10,6 +10,7 @@
 #include "THaApparatus.h"
 #include "THashList.h"
 #include "BdataLoc.h"
+#include <vector>
 
 class TString;
 
@@ -27,6 +28,8 @@ public:
   virtual Int_t   Decode( const THaEvData& );
   virtual void    Print( Option_t* opt="" ) const;
   virtual void    Reset( Option_t* opt="" );
+  virtual Bool_t  GetUsedCrateSlots( CrateSlots_t& crateslots ) const;
+  virtual Bool_t  UsesRawEventData() const;
 
   // Disabled functions from THaApparatus
   virtual Int_t   AddDetector( THaDetector*, Bool_t, Bool_t ) { return 0; }
@@ -36,12 +39,15 @@ protected:
   UInt_t          evtype;      // CODA event type
   UInt_t          evtypebits;  // Bitpattern of active trigger numbers
   THashList       fBdataLoc;   // Raw data channels
+  std::vector<MultiWordLoc> fWordLocGroups; //! WordLocs grouped by crate
+  std::vector<BdataLoc*> fLoadList; //! Channels loaded individually
 
   virtual Int_t   DefineVariables( EMode mode = kDefine );
   virtual Int_t   ReadDatabase( const TDatime& date );
 
   Int_t           DefineLocType( const BdataLoc::BdataLocType& loctype,
 				 const TString& configstr, bool re_init );
+  void            GroupWordLocs();
 
   // Expansion hooks for ReadDatabase
   virtual Int_t   SetupDBVersion( FILE* file, Int_t db_version );
@@ -0,0 +1,285 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::EventCache
+//
+// Holds the raw event buffers of one run (or run segment) in memory so
+// that the run can be replayed repeatedly without reading the input file
+// again. Used by THaAnalyzer when the event cache is enabled, typically
+// for calibration loops where the same events are analyzed many times
+// with modified database parameters:
+//
+//   analyzer->EnableEventCache();
+//   analyzer->GetEventCache()->SetMemoryLimit(4000000000ULL);  // 4 GB
+//   analyzer->Process(run);   // reads from disk, fills the cache
+//   // ... modify database files ...
+//   analyzer->Process(run);   // re-reads databases, replays from memory
+//
+// Memory is allocated in chunks of 4 MB up to the memory limit (default
+// 1 GB). When the limit is reached, the spill policy determines what
+// happens with the remaining events of the run:
+//
+//   kStop   Recording stops. Replays end with the last cached event.
+//   kSpill  Events are appended to a binary spill file (by default a
+//           temporary file in gSystem->TempDirectory()), which is read
+//           back sequentially during replays. The file is deleted when
+//           the cache is cleared.
+//
+// Only runs whose event buffers are self-describing CODA/EVIO events
+// (first word = event length - 1) can be cached.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "EventCache.h"
+#include "THaRunBase.h"
+#include "TClass.h"
+#include "TError.h"
+#include "TSystem.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>    // std::remove
+#include <iostream>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+EventCache::EventCache()
+  : fChunkUsed(0)
+  , fChunkCap(0)
+  , fMaxMem(1000000000ULL)
+  , fMemUsed(0)
+  , fPolicy(kStop)
+  , fNspilled(0)
+  , fNext(0)
+  , fCurrent(nullptr)
+  , fRecording(false)
+  , fAtEOF(false)
+  , fTruncated(false)
+{
+}
+
+//_____________________________________________________________________________
+EventCache::~EventCache()
+{
+  CloseSpill();
+}
+
+//_____________________________________________________________________________
+void EventCache::Clear()
+{
+  // Delete all cached events and release their memory
+
+  fChunks.clear();
+  fEvents.clear();
+  fRun.reset();
+  fChunkUsed = fChunkCap = 0;
+  fMemUsed = 0;
+  fNspilled = 0;
+  fNext = 0;
+  fCurrent = nullptr;
+  fReadBuf.clear();
+  fRecording = fAtEOF = fTruncated = false;
+  CloseSpill();
+}
+
+//_____________________________________________________________________________
+Int_t EventCache::StartRecording( const THaRunBase* run )
+{
+  // Clear the cache and prepare for recording the events of 'run'
+
+  assert(run);
+  Clear();
+  fRun.reset(static_cast<THaRunBase*>(run->IsA()->New()));
+  if( !fRun ) {
+    Error("EventCache::StartRecording", "Failed to copy run object");
+    return -1;
+  }
+  *fRun = *run;
+  fRecording = true;
+  return 0;
+}
+
+//_____________________________________________________________________________
+UInt_t* EventCache::Allocate( size_t nwords )
+{
+  // Reserve space for 'nwords' words. Returns nullptr if the memory limit
+  // would be exceeded.
+
+  if( fChunkUsed + nwords > fChunkCap ) {
+    size_t cap = max(nwords, kChunkSize);
+    if( fMemUsed + cap*sizeof(UInt_t) > fMaxMem )
+      return nullptr;
+    fChunks.emplace_back(new UInt_t[cap]);
+    fMemUsed += cap*sizeof(UInt_t);
+    fChunkCap = cap;
+    fChunkUsed = 0;
+  }
+  UInt_t* p = fChunks.back().get() + fChunkUsed;
+  fChunkUsed += nwords;
+  return p;
+}
+
+//_____________________________________________________________________________
+Int_t EventCache::AddEvent( const UInt_t* evbuffer )
+{
+  // Add a copy of the event in 'evbuffer' to the cache.
+  // Returns 0 if the event was saved, 1 if not (memory limit reached),
+  // and a negative number on error.
+
+  if( !fRecording || fTruncated )
+    return 1;
+  if( !evbuffer )
+    return -1;
+
+  size_t len = static_cast<size_t>(evbuffer[0]) + 1;
+  if( fNspilled == 0 ) {
+    if( UInt_t* p = Allocate(len) ) {
+      copy_n(evbuffer, len, p);
+      fEvents.push_back(p);
+      return 0;
+    }
+    if( fPolicy == kStop ) {
+      Warning("EventCache::AddEvent", "Memory limit of %llu bytes reached "
+              "after %lu events. Remaining events will not be cached.",
+              fMaxMem, static_cast<unsigned long>(fEvents.size()));
+      fTruncated = true;
+      return 1;
+    }
+    if( OpenSpill() != 0 ) {
+      fTruncated = true;
+      return -2;
+    }
+  }
+  fSpill.write(reinterpret_cast<const char*>(evbuffer),
+               static_cast<streamsize>(len*sizeof(UInt_t)));
+  if( !fSpill ) {
+    Error("EventCache::AddEvent", "Error writing spill file %s. "
+          "Remaining events will not be cached.", fSpillName.Data());
+    fTruncated = true;
+    return -3;
+  }
+  ++fNspilled;
+  return 0;
+}
+
+//_____________________________________________________________________________
+void EventCache::StopRecording( Bool_t at_eof )
+{
+  // Finish recording. 'at_eof' indicates that all events of the run were
+  // read, i.e. the cache holds the complete run unless truncated.
+
+  if( !fRecording )
+    return;
+  fRecording = false;
+  fAtEOF = at_eof;
+  if( fSpill.is_open() )
+    fSpill.flush();
+}
+
+//_____________________________________________________________________________
+Bool_t EventCache::Matches( const THaRunBase* run ) const
+{
+  // True if the cache holds events of the given run
+
+  return run && fRun && !fRecording && GetNevents() > 0 &&
+    fRun->IsA() == run->IsA() && fRun->Compare(run) == 0;
+}
+
+//_____________________________________________________________________________
+void EventCache::Rewind()
+{
+  // Restart reading at the first cached event
+
+  fNext = 0;
+  fCurrent = nullptr;
+  if( fSpill.is_open() ) {
+    fSpill.clear();
+    fSpill.seekg(0);
+  }
+}
+
+//_____________________________________________________________________________
+Int_t EventCache::ReadEvent()
+{
+  // Make the next cached event current. Returns THaRunBase::READ_OK,
+  // READ_EOF if no more events, or READ_ERROR on spill file read error.
+
+  if( fNext < fEvents.size() ) {
+    fCurrent = fEvents[fNext++];
+    return THaRunBase::READ_OK;
+  }
+  if( fNext >= GetNevents() ) {
+    fCurrent = nullptr;
+    return THaRunBase::READ_EOF;
+  }
+  UInt_t len = 0;
+  fSpill.read(reinterpret_cast<char*>(&len), sizeof(len));
+  if( fSpill ) {
+    fReadBuf.resize(static_cast<size_t>(len) + 1);
+    fReadBuf[0] = len;
+    fSpill.read(reinterpret_cast<char*>(&fReadBuf[1]),
+                static_cast<streamsize>(len*sizeof(UInt_t)));
+  }
+  if( !fSpill ) {
+    Error("EventCache::ReadEvent", "Error reading spill file %s",
+          fSpillName.Data());
+    fCurrent = nullptr;
+    return THaRunBase::READ_ERROR;
+  }
+  ++fNext;
+  fCurrent = fReadBuf.data();
+  return THaRunBase::READ_OK;
+}
+
+//_____________________________________________________________________________
+Int_t EventCache::OpenSpill()
+{
+  // Open the spill file for writing and reading
+
+  if( fSpillName.IsNull() )
+    fSpillName = Form("%s/podd_evcache_%d.dat", gSystem->TempDirectory(),
+                      gSystem->GetPid());
+  fSpill.open(fSpillName.Data(),
+              ios::in | ios::out | ios::trunc | ios::binary);
+  if( !fSpill.is_open() ) {
+    Error("EventCache::OpenSpill", "Cannot open spill file %s. Remaining "
+          "events will not be cached.", fSpillName.Data());
+    return -1;
+  }
+  Info("EventCache::OpenSpill", "Memory limit of %llu bytes reached. "
+       "Spilling further events to %s", fMaxMem, fSpillName.Data());
+  return 0;
+}
+
+//_____________________________________________________________________________
+void EventCache::CloseSpill()
+{
+  // Close and delete the spill file, if any
+
+  if( fSpill.is_open() ) {
+    fSpill.close();
+    std::remove(fSpillName.Data());
+  }
+  fSpill.clear();
+}
+
+//_____________________________________________________________________________
+void EventCache::Print( Option_t* ) const
+{
+  // Print cache status
+
+  cout << "Event cache: " << GetNevents() << " events";
+  if( fRun )
+    cout << " of run " << fRun->GetNumber();
+  cout << ", " << fMemUsed/1048576 << " of " << fMaxMem/1048576 << " MB used";
+  if( fNspilled > 0 )
+    cout << ", " << fNspilled << " events spilled to " << fSpillName;
+  if( fTruncated )
+    cout << " (truncated)";
+  else if( !fRecording && fRun && !fAtEOF )
+    cout << " (partial run)";
+  cout << endl;
+}
+
+} // namespace Podd
@@ -0,0 +1,90 @@
+#ifndef Podd_EventCache_h_
+#define Podd_EventCache_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::EventCache
+//
+// In-memory store of raw event buffers for repeated replays of a run
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include "TString.h"
+#include <fstream>
+#include <memory>
+#include <vector>
+
+class THaRunBase;
+
+namespace Podd {
+
+class EventCache {
+public:
+  // What to do when the memory limit is reached
+  enum ESpillPolicy {
+    kStop,   // Stop caching. Replays end with the last cached event.
+    kSpill   // Write further events to a temporary spill file
+  };
+
+  EventCache();
+  EventCache( const EventCache& ) = delete;
+  EventCache& operator=( const EventCache& ) = delete;
+  ~EventCache();
+
+  void          Clear();
+  Int_t         StartRecording( const THaRunBase* run );
+  Int_t         AddEvent( const UInt_t* evbuffer );
+  void          StopRecording( Bool_t at_eof );
+  Bool_t        Matches( const THaRunBase* run ) const;
+  void          Rewind();
+  Int_t         ReadEvent();
+  const UInt_t* GetEvBuffer() const { return fCurrent; }
+  void          Print( Option_t* opt="" ) const;
+
+  void          SetMemoryLimit( ULong64_t bytes ) { fMaxMem = bytes; }
+  void          SetSpillPolicy( ESpillPolicy policy ) { fPolicy = policy; }
+  void          SetSpillFile( const char* name ) { fSpillName = name; }
+
+  ULong64_t     GetMemoryLimit()  const { return fMaxMem; }
+  ULong64_t     GetMemoryUsed()   const { return fMemUsed; }
+  ESpillPolicy  GetSpillPolicy()  const { return fPolicy; }
+  const char*   GetSpillFile()    const { return fSpillName.Data(); }
+  ULong64_t     GetNevents()      const { return fEvents.size() + fNspilled; }
+  ULong64_t     GetNspilled()     const { return fNspilled; }
+  Bool_t        IsComplete()      const { return fAtEOF && !fTruncated; }
+  Bool_t        IsRecording()     const { return fRecording; }
+  Bool_t        IsTruncated()     const { return fTruncated; }
+  const THaRunBase* GetRun()      const { return fRun.get(); }
+
+private:
+  static const size_t kChunkSize = 1U<<20;  // Words per memory chunk
+
+  // Event data are kept in fixed-size chunks so that pointers into them
+  // remain valid as the cache grows
+  std::vector<std::unique_ptr<UInt_t[]>> fChunks;
+  std::vector<const UInt_t*> fEvents;    // Start of each cached event
+  std::unique_ptr<THaRunBase> fRun;      // Copy of the cached run
+  size_t        fChunkUsed;  // Words used in last chunk
+  size_t        fChunkCap;   // Capacity of last chunk (words)
+  ULong64_t     fMaxMem;     // Memory limit (bytes)
+  ULong64_t     fMemUsed;    // Memory allocated (bytes)
+  ESpillPolicy  fPolicy;     // Action when fMaxMem is reached
+  TString       fSpillName;  // Name of spill file (default: temp file)
+  std::fstream  fSpill;      // Spill file stream
+  ULong64_t     fNspilled;   // Number of events in spill file
+  size_t        fNext;       // Index of next event to read
+  const UInt_t* fCurrent;    // Current event buffer
+  std::vector<UInt_t> fReadBuf;  // Buffer for events read from spill file
+  Bool_t        fRecording;  // Events are being recorded
+  Bool_t        fAtEOF;      // Recording reached the end of the run
+  Bool_t        fTruncated;  // Events were dropped because of fMaxMem
+
+  UInt_t*       Allocate( size_t nwords );
+  Int_t         OpenSpill();
+  void          CloseSpill();
+};
+
+} // namespace Podd
+
+#endif
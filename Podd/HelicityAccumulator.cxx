@@ -0,0 +1,507 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HelicityAccumulator
+//
+// Physics module that accumulates helicity-resolved statistics of
+// selected global variables (e.g. beam charge, detector yields) during
+// the replay, so that asymmetries are available without writing every
+// event to the output tree and looping over it again.
+//
+// For each variable, the module keeps, with numerically stable running
+// statistics (see RunningStat):
+//
+//  - mean and RMS of the per-event values, separately for each helicity
+//  - mean and error of the asymmetries A = (Y+ - Y-)/(Y+ + Y-) of
+//    helicity patterns (quartets, octets ...), where Y+/- are the mean
+//    values of the variable in the events of either helicity
+//  - the same for macro-pulse windows of a fixed number of patterns
+//
+// Patterns are delimited by a global variable that is non-zero in the
+// first window of each pattern, for example "<helicity_det>.qrt".
+// Without it, only per-helicity statistics are accumulated. Patterns
+// with events of unknown helicity, or without events of both helicities,
+// do not enter the asymmetries.
+//
+// The asymmetries of each completed pattern are available as global
+// variables and, optionally, are written as compact records to a tree
+// named <module name>_patterns. A summary of the final results is printed
+// at the end of the run (see Print()).
+//
+// Database keys (prefix <module name>.), all optional:
+//   variables     Names of global variables, separated by space or comma,
+//                 added to those given in the constructor
+//   sync          Pattern synchronization variable
+//   macro_npat    Patterns per macro-pulse window (default 0 = none)
+//   pattern_tree  Write per-pattern records (default 1)
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "HelicityAccumulator.h"
+#include "THaHelicityDet.h"
+#include "THaVarList.h"
+#include "THaVar.h"
+#include "VarDef.h"
+#include "AnalysisContext.h"
+#include "TObjArray.h"
+#include "TObjString.h"
+#include "TTree.h"
+#include "TMath.h"
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+Double_t RunningStat::GetVariance() const
+{
+  // Sample variance
+
+  return (fN > 1) ? fM2 / static_cast<Double_t>(fN-1) : 0.0;
+}
+
+//_____________________________________________________________________________
+Double_t RunningStat::GetRMS() const
+{
+  return TMath::Sqrt(GetVariance());
+}
+
+//_____________________________________________________________________________
+Double_t RunningStat::GetError() const
+{
+  return (fN > 0) ? TMath::Sqrt(GetVariance() / static_cast<Double_t>(fN))
+                  : 0.0;
+}
+
+//_____________________________________________________________________________
+void RunningStat::Save( vector<Double_t>& state ) const
+{
+  state.push_back(static_cast<Double_t>(fN));
+  state.push_back(fMean);
+  state.push_back(fM2);
+}
+
+//_____________________________________________________________________________
+void RunningStat::Restore( vector<Double_t>::const_iterator& it )
+{
+  fN    = static_cast<ULong64_t>(*it++);
+  fMean = *it++;
+  fM2   = *it++;
+}
+
+//_____________________________________________________________________________
+HelicityAccumulator::HelicityAccumulator( const char* name,
+                                          const char* description,
+                                          const char* helicity_det,
+                                          const char* var_list )
+  : THaPhysicsModule(name, description)
+  , fHelName(helicity_det)
+  , fVarList(var_list)
+  , fMacroLen(0)
+  , fDoTree(true)
+  , fHelDet(nullptr)
+  , fSync(nullptr)
+  , fLastSync(false)
+  , fPatGood(true)
+  , fPatN{0,0}
+  , fMacroN{0,0}
+  , fMacroNpat(0)
+  , fNpat(0)
+  , fNgoodPat(0)
+  , fPatDone(0)
+  , fTree(nullptr)
+{
+  // Constructor. 'helicity_det' is the name of the helicity detector,
+  // including its apparatus, e.g. "R.hel". 'var_list' are the names
+  // of the global variables to accumulate, separated by space or comma.
+}
+
+//_____________________________________________________________________________
+HelicityAccumulator::~HelicityAccumulator()
+{
+  // Destructor
+
+  RemoveVariables();
+  delete fTree;
+}
+
+//_____________________________________________________________________________
+void HelicityAccumulator::Clear( Option_t* opt )
+{
+  // Clear event-by-event data
+
+  THaPhysicsModule::Clear(opt);
+  fPatDone = 0;
+  for( auto& a : fAsym )
+    a = kBig;
+}
+
+//_____________________________________________________________________________
+Int_t HelicityAccumulator::DefineVariables( EMode mode )
+{
+  // Define/delete global variables
+
+  RVarDef vars[] = {
+    { "done", "Pattern completed at this event", "fPatDone" },
+    { "asym", "Asymmetries of completed pattern", "fAsym" },
+    { nullptr }
+  };
+  return DefineVarsFromList( vars, mode );
+}
+
+//_____________________________________________________________________________
+Int_t HelicityAccumulator::ReadDatabase( const TDatime& date )
+{
+  // Read optional configuration from the database
+
+  FILE* file = OpenFile(date);
+  if( !file ) {
+    // Missing file OK -- all keys are optional
+    fIsInit = true;
+    return kOK;
+  }
+
+  fIsInit = false;
+  TString vars, sync = fSyncName;
+  Int_t macro = static_cast<Int_t>(fMacroLen), dotree = fDoTree;
+  DBRequest config_request[] = {
+    { "variables",    &vars,   kTString, 0, true },
+    { "sync",         &sync,   kTString, 0, true },
+    { "macro_npat",   &macro,  kInt,     0, true },
+    { "pattern_tree", &dotree, kInt,     0, true },
+    { nullptr }
+  };
+  Int_t err = LoadDB( file, date, config_request );
+  fclose(file);
+  if( err )
+    return err;
+
+  if( macro < 0 ) {
+    Error( Here("ReadDatabase"), "Invalid number of patterns per "
+           "macro-pulse window = %d. Must be >= 0.", macro );
+    return kInitError;
+  }
+  fDBVarList = vars;
+  fSyncName = sync;
+  fMacroLen = macro;
+  fDoTree = (dotree != 0);
+
+  fIsInit = true;
+  return kOK;
+}
+
+//_____________________________________________________________________________
+THaAnalysisObject::EStatus HelicityAccumulator::Init( const TDatime& run_time )
+{
+  // Initialize the module. Locate the helicity detector and the global
+  // variables to accumulate.
+
+  const char* const here = "Init";
+
+  // Standard initialization. Calls ReadDatabase() and DefineVariables()
+  if( THaPhysicsModule::Init(run_time) != kOK )
+    return fStatus;
+
+  if( !(fHelDet = dynamic_cast<THaHelicityDet*>
+        (FindModule(fHelName.Data(), "THaHelicityDet"))) )
+    return fStatus;
+
+  fVars.clear();
+  TString varlist = fVarList + " " + fDBVarList;
+  unique_ptr<TObjArray> names(varlist.Tokenize(" ,\t"));
+  for( Int_t i = 0; i <= names->GetLast(); ++i ) {
+    const TString& name = static_cast<TObjString*>(names->At(i))->String();
+    fVars.emplace_back(name.Data());
+    VarAcc& acc = fVars.back();
+    if( !(acc.fVar = fContext->GetVars()->Find(name.Data())) ) {
+      Error( Here(here), "Global variable %s not found. "
+             "Module not initialized.", name.Data() );
+      fStatus = kInitError;
+      // Keep going to get reports on all failures
+    }
+  }
+  if( fVars.empty() ) {
+    Error( Here(here), "No variables to accumulate. "
+           "Module not initialized." );
+    fStatus = kInitError;
+  }
+  fSync = nullptr;
+  if( !fSyncName.IsNull() &&
+      !(fSync = fContext->GetVars()->Find(fSyncName.Data())) ) {
+    Error( Here(here), "Pattern synchronization variable %s not found. "
+           "Module not initialized.", fSyncName.Data() );
+    fStatus = kInitError;
+  }
+  // Keep the storage of the asymmetries, which the pattern tree refers to
+  if( fAsym.size() != fVars.size() )
+    fAsym.assign(fVars.size(), kBig);
+
+  return fStatus;
+}
+
+//_____________________________________________________________________________
+void HelicityAccumulator::ResetSums()
+{
+  // Clear all accumulated statistics
+
+  for( auto& v : fVars ) {
+    v.fHel[0].Clear();
+    v.fHel[1].Clear();
+    v.fPatAsym.Clear();
+    v.fMacroAsym.Clear();
+    v.fPatSum[0] = v.fPatSum[1] = v.fMacroSum[0] = v.fMacroSum[1] = 0;
+  }
+  fLastSync = false;
+  fPatGood = true;
+  fPatN[0] = fPatN[1] = fMacroN[0] = fMacroN[1] = 0;
+  fMacroNpat = 0;
+  fNpat = fNgoodPat = 0;
+}
+
+//_____________________________________________________________________________
+void HelicityAccumulator::MakeTree()
+{
+  // Create the tree of per-pattern records in the current directory,
+  // normally the output file. One branch per variable, named after the
+  // variable with '.' replaced by '_'.
+
+  fTree = new TTree(fName + "_patterns",
+                    fName + " helicity pattern asymmetries");
+  fTree->SetAutoSave(200000000);
+  fTree->Branch("npat", &fNpat, "npat/l");
+  fTree->Branch("nhel", fPatN, "nhel[2]/i");
+  for( size_t i = 0; i < fVars.size(); ++i ) {
+    TString bname = fVars[i].fName;
+    bname.ReplaceAll(".", "_");
+    fTree->Branch(bname.Data(), &fAsym[i], (bname + "/F").Data());
+  }
+}
+
+//_____________________________________________________________________________
+Int_t HelicityAccumulator::Begin( THaRunBase* )
+{
+  // Start of run: clear all sums
+
+  ResetSums();
+  if( fDoTree && !fTree && IsOK() )
+    MakeTree();
+  return 0;
+}
+
+//_____________________________________________________________________________
+void HelicityAccumulator::EndMacro()
+{
+  // Macro-pulse window complete: accumulate its asymmetries
+
+  for( auto& v : fVars ) {
+    Double_t yp = v.fMacroSum[1] / fMacroN[1];
+    Double_t ym = v.fMacroSum[0] / fMacroN[0];
+    if( yp + ym != 0 )
+      v.fMacroAsym.Add((yp - ym) / (yp + ym));
+    v.fMacroSum[0] = v.fMacroSum[1] = 0;
+  }
+  fMacroN[0] = fMacroN[1] = 0;
+  fMacroNpat = 0;
+}
+
+//_____________________________________________________________________________
+void HelicityAccumulator::EndPattern()
+{
+  // Pattern complete: compute and accumulate its asymmetries, write
+  // the pattern record
+
+  if( fPatN[0] + fPatN[1] == 0 && fPatGood )
+    return;  // nothing accumulated, e.g. at start of run
+
+  Bool_t good = fPatGood && fPatN[0] > 0 && fPatN[1] > 0;
+  for( size_t i = 0; i < fVars.size(); ++i ) {
+    VarAcc& v = fVars[i];
+    if( good ) {
+      Double_t yp = v.fPatSum[1] / fPatN[1];
+      Double_t ym = v.fPatSum[0] / fPatN[0];
+      if( yp + ym != 0 ) {
+        Double_t a = (yp - ym) / (yp + ym);
+        v.fPatAsym.Add(a);
+        fAsym[i] = static_cast<Float_t>(a);
+      }
+      v.fMacroSum[0] += v.fPatSum[0];
+      v.fMacroSum[1] += v.fPatSum[1];
+    }
+    v.fPatSum[0] = v.fPatSum[1] = 0;
+  }
+  ++fNpat;
+  if( good ) {
+    ++fNgoodPat;
+    fPatDone = 1;
+    if( fTree )
+      fTree->Fill();
+    if( fMacroLen > 0 ) {
+      fMacroN[0] += fPatN[0];
+      fMacroN[1] += fPatN[1];
+      if( ++fMacroNpat == fMacroLen )
+        EndMacro();
+    }
+  }
+  fPatN[0] = fPatN[1] = 0;
+  fPatGood = true;
+}
+
+//_____________________________________________________________________________
+Int_t HelicityAccumulator::Process( const THaEvData& )
+{
+  // Accumulate the variables of this event under its helicity
+
+  if( !IsOK() )
+    return -1;
+
+  if( fSync ) {
+    Bool_t sync = (fSync->GetValue() != 0);
+    if( sync && !fLastSync )
+      EndPattern();
+    fLastSync = sync;
+  }
+
+  THaHelicityDet::EHelicity hel = fHelDet->GetHelicity();
+  if( !fHelDet->HelicityValid() || hel == THaHelicityDet::kUnknown ) {
+    fPatGood = false;
+    return 0;
+  }
+  Int_t ih = (hel == THaHelicityDet::kPlus) ? 1 : 0;
+  ++fPatN[ih];
+  for( auto& v : fVars ) {
+    Double_t x = v.fVar->GetValue();
+    v.fHel[ih].Add(x);
+    v.fPatSum[ih] += x;
+  }
+  fDataValid = true;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HelicityAccumulator::End( THaRunBase* )
+{
+  // End of run: write the pattern records and print the results.
+  // An incomplete last pattern is discarded.
+
+  if( fTree )
+    fTree->Write();
+  if( IsOK() )
+    Print();
+  return 0;
+}
+
+//_____________________________________________________________________________
+const RunningStat& HelicityAccumulator::GetYield( UInt_t i, Int_t hel ) const
+{
+  return fVars.at(i).fHel[hel > 0 ? 1 : 0];
+}
+
+//_____________________________________________________________________________
+const RunningStat& HelicityAccumulator::GetPatternAsymmetry( UInt_t i ) const
+{
+  return fVars.at(i).fPatAsym;
+}
+
+//_____________________________________________________________________________
+const RunningStat& HelicityAccumulator::GetMacroAsymmetry( UInt_t i ) const
+{
+  return fVars.at(i).fMacroAsym;
+}
+
+//_____________________________________________________________________________
+void HelicityAccumulator::Print( Option_t* opt ) const
+{
+  // Print accumulated yields and asymmetries
+
+  THaPhysicsModule::Print(opt);
+  cout << "Helicity detector: " << fHelName;
+  if( fSync )
+    cout << ", pattern sync: " << fSyncName;
+  cout << endl;
+  cout << "Patterns: " << fNpat << " (" << fNgoodPat << " good)";
+  if( fMacroLen > 0 )
+    cout << ", macro-pulse window: " << fMacroLen << " patterns";
+  cout << endl;
+
+  for( const auto& v : fVars ) {
+    cout << v.fName << endl;
+    for( Int_t ih = 1; ih >= 0; --ih ) {
+      const RunningStat& s = v.fHel[ih];
+      cout << "  " << (ih ? "+" : "-") << ": n = " << s.GetN()
+           << "  mean = " << s.GetMean() << " +- " << s.GetError()
+           << "  rms = " << s.GetRMS() << endl;
+    }
+    if( v.fPatAsym.GetN() > 0 )
+      cout << "  Pattern asymmetry = " << v.fPatAsym.GetMean()
+           << " +- " << v.fPatAsym.GetError()
+           << "  (rms " << v.fPatAsym.GetRMS() << ")" << endl;
+    if( v.fMacroAsym.GetN() > 0 )
+      cout << "  Macro-pulse asymmetry = " << v.fMacroAsym.GetMean()
+           << " +- " << v.fMacroAsym.GetError()
+           << "  (" << v.fMacroAsym.GetN() << " windows)" << endl;
+  }
+}
+
+//_____________________________________________________________________________
+void HelicityAccumulator::SaveState( vector<Double_t>& state ) const
+{
+  // Save the accumulated sums, for checkpointing
+
+  state = {
+    Double_t(fLastSync), Double_t(fPatGood),
+    Double_t(fPatN[0]), Double_t(fPatN[1]),
+    Double_t(fMacroN[0]), Double_t(fMacroN[1]), Double_t(fMacroNpat),
+    Double_t(fNpat), Double_t(fNgoodPat), Double_t(fVars.size())
+  };
+  for( const auto& v : fVars ) {
+    v.fHel[0].Save(state);
+    v.fHel[1].Save(state);
+    v.fPatAsym.Save(state);
+    v.fMacroAsym.Save(state);
+    state.insert(state.end(), v.fPatSum, v.fPatSum + 2);
+    state.insert(state.end(), v.fMacroSum, v.fMacroSum + 2);
+  }
+}
+
+//_____________________________________________________________________________
+Int_t HelicityAccumulator::RestoreState( const vector<Double_t>& state )
+{
+  // Restore state saved with SaveState()
+
+  const size_t nhead = 10, nvar = 16;
+  if( state.size() < nhead || state[nhead-1] != fVars.size() ||
+      state.size() != nhead + nvar*fVars.size() ) {
+    Error( Here("RestoreState"), "Invalid state size %lu",
+           static_cast<unsigned long>(state.size()) );
+    return -1;
+  }
+  auto it = state.cbegin();
+  fLastSync  = (*it++ != 0);
+  fPatGood   = (*it++ != 0);
+  fPatN[0]   = static_cast<UInt_t>(*it++);
+  fPatN[1]   = static_cast<UInt_t>(*it++);
+  fMacroN[0] = static_cast<UInt_t>(*it++);
+  fMacroN[1] = static_cast<UInt_t>(*it++);
+  fMacroNpat = static_cast<UInt_t>(*it++);
+  fNpat      = static_cast<ULong64_t>(*it++);
+  fNgoodPat  = static_cast<ULong64_t>(*it++);
+  ++it;
+  for( auto& v : fVars ) {
+    v.fHel[0].Restore(it);
+    v.fHel[1].Restore(it);
+    v.fPatAsym.Restore(it);
+    v.fMacroAsym.Restore(it);
+    v.fPatSum[0]   = *it++;
+    v.fPatSum[1]   = *it++;
+    v.fMacroSum[0] = *it++;
+    v.fMacroSum[1] = *it++;
+  }
+  return 0;
+}
+
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClassImp(Podd::HelicityAccumulator)
@@ -0,0 +1,136 @@
+#ifndef Podd_HelicityAccumulator_h_
+#define Podd_HelicityAccumulator_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HelicityAccumulator
+//
+// Helicity-resolved running statistics and asymmetries of global
+// variables, accumulated during the replay
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaPhysicsModule.h"
+#include "TString.h"
+#include <vector>
+
+class THaHelicityDet;
+class THaVar;
+class TTree;
+
+namespace Podd {
+
+// Numerically stable running mean and variance (Welford's algorithm)
+class RunningStat {
+public:
+  RunningStat() : fN(0), fMean(0), fM2(0) {}
+
+  void      Clear() { fN = 0; fMean = fM2 = 0; }
+  void      Add( Double_t x ) {
+    ++fN;
+    Double_t d = x - fMean;
+    fMean += d / static_cast<Double_t>(fN);
+    fM2 += d * (x - fMean);
+  }
+  ULong64_t GetN()        const { return fN; }
+  Double_t  GetMean()     const { return fMean; }
+  Double_t  GetVariance() const;
+  Double_t  GetRMS()      const;
+  // Error of the mean
+  Double_t  GetError()    const;
+
+  void      Save( std::vector<Double_t>& state ) const;
+  void      Restore( std::vector<Double_t>::const_iterator& it );
+
+private:
+  ULong64_t fN;     // Number of entries
+  Double_t  fMean;  // Running mean
+  Double_t  fM2;    // Sum of squared deviations from the mean
+};
+
+class HelicityAccumulator : public THaPhysicsModule {
+public:
+  HelicityAccumulator( const char* name, const char* description,
+                       const char* helicity_det, const char* var_list = "" );
+  HelicityAccumulator( const HelicityAccumulator& ) = delete;
+  HelicityAccumulator& operator=( const HelicityAccumulator& ) = delete;
+  virtual ~HelicityAccumulator();
+
+  virtual Int_t   Begin( THaRunBase* r=nullptr );
+  virtual void    Clear( Option_t* opt="" );
+  virtual Int_t   End( THaRunBase* r=nullptr );
+  virtual EStatus Init( const TDatime& run_time );
+  virtual void    Print( Option_t* opt="" ) const;
+  virtual Int_t   Process( const THaEvData& );
+  virtual Bool_t  GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
+  virtual void    SaveState( std::vector<Double_t>& state ) const;
+  virtual Int_t   RestoreState( const std::vector<Double_t>& state );
+
+  // Configuration, may be used instead of database values
+  void     SetVariables( const char* var_list ) { fVarList = var_list; }
+  void     SetSyncVariable( const char* name )  { fSyncName = name; }
+  void     SetMacroPatterns( UInt_t n )         { fMacroLen = n; }
+  void     EnablePatternTree( Bool_t b = true ) { fDoTree = b; }
+
+  // Results. 'hel' is +1 or -1, 'i' the index of the variable.
+  UInt_t   GetNvars() const { return static_cast<UInt_t>(fVars.size()); }
+  const RunningStat& GetYield( UInt_t i, Int_t hel ) const;
+  const RunningStat& GetPatternAsymmetry( UInt_t i ) const;
+  const RunningStat& GetMacroAsymmetry( UInt_t i ) const;
+  ULong64_t GetNpatterns() const { return fNpat; }
+
+protected:
+  // Accumulator for one global variable
+  class VarAcc {
+  public:
+    explicit VarAcc( const char* name )
+      : fName(name), fVar(nullptr), fPatSum{0,0}, fMacroSum{0,0} {}
+    TString     fName;        // Name of the global variable
+    THaVar*     fVar;         // The global variable
+    RunningStat fHel[2];      // Per-event values, by helicity (-, +)
+    Double_t    fPatSum[2];   // Sums in the current pattern
+    Double_t    fMacroSum[2]; // Sums in the current macro-pulse window
+    RunningStat fPatAsym;     // Pattern asymmetries
+    RunningStat fMacroAsym;   // Macro-pulse window asymmetries
+  };
+
+  // Configuration
+  TString          fHelName;   // Name of helicity detector
+  TString          fVarList;   // Names of global variables to accumulate
+  TString          fDBVarList; // Additional variables from database
+  TString          fSyncName;  // Variable that is non-zero at pattern start
+  UInt_t           fMacroLen;  // Patterns per macro-pulse window (0 = none)
+  Bool_t           fDoTree;    // Write per-pattern records
+
+  THaHelicityDet*  fHelDet;    // Helicity detector
+  THaVar*          fSync;      // Pattern synchronization variable
+  std::vector<VarAcc> fVars;   // Accumulators
+
+  // Event-to-event state
+  Bool_t           fLastSync;  // Sync value of the previous event
+  Bool_t           fPatGood;   // No events with unknown helicity in pattern
+  UInt_t           fPatN[2];   // Events per helicity in current pattern
+  UInt_t           fMacroN[2]; // Events per helicity in current window
+  UInt_t           fMacroNpat; // Patterns in current window
+  ULong64_t        fNpat;      // Completed patterns
+  ULong64_t        fNgoodPat;  // Completed patterns with both helicities
+
+  // Per-pattern record (also global variables)
+  std::vector<Float_t> fAsym;  // Asymmetries of the last completed pattern
+  Int_t            fPatDone;   // A pattern was completed at this event
+  TTree*           fTree;      //! Per-pattern records
+
+  void             EndPattern();
+  void             EndMacro();
+  void             ResetSums();
+  void             MakeTree();
+
+  virtual Int_t    DefineVariables( EMode mode = kDefine );
+  virtual Int_t    ReadDatabase( const TDatime& date );
+
+  ClassDef(HelicityAccumulator,0)  // Helicity-resolved accumulator
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef Podd_HistBuffer_h_
+#define Podd_HistBuffer_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HistBuffer
+//
+// Dense, unit-weight bin array for fast histogram filling. Contents are
+// merged into a ROOT histogram with Flush().
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+
+class TH1;
+
+namespace Podd {
+
+class HistBuffer {
+public:
+  // Create a buffer with the same binning as 'h'
+  explicit HistBuffer( const TH1* h );
+
+  void      Fill( Double_t x );
+  void      Fill( Double_t x, Double_t y );
+  Int_t     Add( const HistBuffer& rhs );
+  Int_t     Flush( TH1* h );
+  void      Clear();
+
+  Int_t     GetDimension() const { return fNy > 0 ? 2 : 1; }
+  UInt_t    GetNfill()     const { return fNfill; }
+  // Must flush before the bin counters can overflow
+  Bool_t    NeedFlush()    const { return fNfill >= kMaxFill; }
+
+  // Whether a buffer for 'h' is supported and small enough
+  static Bool_t IsSupported( const TH1* h );
+
+  static const size_t kMaxBins = 1U<<20;       // Max buffer size (bins)
+  static const UInt_t kMaxFill = 2000000000U;  // Max fills between flushes
+
+private:
+  Int_t     fNx;       // Number of x bins
+  Int_t     fNy;       // Number of y bins (0 for 1D)
+  Double_t  fXlo;      // Lower edge of x axis
+  Double_t  fXhi;      // Upper edge of x axis
+  Double_t  fYlo;      // Lower edge of y axis
+  Double_t  fYhi;      // Upper edge of y axis
+  UInt_t    fNfill;    // Number of fills since last flush
+  std::vector<UInt_t> fCounts;  // Bin counts incl. under/overflow, TH1 layout
+  // Statistics of in-range fills, as in TH1::GetStats:
+  // sumw, sumw2, sumwx, sumwx2[, sumwy, sumwy2, sumwxy]
+  Double_t  fStats[7];
+
+  static Int_t FindBin( Double_t x, Int_t n, Double_t lo, Double_t hi );
+};
+
+//_____________________________________________________________________________
+inline Int_t HistBuffer::FindBin( Double_t x, Int_t n, Double_t lo, Double_t hi )
+{
+  // Same as TAxis::FindFixBin for a fixed-width axis
+  if( x < lo )
+    return 0;
+  if( !(x < hi) )
+    return n+1;
+  return 1 + Int_t(n*(x-lo)/(hi-lo));
+}
+
+//_____________________________________________________________________________
+inline void HistBuffer::Fill( Double_t x )
+{
+  Int_t bin = FindBin(x, fNx, fXlo, fXhi);
+  ++fCounts[bin];
+  ++fNfill;
+  if( bin > 0 && bin <= fNx ) {
+    fStats[0] += 1.;
+    fStats[1] += 1.;
+    fStats[2] += x;
+    fStats[3] += x*x;
+  }
+}
+
+//_____________________________________________________________________________
+inline void HistBuffer::Fill( Double_t x, Double_t y )
+{
+  Int_t binx = FindBin(x, fNx, fXlo, fXhi);
+  Int_t biny = FindBin(y, fNy, fYlo, fYhi);
+  ++fCounts[binx + (fNx+2)*biny];
+  ++fNfill;
+  if( binx > 0 && binx <= fNx && biny > 0 && biny <= fNy ) {
+    fStats[0] += 1.;
+    fStats[1] += 1.;
+    fStats[2] += x;
+    fStats[3] += x*x;
+    fStats[4] += y;
+    fStats[5] += y*y;
+    fStats[6] += x*y;
+  }
+}
+
+} // namespace Podd
+
+#endif
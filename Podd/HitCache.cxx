@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HitCacheEvent
+//
+// Per-event record of a decoded-hit cache file. The file contains a tree
+// with one entry per event, written column-wise so that each quantity
+// compresses well on its own, and a small tree with the run information
+// needed to initialize a replay.
+//
+// The same object serves as the event buffer handed from HitCacheRun
+// to HitCacheDecoder.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "HitCache.h"
+#include "TTree.h"
+#include "TError.h"
+
+using namespace std;
+
+namespace Podd {
+
+const char* const kHitCacheTree     = "HitCache";
+const char* const kHitCacheInfoTree = "HitCacheInfo";
+
+//_____________________________________________________________________________
+HitCacheEvent::HitCacheEvent() : hdr{}
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+void HitCacheEvent::Clear()
+{
+  // Clear event data. Keeps allocated memory.
+
+  hdr = Header_t{};
+  slot.clear();
+  nhit.clear();
+  chan.clear();
+  data.clear();
+  raw.clear();
+  rawbuf.clear();
+  rocdat.clear();
+  psfact.clear();
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheEvent::SetupTree( TTree* tree, Bool_t write )
+{
+  // Create the branches of 'tree' (if 'write' is true) or set the
+  // addresses of its existing branches to the members of this object.
+  // Returns 0 on success, <0 on error.
+
+  static const char* const here = "HitCacheEvent::SetupTree";
+
+  if( !tree )
+    return -1;
+
+  const char* const hdrdef = "evtype/i:evnum/i:evlen/i:trigbits/i:evtime/l";
+  struct BranchDef_t {
+    const char* name;
+    void* obj;
+  };
+  vector<BranchDef_t> vecs = {
+    { "slot",   &slot   },
+    { "nhit",   &nhit   },
+    { "chan",   &chan   },
+    { "data",   &data   },
+    { "raw",    &raw    },
+    { "rawbuf", &rawbuf },
+    { "rocdat", &rocdat },
+    { "psfact", &psfact }
+  };
+
+  if( write ) {
+    tree->Branch("hdr", &hdr, hdrdef);
+    tree->Branch("slot",   &slot);
+    tree->Branch("nhit",   &nhit);
+    tree->Branch("chan",   &chan);
+    tree->Branch("data",   &data);
+    tree->Branch("raw",    &raw);
+    tree->Branch("rawbuf", &rawbuf);
+    tree->Branch("rocdat", &rocdat);
+    tree->Branch("psfact", &psfact);
+    return 0;
+  }
+
+  if( tree->SetBranchAddress("hdr", static_cast<void*>(&hdr)) < 0 ) {
+    Error(here, "Missing event header branch. Not a hit cache tree?");
+    return -2;
+  }
+  // Object branches need the address of a pointer that stays valid
+  fAddr.resize(vecs.size());
+  for( size_t i = 0; i < vecs.size(); ++i ) {
+    fAddr[i] = vecs[i].obj;
+    if( tree->SetBranchAddress(vecs[i].name,
+                              static_cast<void*>(&fAddr[i])) < 0 ) {
+      Error(here, "Missing branch \"%s\". Not a hit cache tree?",
+            vecs[i].name);
+      return -2;
+    }
+  }
+  return 0;
+}
+
+} // namespace Podd
@@ -0,0 +1,64 @@
+#ifndef Podd_HitCache_h_
+#define Podd_HitCache_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HitCacheEvent
+//
+// One event of a decoded-hit cache file. See HitCacheWriter.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <vector>
+
+class TTree;
+
+namespace Podd {
+
+// Names of the trees in a hit cache file
+extern const char* const kHitCacheTree;      // Per-event data
+extern const char* const kHitCacheInfoTree;  // Run information (one entry)
+
+class HitCacheEvent {
+public:
+  HitCacheEvent();
+  HitCacheEvent( const HitCacheEvent& ) = delete;
+  HitCacheEvent& operator=( const HitCacheEvent& ) = delete;
+
+  void  Clear();
+  // Connect this object to the branches of 'tree', creating the branches
+  // if 'write' is true
+  Int_t SetupTree( TTree* tree, Bool_t write );
+
+  // Event header. The layout must match the leaf list in SetupTree.
+  struct Header_t {
+    UInt_t    evtype;
+    UInt_t    evnum;
+    UInt_t    evlen;
+    UInt_t    trigbits;
+    ULong64_t evtime;
+  } hdr;
+
+  // Decoded hits. Hits are grouped by slot, and by channel within a slot.
+  std::vector<UShort_t> slot;   // Index (crate*MAXSLOT+slot) of slots with hits
+  std::vector<UInt_t>   nhit;   // Number of hits in each slot
+  std::vector<UShort_t> chan;   // Channel of each hit
+  std::vector<UInt_t>   data;   // Data word of each hit
+  std::vector<UInt_t>   raw;    // Raw word of each hit
+
+  // Complete raw event, saved for non-physics events, and for physics
+  // events if HitCacheWriter::SetRawPhysics() is set
+  std::vector<UInt_t>   rawbuf;
+  // Crate, position and length of each ROC bank in rawbuf (physics events)
+  std::vector<UInt_t>   rocdat;
+  // Prescale factors, saved for prescale events only
+  std::vector<UInt_t>   psfact;
+
+private:
+  std::vector<void*>    fAddr;  // Branch addresses when reading
+};
+
+} // namespace Podd
+
+#endif
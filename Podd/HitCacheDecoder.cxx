@@ -0,0 +1,139 @@
+/////////////////////////////////////////////////////////////////////
+//
+//   Podd::HitCacheDecoder
+//
+//   Decoder for events read by HitCacheRun from a decoded-hit cache
+//   file (see HitCacheWriter). Instead of unpacking raw data, the
+//   cached hits are loaded directly into the slot data. Detector
+//   modules see the same per-channel hits as with CodaDecoder.
+//
+//   Non-physics events are passed through as raw buffers, so event
+//   type handlers (EPICS, scalers) work as usual. For physics events,
+//   the raw event buffer is not available unless the cache was written
+//   with HitCacheWriter::SetRawPhysics(). Without it, the raw-data
+//   accessors return zero and all ROC lengths are zero; the analyzer
+//   refuses modules that need raw words (see HitCacheRun).
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "HitCacheDecoder.h"
+#include "HitCache.h"
+#include "THaCrateMap.h"
+#include "THaBenchmark.h"
+#include <cassert>
+
+using namespace std;
+using namespace Decoder;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+HitCacheDecoder::HitCacheDecoder() = default;
+
+//_____________________________________________________________________________
+HitCacheDecoder::~HitCacheDecoder() = default;
+
+//_____________________________________________________________________________
+Int_t HitCacheDecoder::Init()
+{
+  Int_t ret = THaEvData::Init();
+  if( ret != HED_OK ) return ret;
+  FindUsedSlots();
+  return ret;
+}
+
+//_____________________________________________________________________________
+UInt_t HitCacheDecoder::GetPrescaleFactor( UInt_t trigger ) const
+{
+  // Prescale factor for trigger number 'trigger' (1,2,3...), as recorded
+  // in the most recent prescale event
+
+  if( trigger > 0 && trigger <= fPsfact.size() )
+    return fPsfact[trigger-1];
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheDecoder::LoadEvent( const UInt_t* evbuffer )
+{
+  // Load the event record 'evbuffer', which must point to the
+  // HitCacheEvent provided by HitCacheRun::GetEvBuffer()
+
+  assert(evbuffer);
+  const auto* ev = reinterpret_cast<const HitCacheEvent*>(evbuffer);
+
+  buffer       = ev->rawbuf.empty() ? nullptr : ev->rawbuf.data();
+  event_type   = ev->hdr.evtype;
+  event_num    = ev->hdr.evnum;
+  event_length = ev->hdr.evlen;
+  trigger_bits = ev->hdr.trigbits;
+  evt_time     = ev->hdr.evtime;
+
+  // ROC positions are only known for cached raw physics buffers
+  for( auto& ROC : rocdat )
+    ROC.clear();
+  if( buffer ) {
+    for( size_t i = 0; i + 2 < ev->rocdat.size(); i += 3 ) {
+      UInt_t iroc = ev->rocdat[i], pos = ev->rocdat[i+1];
+      UInt_t len = ev->rocdat[i+2];
+      if( iroc < MAXROC && pos + len < ev->rawbuf.size() ) {
+        rocdat[iroc].pos = pos;
+        rocdat[iroc].len = len;
+      }
+    }
+  }
+
+  if( event_type == PRESTART_EVTYPE ) {
+    // Same as in CodaDecoder
+    if( ev->rawbuf.size() > 4 ) {
+      SetRunTime(ev->rawbuf[2]);
+      run_num  = ev->rawbuf[3];
+      run_type = ev->rawbuf[4];
+    }
+    return HED_OK;
+  }
+  if( IsPrescaleEvent() ) {
+    fPsfact = ev->psfact;
+    return HED_OK;
+  }
+  if( !IsPhysicsTrigger() || PrescanModeEnabled() )
+    return HED_OK;
+
+  assert(fMap || fNeedInit);
+  if( first_decode || fNeedInit ) {
+    Int_t ret = Init();
+    if( ret != HED_OK )
+      return ret;
+  }
+  // The cached hits are the complete slot contents, so clear all slots,
+  // including those that are normally not cleared every event
+  if( fDoBench ) fBench->Begin("clearEvent");
+  for( auto i : fSlotUsed )
+    crateslot[i]->clearEvent();
+  if( fDoBench ) fBench->Stop("clearEvent");
+
+  if( fDoBench ) fBench->Begin("loadHits");
+  size_t ihit = 0;
+  for( size_t i = 0; i < ev->slot.size(); ++i ) {
+    UInt_t crate = ev->slot[i] / MAXSLOT, slot = ev->slot[i] % MAXSLOT;
+    UInt_t nhit = ev->nhit[i];
+    if( ihit + nhit > ev->chan.size() )
+      return HED_ERR;  // corrupt record
+    if( !fMap->slotUsed(crate, slot) ) {
+      // Slot not in current crate map
+      ihit += nhit;
+      continue;
+    }
+    THaSlotData* sd = crateslot[idx(crate, slot)].get();
+    for( UInt_t k = 0; k < nhit; ++k, ++ihit )
+      sd->loadData(ev->chan[ihit], ev->data[ihit], ev->raw[ihit]);
+  }
+  if( fDoBench ) fBench->Stop("loadHits");
+
+  return HED_OK;
+}
+
+} // namespace Podd
+
+//_____________________________________________________________________________
+ClassImp(Podd::HitCacheDecoder)
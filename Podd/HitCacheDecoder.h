@@ -0,0 +1,35 @@
+#ifndef Podd_HitCacheDecoder_h_
+#define Podd_HitCacheDecoder_h_
+
+/////////////////////////////////////////////////////////////////////
+//
+//   Podd::HitCacheDecoder
+//
+//   Decoder for events replayed from a decoded-hit cache file
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "THaEvData.h"
+#include <vector>
+
+namespace Podd {
+
+class HitCacheDecoder : public THaEvData {
+public:
+  HitCacheDecoder();
+  virtual ~HitCacheDecoder();
+
+  virtual Int_t  Init();
+  virtual Int_t  LoadEvent( const UInt_t* evbuffer );
+  virtual UInt_t GetPrescaleFactor( UInt_t trigger ) const;
+  virtual Bool_t ReadsRawData() const { return false; }
+
+protected:
+  std::vector<UInt_t> fPsfact;  // Prescale factors from last prescale event
+
+  ClassDef(HitCacheDecoder,0)  // Decoder for decoded-hit cache files
+};
+
+} // namespace Podd
+
+#endif
@@ -0,0 +1,268 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HitCacheRun
+//
+// A run whose events are read from a decoded-hit cache file written by
+// HitCacheWriter. It must be analyzed with Podd::HitCacheDecoder, which
+// THaAnalyzer selects automatically for this type of run:
+//
+//   auto* run = new Podd::HitCacheRun("hits_1234.root");
+//   analyzer->Process(run);
+//
+// Run number, type, date, data version and prescale factors are taken
+// from the run information saved in the cache file.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "HitCacheRun.h"
+#include "HitCacheDecoder.h"
+#include "THaRunParameters.h"
+#include "THaPrintOption.h"
+#include "Helper.h"
+#include "TArrayI.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TError.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+HitCacheRun::HitCacheRun( const char* filename, const char* description )
+  : THaRunBase(description)
+  , fFilename(filename)
+  , fFile(nullptr)
+  , fTree(nullptr)
+  , fEntry(0)
+  , fNentries(0)
+  , fRawPhysics(false)
+  , fEvent(new HitCacheEvent)
+{
+  // Normal & default constructor
+}
+
+//_____________________________________________________________________________
+HitCacheRun::HitCacheRun( const HitCacheRun& rhs )
+  : THaRunBase(rhs)
+  , fFilename(rhs.fFilename)
+  , fFile(nullptr)
+  , fTree(nullptr)
+  , fEntry(0)
+  , fNentries(0)
+  , fRawPhysics(rhs.fRawPhysics)
+  , fEvent(new HitCacheEvent)
+{
+  // Copy ctor. The copy is not opened.
+}
+
+//_____________________________________________________________________________
+HitCacheRun& HitCacheRun::operator=( const THaRunBase& rhs )
+{
+  // Assignment operator. See THaRun::operator=
+
+  if( this != &rhs ) {
+    Close();
+    THaRunBase::operator=(rhs);
+    const auto* run = dynamic_cast<const HitCacheRun*>(&rhs);
+    if( run ) {
+      fFilename = run->fFilename;
+      fRawPhysics = run->fRawPhysics;
+    } else {
+      fFilename.Clear();
+      fRawPhysics = false;
+    }
+  }
+  return *this;
+}
+
+//_____________________________________________________________________________
+HitCacheRun::~HitCacheRun()
+{
+  // Destructor
+
+  HitCacheRun::Close();
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheRun::Close()
+{
+  // Close the cache file
+
+  fTree = nullptr;  // owned by fFile
+  if( fFile ) {
+    fFile->Close();
+    delete fFile;
+    fFile = nullptr;
+  }
+  fEntry = fNentries = 0;
+  fOpened = false;
+  return READ_OK;
+}
+
+//_____________________________________________________________________________
+const UInt_t* HitCacheRun::GetEvBuffer() const
+{
+  // Return the current event record. This is not a raw event buffer;
+  // it is meant to be interpreted by HitCacheDecoder.
+
+  return reinterpret_cast<const UInt_t*>(fEvent.get());
+}
+
+//_____________________________________________________________________________
+TClass* HitCacheRun::GetRequiredDecoder() const
+{
+  // The event records of this run can only be read by HitCacheDecoder
+
+  return HitCacheDecoder::Class();
+}
+
+//_____________________________________________________________________________
+Bool_t HitCacheRun::IsOpen() const
+{
+  return fFile && fFile->IsOpen() && fTree;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheRun::Open()
+{
+  // Open the cache file for reading
+
+  static const char* const here = "HitCacheRun::Open";
+
+  if( fFilename.IsNull() ) {
+    Error( here, "Cache file name not set. Cannot open the run." );
+    return READ_FATAL;
+  }
+  Close();
+
+  TDirectory* olddir = gDirectory;
+  fFile = TFile::Open(fFilename, "READ");
+  if( olddir ) olddir->cd();
+  if( !fFile || fFile->IsZombie() ) {
+    Error( here, "Cannot open hit cache file %s", fFilename.Data() );
+    delete fFile; fFile = nullptr;
+    return READ_FATAL;
+  }
+  fTree = dynamic_cast<TTree*>(fFile->Get(kHitCacheTree));
+  if( !fTree || fEvent->SetupTree(fTree, false) != 0 ) {
+    Error( here, "File %s is not a hit cache file", fFilename.Data() );
+    Close();
+    return READ_FATAL;
+  }
+  fNentries = fTree->GetEntries();
+  fEntry = 0;
+  fOpened = true;
+  return READ_OK;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheRun::ReadEvent()
+{
+  // Read the next event from the cache file
+
+  if( !IsOpen() )
+    return READ_FATAL;
+  if( fEntry >= fNentries )
+    return READ_EOF;
+  if( fTree->GetEntry(fEntry++) <= 0 )
+    return READ_ERROR;
+  return READ_OK;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheRun::ReadInitInfo( Int_t /* level */ )
+{
+  // Read the run information saved in the cache file
+
+  static const char* const here = "HitCacheRun::ReadInitInfo";
+
+  if( !fFile )
+    return READ_FATAL;
+  auto* info = dynamic_cast<TTree*>(fFile->Get(kHitCacheInfoTree));
+  if( !info || info->GetEntries() < 1 ) {
+    Error( here, "No run information in hit cache file %s. File "
+                 "incomplete?", fFilename.Data() );
+    return READ_ERROR;
+  }
+  UInt_t runnum = 0, runtype = 0;
+  ULong64_t runtime = 0;
+  Int_t version = 0;
+  Bool_t rawphys = false;
+  vector<Int_t>* prescales = nullptr;
+  info->SetBranchAddress("run",       &runnum);
+  info->SetBranchAddress("type",      &runtype);
+  info->SetBranchAddress("time",      &runtime);
+  info->SetBranchAddress("version",   &version);
+  info->SetBranchAddress("prescales", &prescales);
+  if( info->GetBranch("rawphys") )
+    info->SetBranchAddress("rawphys", &rawphys);
+  Int_t st = info->GetEntry(0);
+  info->ResetBranchAddresses();
+  if( st <= 0 ) {
+    delete prescales;
+    return READ_ERROR;
+  }
+
+  SetNumber(runnum);
+  SetType(runtype);
+  fDataSet |= kRunNumber|kRunType;
+  fDataRead |= kRunNumber|kRunType;
+  if( !fAssumeDate && runtime != 0 ) {
+    fDate.Set(static_cast<UInt_t>(runtime));
+    fDataSet |= kDate;
+    fDataRead |= kDate;
+  }
+  fDataVersion = version;
+  fRawPhysics = rawphys;
+  if( prescales && !prescales->empty() && fParam ) {
+    TArrayI& ps = fParam->Prescales();
+    for( Int_t i = 0; i < ps.GetSize() && i < SSIZE(*prescales); ++i )
+      ps[i] = (*prescales)[i];
+    fDataSet |= kPrescales;
+    fDataRead |= kPrescales;
+  }
+  delete prescales;
+  return READ_OK;
+}
+
+//_____________________________________________________________________________
+void HitCacheRun::Print( Option_t* opt ) const
+{
+  THaPrintOption sopt(opt);
+  sopt.ToUpper();
+  if( sopt.Contains("NAMEDESC") ) {
+    cout << "\"hitcache://" << GetFilename() << "\"";
+    if( strcmp( GetTitle(), "") != 0 )
+      cout << "  \"" << GetTitle() << "\"";
+    return;
+  }
+  THaRunBase::Print( opt );
+  cout << "Hit cache file: " << fFilename << endl;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheRun::SetFilename( const char* name )
+{
+  // Set the cache file name. Closes the file if it was open.
+  // Return -1 if illegal name, 1 if name not changed, 0 otherwise.
+
+  if( !name ) {
+    Error( "HitCacheRun::SetFilename", "Illegal file name." );
+    return -1;
+  }
+  if( fFilename == name )
+    return 1;
+  Close();
+  fFilename = name;
+  fIsInit = false;
+  return 0;
+}
+
+} // namespace Podd
+
+//_____________________________________________________________________________
+ClassImp(Podd::HitCacheRun)
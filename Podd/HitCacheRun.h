@@ -0,0 +1,58 @@
+#ifndef Podd_HitCacheRun_h_
+#define Podd_HitCacheRun_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HitCacheRun
+//
+// A run replayed from a decoded-hit cache file
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaRunBase.h"
+#include "HitCache.h"
+#include "TString.h"
+#include <memory>
+
+class TFile;
+class TTree;
+
+namespace Podd {
+
+class HitCacheRun : public THaRunBase {
+
+public:
+  explicit HitCacheRun( const char* filename="", const char* description="" );
+  HitCacheRun( const HitCacheRun& run );
+  virtual HitCacheRun& operator=( const THaRunBase& rhs );
+  virtual ~HitCacheRun();
+
+  virtual Int_t         Close();
+  virtual const UInt_t* GetEvBuffer() const;
+  virtual Bool_t        IsOpen() const;
+  virtual Int_t         Open();
+  virtual void          Print( Option_t* opt="" ) const;
+  virtual Int_t         ReadEvent();
+          const char*   GetFilename() const { return fFilename.Data(); }
+          Long64_t      GetNentries() const { return fNentries; }
+  virtual Bool_t        HasRawPhysicsData() const { return fRawPhysics; }
+  virtual TClass*       GetRequiredDecoder() const;
+  virtual Int_t         SetFilename( const char* name );
+
+protected:
+  TString   fFilename;   // Cache file name
+  TFile*    fFile;       //! Cache file
+  TTree*    fTree;       //! Event tree in cache file
+  Long64_t  fEntry;      //! Next entry to read
+  Long64_t  fNentries;   //! Number of entries in tree
+  Bool_t    fRawPhysics; //! Cache has raw buffers of physics events
+  std::unique_ptr<HitCacheEvent> fEvent;  //! Current event record
+
+  virtual Int_t ReadInitInfo( Int_t level );
+
+  ClassDef(HitCacheRun,1)  // A run replayed from a decoded-hit cache file
+};
+
+} // namespace Podd
+
+#endif
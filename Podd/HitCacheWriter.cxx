@@ -0,0 +1,339 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HitCacheWriter
+//
+// Post-processing module that saves the decoded hits (the THaSlotData
+// content: crate, slot, channel, data and raw word of every hit) of each
+// event to a compact, column-wise ROOT file. The file can be replayed
+// with HitCacheRun and HitCacheDecoder, which skip raw data reading and
+// CODA decoding entirely. This is useful for calibration passes where
+// only the detector databases change between passes.
+//
+// Usage:
+//
+//   auto* cache = new Podd::HitCacheWriter("hits_1234.root", "1,2,5");
+//   cache->SetCompression("zstd", 5);
+//   analyzer->AddPostProcess(cache);
+//
+// The optional second argument limits the cache to the given crates.
+// By default, all crates in the crate map are saved.
+//
+// Non-physics events (EPICS, scalers, prestart etc.) are saved as raw
+// buffers so that event type handlers still work on replay. DAQ
+// configuration events are not saved. Processed data held internally by
+// multi-function modules (e.g. FADC pulse integrals) are not part of
+// THaSlotData and are therefore not cached.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "HitCacheWriter.h"
+#include "THaEvData.h"
+#include "THaRunBase.h"
+#include "THaRunParameters.h"
+#include "THaSlotData.h"
+#include "Textvars.h"     // for Podd::Tokenize
+#include "TArrayI.h"
+#include "TFile.h"
+#include "TTree.h"
+#include "TError.h"
+#include "TString.h"
+#include <cstdlib>
+#include <string>
+// only for ERetVal, used by Process()
+#include "THaAnalyzer.h"
+
+using namespace std;
+using namespace Decoder;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+HitCacheWriter::HitCacheWriter( const char* filename, const char* crates )
+  : fFileName(filename)
+  , fCompress(kZLIB*100+1)
+  , fRawPhysics(false)
+  , fWarnModule(false)
+  , fFile(nullptr)
+  , fTree(nullptr)
+  , fEvent(new HitCacheEvent)
+  , fRunNumber(0)
+  , fRunType(0)
+  , fRunTime(0)
+  , fDataVersion(0)
+{
+  // Constructor
+
+  SetCrates(crates);
+}
+
+//_____________________________________________________________________________
+HitCacheWriter::~HitCacheWriter()
+{
+  // Destructor. Closes the output file if open.
+
+  HitCacheWriter::Close();
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::SetCompression( ECompression algo, Int_t level )
+{
+  // Set compression algorithm and level (0-9) of the output file.
+  // Must be called before Init().
+
+  if( level < 0 || level > 9 ) {
+    Error("HitCacheWriter::SetCompression", "Illegal compression level %d. "
+          "Must be 0-9.", level);
+    return -1;
+  }
+  fCompress = (algo == kNone || level == 0) ? 0 : 100*algo + level;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::SetCompression( const char* algo, Int_t level )
+{
+  // Set compression algorithm by name: "none", "zlib", "lzma", "lz4", "zstd"
+
+  TString s(algo);
+  s.ToLower();
+  ECompression a = kZLIB;
+  if( s == "none" )
+    a = kNone;
+  else if( s == "zlib" )
+    a = kZLIB;
+  else if( s == "lzma" )
+    a = kLZMA;
+  else if( s == "lz4" )
+    a = kLZ4;
+  else if( s == "zstd" )
+    a = kZSTD;
+  else {
+    Error("HitCacheWriter::SetCompression", "Unknown compression algorithm "
+          "\"%s\". Use one of none, zlib, lzma, lz4, zstd.", algo);
+    return -1;
+  }
+  return SetCompression(a, level);
+}
+
+//_____________________________________________________________________________
+Bool_t HitCacheWriter::GetUsedCrateSlots(
+  std::set<std::pair<UInt_t,UInt_t>>& crateslots ) const
+{
+  // The hits of all slots of the selected crates are saved. Without a crate
+  // selection, all crates are needed.
+
+  if( fCrates.empty() )
+    return false;
+  for( auto crate : fCrates )
+    crateslots.emplace(crate, kMaxUInt);
+  return true;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::SetCrates( const char* crates )
+{
+  // Set list of crates to save. 'crates' is a string of crate numbers
+  // separated by commas or spaces. An empty string selects all crates.
+
+  fCrates.clear();
+  fSaveCrate.assign(MAXROC, true);
+  if( !crates || !*crates )
+    return 0;
+  vector<string> tokens;
+  Tokenize(crates, " ,", tokens);
+  fSaveCrate.assign(MAXROC, false);
+  for( const auto& tok : tokens ) {
+    char* end = nullptr;
+    unsigned long crate = strtoul(tok.c_str(), &end, 10);
+    if( *end || crate >= MAXROC ) {
+      Error("HitCacheWriter::SetCrates", "Illegal crate number \"%s\"",
+            tok.c_str());
+      fCrates.clear();
+      fSaveCrate.assign(MAXROC, true);
+      return -1;
+    }
+    if( !fSaveCrate[crate] ) {
+      fSaveCrate[crate] = true;
+      fCrates.push_back(crate);
+    }
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::Init( const TDatime& )
+{
+  // Open the output file and create the event tree
+
+  const char* const here = "HitCacheWriter::Init";
+
+  if( fIsInit )
+    return 0;
+
+  TDirectory* olddir = gDirectory;
+  fFile = TFile::Open(fFileName, "RECREATE", "Podd decoded-hit cache",
+                      fCompress);
+  if( !fFile || fFile->IsZombie() ) {
+    Error(here, "Cannot open hit cache file %s for writing.",
+          fFileName.Data());
+    delete fFile; fFile = nullptr;
+    if( olddir ) olddir->cd();
+    return -3;
+  }
+  fTree = new TTree(kHitCacheTree, "Decoded hits");
+  fEvent->SetupTree(fTree, true);
+  if( olddir ) olddir->cd();
+
+  fIsInit = 1;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::FillEvent( const THaEvData* evdata )
+{
+  // Copy the decoded hits of the current event to fEvent
+
+  HitCacheEvent& ev = *fEvent;
+  ev.Clear();
+  ev.hdr.evtype   = evdata->GetEvType();
+  ev.hdr.evnum    = evdata->GetEvNum();
+  ev.hdr.evlen    = evdata->GetEvLength();
+  ev.hdr.trigbits = evdata->GetTrigBits();
+  ev.hdr.evtime   = evdata->GetEvTime();
+
+  bool physics = evdata->IsPhysicsTrigger();
+  if( physics ) {
+    for( UInt_t i = 0; i < evdata->GetNslots(); ++i ) {
+      const THaSlotData* sd = evdata->GetSlotData(i);
+      if( !sd || sd->getNumChan() == 0 || !fSaveCrate[sd->getCrate()] )
+        continue;
+      UInt_t crate = sd->getCrate(), slot = sd->getSlot();
+      if( !fWarnModule && evdata->IsMultifunction(crate, slot) ) {
+        Warning("HitCacheWriter", "Crate %u slot %u contains a multi-function "
+                "module. Only its raw hits are cached.", crate, slot);
+        fWarnModule = true;
+      }
+      UInt_t nhit = 0;
+      for( UInt_t k = 0; k < sd->getNumChan(); ++k ) {
+        UInt_t chan = sd->getNextChan(k);
+        for( UInt_t hit = 0; hit < sd->getNumHits(chan); ++hit ) {
+          ev.chan.push_back(chan);
+          ev.data.push_back(sd->getData(chan, hit));
+          ev.raw.push_back(sd->getRawData(chan, hit));
+        }
+        nhit += sd->getNumHits(chan);
+      }
+      ev.slot.push_back(slot + MAXSLOT * crate);
+      ev.nhit.push_back(nhit);
+    }
+  }
+  if( !physics || fRawPhysics ) {
+    const UInt_t* buf = evdata->GetRawDataBuffer();
+    if( buf ) {
+      ev.rawbuf.assign(buf, buf + evdata->GetEvLength());
+      // ROC positions for raw-word lookups in the replay
+      for( UInt_t crate = 0; physics && crate < MAXROC; ++crate ) {
+        UInt_t len = evdata->GetRocLength(crate);
+        if( len == 0 )
+          continue;
+        auto pos = static_cast<UInt_t>(evdata->GetRawDataBuffer(crate) - buf);
+        if( pos + len < ev.rawbuf.size() ) {
+          ev.rocdat.push_back(crate);
+          ev.rocdat.push_back(pos);
+          ev.rocdat.push_back(len);
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::Process( const THaEvData* evdata, const THaRunBase* run,
+                               Int_t /* code */ )
+{
+  // Save the current event to the cache file
+
+  if( !fIsInit || !evdata )
+    return THaAnalyzer::kOK;
+
+  // DAQ configuration events carry decoder-specific data that cannot be
+  // reproduced from a raw buffer
+  UInt_t evtype = evdata->GetEvType();
+  if( evtype == DAQCONFIG_FILE1 || evtype == DAQCONFIG_FILE2 )
+    return THaAnalyzer::kOK;
+
+  FillEvent(evdata);
+
+  if( !evdata->IsPhysicsTrigger() || fTree->GetEntries() == 0 ) {
+    // Keep track of the run information. Update from non-physics events
+    // since these may carry new run parameters.
+    fRunNumber   = evdata->GetRunNum();
+    fRunType     = evdata->GetRunType();
+    fRunTime     = evdata->GetRunTime();
+    fDataVersion = evdata->GetDataVersion();
+    const THaRunParameters* param = run ? run->GetParameters() : nullptr;
+    if( param ) {
+      const TArrayI& ps = param->GetPrescales();
+      fPrescales.assign(ps.GetArray(), ps.GetArray() + ps.GetSize());
+    }
+    if( evdata->IsPrescaleEvent() ) {
+      for( size_t i = 0; i < fPrescales.size(); ++i )
+        fEvent->psfact.push_back(evdata->GetPrescaleFactor(i + 1));
+    }
+  }
+
+  fTree->Fill();
+  return THaAnalyzer::kOK;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::WriteRunInfo()
+{
+  // Write the run information tree to the output file. Must be called
+  // with fFile as the current directory.
+
+  UInt_t    runnum = fRunNumber, runtype = fRunType;
+  ULong64_t runtime = fRunTime;
+  Int_t     version = fDataVersion;
+  Bool_t    rawphys = fRawPhysics;
+  vector<UInt_t> crates = fCrates;
+  vector<Int_t>  prescales = fPrescales;
+  auto* info = new TTree(kHitCacheInfoTree, "Hit cache run information");
+  info->Branch("run",       &runnum,  "run/i");
+  info->Branch("type",      &runtype, "type/i");
+  info->Branch("time",      &runtime, "time/l");
+  info->Branch("version",   &version, "version/I");
+  info->Branch("rawphys",   &rawphys, "rawphys/O");
+  info->Branch("crates",    &crates);
+  info->Branch("prescales", &prescales);
+  info->Fill();
+  info->Write("", TObject::kOverwrite);
+  delete info;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HitCacheWriter::Close()
+{
+  // Write run information and close the output file
+
+  if( !fFile )
+    return 0;
+
+  TDirectory* olddir = (gDirectory != fFile) ? gDirectory : nullptr;
+  fFile->cd();
+  fTree->Write("", TObject::kOverwrite);
+  WriteRunInfo();
+  delete fTree; fTree = nullptr;
+  fFile->Close();
+  delete fFile; fFile = nullptr;
+  if( olddir ) olddir->cd();
+  fIsInit = 0;
+  return 0;
+}
+
+} // namespace Podd
+
+//_____________________________________________________________________________
+ClassImp(Podd::HitCacheWriter)
@@ -0,0 +1,70 @@
+#ifndef Podd_HitCacheWriter_h_
+#define Podd_HitCacheWriter_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::HitCacheWriter
+//
+// Post-processing module that writes decoded hits to a cache file
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaPostProcess.h"
+#include "HitCache.h"
+#include "TString.h"
+#include <memory>
+#include <vector>
+
+class TFile;
+class TTree;
+
+namespace Podd {
+
+class HitCacheWriter : public THaPostProcess {
+public:
+  explicit HitCacheWriter( const char* filename, const char* crates = "" );
+  virtual ~HitCacheWriter();
+
+  virtual Int_t Init( const TDatime& );
+  virtual Int_t Process( const THaEvData*, const THaRunBase*, Int_t code );
+  virtual Int_t Close();
+  virtual Bool_t GetUsedCrateSlots( std::set<std::pair<UInt_t,UInt_t>>& ) const;
+
+  // Compression algorithms, numbered as in ROOT's compression settings
+  enum ECompression { kNone = 0, kZLIB = 1, kLZMA = 2, kLZ4 = 4, kZSTD = 5 };
+
+  Int_t  SetCompression( ECompression algo, Int_t level );
+  Int_t  SetCompression( const char* algo, Int_t level );
+  Int_t  SetCrates( const char* crates );
+  void   SetRawPhysics( Bool_t b = true ) { fRawPhysics = b; }
+
+  Int_t  GetCompression() const { return fCompress; }
+  const std::vector<UInt_t>& GetCrates() const { return fCrates; }
+
+protected:
+  TString             fFileName;   // Name of cache output file
+  std::vector<UInt_t> fCrates;     // Crates to save (empty = all)
+  std::vector<bool>   fSaveCrate;  // Lookup table for fCrates
+  Int_t               fCompress;   // ROOT compression setting (algo*100+level)
+  Bool_t              fRawPhysics; // Also save raw buffer of physics events
+  Bool_t              fWarnModule; // Multi-function module warning printed
+  TFile*              fFile;       // Output file
+  TTree*              fTree;       // Event tree
+  std::unique_ptr<HitCacheEvent> fEvent;  // Current event record
+
+  // Run information, written at Close()
+  UInt_t              fRunNumber;
+  UInt_t              fRunType;
+  ULong64_t           fRunTime;
+  Int_t               fDataVersion;
+  std::vector<Int_t>  fPrescales;
+
+  Int_t  FillEvent( const THaEvData* evdata );
+  Int_t  WriteRunInfo();
+
+  ClassDef(HitCacheWriter,0)  // Writes decoded hits to a cache file
+};
+
+} // namespace Podd
+
+#endif
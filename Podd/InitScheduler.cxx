@@ -0,0 +1,412 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::InitScheduler
+//
+// Initializes a list of analysis modules (apparatuses, physics modules,
+// event type handlers, inter-stage modules) for a given date. Used by
+// THaAnalyzer::InitModules.
+//
+// With one thread (the default), the modules are initialized one after
+// the other in list order, stopping at the first failure, exactly as
+// before. With more threads, each worker takes the next module from the
+// list and calls its Init(). Only the database reading part of Init(),
+// i.e. ReadRunDatabase() and ReadDatabase(), of classes that declare it
+// thread-safe with IsDBReadThreadSafe() runs concurrently. All other
+// initialization code, including the registration of global variables,
+// and the database reading of all other classes is serialized by a lock.
+//
+// Dependencies between modules are resolved on the fly: when a module
+// calls FindModule() for another scheduled module (or a detector of one)
+// that is not yet initialized, it either initializes that module itself
+// if nobody has started it, or waits until the thread that is working
+// on it is done. Detectors are always initialized by their apparatus,
+// so parent/child dependencies are respected. Circular dependencies are
+// detected and reported by FindModule() as uninitialized modules, as in
+// the sequential case.
+//
+// Requirements for declaring a class thread-safe:
+//  - ReadRunDatabase() and ReadDatabase() must only modify the module
+//    itself. They must not define global variables, initialize other
+//    modules, or modify any other shared state (global lists, gROOT,
+//    gSystem, static members).
+//  - Dependencies on other modules must be obtained with FindModule().
+//  - The declaration must be repeated by each class that overrides one
+//    of the database readers. Otherwise, the readers run serialized.
+// Global variables are defined in a nondeterministic order.
+//
+// Each thread tracks the scheduler it works for, so several schedulers
+// may run at the same time, e.g. in different analysis contexts.
+//
+// Per-module initialization times are available via GetResults() and
+// printed by Print().
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "InitScheduler.h"
+#include "THaAnalysisObject.h"
+#include "AnalysisContext.h"
+#include "TDatime.h"
+#include "TError.h"
+#include "TROOT.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <system_error>
+#include <thread>
+
+using namespace std;
+using clock_type = chrono::steady_clock;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+struct InitScheduler::Task {
+  enum EState { kPending, kRunning, kDone };
+  explicit Task( THaAnalysisObject* module )
+    : state(kPending), inlined(nullptr), waitsOn(nullptr),
+      result{module, 0, 0., 0., ""} {}
+  EState  state;
+  Task*   inlined;   // Dependency being initialized by the same thread
+  Task*   waitsOn;   // Dependency this task is waiting for
+  Result  result;
+};
+
+thread_local InitScheduler* InitScheduler::ftActive = nullptr;
+thread_local InitScheduler::Task* InitScheduler::ftCurrent = nullptr;
+thread_local Bool_t InitScheduler::ftLocked = false;
+
+static inline Double_t Seconds( clock_type::duration d )
+{
+  return chrono::duration<Double_t>(d).count();
+}
+
+//_____________________________________________________________________________
+InitScheduler::InitScheduler( UInt_t nthreads, Int_t verbose )
+  : fDate(nullptr), fContext(nullptr), fNthreads(max(nthreads, 1U)), fVerbose(verbose),
+    fNext(0), fAbort(false), fElapsed(0)
+{
+}
+
+//_____________________________________________________________________________
+InitScheduler::~InitScheduler() = default;
+
+//_____________________________________________________________________________
+Int_t InitScheduler::Run( const vector<THaAnalysisObject*>& modules,
+                          const TDatime& date )
+{
+  // Initialize 'modules' for 'date'. Returns 0 if all modules were
+  // initialized successfully. Otherwise, returns the Init() status of
+  // the first failed module in list order, or -1 if that module threw
+  // an exception or is not OK despite a successful return.
+
+  assert(!ftActive);  // Not from within a module being initialized
+  fTasks.clear();
+  fTasks.reserve(modules.size());
+  for( auto* module : modules )
+    fTasks.emplace_back(new Task(module));
+  fResults.clear();
+  fDate = &date;
+  fContext = AnalysisContext::Current();
+  fNext = 0;
+  fAbort = false;
+
+  auto start = clock_type::now();
+  UInt_t nthreads = min<size_t>(fNthreads, fTasks.size());
+  if( nthreads <= 1 ) {
+    Worker();
+  } else {
+    ROOT::EnableThreadSafety();
+    // The calling thread is one of the workers, so initialization
+    // proceeds even if no threads can be started
+    vector<thread> threads;
+    try {
+      for( UInt_t i = 1; i < nthreads; ++i )
+        threads.emplace_back(&InitScheduler::ParallelWorker, this);
+    }
+    catch( const system_error& e ) {
+      Warning("InitScheduler::Run", "Cannot start thread: %s. Continuing "
+              "with %lu threads.", e.what(),
+              static_cast<unsigned long>(threads.size()+1));
+    }
+    ParallelWorker();
+    for( auto& t : threads )
+      t.join();
+  }
+  fElapsed = Seconds(clock_type::now() - start);
+
+  Int_t retval = 0;
+  for( const auto& task : fTasks ) {
+    if( task->state != Task::kDone )
+      continue;
+    const Result& res = task->result;
+    fResults.push_back(res);
+    if( retval == 0 && (res.status != THaAnalysisObject::kOK ||
+                        !res.exception.empty() || !res.module->IsOK()) )
+      retval = (res.status != THaAnalysisObject::kOK) ? res.status : -1;
+  }
+  fDate = nullptr;
+  return retval;
+}
+
+//_____________________________________________________________________________
+void InitScheduler::Worker()
+{
+  // Initialize pending modules in list order until none are left or a
+  // module has failed
+
+  // Modules are initialized in the context of the caller of Run()
+  AnalysisContext::Scope scope(fContext);
+
+  while( true ) {
+    Task* task = nullptr;
+    {
+      lock_guard<mutex> lock(fMutex);
+      while( fNext < fTasks.size() && fTasks[fNext]->state != Task::kPending )
+        ++fNext;
+      if( fAbort || fNext == fTasks.size() )
+        return;
+      task = fTasks[fNext++].get();
+      task->state = Task::kRunning;
+    }
+    RunTask(task);
+  }
+}
+
+//_____________________________________________________________________________
+void InitScheduler::ParallelWorker()
+{
+  // Worker of a parallel Run(). Enables the hooks for this thread.
+
+  ftActive = this;
+  Worker();
+  ftActive = nullptr;
+}
+
+//_____________________________________________________________________________
+void InitScheduler::RunTask( Task* task )
+{
+  // Call Init() of the task's module while holding the serialization lock.
+  // The task must have been claimed (state kRunning) by the caller.
+
+  Result& res = task->result;
+  Task* prev = ftCurrent;
+  ftCurrent = task;
+  Bool_t do_lock = !ftLocked;
+  if( do_lock ) {
+    fSerial.lock();
+    ftLocked = true;
+  }
+  if( fVerbose > 1 )
+    cout << "Initializing " << res.module->GetName() << endl;
+  auto start = clock_type::now();
+  try {
+    res.status = res.module->Init(*fDate);
+  }
+  catch( const exception& e ) {
+    res.status = -1;
+    res.exception = e.what();
+  }
+  catch( ... ) {
+    res.status = -1;
+    res.exception = "unknown exception";
+  }
+  res.time = Seconds(clock_type::now() - start) - res.wait;
+  if( do_lock ) {
+    ftLocked = false;
+    fSerial.unlock();
+  }
+  ftCurrent = prev;
+
+  {
+    lock_guard<mutex> lock(fMutex);
+    task->state = Task::kDone;
+    if( res.status != THaAnalysisObject::kOK || !res.module->IsOK() )
+      fAbort = true;
+  }
+  fDone.notify_all();
+}
+
+//_____________________________________________________________________________
+InitScheduler::Task* InitScheduler::FindTask( const THaAnalysisObject* module ) const
+{
+  // Find the task for 'module' or, if 'module' is not scheduled itself,
+  // for the scheduled module it belongs to (e.g. the apparatus of a
+  // detector), i.e. the one with the longest prefix matching that of
+  // 'module'. Returns nullptr if none.
+
+  for( const auto& task : fTasks )
+    if( task->result.module == module )
+      return task.get();
+  const char* prefix = module->GetPrefix();
+  if( !prefix )
+    return nullptr;
+  Task* found = nullptr;
+  size_t maxlen = 0;
+  for( const auto& task : fTasks ) {
+    const THaAnalysisObject* obj = task->result.module;
+    TString tprefix = obj->GetPrefix() ? TString(obj->GetPrefix())
+                                       : TString(obj->GetName()) + ".";
+    size_t len = tprefix.Length();
+    if( len > maxlen && strncmp(prefix, tprefix.Data(), len) == 0 ) {
+      found = task.get();
+      maxlen = len;
+    }
+  }
+  return found;
+}
+
+//_____________________________________________________________________________
+Bool_t InitScheduler::WouldDeadlock( const Task* target, const Task* self ) const
+{
+  // Check if waiting for 'target' would make 'self' wait for itself.
+  // Follow the chain of tasks that 'target' depends on: the innermost
+  // task on target's thread, the task that one is waiting for, etc.
+  // Must be called with fMutex held.
+
+  const Task* t = target;
+  while( t ) {
+    while( t->inlined )
+      t = t->inlined;
+    if( t == self )
+      return true;
+    t = t->waitsOn;
+  }
+  return false;
+}
+
+//_____________________________________________________________________________
+void InitScheduler::Wait( const THaAnalysisObject* module )
+{
+  // Ensure that the scheduled module owning 'module' is initialized
+
+  Task* self = ftCurrent;
+  if( !self )
+    return;  // Not called from a module being initialized
+  Task* target = FindTask(module);
+  if( !target )
+    return;
+
+  auto start = clock_type::now();
+  unique_lock<mutex> lock(fMutex);
+  if( target->state == Task::kDone )
+    return;
+  if( target->state == Task::kPending ) {
+    // Nobody has started the dependency yet. Do it now.
+    target->state = Task::kRunning;
+    self->inlined = target;
+    lock.unlock();
+    RunTask(target);
+    lock.lock();
+    self->inlined = nullptr;
+  } else {
+    // Being initialized by another thread. If that thread is directly or
+    // indirectly waiting for us, give up. FindModule then reports the
+    // module as not initialized.
+    if( WouldDeadlock(target, self) )
+      return;
+    self->waitsOn = target;
+    Bool_t relock = ftLocked;
+    if( relock ) {
+      ftLocked = false;
+      fSerial.unlock();
+    }
+    fDone.wait(lock, [target]{ return target->state == Task::kDone; });
+    self->waitsOn = nullptr;
+    lock.unlock();
+    if( relock ) {
+      fSerial.lock();
+      ftLocked = true;
+    }
+  }
+  self->result.wait += Seconds(clock_type::now() - start);
+}
+
+//_____________________________________________________________________________
+void InitScheduler::WaitFor( const THaAnalysisObject* module )
+{
+  if( ftActive && module )
+    ftActive->Wait(module);
+}
+
+//_____________________________________________________________________________
+InitScheduler::Unlock::Unlock( Bool_t enable )
+  : fRelock(enable && ftActive && ftLocked)
+{
+  if( fRelock ) {
+    ftLocked = false;
+    ftActive->fSerial.unlock();
+  }
+}
+
+//_____________________________________________________________________________
+InitScheduler::Unlock::~Unlock()
+{
+  if( fRelock ) {
+    ftActive->fSerial.lock();
+    ftLocked = true;
+  }
+}
+
+//_____________________________________________________________________________
+InitScheduler::Lock::Lock()
+  : fLocked(ftActive && !ftLocked)
+{
+  if( fLocked ) {
+    ftActive->fSerial.lock();
+    ftLocked = true;
+  }
+}
+
+//_____________________________________________________________________________
+InitScheduler::Lock::~Lock()
+{
+  if( fLocked ) {
+    ftLocked = false;
+    ftActive->fSerial.unlock();
+  }
+}
+
+//_____________________________________________________________________________
+void InitScheduler::Print( Option_t* ) const
+{
+  // Print per-module initialization times, slowest first
+
+  if( fResults.empty() )
+    return;
+  vector<const Result*> res;
+  res.reserve(fResults.size());
+  size_t w = 6;
+  Double_t sum = 0;
+  for( const auto& r : fResults ) {
+    res.push_back(&r);
+    w = max(w, strlen(r.module->GetName()));
+    sum += r.time;
+  }
+  stable_sort(res.begin(), res.end(), []( const Result* a, const Result* b ) {
+    return a->time > b->time;
+  });
+  auto fmt = cout.flags();
+  auto prec = cout.precision();
+  cout << "Module initialization times:" << endl;
+  cout << left << setw(static_cast<int>(w)) << "Module" << right
+       << setw(11) << "init(s)"
+       << setw(11) << "wait(s)"
+       << setw(9)  << "status" << endl;
+  cout << fixed << setprecision(3);
+  for( const auto* r : res ) {
+    cout << left << setw(static_cast<int>(w)) << r->module->GetName() << right
+         << setw(11) << r->time
+         << setw(11) << r->wait
+         << setw(9)  << r->status << endl;
+  }
+  cout << "Total " << sum << " s, elapsed " << fElapsed << " s with "
+       << fNthreads << (fNthreads > 1 ? " threads" : " thread") << endl;
+  cout.flags(fmt);
+  cout.precision(prec);
+}
+
+} // namespace Podd
@@ -0,0 +1,105 @@
+#ifndef Podd_InitScheduler_h_
+#define Podd_InitScheduler_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::InitScheduler
+//
+// Initializes a list of analysis modules, optionally in parallel, and
+// records the initialization time of each module
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class THaAnalysisObject;
+class TDatime;
+
+namespace Podd {
+
+class AnalysisContext;
+
+class InitScheduler {
+public:
+  struct Result {
+    THaAnalysisObject* module;
+    Int_t       status;     // Return value of module->Init()
+    Double_t    time;       // Time spent in Init(), excluding waits (s)
+    Double_t    wait;       // Time spent waiting for other modules (s)
+    std::string exception;  // Message of exception thrown by Init(), if any
+  };
+
+  explicit InitScheduler( UInt_t nthreads = 1, Int_t verbose = 0 );
+  InitScheduler( const InitScheduler& ) = delete;
+  InitScheduler& operator=( const InitScheduler& ) = delete;
+  ~InitScheduler();
+
+  Int_t     Run( const std::vector<THaAnalysisObject*>& modules,
+                 const TDatime& date );
+  void      Print( Option_t* opt="" ) const;
+
+  const std::vector<Result>& GetResults() const { return fResults; }
+  Double_t  GetElapsed()  const { return fElapsed; }
+  UInt_t    GetNthreads() const { return fNthreads; }
+
+  // Hooks for THaAnalysisObject. These do nothing unless a parallel Run()
+  // is in progress.
+
+  // Allow other modules to be initialized concurrently while in scope,
+  // if 'enable' is true. Used around database reading of modules that
+  // declare it thread-safe.
+  class Unlock {
+  public:
+    explicit Unlock( Bool_t enable = true );
+    ~Unlock();
+  private:
+    Bool_t fRelock;
+  };
+  // Serialize with other modules' initialization while in scope. Needed
+  // only for code that can be reached from within an Unlock scope.
+  class Lock {
+  public:
+    Lock();
+    ~Lock();
+  private:
+    Bool_t fLocked;
+  };
+  // Wait until the scheduled module owning 'module' is initialized
+  static void WaitFor( const THaAnalysisObject* module );
+
+private:
+  struct Task;
+
+  std::vector<std::unique_ptr<Task>> fTasks;
+  std::vector<Result>     fResults;   // Results of modules that were run
+  const TDatime*          fDate;      // Initialization date
+  AnalysisContext*        fContext;   // Analysis context of the caller
+  UInt_t                  fNthreads;  // Max number of threads to use
+  Int_t                   fVerbose;   // Print module names if > 1
+  size_t                  fNext;      // Next task to start
+  Bool_t                  fAbort;     // A module failed, start no new ones
+  Double_t                fElapsed;   // Wall-clock time of last Run() (s)
+  std::mutex              fSerial;    // Serializes all but database reading
+  std::mutex              fMutex;     // Protects task states
+  std::condition_variable fDone;      // Signals task completion
+
+  void      Worker();
+  void      ParallelWorker();
+  void      RunTask( Task* task );
+  void      Wait( const THaAnalysisObject* module );
+  Task*     FindTask( const THaAnalysisObject* module ) const;
+  Bool_t    WouldDeadlock( const Task* target, const Task* self ) const;
+
+  static thread_local InitScheduler* ftActive; // Parallel scheduler of this thread
+  static thread_local Task*     ftCurrent;  // Task run by this thread
+  static thread_local Bool_t    ftLocked;   // This thread holds fSerial
+};
+
+} // namespace Podd
+
+#endif
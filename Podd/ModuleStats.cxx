@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ModuleStats
+//
+// Accumulates, for one analysis module, the number of calls made to it
+// by the analyzer, the wall-clock time spent in those calls and the
+// number of heap allocations they made. Per-event totals are tracked so
+// that the slowest event can be identified and events exceeding a
+// latency budget can be flagged.
+//
+// Allocations are only counted while Podd::AllocCounter is enabled.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "ModuleStats.h"
+#include "AllocCounter.h"
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+ModuleStats::ModuleStats( THaAnalysisObject* module )
+  : fModule(module)
+  , fAllocStart(0)
+  , fNcalls(0)
+  , fNevents(0)
+  , fNalloc(0)
+  , fEventAlloc(0)
+  , fMaxAlloc(0)
+  , fEventTime(0)
+  , fLastTime(0)
+  , fTotalTime(0)
+  , fMaxTime(0)
+  , fMaxEvent(0)
+  , fNoverBudget(0)
+  , fLastAllocEvent(0)
+{
+}
+
+//_____________________________________________________________________________
+void ModuleStats::Clear()
+{
+  // Reset all counters
+
+  fAllocStart = fNcalls = fNevents = fNalloc = fEventAlloc = fMaxAlloc = 0;
+  fEventTime = fLastTime = fTotalTime = fMaxTime = 0;
+  fMaxEvent = fNoverBudget = fLastAllocEvent = 0;
+}
+
+//_____________________________________________________________________________
+void ModuleStats::Start()
+{
+  // Begin timing a call to the module
+
+  fAllocStart = AllocCounter::GetCount();
+  fStart = clock_type::now();
+}
+
+//_____________________________________________________________________________
+void ModuleStats::Stop()
+{
+  // End timing a call to the module. Accumulate time and allocations.
+
+  chrono::duration<Double_t> dt = clock_type::now() - fStart;
+  fEventTime += dt.count();
+  ULong64_t nalloc = AllocCounter::GetCount() - fAllocStart;
+  fNalloc += nalloc;
+  fEventAlloc += nalloc;
+  ++fNcalls;
+}
+
+//_____________________________________________________________________________
+Bool_t ModuleStats::EndEvent( UInt_t evnum, Double_t budget )
+{
+  // Close accounting for the current event 'evnum'. Returns true if the
+  // module's time for this event exceeded 'budget' (seconds, if > 0).
+  // The last event with allocations shows whether the module has reached
+  // an allocation-free steady state.
+
+  Bool_t over = false;
+  fLastTime = fEventTime;
+  if( fEventTime > 0 ) {
+    ++fNevents;
+    fTotalTime += fEventTime;
+    if( fEventTime > fMaxTime ) {
+      fMaxTime = fEventTime;
+      fMaxEvent = evnum;
+    }
+    if( budget > 0 && fEventTime > budget ) {
+      ++fNoverBudget;
+      over = true;
+    }
+  }
+  fEventTime = 0;
+  if( fEventAlloc > 0 ) {
+    if( fEventAlloc > fMaxAlloc )
+      fMaxAlloc = fEventAlloc;
+    fLastAllocEvent = evnum;
+    fEventAlloc = 0;
+  }
+  return over;
+}
+
+} // namespace Podd
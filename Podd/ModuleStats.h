@@ -0,0 +1,77 @@
+#ifndef Podd_ModuleStats_h_
+#define Podd_ModuleStats_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ModuleStats
+//
+// Per-module timing and resource accounting for the analysis chain
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <chrono>
+
+class THaAnalysisObject;
+
+namespace Podd {
+
+class ModuleStats {
+public:
+  explicit ModuleStats( THaAnalysisObject* module = nullptr );
+
+  void      Clear();
+  void      Start();
+  void      Stop();
+  Bool_t    EndEvent( UInt_t evnum, Double_t budget );
+
+  THaAnalysisObject* GetModule() const { return fModule; }
+
+  ULong64_t GetNcalls()      const { return fNcalls; }
+  ULong64_t GetNevents()     const { return fNevents; }
+  ULong64_t GetNalloc()      const { return fNalloc; }
+  ULong64_t GetMaxAlloc()    const { return fMaxAlloc; }
+  UInt_t    GetLastAllocEvent() const { return fLastAllocEvent; }
+  Double_t  GetTotalTime()   const { return fTotalTime; }
+  Double_t  GetMaxTime()     const { return fMaxTime; }
+  Double_t  GetLastTime()    const { return fLastTime; }
+  UInt_t    GetMaxEvent()    const { return fMaxEvent; }
+  UInt_t    GetNoverBudget() const { return fNoverBudget; }
+
+private:
+  using clock_type = std::chrono::steady_clock;
+
+  THaAnalysisObject*     fModule;      // Module being monitored
+  clock_type::time_point fStart;       // Start of current call
+  ULong64_t              fAllocStart;  // Allocation count at start of call
+  ULong64_t              fNcalls;      // Number of calls to the module
+  ULong64_t              fNevents;     // Number of events with calls
+  ULong64_t              fNalloc;      // Number of heap allocations
+  ULong64_t              fEventAlloc;  // Allocations in current event
+  ULong64_t              fMaxAlloc;    // Maximum allocations per event
+  Double_t               fEventTime;   // Time spent in current event (s)
+  Double_t               fLastTime;    // Time spent in last event (s)
+  Double_t               fTotalTime;   // Total time spent in module (s)
+  Double_t               fMaxTime;     // Maximum time per event (s)
+  UInt_t                 fMaxEvent;    // Event number with maximum time
+  UInt_t                 fNoverBudget; // Events exceeding time budget
+  UInt_t                 fLastAllocEvent; // Last event number with allocations
+};
+
+//_____________________________________________________________________________
+// Scope guard for timing one call to a module. Does nothing if 'stats'
+// is null, so callers can pass nullptr when accounting is disabled.
+class ModuleTimer {
+public:
+  explicit ModuleTimer( ModuleStats* stats ) : fStats(stats)
+  { if( fStats ) fStats->Start(); }
+  ~ModuleTimer() { if( fStats ) fStats->Stop(); }
+  ModuleTimer( const ModuleTimer& ) = delete;
+  ModuleTimer& operator=( const ModuleTimer& ) = delete;
+private:
+  ModuleStats* fStats;
+};
+
+} // namespace Podd
+
+#endif
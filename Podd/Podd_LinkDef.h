@@ -118,6 +118,16 @@
 #pragma link C++ class Podd::MultiFileRun+;
 #pragma link C++ class Podd::MultiFileRun::StreamInfo+;
 #pragma link C++ class Podd::MultiFileRun::FileInfo+;
+#pragma link C++ class Podd::HitCacheWriter+;
+#pragma link C++ class Podd::HitCacheRun+;
+#pragma link C++ class Podd::HitCacheDecoder+;
+#pragma link C++ class Podd::BatchReplay;
+#pragma link C++ class Podd::ShardInfo+;
+#pragma link C++ class Podd::ShardInfo::CutStats+;
+#pragma link C++ class Podd::Checkpoint+;
+#pragma link C++ class Podd::AnalysisContext;
+#pragma link C++ class Podd::RunningStat+;
+#pragma link C++ class Podd::HelicityAccumulator+;
 
 #ifdef ONLINE_ET
 #pragma link C++ class THaOnlRun+;
@@ -2,6 +2,7 @@
 ###### Author:  Edward Brash (brash@jlab.org) June 2013
 ###### Modified for Podd 1.7 directory layout: Ole Hansen (ole@jlab.org) Sep 2018
 
+import os
 from podd_util import build_library, write_compiledata
 Import('baseenv')
 
@@ -9,11 +10,16 @@ libname = 'Podd'
 
 # Sources and headers
 src = """
-BankData.cxx                 BdataLoc.cxx                 CodaRawDecoder.cxx
-DecData.cxx                  DetectorData.cxx             FileInclude.cxx
-FixedArrayVar.cxx            InterStageModule.cxx         MethodVar.cxx
-MultiFileRun.cxx             SeqCollectionMethodVar.cxx   SeqCollectionVar.cxx
-SimDecoder.cxx               THaAnalysisObject.cxx        THaAnalyzer.cxx
+AllocCounter.cxx             AnalysisContext.cxx          BankData.cxx
+BatchReplay.cxx              BdataLoc.cxx                 Checkpoint.cxx
+CodaRawDecoder.cxx           DecData.cxx                  DetectorData.cxx
+EventCache.cxx               FileInclude.cxx              FixedArrayVar.cxx
+HelicityAccumulator.cxx      HistBuffer.cxx               HitCache.cxx
+HitCacheDecoder.cxx          HitCacheRun.cxx              HitCacheWriter.cxx
+InitScheduler.cxx            InterStageModule.cxx         MethodVar.cxx
+ModuleStats.cxx              MultiFileRun.cxx             SeqCollectionMethodVar.cxx
+SeqCollectionVar.cxx         ShardInfo.cxx                SimDecoder.cxx
+StageAllocStats.cxx          THaAnalysisObject.cxx        THaAnalyzer.cxx
 THaApparatus.cxx             THaArrayString.cxx           THaAvgVertex.cxx
 THaBPM.cxx                   THaBeam.cxx                  THaBeamDet.cxx
 THaBeamEloss.cxx             THaBeamInfo.cxx              THaBeamModule.cxx
@@ -54,3 +60,12 @@ poddlib = build_library(baseenv, libname, src, extrahdrs,
                         extradicthdrs = ['THaGlobals.h'], useenv = False,
                         versioned = True)
 Clean(poddlib, compiledata)
+
+# Replacement operator new/delete counting allocations for AllocCounter.
+# Only effective if linked ahead of all other libraries or preloaded.
+hookslib = baseenv.SharedLibrary(target = 'PoddAllocHooks',
+                                 source = ['AllocHooks.cxx'],
+                                 LIBS = [''], LIBPATH = [''])
+baseenv.InstallWithRPATH(os.path.join(baseenv.subst('$INSTALLDIR'),
+                                      baseenv.subst('$LIBSUBDIR')),
+                         hookslib, [])
@@ -0,0 +1,240 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ShardInfo
+//
+// A large run can be analyzed in several independent jobs ("shards"),
+// each processing a contiguous part of the run, either a range of events
+// or a range of file segments (see THaAnalyzer::SetShard). Each job
+// writes a ShardInfo object named "Shard_Info" to its output file. It
+// records which part of the run was analyzed and the analyzer's event
+// counters and cut statistics for that part only.
+//
+// Merge() adds the statistics of other shards of the same run. It is
+// called automatically by TFileMerger, and so by hadd and the mergeshards
+// utility. IsComplete() tells whether all shards of the run have been
+// merged. Print() shows the (combined) counters and cut statistics in
+// the format of the analyzer's end-of-run summary.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "ShardInfo.h"
+#include "TCollection.h"
+#include "TError.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+ShardInfo::ShardInfo()
+  : fNshards(0), fMode(kEvents), fRunNumber(0), fFirst(0), fLast(0)
+{
+}
+
+//_____________________________________________________________________________
+ShardInfo::ShardInfo( UInt_t shard, UInt_t nshards, EMode mode,
+                      UInt_t run_number )
+  : TNamed("Shard_Info", "Analyzed part of run")
+  , fShards{shard}
+  , fNshards(nshards)
+  , fMode(mode)
+  , fRunNumber(run_number)
+  , fFirst(0)
+  , fLast(0)
+{
+}
+
+//_____________________________________________________________________________
+void ShardInfo::AddCounter( const char* description, ULong64_t count )
+{
+  fCounterText.emplace_back(description ? description : "");
+  fCounts.push_back(count);
+}
+
+//_____________________________________________________________________________
+void ShardInfo::AddCut( const char* name, const char* block,
+                        ULong64_t ncalled, ULong64_t npassed )
+{
+  fCuts.push_back({name, block ? block : "", ncalled, npassed});
+}
+
+//_____________________________________________________________________________
+void ShardInfo::ClearStats()
+{
+  fCounterText.clear();
+  fCounts.clear();
+  fCuts.clear();
+}
+
+//_____________________________________________________________________________
+Bool_t ShardInfo::IsCompatible( const ShardInfo& rhs ) const
+{
+  // True if 'rhs' describes another part of the same run divided in the
+  // same way
+
+  return fRunNumber == rhs.fRunNumber && fNshards == rhs.fNshards &&
+         fMode == rhs.fMode;
+}
+
+//_____________________________________________________________________________
+Bool_t ShardInfo::IsComplete() const
+{
+  // True if each shard of the run is included exactly once
+
+  if( fShards.size() != fNshards )
+    return false;
+  vector<UInt_t> shards(fShards);
+  sort(shards.begin(), shards.end());
+  for( UInt_t i = 0; i < fNshards; ++i )
+    if( shards[i] != i )
+      return false;
+  return true;
+}
+
+//_____________________________________________________________________________
+void ShardInfo::Add( const ShardInfo& rhs )
+{
+  // Add statistics of 'rhs'. Counters and cuts are matched by name.
+
+  fShards.insert(fShards.end(), rhs.fShards.begin(), rhs.fShards.end());
+  fFirst = min(fFirst, rhs.fFirst);
+  fLast  = max(fLast, rhs.fLast);
+  for( size_t i = 0; i < rhs.fCounts.size(); ++i ) {
+    auto it = find(fCounterText.begin(), fCounterText.end(),
+                   rhs.fCounterText[i]);
+    if( it != fCounterText.end() )
+      fCounts[it - fCounterText.begin()] += rhs.fCounts[i];
+    else
+      AddCounter(rhs.fCounterText[i].c_str(), rhs.fCounts[i]);
+  }
+  for( const auto& cut : rhs.fCuts ) {
+    auto it = find_if(fCuts.begin(), fCuts.end(), [&cut]( const CutStats& c ) {
+      return c.name == cut.name;
+    });
+    if( it != fCuts.end() ) {
+      it->ncalled += cut.ncalled;
+      it->npassed += cut.npassed;
+    } else
+      fCuts.push_back(cut);
+  }
+}
+
+//_____________________________________________________________________________
+void ShardInfo::Subtract( const ShardInfo& rhs )
+{
+  // Subtract statistics of 'rhs', which must have been taken earlier from
+  // the same analysis. Used to exclude events processed before the start
+  // of the shard.
+
+  for( size_t i = 0; i < rhs.fCounts.size() && i < fCounts.size(); ++i ) {
+    if( fCounterText[i] == rhs.fCounterText[i] )
+      fCounts[i] -= min(fCounts[i], rhs.fCounts[i]);
+  }
+  for( size_t i = 0; i < rhs.fCuts.size() && i < fCuts.size(); ++i ) {
+    if( fCuts[i].name == rhs.fCuts[i].name ) {
+      fCuts[i].ncalled -= min(fCuts[i].ncalled, rhs.fCuts[i].ncalled);
+      fCuts[i].npassed -= min(fCuts[i].npassed, rhs.fCuts[i].npassed);
+    }
+  }
+}
+
+//_____________________________________________________________________________
+Long64_t ShardInfo::Merge( TCollection* list )
+{
+  // Add the statistics of the ShardInfo objects in 'list'.
+  // Returns the number of shards included, or -1 if any object in 'list'
+  // belongs to a different run or a different division of the run.
+
+  if( !list )
+    return 0;
+  TIter next(list);
+  while( TObject* obj = next() ) {
+    auto* rhs = dynamic_cast<ShardInfo*>(obj);
+    if( !rhs )
+      continue;
+    if( !IsCompatible(*rhs) ) {
+      Error("ShardInfo::Merge", "Cannot merge shard of run %u (%u shards) "
+            "with shard of run %u (%u shards)", rhs->fRunNumber,
+            rhs->fNshards, fRunNumber, fNshards);
+      return -1;
+    }
+    Add(*rhs);
+  }
+  return static_cast<Long64_t>(fShards.size());
+}
+
+//_____________________________________________________________________________
+void ShardInfo::Print( Option_t* ) const
+{
+  // Print shard description, counters and cut statistics
+
+  auto fmt = cout.flags();
+  auto prec = cout.precision();
+  vector<UInt_t> shards(fShards);
+  sort(shards.begin(), shards.end());
+  cout << "Run " << fRunNumber << ", " << shards.size() << " of "
+       << fNshards << " shards (by "
+       << (fMode == kSegments ? "segment" : "event") << ")";
+  if( !IsComplete() ) {
+    cout << ": shards";
+    for( auto s : shards )
+      cout << " " << s;
+  }
+  cout << endl;
+  cout << (fMode == kSegments ? "Segments " : "Events ") << fFirst << "-";
+  if( fLast != kMaxUInt )
+    cout << fLast;
+  else
+    cout << "end";
+  cout << endl;
+
+  ULong64_t maxcount = 0;
+  for( auto n : fCounts )
+    maxcount = max(maxcount, n);
+  int w = 1;
+  while( maxcount >= 10 ) {
+    maxcount /= 10;
+    ++w;
+  }
+  bool first = true;
+  for( size_t i = 0; i < fCounts.size(); ++i ) {
+    if( fCounts[i] != 0 && !fCounterText[i].empty() ) {
+      if( first ) {
+        cout << "Counter summary:" << endl;
+        first = false;
+      }
+      cout << setw(w) << fCounts[i] << "  " << fCounterText[i] << endl;
+    }
+  }
+  if( !fCuts.empty() )
+    cout << endl << "Cut summary:" << endl;
+  size_t wn = 4;
+  for( const auto& cut : fCuts )
+    wn = max(wn, cut.name.length());
+  string block;
+  for( const auto& cut : fCuts ) {
+    if( cut.block != block ) {
+      block = cut.block;
+      cout << "BLOCK: " << block << endl;
+    }
+    cout << left << setw(static_cast<int>(wn)) << cut.name << right
+         << "  called: " << setw(10) << cut.ncalled
+         << "  passed: " << setw(10) << cut.npassed;
+    if( cut.ncalled > 0 )
+      cout << " (" << fixed << setprecision(1)
+           << 100. * static_cast<Double_t>(cut.npassed) /
+              static_cast<Double_t>(cut.ncalled)
+           << "%)";
+    cout << endl;
+  }
+  cout.flags(fmt);
+  cout.precision(prec);
+}
+
+} // namespace Podd
+
+//_____________________________________________________________________________
+ClassImp(Podd::ShardInfo)
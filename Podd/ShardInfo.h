@@ -0,0 +1,75 @@
+#ifndef Podd_ShardInfo_h_
+#define Podd_ShardInfo_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::ShardInfo
+//
+// Description and statistics of one part ("shard") of a run analyzed
+// in several independent jobs. Written to the output file by THaAnalyzer
+// and combined by the mergeshards utility (or hadd) via Merge().
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "TNamed.h"
+#include <string>
+#include <vector>
+
+class TCollection;
+
+namespace Podd {
+
+class ShardInfo : public TNamed {
+public:
+  // Way the run is divided into shards
+  enum EMode { kEvents = 0, kSegments };
+
+  ShardInfo();
+  ShardInfo( UInt_t shard, UInt_t nshards, EMode mode, UInt_t run_number );
+
+  void      AddCounter( const char* description, ULong64_t count );
+  void      AddCut( const char* name, const char* block,
+                    ULong64_t ncalled, ULong64_t npassed );
+  void      ClearStats();
+  Bool_t    IsComplete() const;
+  Bool_t    IsCompatible( const ShardInfo& rhs ) const;
+  Long64_t  Merge( TCollection* list );
+  virtual void Print( Option_t* opt="" ) const;
+  void      SetRange( UInt_t first, UInt_t last ) { fFirst = first; fLast = last; }
+  void      Subtract( const ShardInfo& rhs );
+
+  UInt_t    GetShard()     const { return fShards.empty() ? 0 : fShards[0]; }
+  UInt_t    GetNshards()   const { return fNshards; }
+  EMode     GetMode()      const { return static_cast<EMode>(fMode); }
+  UInt_t    GetRunNumber() const { return fRunNumber; }
+  UInt_t    GetFirst()     const { return fFirst; }
+  UInt_t    GetLast()      const { return fLast; }
+  const std::vector<UInt_t>& GetShards() const { return fShards; }
+
+  struct CutStats {
+    std::string name;      // Cut name
+    std::string block;     // Name of block the cut belongs to
+    ULong64_t   ncalled;   // Number of evaluations
+    ULong64_t   npassed;   // Number of evaluations that passed
+    ClassDefNV(CutStats,1) // Statistics of one cut
+  };
+
+protected:
+  std::vector<UInt_t>      fShards;      // Shard indices included
+  UInt_t                   fNshards;     // Total number of shards of run
+  Int_t                    fMode;        // Shard mode (see EMode)
+  UInt_t                   fRunNumber;   // Run number
+  UInt_t                   fFirst;       // First event or segment analyzed
+  UInt_t                   fLast;        // Last event or segment analyzed
+  std::vector<std::string> fCounterText; // Analyzer counter descriptions
+  std::vector<ULong64_t>   fCounts;      // Analyzer counter values
+  std::vector<CutStats>    fCuts;        // Cut/test statistics
+
+  void      Add( const ShardInfo& rhs );
+
+  ClassDef(ShardInfo,1)  // Part of a run analyzed in a separate job
+};
+
+} // namespace Podd
+
+#endif
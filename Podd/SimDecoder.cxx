@@ -9,6 +9,7 @@
 #include "SimDecoder.h"
 #include "THaVarList.h"
 #include "THaGlobals.h"
+#include "AnalysisContext.h"
 #include <iostream>
 #include <algorithm>
 
@@ -37,7 +38,8 @@ SimDecoder::SimDecoder() :
 
   // Register standard global variables for event header data
   // (It is up to the actual implementation of SimDecoder to fill these)
-  if( gHaVars ) {
+  THaVarList* varlist = Podd::AnalysisContext::Current()->GetVars();
+  if( varlist ) {
     VarDef vars[] = {
         { "runnum",    "Run number",     kInt,    0, &run_num },
         { "runtype",   "CODA run type",  kInt,    0, &run_type },
@@ -53,7 +55,7 @@ SimDecoder::SimDecoder() :
     if( fInstance > 1 )
       prefix.Append(Form("%d",fInstance));
     prefix.Append(".");
-    gHaVars->DefineVariables( vars, prefix, here );
+    varlist->DefineVariables( vars, prefix, here );
   } else
     Warning(here,"No global variable list found. Variables not registered.");
 }
@@ -70,12 +72,13 @@ SimDecoder::~SimDecoder()
   SafeDelete(fMCHits)
 
   // Unregister global variables registered in the constructor
-  if( gHaVars ) {
+  THaVarList* varlist = Podd::AnalysisContext::Current()->GetVars();
+  if( varlist ) {
     TString prefix("g");
     if( fInstance > 1 )
       prefix.Append(Form("%d",fInstance));
     prefix.Append(".*");
-    gHaVars->RemoveRegexp( prefix );
+    varlist->RemoveRegexp( prefix );
   }
 }
 
@@ -0,0 +1,172 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::StageAllocStats
+//
+// Counts the heap allocations made during each stage of the analysis
+// event loop ("RawDecode", "Decode", "Output", ...), as bracketed by
+// Begin() and Stop(). EndEvent() closes the current event.
+//
+// The first fWarmup events are counted, but excluded from the
+// steady-state statistics, so that containers that grow to their working
+// size during the first events do not count against the steady state.
+// A fully warmed-up event loop should make no allocations at all. Stages
+// that do are listed by Print() together with the last event number in
+// which they allocated memory.
+//
+// Allocations are only counted while Podd::AllocCounter is enabled.
+// Stages are identified by name; the first Begin() of a new stage
+// allocates its entry, which falls within the warm-up.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "StageAllocStats.h"
+#include "AllocCounter.h"
+#include "Helper.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+namespace Podd {
+
+//_____________________________________________________________________________
+StageAllocStats::StageAllocStats( UInt_t warmup )
+  : fWarmup(warmup)
+  , fNevents(0)
+  , fNsteady(0)
+  , fNalloc(0)
+  , fNallocEvents(0)
+  , fLastAllocEvent(0)
+  , fActive(false)
+{
+  fStages.reserve(16);
+}
+
+//_____________________________________________________________________________
+void StageAllocStats::Clear()
+{
+  // Reset all counters. Keeps the list of stages.
+
+  for( auto& st : fStages ) {
+    st.start = st.event = st.total = st.steady = st.max = st.nevents = 0;
+    st.lastev = 0;
+  }
+  fNevents = fNsteady = fNalloc = fNallocEvents = 0;
+  fLastAllocEvent = 0;
+  fActive = false;
+}
+
+//_____________________________________________________________________________
+StageAllocStats::Stage_t* StageAllocStats::Find( const char* stage )
+{
+  // Find statistics of 'stage'. Linear search, there are only a few stages.
+
+  for( auto& st : fStages ) {
+    if( st.name == stage )
+      return &st;
+  }
+  return nullptr;
+}
+
+//_____________________________________________________________________________
+const StageAllocStats::Stage_t* StageAllocStats::GetStage( const char* stage ) const
+{
+  // Statistics of 'stage', or nullptr if no such stage was run
+
+  return const_cast<StageAllocStats*>(this)->Find(stage);
+}
+
+//_____________________________________________________________________________
+void StageAllocStats::Begin( const char* stage )
+{
+  // Start counting allocations for 'stage'
+
+  Stage_t* st = Find(stage);
+  if( !st ) {
+    fStages.emplace_back(stage);
+    st = &fStages.back();
+  }
+  st->start = AllocCounter::GetCount();
+  fActive = true;
+}
+
+//_____________________________________________________________________________
+void StageAllocStats::Stop( const char* stage )
+{
+  // Stop counting allocations for 'stage'. Stages may run several times
+  // per event.
+
+  Stage_t* st = Find(stage);
+  if( st )
+    st->event += AllocCounter::GetCount() - st->start;
+}
+
+//_____________________________________________________________________________
+void StageAllocStats::EndEvent( UInt_t evnum )
+{
+  // Close accounting for the current event 'evnum'. Does nothing if no
+  // stage ran since the last call.
+
+  if( !fActive )
+    return;
+  fActive = false;
+  Bool_t steady = (++fNevents > fWarmup);
+  if( steady )
+    ++fNsteady;
+  ULong64_t nalloc = 0;
+  for( auto& st : fStages ) {
+    if( st.event == 0 )
+      continue;
+    st.total += st.event;
+    st.lastev = evnum;
+    if( steady ) {
+      st.steady += st.event;
+      st.max = std::max(st.max, st.event);
+      ++st.nevents;
+      nalloc += st.event;
+    }
+    st.event = 0;
+  }
+  if( nalloc > 0 ) {
+    fNalloc += nalloc;
+    ++fNallocEvents;
+    fLastAllocEvent = evnum;
+  }
+}
+
+//_____________________________________________________________________________
+void StageAllocStats::Print() const
+{
+  // Print per-stage allocation summary
+
+  size_t w = 6;
+  for( const auto& st : fStages )
+    w = std::max(w, st.name.length());
+  cout << "Allocation summary (" << fNevents << " events, "
+       << std::min<ULong64_t>(fNevents, fWarmup) << " warm-up):" << endl;
+  cout << left << setw(SINT(w)) << "Stage" << right
+       << setw(12) << "total"
+       << setw(12) << "steady"
+       << setw(10) << "max/ev"
+       << setw(10) << "events"
+       << setw(11) << "last_ev" << endl;
+  for( const auto& st : fStages ) {
+    cout << left << setw(SINT(w)) << st.name << right
+         << setw(12) << st.total
+         << setw(12) << st.steady
+         << setw(10) << st.max
+         << setw(10) << st.nevents
+         << setw(11) << st.lastev << endl;
+  }
+  if( fNsteady > 0 ) {
+    if( fNalloc == 0 )
+      cout << "No allocations after warm-up" << endl;
+    else
+      cout << fNalloc << " allocations in " << fNallocEvents << " of "
+           << fNsteady << " events after warm-up, last in event "
+           << fLastAllocEvent << endl;
+  }
+}
+
+} // namespace Podd
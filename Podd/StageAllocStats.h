@@ -0,0 +1,68 @@
+#ifndef Podd_StageAllocStats_h_
+#define Podd_StageAllocStats_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::StageAllocStats
+//
+// Per-stage heap allocation accounting for the analysis event loop
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <string>
+#include <vector>
+
+namespace Podd {
+
+class StageAllocStats {
+public:
+  explicit StageAllocStats( UInt_t warmup = 10 );
+
+  void      Clear();
+  void      Begin( const char* stage );
+  void      Stop( const char* stage );
+  void      EndEvent( UInt_t evnum );
+  void      Print() const;
+
+  void      SetWarmup( UInt_t n ) { fWarmup = n; }
+  UInt_t    GetWarmup()     const { return fWarmup; }
+  ULong64_t GetNevents()    const { return fNevents; }
+  // Totals over all stages after the warm-up events
+  ULong64_t GetNsteady()    const { return fNsteady; }
+  ULong64_t GetNalloc()     const { return fNalloc; }
+  ULong64_t GetNallocEvents() const { return fNallocEvents; }
+  UInt_t    GetLastAllocEvent() const { return fLastAllocEvent; }
+
+  struct Stage_t {
+    explicit Stage_t( const char* _name )
+      : name(_name), start(0), event(0), total(0), steady(0), max(0),
+        nevents(0), lastev(0) {}
+    std::string name;    // Stage name
+    ULong64_t   start;   // Allocation count at Begin()
+    ULong64_t   event;   // Allocations in current event
+    ULong64_t   total;   // Allocations in all events
+    ULong64_t   steady;  // Allocations after warm-up
+    ULong64_t   max;     // Maximum allocations per event after warm-up
+    ULong64_t   nevents; // Events with allocations after warm-up
+    UInt_t      lastev;  // Last event number with allocations
+  };
+  const std::vector<Stage_t>& GetStages() const { return fStages; }
+  const Stage_t* GetStage( const char* stage ) const;
+
+private:
+  std::vector<Stage_t> fStages;         // Stages in order of first use
+  UInt_t    fWarmup;          // Number of warm-up events
+  ULong64_t fNevents;         // Number of events seen
+  ULong64_t fNsteady;         // Number of events after warm-up
+  ULong64_t fNalloc;          // Allocations after warm-up, all stages
+  ULong64_t fNallocEvents;    // Events with allocations after warm-up
+  UInt_t    fLastAllocEvent;  // Last event number with allocations
+  Bool_t    fActive;          // A stage ran since the last EndEvent
+
+  Stage_t*  Find( const char* stage );
+};
+
+} // namespace Podd
+
+#endif
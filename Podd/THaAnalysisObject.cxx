@@ -17,6 +17,7 @@
 #include "THaVarList.h"
 #include "THaGlobals.h"
 #include "TClass.h"
+#include "TMethod.h"
 #include "TDatime.h"
 #include "TROOT.h"
 #include "TMath.h"
@@ -24,6 +25,9 @@
 #include "TVector3.h"
 #include "TSystem.h"
 #include "TString.h"
+#include "Helper.h"
+#include "InitScheduler.h"
+#include "AnalysisContext.h"
 
 #include <cstring>
 #include <iostream>
@@ -35,11 +39,16 @@
 #include <iomanip>
 #include <type_traits>
 #include <limits>
+#include <algorithm>
+#include <mutex>
 
 using namespace std;
 using namespace Podd;
 
 TList* THaAnalysisObject::fgModules = nullptr;
+// Guards fgModules, which is shared by all analyses
+static mutex gModulesMutex;
+Bool_t THaAnalysisObject::fgCheckDBValidity = false;
 
 //_____________________________________________________________________________
 THaAnalysisObject::THaAnalysisObject( const char* name,
@@ -47,10 +56,11 @@ THaAnalysisObject::THaAnalysisObject( const char* name,
   TNamed(name,description), fPrefix(nullptr), fStatus(kNotinit),
   fDebug(0), fIsInit(false), fIsSetup(false), fProperties(0),
   fOKOut(false), fInitDate(19950101,0), fNEventsWithWarnings(0),
-  fExtra(nullptr)
+  fContext(Podd::AnalysisContext::Current()), fExtra(nullptr)
 {
   // Constructor
 
+  lock_guard<mutex> lock(gModulesMutex);
   if( !fgModules ) fgModules = new TList;
   fgModules->Add( this );
 }
@@ -59,7 +69,7 @@ THaAnalysisObject::THaAnalysisObject( const char* name,
 THaAnalysisObject::THaAnalysisObject()
   : fPrefix(nullptr), fStatus(kNotinit), fDebug(0), fIsInit(false),
     fIsSetup(false), fProperties(), fOKOut(false), fNEventsWithWarnings(0),
-    fExtra(nullptr)
+    fContext(Podd::AnalysisContext::Current()), fExtra(nullptr)
 {
   // only for ROOT I/O
 }
@@ -73,8 +83,15 @@ THaAnalysisObject::~THaAnalysisObject()
 
   delete fExtra; fExtra = nullptr;
 
+  lock_guard<mutex> lock(gModulesMutex);
   if (fgModules) {
     fgModules->Remove( this );
+    // Remove dangling references to this object
+    TIter next(fgModules);
+    while( TObject* obj = next() ) {
+      auto& used = static_cast<THaAnalysisObject*>(obj)->fUsedModules;
+      used.erase(remove(used.begin(), used.end(), this), used.end());
+    }
     if( fgModules->GetSize() == 0 ) {
       delete fgModules;
       fgModules = nullptr;
@@ -211,7 +228,11 @@ Int_t THaAnalysisObject::DefineVarsFromList( const void* list,
   // Actual implementation of the variable definition utility function.
   // Static function that can be used by classes other than THaAnalysisObjects
 
-  if( !gHaVars ) {
+  // Variables go to the list of the analysis the object belongs to
+  const auto* aobj = dynamic_cast<const THaAnalysisObject*>(obj);
+  THaVarList* vars = (aobj ? aobj->GetContext()
+                           : Podd::AnalysisContext::Current())->GetVars();
+  if( !vars ) {
     TString action;
     if( mode == kDefine )
       action = "defined";
@@ -224,12 +245,12 @@ Int_t THaAnalysisObject::DefineVarsFromList( const void* list,
 
   if( mode == kDefine ) {
     if( type == kVarDef )
-      gHaVars->DefineVariables( static_cast<const VarDef*>(list),
-				prefix, ::Here(here,prefix) );
+      vars->DefineVariables( static_cast<const VarDef*>(list),
+			     prefix, ::Here(here,prefix) );
     else if( type == kRVarDef )
-      gHaVars->DefineVariables(static_cast<const RVarDef*>(list), obj,
-                               prefix, ::Here(here, prefix), def_prefix,
-                               comment_subst);
+      vars->DefineVariables(static_cast<const RVarDef*>(list), obj,
+                            prefix, ::Here(here, prefix), def_prefix,
+                            comment_subst);
   }
   else if( mode == kDelete ) {
     if( type == kVarDef ) {
@@ -237,7 +258,7 @@ Int_t THaAnalysisObject::DefineVarsFromList( const void* list,
       while( item && item->name ) {
 	TString name(prefix);
 	name.Append( item->name );
-	gHaVars->RemoveName( name );
+	vars->RemoveName( name );
 	++item;
       }
     } else if( type == kRVarDef ) {
@@ -245,7 +266,7 @@ Int_t THaAnalysisObject::DefineVarsFromList( const void* list,
       while( item && item->name ) {
 	TString name(prefix);
 	name.Append( item->name );
-	gHaVars->RemoveName( name );
+	vars->RemoveName( name );
 	++item;
       }
     }
@@ -281,25 +302,32 @@ THaAnalysisObject* THaAnalysisObject::FindModule( const char* name,
     return nullptr;
   }
 
-  // Find the module in the list, comparing 'name' to the module's fPrefix
-  TIter next(fgModules);
+  // Find the module in the list, comparing 'name' to the module's fPrefix.
+  // Only modules of the same analysis are considered.
+  Podd::InitScheduler::Lock lock;
   TObject* obj = nullptr;
-  while( (obj = next()) ) {
+  {
+    lock_guard<mutex> modlock(gModulesMutex);
+    TIter next(fgModules);
+    while( (obj = next()) ) {
 #ifdef NDEBUG
-    auto* module = static_cast<THaAnalysisObject*>(obj);
+      auto* module = static_cast<THaAnalysisObject*>(obj);
 #else
-    auto* module = dynamic_cast<THaAnalysisObject*>(obj);
-    assert(module);
+      auto* module = dynamic_cast<THaAnalysisObject*>(obj);
+      assert(module);
 #endif
-    TString prefix = module->GetPrefixName();
-    if( prefix.IsNull() ) {
-      module->MakePrefix();
-      prefix = module->GetPrefixName();
-      if( prefix.IsNull() )
-	continue;
+      if( module->fContext != fContext )
+        continue;
+      TString prefix = module->GetPrefixName();
+      if( prefix.IsNull() ) {
+        module->MakePrefix();
+        prefix = module->GetPrefixName();
+        if( prefix.IsNull() )
+          continue;
+      }
+      if( prefix == name )
+        break;
     }
-    if( prefix == name )
-      break;
   }
   if( !obj ) {
     if( do_error )
@@ -327,6 +355,8 @@ THaAnalysisObject* THaAnalysisObject::FindModule( const char* name,
   }
   auto* aobj = static_cast<THaAnalysisObject*>( obj );
   if( do_error ) {
+    // During parallel initialization, the module may still be in progress
+    Podd::InitScheduler::WaitFor(aobj);
     if( !aobj->IsOK() ) {
       Error( Here(here), "Module %s (%s) not initialized.",
 	     obj->GetName(), obj->GetTitle() );
@@ -334,6 +364,10 @@ THaAnalysisObject* THaAnalysisObject::FindModule( const char* name,
       return nullptr;
     }
   }
+  // Record the dependency for the analyzer's module pruning
+  if( aobj != this &&
+      find(ALL(fUsedModules), aobj) == fUsedModules.end() )
+    fUsedModules.push_back(aobj);
   return aobj;
 }
 
@@ -433,8 +467,22 @@ THaAnalysisObject::EStatus THaAnalysisObject::Init( const TDatime& date )
   MakePrefix();
 
   // Skip reinitialization if there is no (relevant) date change.
-  if( DBDatesDiffer(date, fInitDate) ) {
+  // If enabled, also skip it if the database files read last time
+  // have no changes for the new date.
+  bool reload = DBDatesDiffer(date, fInitDate) &&
+    (!fgCheckDBValidity || Podd::DBInputsDiffer(fDBFiles, fInitDate, date));
+  if( reload ) {
+    // Don't bother if this object has not implemented its own database reader.
+    bool has_reader = ( IsA()->GetMethodAllAny("ReadDatabase") !=
+          gROOT->GetClass("THaAnalysisObject")->GetMethodAllAny("ReadDatabase") );
+    fDBFiles.clear();
+    Podd::DBFileRecords dbfiles;
     try {
+      // Database reading may run concurrently with the initialization of
+      // other modules if this class allows it (see Podd::InitScheduler)
+      Podd::InitScheduler::Unlock parallel( CanReadDBConcurrently() );
+      Podd::DBFileRecorder recorder(dbfiles);
+
       // Open the run database and call the reader. If database cannot be opened,
       // fail only if this object needs the run database
       // Call this object's actual database reader
@@ -444,9 +492,7 @@ THaAnalysisObject::EStatus THaAnalysisObject::Init( const TDatime& date )
       }
 
       // Read the database for this object.
-      // Don't bother if this object has not implemented its own database reader.
-      if( IsA()->GetMethodAllAny("ReadDatabase") !=
-          gROOT->GetClass("THaAnalysisObject")->GetMethodAllAny("ReadDatabase") ) {
+      if( has_reader ) {
 
         // Call this object's actual database reader
         if( (status = ReadDatabase(date)) )
@@ -475,8 +521,9 @@ THaAnalysisObject::EStatus THaAnalysisObject::Init( const TDatime& date )
             e.what());
       return fStatus = kInitError;
     }
+    fDBFiles = std::move(dbfiles);
   } else if( fDebug > 1 ) {
-    Info(Here(here), "Not re-reading database for same date.");
+    Info(Here(here), "Not re-reading unchanged database.");
   }
 
   // Save the last successful initialization date. This is used to prevent
@@ -550,6 +597,28 @@ Int_t THaAnalysisObject::ReadDatabase( const TDatime& /* date */ )
   return kOK;
 }
 
+//_____________________________________________________________________________
+Bool_t THaAnalysisObject::CanReadDBConcurrently() const
+{
+  // Check if this object's database readers may run concurrently with the
+  // initialization of other modules. The class that declares this with
+  // IsDBReadThreadSafe() must be the one defining the readers or derive
+  // from it. A derived class with its own readers must declare it again.
+
+  if( !IsDBReadThreadSafe() )
+    return false;
+  TClass* cl = IsA();
+  TMethod* optin = cl->GetMethodAllAny("IsDBReadThreadSafe");
+  if( !optin )
+    return false;
+  for( const char* reader : { "ReadDatabase", "ReadRunDatabase" } ) {
+    TMethod* m = cl->GetMethodAllAny(reader);
+    if( m && !optin->GetClass()->InheritsFrom(m->GetClass()) )
+      return false;
+  }
+  return true;
+}
+
 //_____________________________________________________________________________
 Int_t THaAnalysisObject::ReadRunDatabase( const TDatime& date )
 {
@@ -854,11 +923,28 @@ void THaAnalysisObject::Print( Option_t* opt ) const
   }
 }
 
+//_____________________________________________________________________________
+void THaAnalysisObject::ForceDBReload()
+{
+  // Make all existing analysis objects re-read their databases at the next
+  // call to Init(), even if the date has not changed. Useful when database
+  // files are modified between analysis passes over the same run.
+
+  lock_guard<mutex> lock(gModulesMutex);
+  TIter next(fgModules);
+  while( TObject* obj = next() ) {
+    auto* module = static_cast<THaAnalysisObject*>(obj);
+    module->fInitDate.Set(19950101,0);
+    module->fDBFiles.clear();
+  }
+}
+
 //_____________________________________________________________________________
 void THaAnalysisObject::PrintObjects( Option_t* opt )
 {
   // Print all defined analysis objects (useful for debugging)
 
+  lock_guard<mutex> lock(gModulesMutex);
   TIter next(fgModules);
   while( TObject* obj = next() ) {
     obj->Print(opt);
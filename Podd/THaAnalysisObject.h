@@ -15,6 +15,7 @@
 #include "OptionalType.h"
 
 #include <vector>
+#include <set>
 #include <string>
 #include <cstdio>
 #include <map>
@@ -27,6 +28,10 @@ class TVector3;
 class THaRunBase;
 class THaOutput;
 class TObjArray;
+class THaVar;
+namespace Podd {
+  class AnalysisContext;
+}
 
 class THaAnalysisObject : public TNamed {
   
@@ -49,6 +54,8 @@ public:
   virtual const char*  GetDBFileName() const;
           const char*  GetClassName() const;
           const char*  GetConfig() const         { return fConfig.Data(); }
+  // Analysis this object belongs to (the one current at construction)
+  Podd::AnalysisContext* GetContext() const      { return fContext; }
           Int_t        GetDebug() const          { return fDebug; }
           const char*  GetPrefix() const         { return fPrefix; }
           TString      GetPrefixName() const;
@@ -58,6 +65,34 @@ public:
           Bool_t       IsOK() const              { return (fStatus == kOK); }
 
 	  TDatime      GetInitDate() const       { return fInitDate; }
+  // Modules this object obtained via FindModule()
+  const std::vector<THaAnalysisObject*>&
+                       GetUsedModules() const    { return fUsedModules; }
+  // Called by the analyzer's dependency analysis with those of this
+  // object's global variables that are used by output, cuts or histograms.
+  // 'all' is true if other modules depend on this object directly, or if
+  // pruning is disabled. Objects may skip optional computations whose
+  // results are unused, e.g. THaVDC the target reconstruction.
+  virtual void         SetUsedOutputs( const std::set<const THaVar*>& /*vars*/,
+                                       Bool_t /*all*/ ) {}
+  // Crates and slots whose decoded data this object reads, for selective
+  // decoding. A slot of kMaxUInt stands for all slots of the crate.
+  // Returns false if not known, in which case all crates are decoded.
+  // Only classes that list every channel they read may return true;
+  // derived classes reading further channels must override again.
+  using CrateSlots_t = std::set<std::pair<UInt_t,UInt_t>>;
+  virtual Bool_t       GetUsedCrateSlots( CrateSlots_t& /*crateslots*/ ) const
+  { return false; }
+  // True if this object reads words of the raw physics event buffer
+  // (THaEvData::GetRawData(crate,i), GetRocLength etc.), not just hits
+  virtual Bool_t       UsesRawEventData() const { return false; }
+  // Event-to-event state, for checkpointing a replay (see
+  // THaAnalyzer::SetCheckpointInterval). Objects whose results depend on
+  // earlier events implement these. SaveState() leaves 'state' empty if
+  // there is nothing to save. RestoreState() returns non-zero on error.
+  virtual void         SaveState( std::vector<Double_t>& /*state*/ ) const {}
+  virtual Int_t        RestoreState( const std::vector<Double_t>& /*state*/ )
+  { return 0; }
 
           void         SetConfig( const char* label );
   virtual void         SetDebug( Int_t level );
@@ -103,6 +138,13 @@ public:
                                       const char* comment_subst = "" );
 
   static void     PrintObjects( Option_t* opt="" );
+  static const TList* GetModuleList() { return fgModules; }
+  // Make all objects re-read their databases at the next Init()
+  static void     ForceDBReload();
+  // Skip re-reading databases at Init() for a new date if the database
+  // files read previously have no changes for that date
+  static void     EnableDBValidityCheck( Bool_t b = true ) { fgCheckDBValidity = b; }
+  static Bool_t   DBValidityCheckEnabled() { return fgCheckDBValidity; }
 
 protected:
 
@@ -121,6 +163,9 @@ protected:
 
   std::map<std::string,UInt_t> fMessages; // Warning messages & count
   UInt_t          fNEventsWithWarnings;   // Events with warnings
+  std::vector<THaAnalysisObject*> fUsedModules; //! Modules found via FindModule
+  Podd::DBFileRecords fDBFiles; //! Database files read at last Init
+  Podd::AnalysisContext* fContext; //! Analysis this object belongs to
 
   TObject*        fExtra;     // Additional member data (for binary compat.)
 
@@ -150,6 +195,11 @@ protected:
   virtual void         MakePrefix();
   virtual Int_t        ReadDatabase( const TDatime& date );
   virtual Int_t        ReadRunDatabase( const TDatime& date );
+  // True if ReadRunDatabase() and ReadDatabase() of this class only modify
+  // this object, so they may run concurrently with the initialization of
+  // other modules (see Podd::InitScheduler). Ignored unless declared by
+  // the class that defines the database readers, or a class derived from it.
+  virtual Bool_t       IsDBReadThreadSafe() const { return false; }
           Int_t        RemoveVariables();
 
 #ifdef WITH_DEBUG
@@ -163,9 +213,11 @@ protected:
   THaAnalysisObject( const char* name, const char* description );
 
 private:
-  Int_t DefineVariablesWrapper( EMode mode = kDefine );
+  Int_t  DefineVariablesWrapper( EMode mode = kDefine );
+  Bool_t CanReadDBConcurrently() const;
 
   static TList* fgModules;  // List of all currently existing Analysis Modules
+  static Bool_t fgCheckDBValidity;  // Check database changes (see Init)
 
   ClassDef(THaAnalysisObject,2)   //ABC for a data analysis object
 };
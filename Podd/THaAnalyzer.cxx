@@ -25,6 +25,7 @@
 #include "THaEvData.h"
 #include "THaGlobals.h"
 #include "THaSpectrometer.h"
+#include "THaApparatus.h"
 #include "THaCutList.h"
 #include "THaPhysicsModule.h"
 #include "InterStageModule.h"
@@ -32,8 +33,21 @@
 #include "THaBenchmark.h"
 #include "THaEvtTypeHandler.h"
 #include "THaEpicsEvtHandler.h"
+#include "AllocCounter.h"
+#include "StageAllocStats.h"
+#include "THaCut.h"
+#include "THaVar.h"
+#include "THaVarList.h"
+#include "EventCache.h"
+#include "InitScheduler.h"
+#include "THaCodaRun.h"
+#include "MultiFileRun.h"
+#include "ShardInfo.h"
+#include "Checkpoint.h"
+#include "AnalysisContext.h"
 #include "TList.h"
 #include "TTree.h"
+#include "TH1.h"
 #include "TFile.h"
 #include "TDatime.h"
 #include "TError.h"
@@ -41,6 +55,7 @@
 #include "TSystem.h"
 #include "TROOT.h"
 #include "TDirectory.h"
+#include "TKey.h"
 #include "THaCrateMap.h"
 #include "Helper.h"
 
@@ -50,6 +65,11 @@
 #include <stdexcept>
 #include <algorithm>
 #include <vector>
+#include <set>
+#include <cstring>
+#include <cassert>
+#include <memory>
+#include <mutex>
 
 using namespace std;
 using namespace Decoder;
@@ -57,10 +77,14 @@ using namespace Podd;
 
 const char* const THaAnalyzer::kMasterCutName = "master";
 const char* const THaAnalyzer::kDefaultOdefFile = "output.def";
+const char* const THaAnalyzer::kShardInfoName = "Shard_Info";
 
-// Pointer to single instance of this object
+// Pointer to the instance of this object using the global lists
 THaAnalyzer* THaAnalyzer::fgAnalyzer = nullptr;
 
+// Serializes initialization of concurrent analyses
+static mutex gInitMutex;
+
 //FIXME:
 // do we need to "close" scalers/EPICS analysis if we reach the event limit?
 
@@ -89,7 +113,7 @@ inline size_t ListToVector( TList* lst, vector<T*>& vec )
 }
 
 //_____________________________________________________________________________
-THaAnalyzer::THaAnalyzer()
+THaAnalyzer::THaAnalyzer( Podd::AnalysisContext* ctx )
   : fFile(nullptr)
   , fOutput(nullptr)
   , fEpicsHandler(nullptr)
@@ -105,29 +129,62 @@ THaAnalyzer::THaAnalyzer()
   , fPrevEvent(nullptr)
   , fRun(nullptr)
   , fEvData(nullptr)
+  , fModuleBudget(0)
+  , fMaxBudgetWarn(10)
+  , fInitThreads(1)
+  , fDecodeThreads(1)
+  , fEventCache(nullptr)
+  , fAllocStats(nullptr)
+  , fAllocWarmup(10)
+  , fShard(0)
+  , fNshards(0)
+  , fShardMode(kShardEvents)
+  , fShardNevents(0)
+  , fShardWarmup(kMaxUInt)
+  , fShardFirst(0)
+  , fShardState(kShardActive)
+  , fShardStart(nullptr)
+  , fCkptInterval(0)
+  , fCkptMinTime(0)
+  , fNread(0)
+  , fNextCkpt(kMaxULong64)
+  , fLastCkptTime(0)
+  , fResumeCkpt(nullptr)
+  , fContext(ctx ? ctx : Podd::AnalysisContext::Current())
   , fIsInit(false)
   , fAnalysisStarted(false)
   , fLocalEvent(false)
   , fUpdateRun(true)
   , fOverwrite(true)
   , fDoBench(false)
+  , fDoModuleBench(false)
   , fDoHelicity(false)
   , fDoPhysics(true)
   , fDoOtherEvents(true)
   , fDoSlowControl(true)
+  , fDoPruning(false)
+  , fDoCrateSel(false)
+  , fDoLazyDecode(false)
+  , fReplayCache(false)
+  , fDoResume(false)
   , fFirstPhysics(true)
   , fExtra(nullptr)
 {
-  // Default constructor.
-
-  //FIXME: relax this
-  // Allow only one analyzer object (because we use various global lists)
-  if( fgAnalyzer ) {
-    Error("THaAnalyzer", "only one instance of THaAnalyzer allowed.");
+  // Constructor. The analyzer uses the lists, run and decoder class of the
+  // given analysis context. By default, this is the current context, i.e.
+  // the global lists, unless another context has been made current.
+
+  // Allow only one analyzer object per context (because it uses the
+  // context's lists)
+  if( fContext->GetAnalyzer() ) {
+    Error("THaAnalyzer", "only one instance of THaAnalyzer allowed "
+          "per analysis context.");
     MakeZombie();
     return;
   }
-  fgAnalyzer = this;
+  fContext->SetAnalyzer(this);
+  if( fContext->IsDefault() )
+    fgAnalyzer = this;
 
   // EPICS data
   fEpicsHandler = new THaEpicsEvtHandler("epics","EPICS event type");
@@ -148,11 +205,25 @@ THaAnalyzer::~THaAnalyzer()
   DeleteContainer(fEvtHandlers);
   DeleteContainer(fInterStage);
   delete fExtra; fExtra = nullptr;
+  delete fEventCache;
+  delete fAllocStats;
+  delete fShardStart;
+  delete fResumeCkpt;
   delete fBench;
+  if( fContext->GetAnalyzer() == this )
+    fContext->SetAnalyzer(nullptr);
   if( fgAnalyzer == this )
     fgAnalyzer = nullptr;
 }
 
+//_____________________________________________________________________________
+THaAnalyzer* THaAnalyzer::GetInstance()
+{
+  // Return the analyzer of the current analysis context, if any
+
+  return Podd::AnalysisContext::Current()->GetAnalyzer();
+}
+
 //_____________________________________________________________________________
 Int_t THaAnalyzer::AddInterStage( Podd::InterStageModule* module )
 {
@@ -243,6 +314,9 @@ void THaAnalyzer::Close()
   // Close output files and delete fOutput, fFile, and fRun objects.
   // Also delete fEvent if it was allocated automatically by us.
 
+  // The decoder removes its global variables from our context
+  Podd::AnalysisContext::Scope scope(fContext);
+
   // Close all Post-process objects, but do not delete them
   // (destructor does that)
   for( auto* postProc : fPostProcess)
@@ -253,9 +327,13 @@ void THaAnalyzer::Close()
   fSpectrometers.clear();
   fPhysics.clear();
   fEvtHandlers.clear();
+  fAnalysisModules.clear();
+  fModuleStats.clear();
+  fSpectroIdx.clear();
 
-  if( gHaRun && *gHaRun == *fRun )
-    gHaRun = nullptr;
+  THaRunBase* ctx_run = fContext->GetRun();
+  if( ctx_run && *ctx_run == *fRun )
+    fContext->SetRun(nullptr);
 
   delete fEvData; fEvData = nullptr;
   delete fOutput; fOutput = nullptr;
@@ -269,6 +347,109 @@ void THaAnalyzer::Close()
   fIsInit = fAnalysisStarted = false;
 }
 
+//_____________________________________________________________________________
+Int_t THaAnalyzer::SwitchOutputFile( const char* name )
+{
+  // Continue the analysis with a new output file 'name'. Call this between
+  // two Process() calls to write each run to its own file without closing
+  // the analysis. Modules, output definitions, formulas, cuts and
+  // histograms are kept. All trees and histograms in the current output
+  // file are cleared and moved to the new file, which replaces the current
+  // one. Event and cut counters are reset.
+  // If no analysis is in progress, this is equivalent to SetOutFile(name).
+
+  static const char* const here = "SwitchOutputFile";
+
+  if( !name || !*name ) {
+    Error( here, "Must specify an output file name." );
+    return -12;
+  }
+  if( !fAnalysisStarted || !fFile ) {
+    SetOutFile(name);
+    return 0;
+  }
+  // The tree may have switched files (see Process())
+  if( fOutput && fOutput->GetTree() )
+    fFile = fOutput->GetTree()->GetCurrentFile();
+  if( fOutFileName == name || !strcmp(fFile->GetName(), name) ) {
+    Error( here, "New output file name %s is the same as the current one.",
+           name );
+    return -11;
+  }
+  if( !gSystem->AccessPathName(name) ) { //sic
+    if( !fOverwrite ) {
+      Error( here, "Output file %s already exists. Choose a different "
+             "file name or enable overwriting with EnableOverwrite().", name );
+      return -13;
+    }
+    cout << "Overwriting existing";
+  } else
+    cout << "Creating new";
+  cout << " output file: " << name << endl;
+
+  TDirectory* olddir = gDirectory;
+  auto* file = new TFile( name, "RECREATE" );
+  if( file->IsZombie() ) {
+    Error( here, "failed to create output file %s. Check file/directory "
+           "permissions.", name );
+    delete file;
+    olddir->cd();
+    return -14;
+  }
+  file->SetCompressionLevel(fCompress);
+
+  // Move everything that modules or the output expect to persist.
+  // SetDirectory() modifies the list, so iterate over a copy.
+  vector<TObject*> objs;
+  TIter next( fFile->GetList() );
+  while( TObject* obj = next() )
+    objs.push_back(obj);
+  for( auto* obj : objs ) {
+    if( auto* tree = dynamic_cast<TTree*>(obj) ) {
+      tree->Reset();
+      tree->SetDirectory(file);
+    } else if( auto* hist = dynamic_cast<TH1*>(obj) ) {
+      hist->Reset();
+      hist->SetDirectory(file);
+    }
+  }
+  if( olddir == fFile )
+    olddir = file;
+  delete fFile;
+  fFile = file;
+  fOutFileName = name;
+  olddir->cd();
+
+  ClearCounters();
+  fContext->GetCuts()->Reset();
+  for( auto& st : fModuleStats )
+    st.Clear();
+  if( fAllocStats )
+    fAllocStats->Clear();
+  return 0;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableAllocTracking( Bool_t b )
+{
+  // Enable/disable per-stage heap allocation accounting.
+  //
+  // Counts the allocations made in each stage of the event loop
+  // ("RawDecode", "EvtHandlers", "Decode", ..., "Output"). The first
+  // events (see SetAllocWarmup()) are excluded from the steady-state
+  // statistics. After warm-up, the standard analysis chain should make
+  // no allocations per event, except in "Output" when the output tree
+  // flushes its baskets. Results are reported with the timing summary.
+  // Per-module counts are collected with EnableModuleBenchmarks().
+
+  if( b && !fAllocStats )
+    fAllocStats = new Podd::StageAllocStats(fAllocWarmup);
+  else if( !b ) {
+    delete fAllocStats;
+    fAllocStats = nullptr;
+  }
+  AllocCounter::Enable(b || fDoModuleBench);
+}
 
 //_____________________________________________________________________________
 void THaAnalyzer::EnableBenchmarks( Bool_t b )
@@ -276,12 +457,77 @@ void THaAnalyzer::EnableBenchmarks( Bool_t b )
   fDoBench = b;
 }
 
+//_____________________________________________________________________________
+void THaAnalyzer::EnableCrateSelection( Bool_t b )
+{
+  // Enable/disable selective decoding (disabled by default). If enabled,
+  // the decoder skips the data of crates that no active analysis module
+  // reads. See SelectCrates(). Only modules that override
+  // GetUsedCrateSlots() to list every channel they read allow a selection;
+  // any other active module causes all crates to be decoded.
+
+  fDoCrateSel = b;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableEventCache( Bool_t b )
+{
+  // Enable/disable the in-memory event cache.
+  //
+  // When enabled, the raw events read by Process() are kept in memory
+  // (see Podd::EventCache for the memory limit and spill options).
+  // Subsequent calls to Process() for the same run replay the cached
+  // events without accessing the input file. Before each such replay,
+  // all modules re-read their databases, so modified calibration
+  // parameters take effect. The cache is kept across Close().
+  // Disabling the cache frees its memory.
+
+  if( b && !fEventCache )
+    fEventCache = new Podd::EventCache;
+  else if( !b ) {
+    delete fEventCache;
+    fEventCache = nullptr;
+  }
+}
+
 //_____________________________________________________________________________
 void THaAnalyzer::EnableHelicity( Bool_t b )
 {
   fDoHelicity = b;
 }
 
+//_____________________________________________________________________________
+void THaAnalyzer::EnableLazyDecoding( Bool_t b )
+{
+  // Enable/disable lazy decoding (see THaEvData::EnableLazyDecoding).
+  // Crates are then decoded only when an analysis module first reads
+  // their data. Events rejected by early cuts skip most of the decoding.
+
+  fDoLazyDecode = b;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnableModuleBenchmarks( Bool_t b )
+{
+  // Enable/disable per-module timing and allocation accounting.
+  // Results are reported with the timing summary and written to the
+  // output file as tree "ModuleStats".
+
+  fDoModuleBench = b;
+  AllocCounter::Enable(b || fAllocStats != nullptr);
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EnablePruning( Bool_t b )
+{
+  // Enable/disable dependency-driven pruning of analysis modules.
+  // If enabled, apparatuses and physics modules whose results are not
+  // used by the output, the cuts or other needed modules are skipped
+  // during event processing. See PruneModules() for details.
+
+  fDoPruning = b;
+}
+
 //_____________________________________________________________________________
 void THaAnalyzer::EnableRunUpdate( Bool_t b )
 {
@@ -321,7 +567,7 @@ bool THaAnalyzer::EvalStage( int n )
   // If event is skipped, increment associated statistics counter.
   // Call InitCuts() before using!  This is an internal function.
 
-  if( fDoBench ) fBench->Begin("Cuts");
+  BeginStage("Cuts");
 
   const Stage_t& theStage = fStages[n];
 
@@ -340,7 +586,7 @@ bool THaAnalyzer::EvalStage( int n )
       ret = false;
     }
   }
-  if( fDoBench ) fBench->Stop("Cuts");
+  StopStage("Cuts");
   return ret;
 }
 
@@ -364,7 +610,7 @@ void THaAnalyzer::InitStages()
   // stages or additional stages. This should be done with caution.
 
   if( !fStages.empty() )  return;
-  fStages.reserve(kPhysics - kRawDecode + 1);
+  fStages.reserve(kPreDecode - kRawDecode + 1);
   fStages = {
     {kRawDecode,   kRawDecodeTest,   "RawDecode"},
     {kDecode,      kDecodeTest,      "Decode"},
@@ -372,7 +618,8 @@ void THaAnalyzer::InitStages()
     {kCoarseRecon, kCoarseReconTest, "CoarseReconstruct"},
     {kTracking,    kTrackTest,       "Tracking"},
     {kReconstruct, kReconstructTest, "Reconstruct"},
-    {kPhysics,     kPhysicsTest,     "Physics"}
+    {kPhysics,     kPhysicsTest,     "Physics"},
+    {kPreDecode,   kPreDecodeTest,   "PreDecode"}
   };
 }
 
@@ -382,7 +629,7 @@ void THaAnalyzer::InitCounters() {
   // See notes for InitStages() for additional information.
 
   if( !fCounters.empty() ) return;
-  fCounters.reserve(kPhysicsTest - kNevRead + 1);
+  fCounters.reserve(kPreDecodeTest - kNevRead + 1);
   fCounters = {
     {kNevRead,         "events read"},
     {kNevGood,         "events decoded"},
@@ -400,7 +647,8 @@ void THaAnalyzer::InitCounters() {
     {kCoarseReconTest, "skipped after Coarse Reconstruct"},
     {kTrackTest,       "skipped after Tracking"},
     {kReconstructTest, "skipped after Reconstruct"},
-    {kPhysicsTest,     "skipped after Physics"}
+    {kPhysicsTest,     "skipped after Physics"},
+    {kPreDecodeTest,   "skipped by PreDecode test"}
   };
 }
 
@@ -414,16 +662,40 @@ void THaAnalyzer::InitCuts()
 
   for( auto& theStage : fStages ) {
     // If block not found, this will return nullptr and work just fine later.
-    theStage.cut_list = gHaCuts->FindBlock( theStage.name );
+    theStage.cut_list = fContext->GetCuts()->FindBlock( theStage.name );
 
     if( theStage.cut_list ) {
       TString master_cut( theStage.name );
       master_cut.Append( '_' );
       master_cut.Append( kMasterCutName );
-      theStage.master_cut = gHaCuts->FindCut( master_cut );
+      theStage.master_cut = fContext->GetCuts()->FindCut( master_cut );
     } else
       theStage.master_cut = nullptr;
   }
+
+  // If there are "PreDecode" tests, let the decoder run them on the event
+  // header data so that rejected events are never decoded
+  if( fEvData ) {
+    if( fStages.size() > kPreDecode && fStages[kPreDecode].cut_list )
+      fEvData->SetHeaderFilter(
+        [this]( const THaEvData* ) { return TestEventHeader(); });
+    else
+      fEvData->SetHeaderFilter(nullptr);
+  }
+}
+
+//_____________________________________________________________________________
+bool THaAnalyzer::TestEventHeader()
+{
+  // Evaluate the "PreDecode" test block for the current event. Called by the
+  // decoder when only the event header data are available. The tests should
+  // therefore only use header variables like g.evtyp, g.evnum and
+  // g.trigbits. Returns false if the event is to be skipped.
+
+  // Start with fresh test results since this runs before the per-event
+  // ClearAll() in the event loop
+  fContext->GetCuts()->ClearAll();
+  return EvalStage(kPreDecode);
 }
 
 //_____________________________________________________________________________
@@ -431,37 +703,56 @@ Int_t THaAnalyzer::InitModules(
   const std::vector<THaAnalysisObject*>& module_list, TDatime& run_time )
 {
   // Initialize a list of THaAnalysisObjects for time 'run_time'.
-  // If 'baseclass' given, ensure that each object in the list inherits
-  // from 'baseclass'.
+  // With SetInitThreads(n > 1), independent modules read their databases
+  // in parallel (see Podd::InitScheduler). Per-module initialization
+  // times are printed if fVerbose > 1 or benchmarks are enabled.
 
   static const char* const here = "InitModules()";
 
-  Int_t retval = 0;
-  for( auto it = module_list.begin(); it != module_list.end(); ) {
-    auto* theModule = *it;
-    if( fVerbose > 1 )
-      cout << "Initializing " << theModule->GetName() << endl;
-    try {
-      retval = theModule->Init( run_time );
+  Podd::InitScheduler sched(fInitThreads, fVerbose);
+  Int_t retval = sched.Run(module_list, run_time);
+  if( fVerbose > 1 || fDoBench )
+    sched.Print();
+  if( retval != kOK ) {
+    for( const auto& res : sched.GetResults() ) {
+      THaAnalysisObject* theModule = res.module;
+      if( !res.exception.empty() ) {
+        Error(here, "Exception %s caught during initialization of module "
+              "%s (%s). Analyzer initialization failed.",
+              res.exception.c_str(), theModule->GetName(),
+              theModule->GetTitle() );
+      } else if( res.status != kOK || !theModule->IsOK() ) {
+        Error( here, "Error %d initializing module %s (%s). "
+               "Analyzer initialization failed.",
+               res.status, theModule->GetName(), theModule->GetTitle() );
+      } else
+        continue;
+      break;
     }
-    catch( const exception& e ) {
-      Error(here, "Exception %s caught during initialization of module "
-	     "%s (%s). Analyzer initialization failed.",
-            e.what(), theModule->GetName(), theModule->GetTitle() );
+  }
+  return retval;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::CheckRawDataAccess(
+  const std::vector<THaAnalysisObject*>& module_list, THaRunBase* run )
+{
+  // Refuse modules that read raw physics event words if the run cannot
+  // provide the raw buffers, e.g. a hit cache written without
+  // HitCacheWriter::SetRawPhysics(). Such modules would silently get zeros.
+
+  if( !run || run->HasRawPhysicsData() )
+    return 0;
+  Int_t retval = 0;
+  for( const auto* theModule : module_list ) {
+    if( theModule->UsesRawEventData() ) {
+      Error( "CheckRawDataAccess", "Module %s (%s) reads raw event words, "
+             "but run %s has no raw physics event data. Analyzer "
+             "initialization failed.", theModule->GetName(),
+             theModule->GetTitle(), run->GetName() );
       retval = -1;
-      goto errexit;
-    }
-    if( retval != kOK || !theModule->IsOK() ) {
-      Error( here, "Error %d initializing module %s (%s). "
-             "Analyzer initialization failed.",
-            retval, theModule->GetName(), theModule->GetTitle() );
-      if( retval == kOK )
-	retval = -1;
-      break;
     }
-    ++it;
   }
- errexit:
   return retval;
 }
 
@@ -473,6 +764,13 @@ Int_t THaAnalyzer::Init( THaRunBase* run )
   // This is a wrapper, so we can conveniently control the benchmark counter
   if( !run ) return -1;
 
+  // Modules set up during initialization use our context's lists.
+  // Initialization of analyses in different contexts is serialized since
+  // it uses process-wide resources (module list, crate maps, databases)
+  // and since only one parallel module initialization may run at a time.
+  Podd::AnalysisContext::Scope scope(fContext);
+  std::lock_guard<std::mutex> lock(gInitMutex);
+
   if( !fIsInit ) fBench->Reset();
   fBench->Begin("Total");
 
@@ -624,17 +922,33 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
   }
 
   //--- Create our decoder from the TClass specified by the user.
+  //    Runs whose event buffers are not raw CODA data (e.g.
+  //    Podd::HitCacheRun) determine the decoder themselves.
   bool new_decoder = false;
-  if( !fEvData || fEvData->IsA() != gHaDecoder ) {
+  TClass* decoder_class = fContext->GetDecoderClass();
+  TClass* run_decoder = run->GetRequiredDecoder();
+  if( run_decoder &&
+      !(decoder_class && decoder_class->InheritsFrom(run_decoder)) )
+    decoder_class = run_decoder;
+  if( !fEvData || fEvData->IsA() != decoder_class ) {
     delete fEvData; fEvData = nullptr;
-    if( gHaDecoder )
-      fEvData = static_cast<THaEvData*>(gHaDecoder->New());
+    if( decoder_class )
+      fEvData = static_cast<THaEvData*>(decoder_class->New());
     if( !fEvData ) {
       Error( here, "Failed to create decoder object. "
 	     "Something is very wrong..." );
       return -241;
     }
     new_decoder = true;
+    if( run_decoder )
+      Info( here, "Using decoder %s for run %s", decoder_class->GetName(),
+            run->GetName() );
+  }
+  if( !run_decoder && !fEvData->ReadsRawData() ) {
+    Error( here, "Decoder %s cannot read raw data of run %s. Select a "
+           "decoder for raw CODA data.", fEvData->IsA()->GetName(),
+           run->GetName() );
+    return -244;
   }
   // Set run-level info that was retrieved when initializing the run.
   // In case we analyze a continuation segment, fEvtData may not see
@@ -645,8 +959,15 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
 
   // Deal with the run.
   bool new_run   = ( !fRun || *fRun != *run );
+
+  // Replay from the event cache if it holds this run. Force the modules
+  // to re-read their databases, which may have changed since the last pass.
+  fReplayCache = ( fEventCache && fEventCache->Matches(run) );
+  if( fReplayCache )
+    THaAnalysisObject::ForceDBReload();
+
   bool need_init = ( !fIsInit || new_event || new_output || new_run ||
-		     new_decoder || run_init );
+		     new_decoder || run_init || fReplayCache );
 
 #if 0
   // Warn user if trying to analyze the same run twice with overlapping
@@ -687,9 +1008,9 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
     *fRun = *run;  // Copy the run via its virtual operator=
   }
 
-  // Make the current run available globally - the run parameters are
-  // needed by some modules
-  gHaRun = fRun;
+  // Make the current run available to the modules of this analysis - the
+  // run parameters are needed by some modules
+  fContext->SetRun(fRun);
 
   // Print run info
   if( fVerbose>0 ) {
@@ -736,12 +1057,12 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
   // Tell the decoder about the run's CODA version
   fEvData->SetDataVersion( run->GetDataVersion() );
 
-  // Use the global lists of analysis objects.
+  // Use the lists of analysis objects of our context.
   if( !fAnalysisStarted ) {
-    ListToVector(gHaApps, fApps);
-    ListToVector(gHaApps, fSpectrometers);
-    ListToVector(gHaPhysics, fPhysics);
-    ListToVector(gHaEvtHandlers, fEvtHandlers);
+    ListToVector(fContext->GetApps(), fApps);
+    ListToVector(fContext->GetApps(), fSpectrometers);
+    ListToVector(fContext->GetPhysics(), fPhysics);
+    ListToVector(fContext->GetEvtHandlers(), fEvtHandlers);
   }
 
   // Initialize all apparatuses, physics modules, event type handlers
@@ -755,22 +1076,24 @@ Int_t THaAnalyzer::DoInit( THaRunBase* run )
   modulesToInit.insert(modulesToInit.end(), ALL(fEvtHandlers));
   modulesToInit.insert(modulesToInit.end(), ALL(fInterStage));
   retval = InitModules(modulesToInit, run_time);
+  if( retval == 0 )
+    retval = CheckRawDataAccess(modulesToInit, fRun);
   if( retval == 0 ) {
 
     // Set up cuts here, now that all global variables are available
     if( fCutFileName.IsNull() ) {
       // No test definitions -> make sure list is clear
-      gHaCuts->Clear();
+      fContext->GetCuts()->Clear();
       fLoadedCutFileName = "";
     } else {
       if( fCutFileName != fLoadedCutFileName ) {
 	// New test definitions -> load them
 	cout << "Loading cuts from " << fCutFileName << endl;
-	gHaCuts->Load( fCutFileName );
+	fContext->GetCuts()->Load( fCutFileName );
 	fLoadedCutFileName = fCutFileName;
       }
       // Ensure all tests are up-to-date. Global variables may have changed.
-      gHaCuts->Compile();
+      fContext->GetCuts()->Compile();
     }
     // Initialize local pointers to test blocks and master cuts
     InitCuts();
@@ -856,17 +1179,32 @@ Int_t THaAnalyzer::ReadOneEvent()
   // Read one event from current run (fRun) and raw-decode it using the
   // current decoder (fEvData)
 
-  if( fDoBench ) fBench->Begin("RawDecode");
+  BeginStage("RawDecode");
 
   // Find next event buffer in CODA file. Quit if error.
   Int_t status = THaRunBase::READ_OK;
-  if( !fEvData->DataCached() )
-    status = fRun->ReadEvent();
+  if( !fEvData->DataCached() ) {
+    if( fReplayCache )
+      status = fEventCache->ReadEvent();
+    else {
+      status = fRun->ReadEvent();
+      if( status == THaRunBase::READ_OK && fEventCache )
+        fEventCache->AddEvent( fRun->GetEvBuffer() );
+    }
+    if( status == THaRunBase::READ_OK )
+      ++fNread;
+  }
+  // Determine whether this event precedes the shard being analyzed or the
+  // checkpoint being resumed from. This must be done before decoding since
+  // the decoder's header filter depends on it.
+  if( status == THaRunBase::READ_OK && fShardState != kShardActive )
+    UpdateShardState();
 
   switch( status ) {
   case THaRunBase::READ_OK:
     // Decode the event
-    status = fEvData->LoadEvent( fRun->GetEvBuffer() );
+    status = fEvData->LoadEvent( fReplayCache ? fEventCache->GetEvBuffer()
+                                              : fRun->GetEvBuffer() );
     switch( status ) {
     case THaEvData::HED_OK:     // fall through
     case THaEvData::HED_WARN:
@@ -898,7 +1236,7 @@ Int_t THaAnalyzer::ReadOneEvent()
     break;
   }
 
-  if( fDoBench ) fBench->Stop("RawDecode");
+  StopStage("RawDecode");
   return status;
 }
 
@@ -915,6 +1253,17 @@ void THaAnalyzer::AddEpicsEvtType(Int_t itype)
     if (fEpicsHandler) fEpicsHandler->AddEvtType(itype);
 }
 
+//_____________________________________________________________________________
+void THaAnalyzer::SetAllocWarmup( UInt_t n )
+{
+  // Set the number of events excluded from the steady-state allocation
+  // statistics (see EnableAllocTracking()). Default 10.
+
+  fAllocWarmup = n;
+  if( fAllocStats )
+    fAllocStats->SetWarmup(n);
+}
+
 //_____________________________________________________________________________
 Int_t THaAnalyzer::SetCountMode( Int_t mode )
 {
@@ -1021,9 +1370,9 @@ void THaAnalyzer::PrintCutSummary() const
 {
   // Print summary of cuts
 
-  if( gHaCuts->GetSize() > 0 ) {
+  if( fContext->GetCuts()->GetSize() > 0 ) {
     cout << "Cut summary:" << endl;
-    gHaCuts->Print("STATS");
+    fContext->GetCuts()->Print("STATS");
   }
 }
 
@@ -1036,14 +1385,63 @@ void THaAnalyzer::PrintTimingSummary() const
     if( fDoBench ) {
       cout << "Timing summary:" << endl;
       names = {
-        "Init", "Begin", "RawDecode", "Decode", "CoarseTracking",
-        "CoarseReconstruct", "Tracking", "Reconstruct", "Physics", "End",
-        "Output", "Cuts"
+        "Init", "Begin", "RawDecode", "EvtHandlers", "Decode",
+        "CoarseTracking", "CoarseReconstruct", "Tracking", "Reconstruct",
+        "Physics", "End", "Output", "Cuts"
       };
     }
     names.emplace_back("Total");
     fBench->PrintByName(names);
   }
+  if( fDoModuleBench )
+    PrintModuleSummary();
+  if( fAllocStats )
+    fAllocStats->Print();
+  if( fDoBench && fEvData )
+    fEvData->PrintDecodeCounts();
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::PrintModuleSummary() const
+{
+  // Print per-module timing and allocation statistics
+
+  if( fModuleStats.empty() )
+    return;
+  size_t w = 6;
+  for( const auto& st : fModuleStats )
+    w = std::max(w, strlen(st.GetModule()->GetName()));
+  auto fmt = cout.flags();
+  auto prec = cout.precision();
+  cout << "Module timing summary:" << endl;
+  cout << left << setw(SINT(w)) << "Module" << right
+       << setw(11) << "calls"
+       << setw(11) << "total(s)"
+       << setw(11) << "avg(ms)"
+       << setw(11) << "max(ms)"
+       << setw(11) << "max_ev"
+       << setw(11) << "allocs"
+       << setw(11) << "last_alloc"
+       << setw(9)  << "over" << endl;
+  cout << fixed;
+  for( const auto& st : fModuleStats ) {
+    Double_t avg = st.GetNevents() > 0
+                   ? 1e3 * st.GetTotalTime() / st.GetNevents() : 0.;
+    cout << left << setw(SINT(w)) << st.GetModule()->GetName() << right
+         << setw(11) << st.GetNcalls()
+         << setw(11) << setprecision(3) << st.GetTotalTime()
+         << setw(11) << setprecision(4) << avg
+         << setw(11) << setprecision(4) << 1e3 * st.GetMaxTime()
+         << setw(11) << st.GetMaxEvent()
+         << setw(11) << st.GetNalloc()
+         << setw(11) << st.GetLastAllocEvent()
+         << setw(9)  << st.GetNoverBudget() << endl;
+  }
+  if( fModuleBudget > 0 )
+    cout << "(\"over\" = events exceeding time budget of "
+         << setprecision(3) << 1e3 * fModuleBudget << " ms)" << endl;
+  cout.flags(fmt);
+  cout.precision(prec);
 }
 
 //_____________________________________________________________________________
@@ -1167,22 +1565,21 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
 
   try {
     stage = "Decode";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* mod : fAnalysisModules ) {
-      obj = mod;
-      mod->Clear();
+    BeginStage(stage);
+    for( size_t i = 0; i < fAnalysisModules.size(); ++i ) {
+      if( IsPruned(i) ) continue;
+      obj = fAnalysisModules[i];
+      ModuleTimer timer(ModStats(i));
+      obj->Clear();
     }
-    for( auto* app : fApps ) {
-      obj = app;
-      app->Decode(*fEvData);
+    for( size_t i = 0; i < fApps.size(); ++i ) {
+      if( IsPruned(i) ) continue;
+      obj = fApps[i];
+      ModuleTimer timer(ModStats(i));
+      fApps[i]->Decode(*fEvData);
     }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kDecode ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
-    }
-    if( fDoBench ) fBench->Stop(stage);
+    ProcessInterStage(kDecode, obj);
+    StopStage(stage);
     if( !EvalStage(kDecode) ) return kSkip;
 
     //--- Main physics analysis. Calls the following for each defined apparatus
@@ -1196,76 +1593,67 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
     //-- Coarse processing
 
     stage = "CoarseTracking";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* spectro : fSpectrometers ) {
-      obj = spectro;
-      spectro->CoarseTrack();
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kCoarseTrack ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
+    BeginStage(stage);
+    for( size_t i = 0; i < fSpectrometers.size(); ++i ) {
+      if( IsPruned(fSpectroIdx[i]) ) continue;
+      obj = fSpectrometers[i];
+      ModuleTimer timer(ModStats(fSpectroIdx[i]));
+      fSpectrometers[i]->CoarseTrack();
     }
-    if( fDoBench ) fBench->Stop(stage);
+    ProcessInterStage(kCoarseTrack, obj);
+    StopStage(stage);
     if( !EvalStage(kCoarseTrack) )  return kSkip;
 
 
     stage = "CoarseReconstruct";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* app : fApps ) {
-      obj = app;
-      app->CoarseReconstruct();
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kCoarseRecon ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
+    BeginStage(stage);
+    for( size_t i = 0; i < fApps.size(); ++i ) {
+      if( IsPruned(i) ) continue;
+      obj = fApps[i];
+      ModuleTimer timer(ModStats(i));
+      fApps[i]->CoarseReconstruct();
     }
-    if( fDoBench ) fBench->Stop(stage);
+    ProcessInterStage(kCoarseRecon, obj);
+    StopStage(stage);
     if( !EvalStage(kCoarseRecon) )  return kSkip;
 
     //-- Fine (Full) Reconstruct().
 
     stage = "Tracking";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* spectro : fSpectrometers ) {
-      obj = spectro;
-      spectro->Track();
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kTracking ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
+    BeginStage(stage);
+    for( size_t i = 0; i < fSpectrometers.size(); ++i ) {
+      if( IsPruned(fSpectroIdx[i]) ) continue;
+      obj = fSpectrometers[i];
+      ModuleTimer timer(ModStats(fSpectroIdx[i]));
+      fSpectrometers[i]->Track();
     }
-    if( fDoBench ) fBench->Stop(stage);
+    ProcessInterStage(kTracking, obj);
+    StopStage(stage);
     if( !EvalStage(kTracking) )  return kSkip;
 
 
     stage = "Reconstruct";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* app : fApps ) {
-      obj = app;
-      app->Reconstruct();
-    }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kReconstruct ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
+    BeginStage(stage);
+    for( size_t i = 0; i < fApps.size(); ++i ) {
+      if( IsPruned(i) ) continue;
+      obj = fApps[i];
+      ModuleTimer timer(ModStats(i));
+      fApps[i]->Reconstruct();
     }
-    if( fDoBench ) fBench->Stop(stage);
+    ProcessInterStage(kReconstruct, obj);
+    StopStage(stage);
     if( !EvalStage(kReconstruct) )  return kSkip;
 
     //--- Process the list of physics modules
 
     stage = "Physics";
-    if( fDoBench ) fBench->Begin(stage);
-    for( auto* physmod : fPhysics ) {
-      obj = physmod;
-      Int_t err = physmod->Process( *fEvData );
+    BeginStage(stage);
+    const size_t ioff = fApps.size() + fInterStage.size();
+    for( size_t i = 0; i < fPhysics.size(); ++i ) {
+      if( IsPruned(ioff + i) ) continue;
+      obj = fPhysics[i];
+      ModuleTimer timer(ModStats(ioff + i));
+      Int_t err = fPhysics[i]->Process( *fEvData );
       if( err == THaPhysicsModule::kTerminate )
         code = kTerminate;
       else if( err == THaPhysicsModule::kFatal ) {
@@ -1273,13 +1661,8 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
         break;
       }
     }
-    for( auto* mod : fInterStage ) {
-      if( mod->GetStage() == kPhysics ) {
-        obj = mod;
-        mod->Process(*fEvData);
-      }
-    }
-    if( fDoBench ) fBench->Stop(stage);
+    ProcessInterStage(kPhysics, obj);
+    StopStage(stage);
     if( code == kFatal ) return kFatal;
 
     //--- Evaluate "Physics" test block
@@ -1295,13 +1678,13 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
     Error( here, "Caught exception %s in module %s (%s) during %s analysis "
 	   "stage. Terminating analysis.", e.what(), module_name.Data(),
 	   module_desc.Data(), stage );
-    if( fDoBench ) fBench->Stop(stage);
+    StopStage(stage);
     code = kFatal;
     goto errexit;
   }
 
   //---  Process output
-  if( fDoBench ) fBench->Begin("Output");
+  BeginStage("Output");
   try {
     //--- If Event defined, fill it.
     if( fEvent ) {
@@ -1323,25 +1706,47 @@ Int_t THaAnalyzer::PhysicsAnalysis( Int_t code )
 	   "Terminating analysis.", e.what(), fNev );
     code = kFatal;
   }
-  if( fDoBench ) fBench->Stop("Output");
+  StopStage("Output");
 
  errexit:
   return code;
 }
 
+//_____________________________________________________________________________
+void THaAnalyzer::EvtHandlerAnalysis()
+{
+  // Pass the current event to the event type handlers
+
+  static const char* const here = "EvtHandlerAnalysis";
+
+  BeginStage("EvtHandlers");
+  for( auto* obj : fEvtHandlers ) {
+    try {
+      obj->Analyze(fEvData);
+    }
+    catch( const exception& e) {
+      // Generic exceptions are not fatal. Print message and continue.
+      Error( here, "%s", e.what() );
+    }
+  }
+  StopStage("EvtHandlers");
+}
+
 //_____________________________________________________________________________
 Int_t THaAnalyzer::SlowControlAnalysis( Int_t code )
 {
   // Analyze slow control (EPICS) data and write them to output.
   // Ignores RawDecode results and requested event range, so EPICS
   // data are always analyzed continuously from the beginning of the run.
+  // In a sharded analysis, only EPICS events within the shard are written.
 
   if( code == kFatal )
     return code;
   if ( !fEpicsHandler ) return kOK;
-  if( fDoBench ) fBench->Begin("Output");
-  if( fOutput ) fOutput->ProcEpics(fEvData, fEpicsHandler);
-  if( fDoBench ) fBench->Stop("Output");
+  BeginStage("Output");
+  if( fOutput )
+    fOutput->ProcEpics(fEvData, fEpicsHandler, fShardState == kShardActive);
+  StopStage("Output");
   if( code == kTerminate )
     return code;
   return kOK;
@@ -1367,17 +1772,16 @@ Int_t THaAnalyzer::PostProcess( Int_t code )
   // THaPostProcess::Process() function for optional evaluation,
   // e.g. skipping events that fail analysis stage cuts.
 
-  if( fDoBench ) fBench->Begin("PostProcess");
-
   if( code == kFatal )
     return code;
+  BeginStage("PostProcess");
   for( auto* obj : fPostProcess ) {
     Int_t ret = obj->Process(fEvData,fRun,code);
     if( obj->TestBits(THaPostProcess::kUseReturnCode) &&
 	ret > code )
       code = ret;
   }
-  if( fDoBench ) fBench->Stop("PostProcess");
+  StopStage("PostProcess");
   return code;
 }
 
@@ -1386,10 +1790,26 @@ Int_t THaAnalyzer::MainAnalysis()
 {
   // Main analysis carried out for each event
 
-  static const char* const here = "MainAnalysis";
-
   Int_t retval = kOK;
 
+  //--- Sharded analysis: events preceding the shard are either skipped or,
+  //    during the warm-up, only passed to the event type handlers
+  if( fShardState == kShardSkip ||
+      (fShardState == kShardWarmup && fEvData->IsPhysicsTrigger()) )
+    return kSkip;
+  //--- Evaluate test block "PreDecode". Events rejected by the decoder's
+  //    header filter have not been decoded. Physics events not tested by
+  //    the decoder (e.g. multiblock data or decoders without header filter
+  //    support) are tested here. Rejected events are skipped after being
+  //    passed to the event type handlers, which read the raw event buffer,
+  //    as for events failing "RawDecode".
+  if( fEvData->IsHeaderRejected() ||
+      (fEvData->IsPhysicsTrigger() && !fEvData->IsHeaderChecked() &&
+       !EvalStage(kPreDecode)) ) {
+    EvtHandlerAnalysis();
+    return kSkip;
+  }
+
   Incr(kNevGood);
 
   //--- Evaluate test block "RawDecode"
@@ -1400,21 +1820,15 @@ Int_t THaAnalyzer::MainAnalysis()
   }
 
   //FIXME Move to "OtherAnalysis"?
-  for( auto* obj : fEvtHandlers ) {
-    try {
-      obj->Analyze(fEvData);
-    }
-    catch( const exception& e) {
-      // Generic exceptions are not fatal. Print message and continue.
-      Error( here, "%s", e.what() );
-    }
-  }
+  EvtHandlerAnalysis();
 
   bool evdone = false;
   //=== Physics triggers ===
   if( fEvData->IsPhysicsTrigger() && fDoPhysics ) {
     Incr(kNevPhysics);
     retval = PhysicsAnalysis(retval);
+    if( fDoModuleBench )
+      EndModuleEvent();
     evdone = true;
   }
 
@@ -1427,6 +1841,8 @@ Int_t THaAnalyzer::MainAnalysis()
       evdone = true;
     }
   }
+  if( fShardState == kShardWarmup )
+    return kSkip;
 
   //=== Other events ===
   if( !evdone && fDoOtherEvents ) {
@@ -1460,6 +1876,9 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
 
   static const char* const here = "Process";
 
+  // Modules and formulas evaluated in the event loop use our context
+  Podd::AnalysisContext::Scope scope(fContext);
+
   if( !run ) {
     if( fRun )
       run = fRun;
@@ -1467,9 +1886,21 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
       return -1;
   }
 
+  //--- Sharded analysis by file segment: select the segments to read.
+  //    This must be done before the run is initialized.
+  Int_t status = 0;
+  if( fNshards > 0 && fShardMode == kShardSegments &&
+      (status = InitShardSegments(run)) != 0 )
+    return status;
+
+  //--- Resume an interrupted replay from its checkpoint, if any. This must
+  //    be done before the output file is created.
+  if( fDoResume && (status = InitResume(run)) != 0 )
+    return status;
+
   //--- Initialization. Creates fFile, fOutput, and fEvent if necessary.
   //    Also copies run to fRun if run is different from fRun
-  Int_t status = Init( run );
+  status = Init( run );
   if( status != 0 ) {
     return status;
   }
@@ -1477,20 +1908,57 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
   // Restart "Total" since it is stopped in Init()
   fBench->Begin("Total");
 
-  //--- Re-open the data source. Should succeed since this was tested in Init().
-  if( (status = fRun->Open()) != THaRunBase::READ_OK ) {
-    Error( here, "Failed to re-open the input file. "
-	   "Make sure the file still exists.");
-    fBench->Stop("Total");
-    return -4;
+  // The shard's events and the checkpoint position are located by reading
+  // the input file
+  if( fReplayCache && (fNshards > 0 || fResumeCkpt) ) {
+    Warning( here, "Event cache not used for sharded or resumed analysis." );
+    fReplayCache = false;
+  }
+
+  if( fReplayCache ) {
+    //--- Replay from the event cache instead of the input file
+    fEventCache->Rewind();
+    const THaRunBase* cached = fEventCache->GetRun();
+    if( fEventCache->IsTruncated() ||
+        (!fEventCache->IsComplete() &&
+         fRun->GetLastEvent() > cached->GetLastEvent()) )
+      Warning( here, "Event cache holds only the first %llu events of "
+               "run %d. Analysis will end early.",
+               fEventCache->GetNevents(), fRun->GetNumber() );
+    if( fVerbose>1 )
+      fEventCache->Print();
+  } else {
+    //--- Re-open the data source. Should succeed since this was tested in Init().
+    if( (status = fRun->Open()) != THaRunBase::READ_OK ) {
+      Error( here, "Failed to re-open the input file. "
+	     "Make sure the file still exists.");
+      fBench->Stop("Total");
+      return -4;
+    }
+    // Record events in the cache, if enabled. The cache needs
+    // self-describing event buffers, which only CODA runs provide.
+    if( fEventCache ) {
+      if( dynamic_cast<THaCodaRun*>(fRun) )
+        fEventCache->StartRecording(fRun);
+      else {
+        Warning( here, "Event cache only supported for CODA runs. "
+                 "Events will not be cached." );
+        fEventCache->Clear();
+      }
+    }
   }
 
-  // Make the current run available globally - the run parameters are
-  // needed by some modules
-  gHaRun = fRun;
+  // Make the current run available to the modules of this analysis - the
+  // run parameters are needed by some modules
+  fContext->SetRun(fRun);
 
   // Enable/disable helicity decoding as requested
   fEvData->EnableHelicity( HelicityEnabled() );
+  fEvData->EnableLazyDecoding( LazyDecodingEnabled() );
+  // Multiblock events are decoded with the requested number of threads
+  // when read. The events of a block are still analyzed one by one.
+  fEvData->SetDecodeThreads( fDecodeThreads );
+  fEvData->ResetDecodeCounts();
   // Set decoder reporting level. FIXME: update when THaEvData is updated
   fEvData->SetVerbose( (fVerbose>2) );
   fEvData->SetDebug( (fVerbose>3) );
@@ -1502,6 +1970,25 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
 	 << endl;
     cout << endl << "Starting analysis" << endl;
   }
+  //--- Sharded analysis: set the event range of the shard, if necessary,
+  //    and prepare to skip or scan the events preceding it
+  fShardState = kShardActive;
+  if( fNshards > 0 ) {
+    if( fShardMode == kShardEvents && (status = InitShardEvents()) != 0 ) {
+      fRun->Close();
+      fBench->Stop("Total");
+      return status;
+    }
+    StartShard();
+    if( fVerbose>1 )
+      cout << "Analyzing shard " << fShard << " of " << fNshards
+           << " starting at " << (fShardMode == kShardEvents ? "event " :
+                                  "segment ") << fShardFirst << endl;
+  }
+  //--- Resumed replay: scan the events up to the checkpoint
+  if( fResumeCkpt )
+    StartWarmup();
+
   // Events prior to fRun->GetFirstEvent() are skipped in MainAnalysis()
   if( fVerbose>2 && fRun->GetFirstEvent()>1 )
     cout << "Skipping " << fRun->GetFirstEvent() << " events" << endl;
@@ -1510,10 +1997,15 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
 
   if( fDoBench ) fBench->Begin("Init");
   fNev = 0;
+  fNread = 0;
+  fNextCkpt = (fCkptInterval > 0) ? fCkptInterval : kMaxULong64;
+  fLastCkptTime = gSystem->Now();
   bool terminate = false, fatal = false;
   UInt_t nlast = fRun->GetLastEvent();
   fAnalysisStarted = true;
   PrepareModuleList();
+  PruneModules();
+  SelectCrates();
   if( fDoBench ) fBench->Stop("Init");
   BeginAnalysis();
   if( fFile ) {
@@ -1522,9 +2014,26 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
     fRun->Write("Run_Data");  // Save run data to first ROOT file
     if( fDoBench ) fBench->Stop("Output");
   }
+  if( fResumeCkpt && (status = ResumeOutput()) != 0 ) {
+    fRun->Close();
+    fBench->Stop("Total");
+    return status;
+  }
 
-  while ( !terminate && fNev < nlast &&
-	  (status = ReadOneEvent()) != THaRunBase::READ_EOF ) {
+  while( !terminate && fNev < nlast ) {
+
+    //--- Close allocation accounting for the previous event
+    if( fAllocStats )
+      fAllocStats->EndEvent(fEvData->GetEvNum());
+
+    //--- Save the state of the analysis periodically. Checkpoints are
+    //    taken only between event buffers.
+    if( fNread >= fNextCkpt && !fEvData->DataCached() &&
+        fShardState == kShardActive )
+      WriteCheckpoint();
+
+    if( (status = ReadOneEvent()) == THaRunBase::READ_EOF )
+      break;
 
     //--- Skip events with errors, unless fatal
     if( status == THaRunBase::READ_FATAL ) {
@@ -1563,10 +2072,12 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
     if( fUpdateRun )
       fRun->Update( fEvData );
 
-    //--- Clear all tests/cuts
-    if( fDoBench ) fBench->Begin("Cuts");
-    gHaCuts->ClearAll();
-    if( fDoBench ) fBench->Stop("Cuts");
+    //--- Clear all tests/cuts, unless already done for the header test
+    if( !fEvData->IsHeaderChecked() ) {
+      BeginStage("Cuts");
+      fContext->GetCuts()->ClearAll();
+      StopStage("Cuts");
+    }
 
     //--- Perform the analysis
     Int_t err = MainAnalysis();
@@ -1590,11 +2101,34 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
     Incr(kNevAccepted);
 
   }  // End of event loop
+  if( fAllocStats )
+    fAllocStats->EndEvent(fEvData->GetEvNum());
+
+  // A shard that was never reached has no statistics
+  if( fNshards > 0 ) {
+    if( fShardState != kShardActive )
+      EndWarmup();
+    InitCuts();  // Restore header filter
+  }
+  if( fResumeCkpt ) {
+    Warning( here, "Input ended before the checkpoint position. "
+             "Has the input changed?" );
+    EndResume();
+  }
 
   EndAnalysis();
 
   //--- Close the input file
-  fRun->Close();
+  if( fReplayCache )
+    fReplayCache = false;
+  else {
+    fRun->Close();
+    if( fEventCache ) {
+      fEventCache->StopRecording( status == THaRunBase::READ_EOF );
+      if( fVerbose>1 )
+        fEventCache->Print();
+    }
+  }
 
   // Save final run parameters in run object of caller, if any
   *run = *fRun;
@@ -1613,7 +2147,15 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
   if( fFile )   fFile->cd();
   if( fOutput ) fOutput->End();
   if( fFile ) {
+    if( fDoModuleBench )
+      WriteModuleStats();
     fRun->Write("Run_Data");  // Save run data to ROOT file
+    if( fNshards > 0 ) {
+      // Save description and statistics of this shard for merging
+      unique_ptr<ShardInfo> info{MakeShardInfo()};
+      info->Subtract(*fShardStart);
+      info->Write(kShardInfoName, TObject::kOverwrite);
+    }
     //    fFile->Write();//already done by fOutput->End()
     fFile->Purge();         // get rid of excess object "cycles"
   }
@@ -1634,6 +2176,16 @@ Int_t THaAnalyzer::Process( THaRunBase* run )
 
   PrintSummary(exit_status);
 
+  //--- Checkpoints are no longer needed once the replay has completed
+  if( !fatal ) {
+    if( fCkptInterval > 0 || fDoResume )
+      gSystem->Unlink(GetCheckpointFileName());
+    if( !fResumeFileName.IsNull() ) {
+      gSystem->Unlink(fResumeFileName);
+      fResumeFileName.Clear();
+    }
+  }
+
   //keep the last run available
   //  gHaRun = nullptr;
   return SINT(fNev);
@@ -1650,6 +2202,574 @@ void THaAnalyzer::SetCodaVersion( Int_t vers )
   fWantCodaVers = vers;
 }
 
+//_____________________________________________________________________________
+void THaAnalyzer::SetShard( UInt_t shard, UInt_t nshards, EShardMode mode )
+{
+  // Analyze only part 'shard' (counting from 0) of 'nshards' parts of the
+  // run in subsequent calls to Process(). This allows a large run to be
+  // analyzed by several independent jobs. The output files of all shards
+  // can be combined with the mergeshards utility.
+  //
+  // kShardEvents: The event range of the run (default: all events) is
+  // divided into 'nshards' parts of equal size. The total number of events
+  // is either set with SetShardEvents() or determined by a fast scan of
+  // the run before the analysis. Physics events preceding the shard are
+  // read, but not decoded. Scaler, EPICS and other special events within
+  // SetShardWarmup() events before the shard (default: all) are passed to
+  // the event type handlers so that their state is set up correctly.
+  //
+  // kShardSegments: The file segments of a Podd::MultiFileRun are divided
+  // into 'nshards' contiguous groups. SetShardWarmup() segments (default: 1)
+  // preceding the shard are read and scanned as above.
+  //
+  // Sharding modifies the event range or segment range of the run object.
+  // The output file of each shard contains a Podd::ShardInfo object with
+  // the event counters and cut statistics of the shard. Scaler and EPICS
+  // trees contain only data from within the shard so that the merged trees
+  // are continuous. Use ClearShard() to analyze complete runs again.
+
+  if( nshards == 0 || shard >= nshards ) {
+    Error( "SetShard", "Invalid shard %u of %u. Sharding disabled.",
+           shard, nshards );
+    fNshards = 0;
+    return;
+  }
+  fShard = shard;
+  fNshards = nshards;
+  fShardMode = mode;
+  fShardWarmup = (mode == kShardSegments) ? 1 : kMaxUInt;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::InitShardSegments( THaRunBase* run )
+{
+  // Restrict the input files of 'run' to the segments of the current shard
+  // and the warm-up segments preceding them. 'run' must be a MultiFileRun.
+
+  static const char* const here = "InitShardSegments";
+
+  auto* mrun = dynamic_cast<MultiFileRun*>(run);
+  if( !mrun ) {
+    Error( here, "Sharding by segment requires a Podd::MultiFileRun." );
+    return -20;
+  }
+  Int_t ret = 0;
+  if( !mrun->IsInit() && (ret = mrun->Init()) != 0 )
+    return ret;
+  Int_t start = mrun->GetStartSegment(), last = mrun->GetLastSegment();
+  ULong64_t nseg = (last >= start) ? last - start + 1 : 0;
+  if( nseg < fNshards ) {
+    Error( here, "Cannot divide %llu file segments into %u shards.",
+           nseg, fNshards );
+    return -21;
+  }
+  auto first = static_cast<UInt_t>(start + fShard * nseg / fNshards);
+  auto end   = static_cast<UInt_t>(start + (fShard+1) * nseg / fNshards);
+  UInt_t nwarm = min(fShardWarmup, first - start);
+  // This clears the run's initialization. DoInit() will redo it.
+  mrun->SetFirstSegment(SINT(first - nwarm));
+  mrun->SetMaxSegments(SINT(end - first + nwarm));
+  fShardFirst = first;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::InitShardEvents()
+{
+  // Set the event range of fRun to the events of the current shard.
+  // fRun must be open.
+
+  static const char* const here = "InitShardEvents";
+
+  UInt_t first = fRun->GetFirstEvent(), last = fRun->GetLastEvent();
+  UInt_t nev = fShardNevents;
+  if( nev == 0 ) {
+    if( fVerbose>1 )
+      cout << "Counting events" << endl;
+    nev = CountEvents();
+    fRun->Close();
+    if( fRun->Open() != THaRunBase::READ_OK ) {
+      Error( here, "Failed to re-open the input file." );
+      return -4;
+    }
+  }
+  last = min(last, nev);
+  if( first > last || last - first + 1 < fNshards ) {
+    Error( here, "Cannot divide events %u-%u into %u shards.",
+           first, last, fNshards );
+    return -22;
+  }
+  ULong64_t n = last - first + 1;
+  auto sfirst = static_cast<UInt_t>(first + fShard * n / fNshards);
+  // The last shard analyzes any events beyond the count as well
+  UInt_t slast = (fShard+1 == fNshards) ? fRun->GetLastEvent()
+    : static_cast<UInt_t>(first + (fShard+1) * n / fNshards - 1);
+  fRun->SetEventRange(sfirst, slast);
+  fShardFirst = sfirst;
+  return 0;
+}
+
+//_____________________________________________________________________________
+UInt_t THaAnalyzer::CountEvents()
+{
+  // Count the events in fRun according to the current counting mode (see
+  // SetCountMode). Physics events are not decoded. fRun must be open and
+  // is read to the end.
+
+  fEvData->SetHeaderFilter( []( const THaEvData* ) { return false; } );
+  UInt_t nev = 0;
+  Int_t status = THaRunBase::READ_OK;
+  while( status != THaRunBase::READ_EOF && status != THaRunBase::READ_FATAL ) {
+    if( !fEvData->DataCached() &&
+        (status = fRun->ReadEvent()) != THaRunBase::READ_OK )
+      continue;
+    Int_t ret = fEvData->LoadEvent( fRun->GetEvBuffer() );
+    if( ret == THaEvData::HED_FATAL )
+      break;
+    if( ret == THaEvData::HED_ERR )
+      continue;
+    switch( fCountMode ) {
+    case kCountPhysics:
+      if( fEvData->IsPhysicsTrigger() )
+        ++nev;
+      break;
+    case kCountAll:
+      ++nev;
+      break;
+    case kCountRaw:
+      nev = max(nev, fEvData->GetEvNum());
+      break;
+    default:
+      break;
+    }
+  }
+  fEvData->SetHeaderFilter(nullptr);
+  return nev;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::StartShard()
+{
+  // Prepare the event loop for the current shard
+
+  StartWarmup();
+  // Statistics may include earlier runs of a continuing analysis
+  delete fShardStart;
+  fShardStart = MakeShardInfo();
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::StartWarmup()
+{
+  // Until the first event to be analyzed is read, the event type handlers
+  // run in warm-up mode, and physics events are rejected by the decoder's
+  // header filter.
+
+  fShardState = kShardWarmup;
+  for( auto* obj : fEvtHandlers )
+    obj->SetWarmup(true);
+  bool predecode = fStages.size() > kPreDecode && fStages[kPreDecode].cut_list;
+  fEvData->SetHeaderFilter( [this,predecode]( const THaEvData* ) {
+    return fShardState == kShardActive && (!predecode || TestEventHeader());
+  });
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::UpdateShardState()
+{
+  // Determine if the event just read belongs to the current shard or
+  // follows the checkpoint being resumed from
+
+  if( fResumeCkpt ) {
+    if( fNread > fResumeCkpt->GetNread() )
+      EndResume();
+    return;
+  }
+  if( fShardMode == kShardSegments ) {
+    if( static_cast<THaRun*>(fRun)->GetSegment() >= SINT(fShardFirst) )
+      EndWarmup();
+    return;
+  }
+  // fNev does not yet include the current event. In kCountRaw mode, this
+  // assumes consecutive event numbers.
+  UInt_t next = fNev + 1;
+  if( next >= fShardFirst )
+    EndWarmup();
+  else
+    fShardState = (fShardFirst - next > fShardWarmup) ? kShardSkip
+                                                      : kShardWarmup;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EndWarmup()
+{
+  // Start of the shard proper. Statistics accumulated so far are not part
+  // of the shard's statistics.
+
+  fShardState = kShardActive;
+  for( auto* obj : fEvtHandlers )
+    obj->SetWarmup(false);
+  delete fShardStart;
+  fShardStart = MakeShardInfo();
+}
+
+//_____________________________________________________________________________
+ShardInfo* THaAnalyzer::MakeShardInfo() const
+{
+  // Description of the current shard with the current values of the event
+  // counters and cut statistics
+
+  auto* info = new ShardInfo( fShard, fNshards,
+    (fShardMode == kShardSegments) ? ShardInfo::kSegments : ShardInfo::kEvents,
+    fRun ? fRun->GetNumber() : 0 );
+  if( fShardMode == kShardSegments ) {
+    auto* mrun = dynamic_cast<MultiFileRun*>(fRun);
+    info->SetRange(fShardFirst, mrun ? static_cast<UInt_t>(mrun->GetLastSegment())
+                                     : fShardFirst);
+  } else if( fRun )
+    info->SetRange(fShardFirst, fRun->GetLastEvent());
+  for( const auto& theCounter : fCounters )
+    info->AddCounter(theCounter.description, theCounter.count);
+  TIter next( fContext->GetCuts()->GetCutList() );
+  while( auto* cut = static_cast<THaCut*>(next()) )
+    info->AddCut(cut->GetName(), cut->GetBlockname(), cut->GetNCalled(),
+                 cut->GetNPassed());
+  return info;
+}
+
+//_____________________________________________________________________________
+TString THaAnalyzer::GetCheckpointFileName() const
+{
+  // Name of the checkpoint file for the current output file
+
+  if( !fCkptFileName.IsNull() )
+    return fCkptFileName;
+  return fOutFileName + ".ckpt";
+}
+
+//_____________________________________________________________________________
+static const char* StateKey( const THaAnalysisObject* obj )
+{
+  // Key of the state of 'obj' in a checkpoint. Detectors of different
+  // apparatuses may have the same name (e.g. "L.hel" and "R.hel"), so use
+  // the full prefix where one has been set.
+
+  const char* prefix = obj->GetPrefix();
+  return (prefix && *prefix) ? prefix : obj->GetName();
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::GetStateObjects( vector<THaAnalysisObject*>& objs ) const
+{
+  // Collect all objects whose event-to-event state is saved in checkpoints:
+  // the analysis modules, the detectors of each apparatus, and the event
+  // type handlers.
+
+  objs.clear();
+  for( auto* obj : fAnalysisModules ) {
+    objs.push_back(obj);
+    if( auto* app = dynamic_cast<THaApparatus*>(obj) ) {
+      TIter next( app->GetDetectors() );
+      while( auto* det = static_cast<THaAnalysisObject*>(next()) )
+        objs.push_back(det);
+    }
+  }
+  objs.insert( objs.end(), ALL(fEvtHandlers) );
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SaveModuleStates( Checkpoint& ckpt ) const
+{
+  // Add the states of all modules that have one to 'ckpt'
+
+  vector<THaAnalysisObject*> objs;
+  GetStateObjects(objs);
+  vector<Double_t> state;
+  for( const auto* obj : objs ) {
+    state.clear();
+    obj->SaveState(state);
+    if( !state.empty() )
+      ckpt.AddState(StateKey(obj), state);
+  }
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::RestoreModuleStates( const Checkpoint& ckpt ) const
+{
+  // Restore the states of all modules from 'ckpt'. Modules without a
+  // saved state are left as they are.
+
+  vector<THaAnalysisObject*> objs;
+  GetStateObjects(objs);
+  vector<Double_t> state;
+  for( auto* obj : objs ) {
+    if( ckpt.GetState(StateKey(obj), state) && obj->RestoreState(state) != 0 )
+      Warning( "RestoreModuleStates", "Cannot restore state of module %s",
+               StateKey(obj) );
+  }
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::WriteCheckpoint()
+{
+  // Save the state of the analysis so that the replay can be resumed from
+  // here after an interruption (see EnableResume). Called between event
+  // buffers every fCkptInterval buffers read, but at most every
+  // fCkptMinTime seconds.
+  //
+  // The output trees are flushed to the output file, including their
+  // headers, so that the entries written so far can be recovered even if
+  // the file is not closed properly. A Podd::Checkpoint with the input
+  // position, counters, cut statistics, tree entries and module states is
+  // written, together with copies of the output histograms, to the
+  // checkpoint file, which is replaced atomically. The cost per checkpoint
+  // is bounded by the size of the tree buffers and histograms.
+
+  static const char* const here = "WriteCheckpoint";
+
+  fNextCkpt = fNread + fCkptInterval;
+  Long64_t now = gSystem->Now();
+  if( !fFile || now - fLastCkptTime < 1e3 * fCkptMinTime )
+    return 0;
+  fLastCkptTime = now;
+
+  if( fDoBench ) fBench->Begin("Output");
+  // The tree may have switched files (see Process())
+  if( fOutput && fOutput->GetTree() )
+    fFile = fOutput->GetTree()->GetCurrentFile();
+
+  auto* thisrun = dynamic_cast<THaRun*>(fRun);
+  Checkpoint ckpt( fRun->GetNumber(),
+                   thisrun ? thisrun->GetFilename() : fRun->GetName() );
+  ckpt.SetPosition( fNread, thisrun ? thisrun->GetSegment() : -1, fNev,
+                    fRun->GetNumAnalyzed() );
+  for( const auto& theCounter : fCounters )
+    ckpt.AddCounter(theCounter.count);
+  TIter nextcut( fContext->GetCuts()->GetCutList() );
+  while( auto* cut = static_cast<THaCut*>(nextcut()) )
+    ckpt.AddCut(cut->GetName(), cut->GetNCalled(), cut->GetNPassed());
+  SaveModuleStates(ckpt);
+
+  vector<TH1*> hists;
+  CheckpointOutput(ckpt, hists);
+
+  // Write to a temporary file first so that a valid checkpoint always
+  // exists, even if we are interrupted here
+  TString name = GetCheckpointFileName(), tmpname = name + ".tmp";
+  TDirectory* olddir = gDirectory;
+  Int_t ret = 0;
+  {
+    TFile file( tmpname, "RECREATE" );
+    if( file.IsZombie() ) {
+      Error( here, "Cannot create checkpoint file %s", tmpname.Data() );
+      ret = -1;
+    } else {
+      file.WriteTObject(&ckpt);
+      if( !hists.empty() ) {
+        TDirectory* hdir = file.mkdir("Histograms");
+        for( auto* hist : hists )
+          hdir->WriteTObject(hist);
+      }
+      file.Close();
+    }
+  }
+  olddir->cd();
+  if( ret == 0 && gSystem->Rename(tmpname, name) != 0 ) {
+    Error( here, "Cannot rename %s to %s", tmpname.Data(), name.Data() );
+    ret = -1;
+  }
+  // The output saved when resuming is superseded by this checkpoint
+  if( ret == 0 && !fResumeFileName.IsNull() ) {
+    gSystem->Unlink(fResumeFileName);
+    fResumeFileName.Clear();
+  }
+  if( fDoBench ) fBench->Stop("Output");
+  if( ret == 0 && fVerbose>2 )
+    cout << "Checkpoint at event " << fNev << endl;
+  return ret;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::CheckpointOutput( Checkpoint& ckpt, vector<TH1*>& hists )
+{
+  // Bring the output file up to date for a checkpoint. Save the trees
+  // and record their entries in 'ckpt'. Put the histograms, which the
+  // checkpoint file carries, into 'hists'.
+
+  // Histogram fills may still be buffered (see THaVhist)
+  if( fOutput )
+    fOutput->FlushHistograms();
+  TIter next( fFile->GetList() );
+  while( TObject* obj = next() ) {
+    if( auto* tree = dynamic_cast<TTree*>(obj) ) {
+      tree->AutoSave("SaveSelf FlushBaskets");
+      ckpt.AddTree(tree->GetName(), tree->GetEntries());
+    } else if( auto* hist = dynamic_cast<TH1*>(obj) )
+      hists.push_back(hist);
+  }
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::InitResume( THaRunBase* run )
+{
+  // Prepare to resume an interrupted replay of 'run' from the checkpoint
+  // saved in the checkpoint file. The output file of the interrupted
+  // replay is renamed to <output>.resume. Its trees are copied up to the
+  // checkpoint to the new output file (see ResumeOutput).
+  // If there is no checkpoint file, the replay starts from the beginning.
+
+  static const char* const here = "InitResume";
+
+  delete fResumeCkpt; fResumeCkpt = nullptr;
+  if( fAnalysisStarted ) {
+    Warning( here, "Can only resume the first run of an analysis. "
+             "Analyzing run from the beginning." );
+    return 0;
+  }
+  if( fNshards > 0 ) {
+    Error( here, "Cannot resume a sharded analysis." );
+    return -23;
+  }
+  TString ckname = GetCheckpointFileName();
+  if( gSystem->AccessPathName(ckname) ) { //sic
+    if( fVerbose>0 )
+      cout << "No checkpoint file " << ckname << ". Starting replay from "
+           << "the beginning." << endl;
+    return 0;
+  }
+  TDirectory* olddir = gDirectory;
+  unique_ptr<Checkpoint> ckpt;
+  {
+    unique_ptr<TFile> file{TFile::Open(ckname, "READ")};
+    if( file && !file->IsZombie() )
+      ckpt.reset(dynamic_cast<Checkpoint*>(file->Get("Checkpoint")));
+  }
+  olddir->cd();
+  if( !ckpt ) {
+    Error( here, "Cannot read checkpoint from %s", ckname.Data() );
+    return -24;
+  }
+  Int_t ret = 0;
+  if( !run->IsInit() && (ret = run->Init()) != 0 )
+    return ret;
+  if( ckpt->GetRunNumber() != run->GetNumber() ) {
+    Error( here, "Checkpoint %s is for run %u, not run %u", ckname.Data(),
+           ckpt->GetRunNumber(), run->GetNumber() );
+    return -24;
+  }
+  // If an earlier attempt to resume was interrupted before it saved a
+  // checkpoint of its own, its output is incomplete, and the output of the
+  // original replay is still there
+  TString oldname = fOutFileName + ".resume";
+  if( gSystem->AccessPathName(oldname) ) {
+    if( gSystem->Rename(fOutFileName, oldname) != 0 ) {
+      Error( here, "Cannot rename output file %s to %s", fOutFileName.Data(),
+             oldname.Data() );
+      return -24;
+    }
+  } else
+    gSystem->Unlink(fOutFileName);
+  fResumeFileName = oldname;
+  fResumeCkpt = ckpt.release();
+  if( fVerbose>0 ) {
+    cout << "Resuming replay. ";
+    fResumeCkpt->Print();
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t THaAnalyzer::ResumeOutput()
+{
+  // Copy the output of the interrupted replay up to the checkpoint to the
+  // new output file: the entries of each tree saved at the checkpoint, and
+  // the histograms saved in the checkpoint file. Later entries, if any,
+  // are dropped since they will be filled again.
+
+  static const char* const here = "ResumeOutput";
+
+  TDirectory* olddir = gDirectory;
+  unique_ptr<TFile> oldfile{TFile::Open(fResumeFileName, "READ")};
+  if( !oldfile || oldfile->IsZombie() ) {
+    Error( here, "Cannot open output file %s of interrupted replay",
+           fResumeFileName.Data() );
+    olddir->cd();
+    return -24;
+  }
+  Int_t ret = 0;
+  const auto& names = fResumeCkpt->GetTreeNames();
+  const auto& entries = fResumeCkpt->GetTreeEntries();
+  for( size_t i = 0; i < names.size() && ret == 0; ++i ) {
+    auto* tree = dynamic_cast<TTree*>(fFile->Get(names[i].c_str()));
+    auto* oldtree = dynamic_cast<TTree*>(oldfile->Get(names[i].c_str()));
+    if( !tree || !oldtree || oldtree->GetEntries() < entries[i] ) {
+      Error( here, "Cannot restore tree %s from %s", names[i].c_str(),
+             fResumeFileName.Data() );
+      ret = -24;
+      break;
+    }
+    fFile->cd();
+    tree->CopyEntries(oldtree, entries[i]);
+  }
+  oldfile.reset();
+
+  unique_ptr<TFile> ckfile{TFile::Open(GetCheckpointFileName(), "READ")};
+  TDirectory* hdir = ckfile ? ckfile->GetDirectory("Histograms") : nullptr;
+  if( hdir && ret == 0 ) {
+    TIter next( hdir->GetListOfKeys() );
+    while( auto* key = static_cast<TKey*>(next()) ) {
+      auto* hist = dynamic_cast<TH1*>(fFile->Get(key->GetName()));
+      // The saved histogram is owned by hdir
+      auto* saved = dynamic_cast<TH1*>(key->ReadObj());
+      if( hist && saved )
+        hist->Add(saved);
+      else
+        Warning( here, "Cannot restore histogram %s", key->GetName() );
+    }
+  }
+  olddir->cd();
+  return ret;
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EndResume()
+{
+  // The checkpoint position has been reached. Restore the counters, cut
+  // statistics and module states saved at the checkpoint and continue
+  // with the normal analysis. Module states include those of the
+  // detectors of each apparatus, e.g. helicity predictors, which are not
+  // run during the warm-up. The event type handlers have rebuilt their
+  // state from the events scanned so far.
+
+  fShardState = kShardActive;
+  for( auto* obj : fEvtHandlers )
+    obj->SetWarmup(false);
+  InitCuts();  // Restore header filter
+
+  const auto& counts = fResumeCkpt->GetCounts();
+  for( size_t i = 0; i < counts.size() && i < fCounters.size(); ++i )
+    fCounters[i].count = static_cast<UInt_t>(counts[i]);
+  const auto& cutnames = fResumeCkpt->GetCutNames();
+  for( size_t i = 0; i < cutnames.size(); ++i ) {
+    if( auto* cut = fContext->GetCuts()->FindCut(cutnames[i].c_str()) )
+      cut->SetCounts(fResumeCkpt->GetCutCalled()[i],
+                     fResumeCkpt->GetCutPassed()[i]);
+  }
+  fNev = fResumeCkpt->GetNev();
+  fRun->IncrNumAnalyzed(
+    SINT(fResumeCkpt->GetNumAnalyzed()) - SINT(fRun->GetNumAnalyzed()) );
+  RestoreModuleStates(*fResumeCkpt);
+
+  if( fVerbose>1 )
+    cout << "Resuming analysis at event " << fNev << endl;
+  delete fResumeCkpt; fResumeCkpt = nullptr;
+  // Save the state of the resumed replay right away
+  if( fCkptInterval > 0 ) {
+    fNextCkpt = fNread;
+    fLastCkptTime = 0;
+  }
+}
+
 //_____________________________________________________________________________
 void THaAnalyzer::PrepareModuleList()
 {
@@ -1662,6 +2782,355 @@ void THaAnalyzer::PrepareModuleList()
   fAnalysisModules.insert(fAnalysisModules.end(), ALL(fApps));
   fAnalysisModules.insert(fAnalysisModules.end(), ALL(fInterStage));
   fAnalysisModules.insert(fAnalysisModules.end(), ALL(fPhysics));
+
+  // Set up per-module statistics. Keep accumulated values if the module
+  // list is unchanged, e.g. when continuing with the next run segment.
+  bool same = (fModuleStats.size() == fAnalysisModules.size());
+  for( size_t i = 0; same && i < fAnalysisModules.size(); ++i )
+    same = (fModuleStats[i].GetModule() == fAnalysisModules[i]);
+  if( !same ) {
+    fModuleStats.clear();
+    fModuleStats.reserve(fAnalysisModules.size());
+    for( auto* module : fAnalysisModules )
+      fModuleStats.emplace_back(module);
+  }
+  fSpectroIdx.clear();
+  fSpectroIdx.reserve(fSpectrometers.size());
+  for( auto* spectro : fSpectrometers ) {
+    auto it = std::find(ALL(fApps), spectro);
+    assert(it != fApps.end());  // fSpectrometers is a subset of fApps
+    fSpectroIdx.push_back(it - fApps.begin());
+  }
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::PruneModules()
+{
+  // Dependency analysis for module pruning (see EnablePruning()).
+  //
+  // A module is needed if
+  //  - any of its global variables is used by the output (tree variables,
+  //    formulas, cuts, histograms) or by any cut in the context's cut list, or
+  //  - a needed module, or one of its detectors, obtained it with
+  //    FindModule() during initialization (e.g. the spectrometer of
+  //    THaGoldenTrack or the input module of THaElossCorrection), or
+  //  - it is an inter-stage module, or it defines no global variables at
+  //    all (its purpose is then presumably a side effect).
+  // Global variables and detectors are attributed to the module with the
+  // longest matching name prefix. All other modules are skipped in
+  // PhysicsAnalysis(). Needed modules are told which of their variables
+  // are used via SetUsedOutputs().
+  //
+  // Dependencies not established via FindModule (e.g. direct lookups of
+  // another module's global variables) are not detected. Do not enable
+  // pruning for setups that rely on them.
+
+  fSkipModule.clear();
+  if( !fDoPruning ) {
+    // Undo any output restrictions from a previous, pruned replay
+    for( auto* module : fAnalysisModules )
+      module->SetUsedOutputs(set<const THaVar*>(), true);
+    return;
+  }
+
+  const size_t n = fAnalysisModules.size(), kNone = n;
+  auto owner = [this]( const char* name ) { return FindOwner(name); };
+  auto index_of = [this]( const THaAnalysisObject* obj ) {
+    return FindOwner(obj);
+  };
+
+  vector<char> needed(n, false), all(n, false), hasvars(n, false);
+  vector<set<const THaVar*>> used(n);
+
+  // Modules with global variables
+  TIter nextvar(fContext->GetVars());
+  while( TObject* obj = nextvar() ) {
+    size_t i = owner(obj->GetName());
+    if( i != kNone )
+      hasvars[i] = true;
+  }
+  // Variables used by output and cuts
+  set<const THaVar*> vars;
+  if( fOutput )
+    fOutput->GetVariables(vars);
+  TIter nextcut(fContext->GetCuts()->GetCutList());
+  while( TObject* obj = nextcut() )
+    static_cast<const THaCut*>(obj)->GetVariables(vars);
+  for( const auto* var : vars ) {
+    size_t i = owner(var->GetName());
+    if( i != kNone ) {
+      needed[i] = true;
+      used[i].insert(var);
+    }
+  }
+  // Modules that are always needed
+  for( size_t i = 0; i < n; ++i ) {
+    if( !hasvars[i] ||
+        find(ALL(fInterStage), fAnalysisModules[i]) != fInterStage.end() )
+      needed[i] = all[i] = true;
+  }
+  // Module dependencies recorded by FindModule
+  vector<vector<size_t>> deps(n);
+  TIter nextmod(THaAnalysisObject::GetModuleList());
+  while( TObject* obj = nextmod() ) {
+    auto* module = static_cast<THaAnalysisObject*>(obj);
+    size_t i = index_of(module);
+    if( i == kNone )
+      continue;
+    for( const auto* dep : module->GetUsedModules() ) {
+      size_t j = index_of(dep);
+      if( j != kNone && j != i )
+        deps[i].push_back(j);
+    }
+  }
+  // Propagate along dependencies
+  vector<size_t> todo;
+  for( size_t i = 0; i < n; ++i )
+    if( needed[i] ) todo.push_back(i);
+  while( !todo.empty() ) {
+    size_t i = todo.back();
+    todo.pop_back();
+    for( auto j : deps[i] ) {
+      all[j] = true;
+      if( !needed[j] ) {
+        needed[j] = true;
+        todo.push_back(j);
+      }
+    }
+  }
+
+  fSkipModule.assign(n, false);
+  size_t npruned = 0;
+  for( size_t i = 0; i < n; ++i ) {
+    if( needed[i] )
+      fAnalysisModules[i]->SetUsedOutputs(used[i], all[i]);
+    else {
+      fSkipModule[i] = true;
+      ++npruned;
+      if( fVerbose > 0 )
+        cout << "Pruning unused module " << fAnalysisModules[i]->GetName()
+             << " (" << fAnalysisModules[i]->GetTitle() << ")" << endl;
+    }
+  }
+  if( npruned == 0 )
+    fSkipModule.clear();
+}
+
+//_____________________________________________________________________________
+size_t THaAnalyzer::FindOwner( const char* name ) const
+{
+  // Index in fAnalysisModules of the module owning the global variable or
+  // object with the given name, i.e. the module with the longest prefix
+  // matching 'name'. Returns fAnalysisModules.size() if none.
+
+  size_t imod = fAnalysisModules.size(), maxlen = 0;
+  for( size_t i = 0; i < fAnalysisModules.size(); ++i ) {
+    const char* prefix = fAnalysisModules[i]->GetPrefix();
+    size_t len = prefix ? strlen(prefix) : 0;
+    if( len > maxlen && strncmp(name, prefix, len) == 0 ) {
+      imod = i;
+      maxlen = len;
+    }
+  }
+  return imod;
+}
+
+//_____________________________________________________________________________
+size_t THaAnalyzer::FindOwner( const THaAnalysisObject* obj ) const
+{
+  // Index in fAnalysisModules of 'obj' itself or of the module it belongs
+  // to (e.g. the apparatus of a detector). Returns fAnalysisModules.size()
+  // if none.
+
+  auto it = find(ALL(fAnalysisModules), obj);
+  if( it != fAnalysisModules.end() )
+    return it - fAnalysisModules.begin();
+  return obj->GetPrefix() ? FindOwner(obj->GetPrefix())
+                          : fAnalysisModules.size();
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::SelectCrates()
+{
+  // Set up selective decoding (see EnableCrateSelection()).
+  //
+  // Collect the crates and slots that the active analysis modules, their
+  // detectors and sub-detectors, and the post-processing modules read,
+  // and tell the decoder to decode only these crates. Pruned modules are
+  // not considered. If any module cannot report its channels (i.e.
+  // GetUsedCrateSlots() returns false), all crates are decoded.
+  //
+  // Event type handlers are not considered since they work on the raw
+  // event buffer, which remains complete. For the same reason, raw-word
+  // lookups like DecData's "word" and "roclen" entries need no decoding.
+
+  if( !fEvData )
+    return;
+  fEvData->ClearCrateSelection();
+  if( !fDoCrateSel )
+    return;
+
+  const size_t kNone = fAnalysisModules.size();
+  THaAnalysisObject::CrateSlots_t used;
+  TIter next(THaAnalysisObject::GetModuleList());
+  while( auto* obj = static_cast<THaAnalysisObject*>(next()) ) {
+    size_t i = FindOwner(obj);
+    if( i == kNone || IsPruned(i) )
+      continue;
+    if( !obj->GetUsedCrateSlots(used) ) {
+      if( fVerbose > 0 )
+        cout << "Decoding all crates: raw data channels of "
+             << obj->GetName() << " (" << obj->ClassName()
+             << ") not known" << endl;
+      return;
+    }
+  }
+  for( const auto* module : fPostProcess ) {
+    if( !module->GetUsedCrateSlots(used) ) {
+      if( fVerbose > 0 )
+        cout << "Decoding all crates: raw data channels of post-processing "
+             << "module " << module->ClassName() << " not known" << endl;
+      return;
+    }
+  }
+
+  // 'used' is ordered by crate, then slot
+  vector<UInt_t> crates;
+  for( const auto& cs : used ) {
+    if( crates.empty() || crates.back() != cs.first )
+      crates.push_back(cs.first);
+  }
+  fEvData->SetCrateSelection(crates);
+
+  if( fVerbose > 0 ) {
+    cout << "Decoding only crates used by the analysis:";
+    if( crates.empty() )
+      cout << " none";
+    cout << endl;
+    for( auto crate : crates ) {
+      cout << "  crate " << setw(2) << crate << ": slots";
+      for( auto it = used.lower_bound(make_pair(crate, 0U));
+           it != used.end() && it->first == crate; ++it ) {
+        if( it->second == kMaxUInt )
+          cout << " (all)";
+        else
+          cout << " " << it->second;
+      }
+      cout << endl;
+    }
+    if( const auto* cmap = fEvData->GetCrateMap() ) {
+      vector<UInt_t> skipped;
+      for( auto crate : cmap->GetUsedCrates() ) {
+        if( !fEvData->IsCrateSelected(crate) )
+          skipped.push_back(crate);
+      }
+      if( !skipped.empty() ) {
+        cout << "  skipping crates";
+        for( auto crate : skipped )
+          cout << " " << crate;
+        cout << endl;
+      }
+    }
+  }
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::ProcessInterStage( Int_t stage, THaAnalysisObject*& obj )
+{
+  // Run inter-stage modules registered for analysis stage 'stage'.
+  // 'obj' is set to the current module for error reporting.
+
+  const size_t ioff = fApps.size();
+  for( size_t i = 0; i < fInterStage.size(); ++i ) {
+    auto* mod = fInterStage[i];
+    if( mod->GetStage() == stage ) {
+      obj = mod;
+      ModuleTimer timer(ModStats(ioff + i));
+      mod->Process(*fEvData);
+    }
+  }
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::BeginStage( const char* name )
+{
+  // Start timer and allocation counter of event loop stage 'name',
+  // if enabled
+
+  if( fDoBench ) fBench->Begin(name);
+  if( fAllocStats ) fAllocStats->Begin(name);
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::StopStage( const char* name )
+{
+  // Stop timer and allocation counter of event loop stage 'name'
+
+  if( fAllocStats ) fAllocStats->Stop(name);
+  if( fDoBench ) fBench->Stop(name);
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::EndModuleEvent()
+{
+  // Close per-module accounting for the current event. Flag modules whose
+  // time for this event exceeded the time budget, if one is set.
+
+  UInt_t evnum = fEvData->GetEvNum();
+  for( auto& st : fModuleStats ) {
+    if( st.EndEvent(evnum, fModuleBudget) &&
+        st.GetNoverBudget() <= fMaxBudgetWarn ) {
+      Warning("THaAnalyzer", "Module %s took %.3f ms in event %u, exceeding "
+              "budget of %.3f ms%s", st.GetModule()->GetName(),
+              1e3 * st.GetLastTime(), evnum, 1e3 * fModuleBudget,
+              st.GetNoverBudget() == fMaxBudgetWarn
+              ? ". Further warnings suppressed." : "");
+    }
+  }
+}
+
+//_____________________________________________________________________________
+void THaAnalyzer::WriteModuleStats()
+{
+  // Write per-module statistics to the current output file as a TTree
+  // with one entry per module
+
+  if( fModuleStats.empty() )
+    return;
+  TDirectory* olddir = gDirectory;
+  fFile->cd();
+  auto* tree = new TTree("ModuleStats", "Per-module timing statistics");
+  Char_t    name[128];
+  ULong64_t ncalls = 0, nevents = 0, nalloc = 0, maxalloc = 0;
+  Double_t  total = 0, tmax = 0;
+  UInt_t    maxev = 0, nover = 0, lastalloc = 0;
+  tree->Branch("name",    name,     "name/C");
+  tree->Branch("ncalls",  &ncalls,  "ncalls/l");
+  tree->Branch("nevents", &nevents, "nevents/l");
+  tree->Branch("total",   &total,   "total/D");
+  tree->Branch("max",     &tmax,    "max/D");
+  tree->Branch("maxev",   &maxev,   "maxev/i");
+  tree->Branch("nalloc",  &nalloc,  "nalloc/l");
+  tree->Branch("maxalloc",  &maxalloc,  "maxalloc/l");
+  tree->Branch("lastalloc", &lastalloc, "lastalloc/i");
+  tree->Branch("nover",   &nover,   "nover/i");
+  for( const auto& st : fModuleStats ) {
+    strncpy(name, st.GetModule()->GetName(), sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    ncalls  = st.GetNcalls();
+    nevents = st.GetNevents();
+    total   = st.GetTotalTime();
+    tmax    = st.GetMaxTime();
+    maxev   = st.GetMaxEvent();
+    nalloc  = st.GetNalloc();
+    maxalloc  = st.GetMaxAlloc();
+    lastalloc = st.GetLastAllocEvent();
+    nover   = st.GetNoverBudget();
+    tree->Fill();
+  }
+  tree->Write("", TObject::kOverwrite);
+  delete tree;
+  olddir->cd();
 }
 
 //_____________________________________________________________________________
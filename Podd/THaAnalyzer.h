@@ -9,6 +9,7 @@
 
 #include "TObject.h"
 #include "TString.h"
+#include "ModuleStats.h"
 #include <vector>
 
 class THaEvent;
@@ -29,14 +30,20 @@ class THaApparatus;
 class THaSpectrometer;
 class THaPhysicsModule;
 class THaAnalysisObject;
+class TH1;
 namespace Podd {
   class InterStageModule;
+  class EventCache;
+  class ShardInfo;
+  class Checkpoint;
+  class AnalysisContext;
+  class StageAllocStats;
 }
 
 class THaAnalyzer : public TObject {
 
 public:
-  THaAnalyzer();
+  explicit THaAnalyzer( Podd::AnalysisContext* ctx = nullptr );
   virtual ~THaAnalyzer();
 
   virtual Int_t  AddInterStage( Podd::InterStageModule* module );
@@ -46,13 +53,20 @@ public:
           Int_t  Init( THaRunBase& run )    { return Init( &run ); }
   virtual Int_t  Process( THaRunBase* run=nullptr );
           Int_t  Process( THaRunBase& run ) { return Process(&run); }
+  virtual Int_t  SwitchOutputFile( const char* name );
   virtual void   Print( Option_t* opt="" ) const;
 
+  void           EnableAllocTracking( Bool_t b = true );
   void           EnableBenchmarks( Bool_t b = true );
+  void           EnableCrateSelection( Bool_t b = true );
+  void           EnableEventCache( Bool_t b = true );
   void           EnableHelicity( Bool_t b = true );
+  void           EnableLazyDecoding( Bool_t b = true );
+  void           EnableModuleBenchmarks( Bool_t b = true );
   void           EnableOtherEvents( Bool_t b = true );
   void           EnableOverwrite( Bool_t b = true );
   void           EnablePhysicsEvents( Bool_t b = true );
+  void           EnablePruning( Bool_t b = true );
   void           EnableRunUpdate( Bool_t b = true );
   void           EnableSlowControl( Bool_t b = true );
   const char*    GetOutFileName()      const  { return fOutFileName.Data(); }
@@ -73,9 +87,18 @@ public:
                  GetEvtHandlers()      const  { return fEvtHandlers; }
   const std::vector<THaPostProcess*>&
                  GetPostProcess()      const  { return fPostProcess; }
+  Podd::EventCache* GetEventCache()    const  { return fEventCache; }
+  const Podd::StageAllocStats*
+                 GetAllocStats()       const  { return fAllocStats; }
+  Bool_t         AllocTrackingEnabled() const { return fAllocStats != nullptr; }
   Bool_t         HasStarted()          const  { return fAnalysisStarted; }
+  Bool_t         CrateSelectionEnabled() const { return fDoCrateSel; }
+  Bool_t         EventCacheEnabled()   const  { return fEventCache != nullptr; }
   Bool_t         HelicityEnabled()     const  { return fDoHelicity; }
+  Bool_t         LazyDecodingEnabled() const  { return fDoLazyDecode; }
+  Bool_t         ModuleBenchmarksEnabled() const { return fDoModuleBench; }
   Bool_t         PhysicsEnabled()      const  { return fDoPhysics; }
+  Bool_t         PruningEnabled()      const  { return fDoPruning; }
   Bool_t         OtherEventsEnabled()  const  { return fDoOtherEvents; }
   Bool_t         SlowControlEnabled()  const  { return fDoSlowControl; }
   virtual Int_t  SetCountMode( Int_t mode );
@@ -88,13 +111,57 @@ public:
   void           SetCompressionLevel( Int_t level ) { fCompress = level; }
   void           SetMarkInterval( UInt_t interval ) { fMarkInterval = interval; }
   void           SetVerbosity( Int_t level )        { fVerbose = level; }
+  // Per-event time budget (seconds) for each module. 0 = no budget
+  void           SetModuleTimeBudget( Double_t t )  { fModuleBudget = t; }
+  // Events excluded from steady-state allocation statistics
+  void           SetAllocWarmup( UInt_t n );
+  // Number of threads for module initialization. 1 = sequential
+  void           SetInitThreads( UInt_t n )         { fInitThreads = n; }
+  UInt_t         GetInitThreads()      const  { return fInitThreads; }
+  // Number of threads for decoding CODA3 event blocks. 1 = sequential
+  void           SetDecodeThreads( UInt_t n )       { fDecodeThreads = n; }
+  UInt_t         GetDecodeThreads()    const  { return fDecodeThreads; }
+  Double_t       GetModuleTimeBudget() const        { return fModuleBudget; }
+  const std::vector<Podd::ModuleStats>&
+                 GetModuleStats()      const  { return fModuleStats; }
+  // Stage timers ("Decode", "Tracking", ...), see EnableBenchmarks()
+  THaBenchmark*  GetBenchmark()        const  { return fBench; }
   void           SetCodaVersion(Int_t vers);
 
+  // Sharded analysis: analyze only part 'shard' (0..nshards-1) of a run.
+  // kShardEvents divides the event range, kShardSegments divides the file
+  // segments of a Podd::MultiFileRun.
+  enum EShardMode { kShardEvents, kShardSegments };
+  void           SetShard( UInt_t shard, UInt_t nshards,
+                           EShardMode mode = kShardEvents );
+  void           ClearShard()                       { fNshards = 0; }
+  // Total number of events to divide (kShardEvents). 0 = count them
+  void           SetShardEvents( UInt_t nev )       { fShardNevents = nev; }
+  // Events (kShardEvents) or segments (kShardSegments) preceding the shard
+  // that are scanned for scaler and EPICS data
+  void           SetShardWarmup( UInt_t n )         { fShardWarmup = n; }
+  UInt_t         GetShard()            const  { return fShard; }
+  UInt_t         GetNshards()          const  { return fNshards; }
+
+  // Checkpointing: save the state of the analysis every 'nbuf' event
+  // buffers read, but at most every 'tmin' seconds. 0 = disabled.
+  void           SetCheckpointInterval( UInt_t nbuf, Double_t tmin = 0 )
+  { fCkptInterval = nbuf; fCkptMinTime = tmin; }
+  // Default checkpoint file name is the output file name + ".ckpt"
+  void           SetCheckpointFile( const char* name ) { fCkptFileName = name; }
+  TString        GetCheckpointFileName() const;
+  UInt_t         GetCheckpointInterval() const { return fCkptInterval; }
+  // Resume an interrupted replay from its checkpoint, if any
+  void           EnableResume( Bool_t b = true )    { fDoResume = b; }
+  Bool_t         ResumeEnabled()       const  { return fDoResume; }
+
   // Set the EPICS event type
   void           SetEpicsEvtType(Int_t itype);
   void           AddEpicsEvtType(Int_t itype);
 
-  static THaAnalyzer* GetInstance() { return fgAnalyzer; }
+  // Analyzer of the current analysis context
+  static THaAnalyzer* GetInstance();
+  Podd::AnalysisContext* GetContext() const { return fContext; }
 
   // Return codes for analysis routines inside event loop
   // These should be ordered by severity
@@ -102,12 +169,16 @@ public:
 
   enum {
     kRawDecode = 0, kDecode, kCoarseTrack, kCoarseRecon,
-    kTracking, kReconstruct, kPhysics
+    kTracking, kReconstruct, kPhysics,
+    kPreDecode   // Header-only test, evaluated before raw decoding
   };
 
   // For SetCountMode
   enum ECountMode { kCountPhysics, kCountAll, kCountRaw };
 
+  // Name of Podd::ShardInfo object in output of sharded analysis
+  static const char* const kShardInfoName;
+
 protected:
   // Test and histogram blocks
   class Stage_t {
@@ -127,7 +198,8 @@ protected:
     kNevRead = 0, kNevGood, kNevPhysics, kNevEpics, kNevOther,
     kNevPostProcess, kNevAnalyzed, kNevAccepted,
     kDecodeErr, kCodaErr, kRawDecodeTest, kDecodeTest, kCoarseTrackTest,
-    kCoarseReconTest, kTrackTest, kReconstructTest, kPhysicsTest
+    kCoarseReconTest, kTrackTest, kReconstructTest, kPhysicsTest,
+    kPreDecodeTest
   };
   class Counter_t {
   public:
@@ -171,6 +243,43 @@ protected:
   // Combined list of fApps, fInterStage and fPhysics for PhysicsAnalysis.
   // Does not include fPostProcess and fEvtHandlers.
   std::vector<THaAnalysisObject*>      fAnalysisModules; // Analysis modules
+  // Per-module accounting, parallel to fAnalysisModules
+  std::vector<Podd::ModuleStats>       fModuleStats;     //! Module statistics
+  std::vector<size_t>                  fSpectroIdx;      //! fSpectrometers in fApps
+  // Modules skipped because their results are unused, parallel to
+  // fAnalysisModules. Empty if pruning is disabled.
+  std::vector<bool>                    fSkipModule;      //!
+  Double_t       fModuleBudget;    // Per-event time budget per module (s)
+  UInt_t         fMaxBudgetWarn;   // Max budget warnings printed per module
+  UInt_t         fInitThreads;     // Threads for module initialization
+  UInt_t         fDecodeThreads;   // Threads for decoding event blocks
+  Podd::EventCache* fEventCache;   // Raw event cache (null if disabled)
+  Podd::StageAllocStats* fAllocStats; //! Per-stage allocations (null if disabled)
+  UInt_t         fAllocWarmup;     // Warm-up events for allocation statistics
+
+  // Sharded analysis. Events preceding the shard are either skipped or
+  // scanned only by the event type handlers ("warm-up").
+  enum EShardState { kShardSkip, kShardWarmup, kShardActive };
+  UInt_t         fShard;           // Index of shard to analyze
+  UInt_t         fNshards;         // Number of shards (0 = no sharding)
+  EShardMode     fShardMode;       // Division of run into shards
+  UInt_t         fShardNevents;    // Events to divide (0 = count)
+  UInt_t         fShardWarmup;     // Events/segments to scan before shard
+  UInt_t         fShardFirst;      // First event/segment of shard
+  EShardState    fShardState;      // State of current event
+  Podd::ShardInfo* fShardStart;    //! Statistics at start of shard
+
+  // Checkpoint and resume. A resumed replay skips the events up to the
+  // checkpoint like the events preceding a shard.
+  UInt_t         fCkptInterval;    // Buffers read between checkpoints (0=off)
+  Double_t       fCkptMinTime;     // Minimum time between checkpoints (s)
+  TString        fCkptFileName;    // Checkpoint file name (default: output+.ckpt)
+  ULong64_t      fNread;           // Event buffers read in current replay
+  ULong64_t      fNextCkpt;        // fNread at which next checkpoint is due
+  Long64_t       fLastCkptTime;    // Time of last checkpoint (ms)
+  TString        fResumeFileName;  // Output file being resumed from
+  Podd::Checkpoint* fResumeCkpt;   //! Checkpoint being resumed from
+  Podd::AnalysisContext* fContext; //! Lists, run and decoder of this analysis
 
   // Status and control flags
   Bool_t         fIsInit;          // Init() called successfully
@@ -179,10 +288,16 @@ protected:
   Bool_t         fUpdateRun;       // Update run parameters during replay
   Bool_t         fOverwrite;       // Overwrite existing output files
   Bool_t         fDoBench;         // Collect detailed timing statistics
+  Bool_t         fDoModuleBench;   // Collect per-module timing statistics
   Bool_t         fDoHelicity;      // Enable helicity decoding
   Bool_t         fDoPhysics;       // Enable physics event processing
   Bool_t         fDoOtherEvents;   // Enable other event processing
   Bool_t         fDoSlowControl;   // Enable slow control processing
+  Bool_t         fDoPruning;       // Skip modules whose results are unused
+  Bool_t         fDoCrateSel;      // Decode only crates used by the analysis
+  Bool_t         fDoLazyDecode;    // Decode crates on first access
+  Bool_t         fReplayCache;     // Current replay reads from fEventCache
+  Bool_t         fDoResume;        // Resume replay from checkpoint
 
   // Variables used by analysis functions
   Bool_t         fFirstPhysics;    // Status flag for physics analysis
@@ -194,32 +309,69 @@ protected:
   virtual Int_t  MainAnalysis();
   virtual Int_t  PhysicsAnalysis( Int_t code );
   virtual Int_t  SlowControlAnalysis( Int_t code );
+  virtual void   EvtHandlerAnalysis();
   virtual Int_t  OtherAnalysis( Int_t code );
   virtual Int_t  PostProcess( Int_t code );
   virtual Int_t  ReadOneEvent();
 
+  // Sharded analysis
+  virtual Int_t  InitShardSegments( THaRunBase* run );
+  virtual Int_t  InitShardEvents();
+  UInt_t         CountEvents();
+  void           StartShard();
+  void           StartWarmup();
+  void           UpdateShardState();
+  void           EndWarmup();
+  Podd::ShardInfo* MakeShardInfo() const;
+
+  // Checkpoint and resume
+  virtual Int_t  WriteCheckpoint();
+  void           CheckpointOutput( Podd::Checkpoint& ckpt,
+                                   std::vector<TH1*>& hists );
+  void           GetStateObjects( std::vector<THaAnalysisObject*>& objs ) const;
+  void           SaveModuleStates( Podd::Checkpoint& ckpt ) const;
+  void           RestoreModuleStates( const Podd::Checkpoint& ckpt ) const;
+  virtual Int_t  InitResume( THaRunBase* run );
+  virtual Int_t  ResumeOutput();
+  void           EndResume();
+
   // Support methods & data
   void           ClearCounters();
+  void           ProcessInterStage( Int_t stage, THaAnalysisObject*& obj );
+  Podd::ModuleStats* ModStats( size_t i );
+  void           BeginStage( const char* name );
+  void           StopStage( const char* name );
+  virtual void   EndModuleEvent();
+  virtual void   WriteModuleStats();
   UInt_t         GetCount( Int_t which ) const;
   UInt_t         Incr( Int_t which );
   virtual bool   EvalStage( int n );
+  bool           TestEventHeader();
   virtual void   InitCounters();
   virtual void   InitCuts();
   virtual void   InitStages();
   virtual Int_t  InitModules( const std::vector<THaAnalysisObject*>& module_list,
                               TDatime& run_time );
   virtual Int_t  InitOutput( const std::vector<THaAnalysisObject*>& module_list );
+  virtual Int_t  CheckRawDataAccess( const std::vector<THaAnalysisObject*>&
+                                     module_list, THaRunBase* run );
 
   enum class EExitStatus { kUnknown = -1, kEOF, kEvLimit, kFatal, kTerminated };
   virtual void   PrepareModuleList();
+  virtual void   PruneModules();
+  virtual void   SelectCrates();
+  bool           IsPruned( size_t i ) const;
+  size_t         FindOwner( const char* name ) const;
+  size_t         FindOwner( const THaAnalysisObject* obj ) const;
   virtual void   PrintCounters() const;
   virtual void   PrintExitStatus( EExitStatus status ) const;
   virtual void   PrintRunSummary() const;
   virtual void   PrintCutSummary() const;
   virtual void   PrintTimingSummary() const;
+  virtual void   PrintModuleSummary() const;
   virtual void   PrintSummary( EExitStatus exit_status ) const;
 
-  static THaAnalyzer* fgAnalyzer;  //Pointer to instance of this class
+  static THaAnalyzer* fgAnalyzer;  //Analyzer of the default context
 
   TObject*        fExtra;   // Additional member data (for binary compat.)
 
@@ -247,4 +399,18 @@ inline UInt_t THaAnalyzer::Incr( Int_t which )
   return ++(fCounters[which].count);
 }
 
+//_____________________________________________________________________________
+inline bool THaAnalyzer::IsPruned( size_t i ) const
+{
+  // True if i-th entry in fAnalysisModules is to be skipped
+  return !fSkipModule.empty() && fSkipModule[i];
+}
+
+//_____________________________________________________________________________
+inline Podd::ModuleStats* THaAnalyzer::ModStats( size_t i )
+{
+  // Statistics for i-th entry in fAnalysisModules, if enabled
+  return fDoModuleBench ? &fModuleStats[i] : nullptr;
+}
+
 #endif
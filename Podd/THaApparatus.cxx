@@ -153,6 +153,19 @@ Int_t THaApparatus::End( THaRunBase* run )
   return 0;
 }
 
+//_____________________________________________________________________________
+Bool_t THaApparatus::UsesRawEventData() const
+{
+  // True if any of our detectors reads raw event words
+
+  TIter next(fDetectors);
+  while( auto* obj = static_cast<THaAnalysisObject*>(next()) ) {
+    if( obj->UsesRawEventData() )
+      return true;
+  }
+  return false;
+}
+
 //_____________________________________________________________________________
 THaDetector* THaApparatus::GetDetector( const char* name )
 {
@@ -243,5 +256,20 @@ void THaApparatus::SetDebugAll( Int_t level )
   }
 }
 
+//_____________________________________________________________________________
+void THaApparatus::SetUsedOutputs( const std::set<const THaVar*>& vars,
+                                   Bool_t all )
+{
+  // Pass the used variables on to all detectors. Results that the
+  // apparatus itself needs from its detectors are not included in 'vars',
+  // so detectors may only skip computations that feed their global
+  // variables exclusively.
+
+  TIter next(fDetectors);
+  while( auto* theDetector = static_cast<THaDetector*>( next() )) {
+    theDetector->SetUsedOutputs( vars, all );
+  }
+}
+
 //_____________________________________________________________________________
 ClassImp(THaApparatus)
@@ -33,6 +33,9 @@ public:
   virtual Int_t        CoarseReconstruct() { return 0; }
   virtual Int_t        Reconstruct() = 0;
   virtual void         SetDebugAll( Int_t level );
+  virtual void         SetUsedOutputs( const std::set<const THaVar*>& vars,
+                                       Bool_t all );
+  virtual Bool_t       UsesRawEventData() const;
 
 protected:
   TList*         fDetectors;    // List of all detectors for this apparatus
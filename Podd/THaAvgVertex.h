@@ -26,6 +26,7 @@ public:
 
   virtual EStatus   Init( const TDatime& run_time );
   virtual Int_t     Process( const THaEvData& );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
           void      SetSpectrometers( const char* name1, const char* name2 );
 
 protected:
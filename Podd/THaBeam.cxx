@@ -14,6 +14,7 @@
 #include "THaRunBase.h"
 #include "THaRunParameters.h"
 #include "THaGlobals.h"
+#include "AnalysisContext.h"
 
 //_____________________________________________________________________________
 THaBeam::THaBeam( const char* name, const char* desc ) : 
@@ -41,13 +42,13 @@ THaAnalysisObject::EStatus THaBeam::Init( const TDatime& run_time )
   // initialization and, in addition, finds pointer to the current 
   // run parameters.
 
-  if( !gHaRun || !gHaRun->IsInit() ) {
+  if( !fContext->GetRun() || !fContext->GetRun()->IsInit() ) {
     Error( Here("Init"), "Current run not initialized. "
 	   "Failed to initialize beam apparatus %s (\"%s\"). ",
 	   GetName(), GetTitle() );
     return fStatus = kInitError;
   }
-  fRunParam = gHaRun->GetParameters();
+  fRunParam = fContext->GetRun()->GetParameters();
   if( !fRunParam ) {
     Error( Here("Init"), "Current run has no parameters?!? "
 	   "Failed to initialize beam apparatus %s (\"%s\"). ",
@@ -86,7 +87,7 @@ void THaBeam::Update()
 {
   // Update the fBeamIfo data with the info from the current event
 
-  THaRunParameters* rp = gHaRun->GetParameters();
+  THaRunParameters* rp = fContext->GetRun()->GetParameters();
   if( rp )
     fBeamIfo.Set( rp->GetBeamP(), fDirection, fPosition,
 		  rp->GetBeamPol() );
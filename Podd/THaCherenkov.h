@@ -26,6 +26,8 @@ public:
   virtual void       Clear( Option_t* ="" );
   virtual Int_t      CoarseProcess( TClonesArray& tracks );
   virtual Int_t      FineProcess( TClonesArray& tracks );
+  virtual Bool_t     GetUsedCrateSlots( CrateSlots_t& cs ) const
+  { return DetMapCrateSlots(cs); }
           Data_t     GetAsum() const { return fASUM_c; }
 
 protected:
@@ -39,6 +41,7 @@ protected:
 
   virtual Int_t    DefineVariables( EMode mode = kDefine );
   virtual Int_t    ReadDatabase( const TDatime& date );
+  virtual Bool_t   IsDBReadThreadSafe() const { return true; }
 
   ClassDef(THaCherenkov,0)    //Generic Cherenkov class
 };
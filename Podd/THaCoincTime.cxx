@@ -273,6 +273,18 @@ Int_t THaCoincTime::Process( const THaEvData& evdata )
   return 0;
 }
 
+//_____________________________________________________________________________
+Bool_t THaCoincTime::GetUsedCrateSlots( CrateSlots_t& crateslots ) const
+{
+  // Add the crates/slots of the coincidence TDC channels to 'crateslots'
+
+  for( UInt_t i = 0; i < fDetMap->GetSize(); ++i ) {
+    const THaDetMap::Module* d = fDetMap->GetModule(i);
+    crateslots.emplace(d->crate, d->slot);
+  }
+  return true;
+}
+
 ClassImp(THaCoincTime)
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -34,6 +34,7 @@ public:
   
   virtual EStatus   Init( const TDatime& run_time );
   virtual Int_t     Process( const THaEvData& );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& crateslots ) const;
 
   Int_t   GetNTr1()   const { return fVxTime1.size(); }
   Int_t   GetNTr2()   const { return fVxTime2.size(); }
@@ -14,7 +14,8 @@ class THaCut : public THaFormula {
 public:
   THaCut();
   THaCut( const char* name, const char* expression, const char* block,
-	  const THaVarList* vlst = gHaVars, const THaCutList* clst = gHaCuts );
+	  const THaVarList* vlst = Podd::AnalysisContext::Current()->GetVars(),
+	  const THaCutList* clst = Podd::AnalysisContext::Current()->GetCuts() );
   THaCut( const THaCut& ) = default;
   THaCut& operator=( const THaCut& ) = default;
   virtual ~THaCut() = default;
@@ -39,6 +40,8 @@ public:
   virtual void         Print( Option_t *opt="" ) const;
   virtual void         Reset();
   virtual void         SetBlockname( const Text_t* name );
+          void         SetCounts( UInt_t ncalled, UInt_t npassed )
+  { fNCalled = ncalled; fNPassed = npassed; }
   virtual void         SetName( const Text_t* name );
   virtual void         SetNameTitle( const Text_t* name, const Text_t* title );
 
@@ -17,6 +17,7 @@
 #include "THaEvData.h"
 #include "TRegexp.h"
 #include "TClass.h"
+#include "AnalysisContext.h"
 
 #include <cstring>
 #include <cctype>
@@ -90,8 +91,8 @@ Int_t THaDebugModule::THaDebugModule::ParseList()
         bool found = false;
         TRegexp re(opt, true);
         // We can inspect analysis variables and cuts/tests
-        if( gHaVars ) {
-          TIter next(gHaVars);
+        if( fContext->GetVars() ) {
+          TIter next(fContext->GetVars());
           while( TObject* obj = next() ) {
             TString s = obj->GetName();
             if( s.Index(re) != kNPOS ) {
@@ -100,8 +101,8 @@ Int_t THaDebugModule::THaDebugModule::ParseList()
             }
           }
         }
-        if( gHaCuts ) {
-          const TList* lst = gHaCuts->GetCutList();
+        if( fContext->GetCuts() ) {
+          const TList* lst = fContext->GetCuts()->GetCutList();
           if( lst ) {
             TIter next(lst);
             while( TObject* obj = next() ) {
@@ -206,6 +206,22 @@ void THaDetectorBase::PrintDetMap( Option_t* opt ) const
   fDetMap->Print( opt );
 }
 
+//_____________________________________________________________________________
+Bool_t THaDetectorBase::DetMapCrateSlots( CrateSlots_t& crateslots ) const
+{
+  // Add the crates/slots in the detector map to 'crateslots'. Always
+  // returns true. Detectors that read data only through their detector
+  // map return this from GetUsedCrateSlots().
+
+  if( !fDetMap )
+    return true;
+  for( UInt_t i = 0; i < fDetMap->GetSize(); ++i ) {
+    const THaDetMap::Module* d = fDetMap->GetModule(i);
+    crateslots.emplace(d->crate, d->slot);
+  }
+  return true;
+}
+
 //_____________________________________________________________________________
 Int_t THaDetectorBase::ReadGeometry( FILE* file, const TDatime& date,
 				     Bool_t required )
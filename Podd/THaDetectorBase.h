@@ -53,6 +53,10 @@ public:
   virtual Int_t    GetView( const DigitizerHitInfo_t& hitinfo ) const;
 
 protected:
+  // Crates/slots of the detector map, for GetUsedCrateSlots() of detectors
+  // that read data only via their detector map
+  Bool_t           DetMapCrateSlots( CrateSlots_t& crateslots ) const;
+
   // Mapping
   THaDetMap*    fDetMap;    // Hardware channel map for this detector
 
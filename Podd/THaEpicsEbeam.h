@@ -31,6 +31,7 @@ public:
 
   virtual EStatus   Init( const TDatime& run_time );
   virtual Int_t     Process( const THaEvData& );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
           void      SetBeam( const char* beam );
           void      SetEpicsVar( const char* epics_var );
           void      SetEpicsIsMomentum( Bool_t mode=true );
@@ -26,6 +26,7 @@
 #include "THaVarList.h"
 #include "THaGlobals.h"
 #include "TClass.h"
+#include "AnalysisContext.h"
 #include <cstring>   // for memcpy
 
 ClassImp(THaEventHeader)
@@ -171,11 +172,12 @@ Int_t THaEvent::Init()
 {
   // Initialize fDataMap. Called automatically by Fill() as necessary.
 
-  if( !gHaVars ) return -2;
+  THaVarList* vars = Podd::AnalysisContext::Current()->GetVars();
+  if( !vars ) return -2;
 
   for( auto& datamap : fDataMap ) {
     if( datamap.ncopy == 0 ) break;
-    if( THaVar* pvar = gHaVars->Find( datamap.name )) {
+    if( THaVar* pvar = vars->Find( datamap.name )) {
       datamap.pvar = pvar;
     } else {
       Warning("Init()", "Global variable %s not found. "
@@ -33,6 +33,7 @@
 #include "THaEvt125Handler.h"
 #include "THaEvData.h"
 #include "THaVarList.h"
+#include "AnalysisContext.h"
 #include <cstring>
 #include <cstdio>
 #include <iostream>
@@ -98,8 +99,8 @@ THaAnalysisObject::EStatus THaEvt125Handler::Init(const TDatime&)
   NVars = 4;
   dvars = new Double_t[NVars];
   memset(dvars, 0, NVars*sizeof(Double_t));
-  if (gHaVars) {
-      cout << "EvtHandler:: Have gHaVars.  Good thing. "<<gHaVars<<endl;
+  if (fContext->GetVars()) {
+      cout << "EvtHandler:: Have gHaVars.  Good thing. "<<fContext->GetVars()<<endl;
   } else {
       cout << "EvtHandler:: No gHaVars ?!  Well, that is a problem !!"<<endl;
       return kInitError;
@@ -111,7 +112,7 @@ THaAnalysisObject::EStatus THaEvt125Handler::Init(const TDatime&)
   for (UInt_t i = 0; i < NVars; i++) {
     snprintf(cname, LEN, "HCvar%d", i+1);
     snprintf(cdescription, LEN, "Hall C event type 125 variable %d", i+1);
-    gHaVars->DefineByType(cname, cdescription, &dvars[i], kDouble, count);
+    fContext->GetVars()->DefineByType(cname, cdescription, &dvars[i], kDouble, count);
   }
 
 
@@ -15,7 +15,7 @@
 using namespace std;
 
 THaEvtTypeHandler::THaEvtTypeHandler(const char* name, const char* description)
-  : THaAnalysisObject(name, description), fDebugFile(nullptr)
+  : THaAnalysisObject(name, description), fDebugFile(nullptr), fWarmup(false)
 {
 }
 
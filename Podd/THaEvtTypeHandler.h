@@ -35,10 +35,16 @@ public:
      return eventtypes[0];
    }
    virtual std::vector<UInt_t> GetEvtTypes() { return eventtypes; };
+   // In warm-up mode, handlers update their internal state (e.g. previous
+   // scaler readings) but do not write any output. Used for events
+   // preceding the part of a run being analyzed (see THaAnalyzer::SetShard)
+   virtual void SetWarmup( Bool_t b = true ) { fWarmup = b; }
+   Bool_t IsWarmup() const { return fWarmup; }
 
 protected:
    std::vector<UInt_t> eventtypes;
    std::ofstream *fDebugFile;
+   Bool_t fWarmup;  // Warm-up mode: analyze, but do not write output
 
    virtual void MakePrefix();
 
@@ -28,6 +28,7 @@ public:
 
   virtual EStatus   Init( const TDatime& run_time );
   virtual Int_t     Process( const THaEvData& );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
           void      SetModuleNames( const char* spectro, const char* vertex="" );
 
 protected:
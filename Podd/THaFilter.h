@@ -18,6 +18,9 @@ class THaFilter : public THaPostProcess {
   virtual Int_t Init(const TDatime&);
   virtual Int_t Process( const THaEvData*, const THaRunBase*, Int_t code );
   virtual Int_t Close();
+  // Reads only the raw event buffer, which is never skipped
+  virtual Bool_t GetUsedCrateSlots( std::set<std::pair<UInt_t,UInt_t>>& ) const
+  { return true; }
 
   THaCut* GetCut() const { return fCut; }
 
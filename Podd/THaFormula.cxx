@@ -754,6 +754,32 @@ Int_t THaFormula::GetNdataUnchecked() const
   return ndata;
 }
 
+//_____________________________________________________________________________
+void THaFormula::GetVariables( std::set<const THaVar*>& vars ) const
+{
+  // Add the global variables used by this formula to 'vars'. Cuts and
+  // sub-formulas (e.g. arguments of Sum$()) are expanded recursively.
+
+  for( const auto& def : fVarDef ) {
+    switch( def.type ) {
+    case kVariable:
+    case kString:
+    case kArray:
+      vars.insert(static_cast<const THaVar*>(def.obj));
+      break;
+    case kCut:
+      static_cast<const THaCut*>(def.obj)->GetVariables(vars);
+      break;
+    case kFormula:
+    case kVarFormula:
+      static_cast<const THaFormula*>(def.obj)->GetVariables(vars);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
 //_____________________________________________________________________________
 Int_t THaFormula::GetNdata() const
 {
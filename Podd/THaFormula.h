@@ -10,7 +10,9 @@
 #include "RVersion.h"
 #include "v5/TFormula.h"
 #include "THaGlobals.h"
+#include "AnalysisContext.h"
 #include <vector>
+#include <set>
 #include <iostream>
 
 class THaVarList;
@@ -26,7 +28,8 @@ public:
 
   THaFormula();
   THaFormula( const char* name, const char* formula, Bool_t do_register=true,
-	      const THaVarList* vlst=gHaVars, const THaCutList* clst=gHaCuts );
+	      const THaVarList* vlst=Podd::AnalysisContext::Current()->GetVars(),
+	      const THaCutList* clst=Podd::AnalysisContext::Current()->GetCuts() );
   THaFormula( const THaFormula& rhs );
   THaFormula& operator=( const THaFormula& rhs );
   virtual ~THaFormula();
@@ -48,6 +51,9 @@ public:
   { return const_cast<THaFormula*>(this)->Eval(); }
   virtual Double_t    EvalInstance( Int_t instance );
   virtual Int_t       GetNdata()   const;
+  // Add the global variables used by this formula, including those of
+  // referenced cuts and sub-formulas, to 'vars'
+  virtual void        GetVariables( std::set<const THaVar*>& vars ) const;
   virtual Bool_t      IsArray()    const { return TestBit(kArrayFormula); }
   virtual Bool_t      IsVarArray() const { return TestBit(kVarArray); }
           Bool_t      IsError()    const { return TestBit(kError); }
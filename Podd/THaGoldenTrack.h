@@ -24,6 +24,7 @@ public:
   virtual void      Clear( Option_t* opt="" );
   virtual EStatus   Init( const TDatime& run_time );
   virtual Int_t     Process( const THaEvData& evdata );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
 
   THaTrack*         GetTrack()     const { return fTrack; }
   const THaTrackInfo* GetTrackInfo() const { return &fTrkIfo; }
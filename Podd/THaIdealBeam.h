@@ -18,6 +18,7 @@ public:
   
   virtual EStatus Init( const TDatime& run_time );
   virtual Int_t   Reconstruct() { return 0; }
+  virtual Bool_t  GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
 
 protected:
 
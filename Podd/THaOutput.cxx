@@ -42,15 +42,13 @@
 #include <vector>
 
 #include "THaBenchmark.h"
+#include "AnalysisContext.h"
 
 using namespace std;
 using namespace THaString;
 using namespace Podd;
 
 Int_t THaOutput::fgVerbose = 1;
-//FIXME: these should be member variables
-static Bool_t fgDoBench = false;
-static THaBenchmark fgBench;
 
 static const char comment('#');
 
@@ -173,7 +171,8 @@ THaOutput::THaOutput()
     fEpicsTree(nullptr), fInit(false),
     fExtra(nullptr), fEpicsHandler(nullptr),
     nx(0), ny(0), iscut(0), xlo(0), xhi(0), ylo(0), yhi(0),
-    fOpenEpics(false), fFirstEpics(false), fIsScalar(false)
+    fOpenEpics(false), fFirstEpics(false), fIsScalar(false),
+    fDoBench(false), fBench(new THaBenchmark)
 {
   // Constructor
 }
@@ -184,6 +183,7 @@ THaOutput::~THaOutput()
   // Destructor
 
   delete fExtra; fExtra = nullptr;
+  delete fBench;
 
   // Delete Trees and histograms only if ROOT system is initialized.
   // ROOT will report being uninitialized if we're called from the TSystem
@@ -225,9 +225,10 @@ Int_t THaOutput::Init( const char* filename )
     return 1;
   }
 
-  if( !gHaVars ) return -2;
+  THaVarList* vars = Podd::AnalysisContext::Current()->GetVars();
+  if( !vars ) return -2;
 
-  if( fgDoBench ) fgBench.Begin("Init");
+  if( fDoBench ) fBench->Begin("Init");
 
   fTree = new TTree("T","Hall A Analyzer Output DST");
   fTree->SetAutoSave(200000000);
@@ -235,7 +236,7 @@ Int_t THaOutput::Init( const char* filename )
   fFirstEpics = true;
 
   Int_t err = LoadFile( filename );
-  if( fgDoBench && err != 0 ) fgBench.Stop("Init");
+  if( fDoBench && err != 0 ) fBench->Stop("Init");
 
   if( err == -1 ) {
     return 0;       // No error if file not found, but please
@@ -253,7 +254,7 @@ Int_t THaOutput::Init( const char* filename )
   fVNames.clear();
 
   for (UInt_t ivar = 0; ivar < fNvar; ivar++) {
-    const auto* pvar = gHaVars->Find(fVarnames[ivar].c_str());
+    const auto* pvar = vars->Find(fVarnames[ivar].c_str());
     if (pvar) {
       if (pvar->IsArray()) {
 	fArrayNames.push_back(fVarnames[ivar]);
@@ -291,7 +292,7 @@ Int_t THaOutput::Init( const char* filename )
     vector<string> avar = pform->GetVars();
     for( const auto& str : avar ) {
       string svar = StripBracket(str);
-      const auto* pvar = gHaVars->Find(svar.c_str());
+      const auto* pvar = vars->Find(svar.c_str());
       if (pvar) {
 	if (pvar->IsArray()) {
           auto found = find(fArrayNames.begin(), fArrayNames.end(), svar);
@@ -386,11 +387,11 @@ Int_t THaOutput::Init( const char* filename )
 
   fInit = true;
 
-  if( fgDoBench ) fgBench.Stop("Init");
+  if( fDoBench ) fBench->Stop("Init");
 
-  if( fgDoBench ) fgBench.Begin("Attach");
+  if( fDoBench ) fBench->Begin("Attach");
   Int_t st = Attach();
-  if( fgDoBench ) fgBench.Stop("Attach");
+  if( fDoBench ) fBench->Stop("Attach");
   if ( st )
     return -4;
 
@@ -439,7 +440,8 @@ Int_t THaOutput::Attach()
   // Also, sets the size of the fVariables and fArrays vectors
   // according to the size of the related names array
 
-  if( !gHaVars ) return -2;
+  THaVarList* vars = Podd::AnalysisContext::Current()->GetVars();
+  if( !vars ) return -2;
 
   UInt_t NAry = fArrayNames.size();
   UInt_t NVar = fVNames.size();
@@ -449,7 +451,7 @@ Int_t THaOutput::Attach()
 
   // simple variable-type names
   for (UInt_t ivar = 0; ivar < NVar; ivar++) {
-    auto* pvar = gHaVars->Find(fVNames[ivar].c_str());
+    auto* pvar = vars->Find(fVNames[ivar].c_str());
     if (pvar) {
       if ( !pvar->IsArray() ) {
 	fVariables[ivar] = pvar;
@@ -468,7 +470,7 @@ Int_t THaOutput::Attach()
 
   // arrays
   for (UInt_t ivar = 0; ivar < NAry; ivar++) {
-    auto* pvar = gHaVars->Find(fArrayNames[ivar].c_str());
+    auto* pvar = vars->Find(fArrayNames[ivar].c_str());
     if (pvar) {
       if ( pvar->IsArray() ) {
 	fArrays[ivar] = pvar;
@@ -502,14 +504,16 @@ Int_t THaOutput::Attach()
 }
 
 //_____________________________________________________________________________
-Int_t THaOutput::ProcEpics(THaEvData *evdata, THaEpicsEvtHandler *epicshandle)
+Int_t THaOutput::ProcEpics(THaEvData *evdata, THaEpicsEvtHandler *epicshandle,
+                           Bool_t fill)
 {
   // Process the EPICS data, this fills the trees.
+  // If 'fill' is false, only update the current EPICS values.
 
   if ( !epicshandle ) return 0;
   if ( !epicshandle->IsMyEvent(evdata->GetEvType())
        || fEpicsKey.empty() || !fEpicsTree ) return 0;
-  if( fgDoBench ) fgBench.Begin("EPICS");
+  if( fDoBench ) fBench->Begin("EPICS");
   auto* extras = static_cast<OutputExtras*>(fExtra);
   extras->fEpicsTimestamp = -1;
   extras->fEpicsEvtNum = evdata->GetEvNum(); // most recent physics event number
@@ -533,8 +537,8 @@ Int_t THaOutput::ProcEpics(THaEvData *evdata, THaEpicsEvtHandler *epicshandle)
       fEpicsVar[i] = -1e32;  // data not yet found
     }
   }
-  if (fEpicsTree) fEpicsTree->Fill();
-  if( fgDoBench ) fgBench.Stop("EPICS");
+  if (fEpicsTree && fill) fEpicsTree->Fill();
+  if( fDoBench ) fBench->Stop("EPICS");
   return 1;
 }
 
@@ -544,17 +548,17 @@ Int_t THaOutput::Process()
   // Process the variables, formulas, and histograms.
   // This is called by THaAnalyzer.
 
-  if( fgDoBench ) fgBench.Begin("Formulas");
+  if( fDoBench ) fBench->Begin("Formulas");
   for (auto & form : fFormulas)
     if (form) form->Process();
-  if( fgDoBench ) fgBench.Stop("Formulas");
+  if( fDoBench ) fBench->Stop("Formulas");
 
-  if( fgDoBench ) fgBench.Begin("Cuts");
+  if( fDoBench ) fBench->Begin("Cuts");
   for (auto & cut : fCuts)
     if (cut) cut->Process();
-  if( fgDoBench ) fgBench.Stop("Cuts");
+  if( fDoBench ) fBench->Stop("Cuts");
 
-  if( fgDoBench ) fgBench.Begin("Variables");
+  if( fDoBench ) fBench->Begin("Variables");
   for (UInt_t ivar = 0; ivar < fNvar; ivar++) {
     const auto* pvar = fVariables[ivar];
     if( pvar ) {
@@ -586,42 +590,69 @@ Int_t THaOutput::Process()
       }
     }
   }
-  if( fgDoBench ) fgBench.Stop("Variables");
+  if( fDoBench ) fBench->Stop("Variables");
 
-  if( fgDoBench ) fgBench.Begin("Histos");
+  if( fDoBench ) fBench->Begin("Histos");
   for (auto & hist : fHistos)
     hist->Process();
-  if( fgDoBench ) fgBench.Stop("Histos");
+  if( fDoBench ) fBench->Stop("Histos");
 
-  if( fgDoBench ) fgBench.Begin("TreeFill");
+  if( fDoBench ) fBench->Begin("TreeFill");
   if (fTree) fTree->Fill();
-  if( fgDoBench ) fgBench.Stop("TreeFill");
+  if( fDoBench ) fBench->Stop("TreeFill");
 
   return 0;
 }
 
+//_____________________________________________________________________________
+void THaOutput::GetVariables( std::set<const THaVar*>& vars ) const
+{
+  // Add pointers to all global variables that are written to the tree
+  // or used in output formulas, cuts and histograms to 'vars'
+
+  vars.insert(fVariables.begin(), fVariables.end());
+  vars.insert(fArrays.begin(), fArrays.end());
+  for( const auto* form : fFormulas )
+    form->GetVariables(vars);
+  for( const auto* cut : fCuts )
+    cut->GetVariables(vars);
+  for( const auto* hist : fHistos )
+    hist->GetVariables(vars);
+  vars.erase(nullptr);  // unresolved variable names
+}
+
+//_____________________________________________________________________________
+void THaOutput::FlushHistograms()
+{
+  // Merge the pending buffered fills of all histograms into the histograms,
+  // e.g. before they are copied or written mid-run
+
+  for (auto & hist : fHistos)
+    hist->Flush();
+}
+
 //_____________________________________________________________________________
 Int_t THaOutput::End()
 {
-  if( fgDoBench ) fgBench.Begin("End");
+  if( fDoBench ) fBench->Begin("End");
 
   if (fTree) fTree->Write();
   if (fEpicsTree) fEpicsTree->Write();
   for (auto & hist : fHistos)
     hist->End();
-  if( fgDoBench ) fgBench.Stop("End");
+  if( fDoBench ) fBench->Stop("End");
 
-  if( fgDoBench ) {
+  if( fDoBench ) {
     cout << "Output timing summary:" << endl;
-    fgBench.Print("Init");
-    fgBench.Print("Attach");
-    fgBench.Print("Variables");
-    fgBench.Print("Formulas");
-    fgBench.Print("Cuts");
-    fgBench.Print("Histos");
-    fgBench.Print("TreeFill");
-    fgBench.Print("EPICS");
-    fgBench.Print("End");
+    fBench->Print("Init");
+    fBench->Print("Attach");
+    fBench->Print("Variables");
+    fBench->Print("Formulas");
+    fBench->Print("Cuts");
+    fBench->Print("Histos");
+    fBench->Print("TreeFill");
+    fBench->Print("EPICS");
+    fBench->Print("End");
   }
   return 0;
 }
@@ -1135,7 +1166,7 @@ Int_t THaOutput::BuildBlock(const string& blockn)
 
 
   TRegexp re(blockn.c_str(),true);
-  TIter next(gHaVars);
+  TIter next(Podd::AnalysisContext::Current()->GetVars());
 
   Int_t nvars=0;
   while( TObject* obj = next() ) {
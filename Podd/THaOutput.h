@@ -10,6 +10,7 @@
 #include "TObject.h"
 #include <vector>
 #include <map>
+#include <set>
 #include <string> 
 #include <cstring>
 
@@ -21,6 +22,7 @@ class THaVhist;
 class THaEvData;
 class TTree;
 class THaEvtTypeHandler;
+class THaBenchmark;
 
 class THaOdata {
 // Utility class used by THaOutput to store arrays 
@@ -76,11 +78,18 @@ public:
 
   virtual Int_t Init( const char* filename="output.def" );
   virtual Int_t Process();
-  virtual Int_t ProcEpics(THaEvData *ev, THaEpicsEvtHandler *han);
+  virtual Int_t ProcEpics(THaEvData *ev, THaEpicsEvtHandler *han,
+                          Bool_t fill = true);
   virtual Int_t End();
+  // Merge all buffered histogram fills into the histograms
+  virtual void  FlushHistograms();
   virtual Bool_t TreeDefined() const { return fTree != nullptr; };
   virtual TTree* GetTree() const { return fTree; };
+  // Add pointers to all global variables used for output to 'vars'
+  virtual void   GetVariables( std::set<const THaVar*>& vars ) const;
 
+  // Print timing statistics of the output stages in End()
+  void   EnableBenchmarks( Bool_t b = true ) { fDoBench = b; }
   static void SetVerbosity( Int_t level );
   
 protected:
@@ -142,6 +151,9 @@ private:
   Float_t xlo,xhi,ylo,yhi;
   Bool_t fOpenEpics,fFirstEpics,fIsScalar;
 
+  Bool_t        fDoBench;   //! Collect timing statistics
+  THaBenchmark* fBench;     //! Stage timers of this output
+
   ClassDef(THaOutput,0)  
 };
 
@@ -13,6 +13,7 @@
 #include "THaBeam.h"
 #include "VarDef.h"
 #include "TMath.h"
+#include "AnalysisContext.h"
 
 using namespace std;
 
@@ -108,7 +109,7 @@ Int_t THaPhotoReaction::Process( const THaEvData& )
   // This Procedure calculates the energy of the (REAL)
   // photon from the detected proton momentum 
 
-  if( !IsOK() || !gHaRun ) return -1;
+  if( !IsOK() || !fContext->GetRun() ) return -1;
 
   // Get tracking info of detected proton
   THaTrackInfo* trkifo = fSpectro->GetTrackInfo();
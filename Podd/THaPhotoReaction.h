@@ -30,6 +30,7 @@ public:
   
   virtual EStatus   Init( const TDatime& run_time );
   virtual Int_t     Process( const THaEvData& );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
   //          void        SetTargetMass( Double_t m );
   void              SetSpectrometer( const char* name );
   void              SetBeam( const char* name );
@@ -5,18 +5,25 @@
 
 #include "THaPostProcess.h"
 #include "TList.h"
+#include <mutex>
 
 TList* THaPostProcess::fgModules = nullptr;
 
 using namespace std;
 
+// Modules may be created and deleted by concurrent analyses
+static mutex gPostProcessMutex;
+
 //_____________________________________________________________________________
 THaPostProcess::THaPostProcess() : fIsInit(0) 
 {
   // Constructor
 
-  if( !fgModules ) fgModules = new TList;
-  fgModules->Add( this );
+  {
+    lock_guard<mutex> lock(gPostProcessMutex);
+    if( !fgModules ) fgModules = new TList;
+    fgModules->Add( this );
+  }
 
   // Tell analyzer not to use the return code from Process by default
   // (backwards compatibility for existing modules)
@@ -28,6 +35,7 @@ THaPostProcess::~THaPostProcess()
 {
   // Destructor
 
+  lock_guard<mutex> lock(gPostProcessMutex);
   fgModules->Remove( this );
   if( fgModules->GetSize() == 0 ) {
     delete fgModules; fgModules = nullptr;
@@ -2,6 +2,8 @@
 #define Podd_THaPostProcess_h_
 
 #include "TObject.h"
+#include <set>
+#include <utility>
 
 class THaRunBase;
 class THaEvData;
@@ -16,6 +18,11 @@ class THaPostProcess : public TObject {
   virtual Int_t Process( const THaEvData*, const THaRunBase*, Int_t code )=0;
   virtual Int_t Close()=0;
 
+  // Crates/slots whose decoded data this module reads, as in
+  // THaAnalysisObject::GetUsedCrateSlots. Returns false if unknown.
+  virtual Bool_t GetUsedCrateSlots( std::set<std::pair<UInt_t,UInt_t>>& ) const
+  { return false; }
+
   enum { kUseReturnCode = BIT(23) };
 
 protected:
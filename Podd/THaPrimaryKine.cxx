@@ -18,6 +18,7 @@
 #include "THaBeam.h"
 #include "VarDef.h"
 #include "TMath.h"
+#include "AnalysisContext.h"
 
 using namespace std;
 using namespace Podd;
@@ -139,7 +140,7 @@ Int_t THaPrimaryKine::Process( const THaEvData& )
 {
   // Calculate electron kinematics for the Golden Track of the spectrometer
 
-  if( !IsOK() || !gHaRun ) return -1;
+  if( !IsOK() || !fContext->GetRun() ) return -1;
 
   THaTrackInfo* trkifo = fSpectro->GetTrackInfo();
   if( !trkifo || !trkifo->IsOK() ) return 1;
@@ -151,7 +152,7 @@ Int_t THaPrimaryKine::Process( const THaEvData& )
     fP0.SetVectM( fBeam->GetBeamInfo()->GetPvect(), fM );
   } else {
     // If no beam given, assume beam along z_lab
-    Double_t p_in  = gHaRun->GetParameters()->GetBeamP();
+    Double_t p_in  = fContext->GetRun()->GetParameters()->GetBeamP();
     fP0.SetXYZM( 0.0, 0.0, p_in, fM );
   }
 
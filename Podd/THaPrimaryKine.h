@@ -50,6 +50,7 @@ public:
 
   virtual EStatus   Init( const TDatime& run_time );
   virtual Int_t     Process( const THaEvData& );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
           void      SetMass( Double_t m );
           void      SetTargetMass( Double_t m );
           void      SetSpectrometer( const char* name );
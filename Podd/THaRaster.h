@@ -20,6 +20,8 @@ public:
   virtual void       Clear( Option_t* ="" );
   virtual Int_t      Decode( const THaEvData& );
   virtual Int_t      Process();
+  virtual Bool_t     GetUsedCrateSlots( CrateSlots_t& cs ) const
+  { return DetMapCrateSlots(cs); }
 
   virtual TVector3 GetPosition()  const { return fPosition[2]; }
   virtual TVector3 GetDirection() const { return fDirection; }
@@ -19,6 +19,7 @@ public:
                    bool do_setup = true );
 
   virtual Int_t Reconstruct();
+  virtual Bool_t GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
 
 protected:
 
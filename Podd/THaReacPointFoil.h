@@ -25,6 +25,7 @@ public:
 
   virtual EStatus   Init( const TDatime& run_time );
   virtual Int_t     Process( const THaEvData& );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
           void      SetSpectrometer( const char* name );
           void      SetBeam( const char* name );
 
@@ -18,6 +18,7 @@
 #include "TError.h"
 #include "TSystem.h"
 #include "TRegexp.h"
+#include "AnalysisContext.h"
 #include <iostream>
 #include <iomanip>
 #include <cassert>
@@ -227,7 +228,8 @@ Int_t THaRun::PrescanFile()
   auto* ifo = DAQInfoExtra::GetExtraInfo(fExtra);
   const UInt_t minscan = ifo ? ifo->fMinScan : 50;
 
-  unique_ptr<THaEvData> evdata{static_cast<THaEvData*>(gHaDecoder->New())};
+  TClass* decoder_class = Podd::AnalysisContext::Current()->GetDecoderClass();
+  unique_ptr<THaEvData> evdata{static_cast<THaEvData*>(decoder_class->New())};
   // Disable advanced processing
   evdata->EnableScalers(false);
   evdata->EnableHelicity(false);
@@ -14,6 +14,7 @@
 #include "DAQconfig.h"
 #include "THaPrintOption.h"
 #include "TClass.h"
+#include "TCollection.h"
 #include "TError.h"
 #include <iostream>
 #include <algorithm>  // std::copy, std::equal
@@ -285,6 +286,33 @@ Int_t THaRunBase::Compare( const TObject* obj ) const
   return 0;
 }
 
+//_____________________________________________________________________________
+Long64_t THaRunBase::Merge( TCollection* list )
+{
+  // Merge run objects of other parts of the same run, analyzed in separate
+  // jobs (see THaAnalyzer::SetShard). Called by TFileMerger/hadd.
+  // Adds the numbers of analyzed events and extends the event range.
+  // Objects of other runs are ignored. Returns the number of analyzed events.
+
+  if( !list )
+    return 0;
+  TIter next(list);
+  while( TObject* obj = next() ) {
+    const auto* rhs = dynamic_cast<const THaRunBase*>(obj);
+    if( !rhs || rhs == this )
+      continue;
+    if( rhs->fNumber != fNumber ) {
+      Warning("THaRunBase::Merge", "Not merging run %u into run %u",
+              rhs->fNumber, fNumber);
+      continue;
+    }
+    fNumAnalyzed += rhs->fNumAnalyzed;
+    fEvtRange[0] = min(fEvtRange[0], rhs->fEvtRange[0]);
+    fEvtRange[1] = max(fEvtRange[1], rhs->fEvtRange[1]);
+  }
+  return fNumAnalyzed;
+}
+
 //_____________________________________________________________________________
 Bool_t THaRunBase::HasInfo( UInt_t bits ) const
 {
@@ -14,7 +14,9 @@
 #include <string>
 
 class THaRunParameters;
+class TCollection;
 class THaEvData;
+class TClass;
 
 class THaRunBase : public TNamed {
 
@@ -47,6 +49,7 @@ public:
   virtual void         ClearDate();
           void         ClearEventRange();
   virtual Int_t        Compare( const TObject* obj ) const;
+  virtual Long64_t     Merge( TCollection* list );
           Bool_t       DBRead()         const { return fDBRead; }
           void         IncrNumAnalyzed( Int_t n=1 ) { fNumAnalyzed += n; }
   const   TDatime&     GetDate()        const { return fDate; }
@@ -61,6 +64,12 @@ public:
   THaRunParameters*    GetParameters()  const { return fParam.get(); }
   virtual Bool_t       HasInfo( UInt_t bits ) const;
   virtual Bool_t       HasInfoRead( UInt_t bits ) const;
+  // False if the raw buffers of physics events are not available, so that
+  // raw-word lookups (THaEvData::GetRawData etc.) cannot work
+  virtual Bool_t       HasRawPhysicsData() const { return true; }
+  // Decoder class that can interpret the buffers returned by GetEvBuffer().
+  // nullptr if they are raw CODA data, readable by any such decoder.
+  virtual TClass*      GetRequiredDecoder() const { return nullptr; }
           Bool_t       IsInit()         const { return fIsInit; }
   virtual Bool_t       IsOpen()         const;
   virtual void         Print( Option_t* opt="" ) const;
@@ -13,6 +13,7 @@
 #include "THaTrackingModule.h"
 #include "THaBeam.h"
 #include "TMath.h"
+#include "AnalysisContext.h"
 
 using namespace std;
 
@@ -49,7 +50,7 @@ Int_t THaSAProtonEP::Process( const THaEvData& )
   // Calculate the electron kinematics for elastic eX -> eX using the 
   // 4-vector from the outgoing X.
 
-  if( !IsOK() || !gHaRun ) return -1;
+  if( !IsOK() || !fContext->GetRun() ) return -1;
 
   THaTrackInfo* trkifo = fSpectro->GetTrackInfo();
   if( !trkifo || !trkifo->IsOK() ) return 1;
@@ -59,7 +60,7 @@ Int_t THaSAProtonEP::Process( const THaEvData& )
   if( fBeam ) {
     fP0.SetVectM( fBeam->GetBeamInfo()->GetPvect(), fM );
   } else {
-    Double_t p_in  = gHaRun->GetParameters()->GetBeamP();
+    Double_t p_in  = fContext->GetRun()->GetParameters()->GetBeamP();
     fP0.SetXYZM( 0.0, 0.0, p_in, fM );
   }
 
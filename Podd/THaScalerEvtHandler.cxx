@@ -28,6 +28,11 @@
 //     lscaler->SetDebugFile("LeftScaler.txt");
 //     gHaEvtHandlers->Add (lscaler);
 //
+//   For long runs with frequent scaler readout, the scaler tree can be
+//   stored as compact integer columns (raw counts and count increments)
+//
+//     lscaler->EnableCompactHistory();
+//
 /////////////////////////////////////////////////////////////////////
 
 #include "THaScalerEvtHandler.h"
@@ -42,12 +47,15 @@
 #include <iostream>
 #include <string>
 #include <cctype>      // isspace
+#include <algorithm>
+#include <utility>
 #include "THaVarList.h"
 #include "VarDef.h"
 #include "THaString.h"
 #include "Textvars.h"  // Podd::vsplit
 #include "Helper.h"
 #include "TTree.h"
+#include "AnalysisContext.h"
 
 using namespace std;
 using namespace Decoder;
@@ -61,6 +69,7 @@ THaScalerEvtHandler::THaScalerEvtHandler(const char *name, const char* descripti
   , fNormSlot(kMaxUInt)
   , dvars(nullptr)
   , fScalerTree(nullptr)
+  , fCompactHistory(false)
 {}
 
 THaScalerEvtHandler::~THaScalerEvtHandler()
@@ -89,31 +98,8 @@ Int_t THaScalerEvtHandler::Analyze(THaEvData *evdata)
     EvDump(evdata);
   }
 
-  if( !fScalerTree ) {
-
-    TString sname1 = "TS";
-    TString sname2 = sname1 + fName;
-    TString sname3 = fName + "  Scaler Data";
-
-    if( fDebugFile ) {
-      *fDebugFile << "\nAnalyze 1st time for fName = " << fName << endl;
-      *fDebugFile << sname2 << "      " << sname3 << endl;
-    }
-
-    fScalerTree = new TTree(sname2.Data(),sname3.Data());
-    fScalerTree->SetAutoSave(200000000);
-
-    TString name = "evcount";
-    TString tinfo = name + "/D";
-    fScalerTree->Branch(name.Data(), &evcount, tinfo.Data(), 4000);
-
-    for( size_t i = 0; i < scalerloc.size(); i++) {
-      name = scalerloc[i]->name;
-      tinfo = name + "/D";
-      fScalerTree->Branch(name.Data(), &dvars[i], tinfo.Data(), 4000);
-    }
-
-  }  // if (!fScalerTree)
+  if( !fScalerTree )
+    MakeTree();
 
 
   // Parse the data, load local data arrays.
@@ -132,23 +118,25 @@ Int_t THaScalerEvtHandler::Analyze(THaEvData *evdata)
   const UInt_t *pstop = p+ndata;
   Bool_t ifound = false;
 
+  // Only words matching a scaler header are passed to that scaler
   while( p < pstop ) {
     if( fDebugFile ) {
       *fDebugFile << "p  and  pstop  " << p << "   " << pstop
                   << "   " << hex << *p << "   " << dec << endl;
     }
     Int_t nskip = 1;
-    for( size_t j = 0; j < scalers.size(); j++ ) {
+    UInt_t j = FindScaler(*p);
+    if( j != kMaxUInt ) {
       nskip = scalers[j]->Decode(p);
       if( fDebugFile && nskip > 1 ) {
         *fDebugFile << "\n===== Scaler # " << j << "     fName = " << fName
                     << "   nskip = " << nskip << endl;
         scalers[j]->DebugPrint(fDebugFile);
       }
-      if( nskip > 1 ) {
+      if( nskip > 1 )
         ifound = true;
-        break;
-      }
+      else
+        nskip = 1;
     }
     p = p + nskip;
   }
@@ -167,24 +155,39 @@ Int_t THaScalerEvtHandler::Analyze(THaEvData *evdata)
 
   // The correspondence between dvars and the scaler and the channel
   // will be driven by a scaler.map file, or could be hard-coded.
+  // The indices were checked in Init. The rates were computed by the
+  // scalers when decoding.
 
   for( size_t i = 0; i < scalerloc.size(); i++ ) {
-    UInt_t idx = scalerloc[i]->index;
-    UInt_t ichan = scalerloc[i]->ichan;
+    const ScalerLoc* loc = scalerloc[i];
+    if( loc->index >= scalers.size() )
+      continue;
+    const GenScaler* scaler = scalers[loc->index];
+    if( loc->ikind == IRATE )
+      dvars[i] = scaler->GetRate(loc->ichan);
+    else
+      dvars[i] = scaler->GetData(loc->ichan);
     if( fDebugFile )
-      *fDebugFile << "Debug dvars " << i << "  " << idx << "  " << ichan << endl;
-    if( idx < scalers.size() && ichan < MAXCHAN ) {
-      if( scalerloc[i]->ikind == ICOUNT )
-        dvars[i] = scalers[idx]->GetData(ichan);
-      if( scalerloc[i]->ikind == IRATE )
-        dvars[i] = scalers[idx]->GetRate(ichan);
-      if( fDebugFile )
-        *fDebugFile << "   dvars  " << scalerloc[i]->ikind
-                    << "  " << dvars[i] << endl;
-    } else {
-      cout << "THaScalerEvtHandler:: ERROR:: incorrect index " << i
-           << "  " << idx << "  " << ichan << endl;
+      *fDebugFile << "Debug dvars " << i << "  " << loc->index << "  "
+                  << loc->ichan << "   dvars  " << loc->ikind
+                  << "  " << dvars[i] << endl;
+  }
+
+  if( fCompactHistory && !fWarmup ) {
+    for( size_t i = 0; i < scalerloc.size(); i++ ) {
+      const ScalerLoc* loc = scalerloc[i];
+      if( loc->index >= scalers.size() )
+        continue;
+      const GenScaler* scaler = scalers[loc->index];
+      // A scaler missing from this event has no increment. Its dtime is
+      // zero as well.
+      if( loc->ikind == IRATE )
+        fCounts[i] = scaler->IsDecoded() ? scaler->GetDelta(loc->ichan) : 0;
+      else
+        fCounts[i] = scaler->GetData(loc->ichan);
     }
+    for( size_t j = 0; j < scalers.size(); j++ )
+      fDeltaT[j] = scalers[j]->IsDecoded() ? scalers[j]->GetTimeSincePrev() : 0;
   }
 
   evcount += 1.0;
@@ -195,12 +198,127 @@ Int_t THaScalerEvtHandler::Analyze(THaEvData *evdata)
   if( fDebugFile )
     *fDebugFile << "scaler tree ptr  " << fScalerTree << endl;
 
-  if( fScalerTree )
+  if( fScalerTree && !fWarmup )
     fScalerTree->Fill();
 
   return 1;
 }
 
+void THaScalerEvtHandler::MakeTree()
+{
+  // Create the scaler history tree. By default, it has one Double_t branch
+  // per variable. With compact history, counts and count increments are
+  // stored as integers.
+
+  TString sname1 = "TS";
+  TString sname2 = sname1 + fName;
+  TString sname3 = fName + "  Scaler Data";
+
+  if( fDebugFile ) {
+    *fDebugFile << "\nAnalyze 1st time for fName = " << fName << endl;
+    *fDebugFile << sname2 << "      " << sname3 << endl;
+  }
+
+  fScalerTree = new TTree(sname2.Data(),sname3.Data());
+  fScalerTree->SetAutoSave(200000000);
+
+  TString name = "evcount";
+  TString tinfo = name + "/D";
+  fScalerTree->Branch(name.Data(), &evcount, tinfo.Data(), 4000);
+
+  if( !fCompactHistory ) {
+    for( size_t i = 0; i < scalerloc.size(); i++) {
+      name = scalerloc[i]->name;
+      tinfo = name + "/D";
+      fScalerTree->Branch(name.Data(), &dvars[i], tinfo.Data(), 4000);
+    }
+    return;
+  }
+
+  fCounts.assign(scalerloc.size(), 0);
+  fDeltaT.assign(scalers.size(), 0);
+  if( !scalers.empty() ) {
+    tinfo = Form("dtime[%u]/D", static_cast<UInt_t>(scalers.size()));
+    fScalerTree->Branch("dtime", fDeltaT.data(), tinfo.Data(), 4000);
+  }
+  for( size_t i = 0; i < scalerloc.size(); i++) {
+    const ScalerLoc* loc = scalerloc[i];
+    name = loc->name;
+    if( loc->ikind == IRATE ) {
+      // Rate = delta/dtime, available as an alias with the variable's name.
+      // The rate is 0 if dtime is 0, e.g. if the scaler was not read out.
+      TString delta = name + "_delta";
+      fScalerTree->Branch(delta.Data(), &fCounts[i], (delta+"/i").Data(), 4000);
+      if( loc->index < scalers.size() ) {
+        TString dt = Form("dtime[%u]", loc->index);
+        fScalerTree->SetAlias(name.Data(),
+                              Form("(%s>0)*%s/(%s+(%s<=0))", dt.Data(),
+                                   delta.Data(), dt.Data(), dt.Data()));
+      }
+    } else {
+      fScalerTree->Branch(name.Data(), &fCounts[i], (name+"/i").Data(), 4000);
+    }
+  }
+}
+
+UInt_t THaScalerEvtHandler::FindScaler( UInt_t word ) const
+{
+  // Index of the first not yet decoded scaler whose header matches 'word'.
+  // kMaxUInt if none.
+
+  UInt_t found = kMaxUInt;
+  for( const auto& hi: fHeaderIndex ) {
+    auto key = make_pair(word & hi.mask, 0U);
+    auto it = lower_bound(hi.headers.begin(), hi.headers.end(), key);
+    for( ; it != hi.headers.end() && it->first == key.first; ++it ) {
+      if( it->second < found && !scalers[it->second]->IsDecoded() ) {
+        found = it->second;
+        break;
+      }
+    }
+  }
+  return found;
+}
+
+void THaScalerEvtHandler::BuildHeaderIndex()
+{
+  // Sort the scaler headers by mask and value for FindScaler()
+
+  fHeaderIndex.clear();
+  for( UInt_t j = 0; j < scalers.size(); j++ ) {
+    UInt_t mask = scalers[j]->GetHeaderMask();
+    auto it = find_if(fHeaderIndex.begin(), fHeaderIndex.end(),
+                      [mask]( const HeaderIndex& hi ) {
+                        return hi.mask == mask;
+                      });
+    if( it == fHeaderIndex.end() ) {
+      fHeaderIndex.push_back(HeaderIndex{mask, {}});
+      it = fHeaderIndex.end() - 1;
+    }
+    it->headers.emplace_back(scalers[j]->GetHeader() & mask, j);
+  }
+  for( auto& hi: fHeaderIndex )
+    sort(hi.headers.begin(), hi.headers.end());
+}
+
+void THaScalerEvtHandler::VerifyVars()
+{
+  // Check the scaler index and channel of each variable once, so that
+  // Analyze does not need to
+
+  for( size_t i = 0; i < scalerloc.size(); i++ ) {
+    ScalerLoc* loc = scalerloc[i];
+    if( loc->index >= scalers.size() || loc->ichan >= MAXCHAN ||
+        (loc->ikind != ICOUNT && loc->ikind != IRATE) ) {
+      cout << "THaScalerEvtHandler:: ERROR:: incorrect index " << i
+           << "  " << loc->index << "  " << loc->ichan << "  "
+           << loc->ikind << ". Variable " << loc->name
+           << " will not be filled." << endl;
+      loc->index = kMaxUInt;
+    }
+  }
+}
+
 // Helper functions for Init()
 void THaScalerEvtHandler::ParseVariable( const vector<string>& dbline )
 {
@@ -416,6 +534,10 @@ THaAnalysisObject::EStatus THaScalerEvtHandler::Init(const TDatime& date)
 
   // Identify indices of scalers[] vector to variables.
   SetIndices();
+  VerifyVars();
+
+  // Header lookup for decoding
+  BuildHeaderIndex();
 
   if(fDebugFile) {
     *fDebugFile << "THaScalerEvtHandler:: Name of scaler bank "<<fName<<endl;
@@ -448,9 +570,9 @@ void THaScalerEvtHandler::DefVars()
   delete [] dvars;
   dvars = new Double_t[Nvars];  // dvars is a member of this class
   memset(dvars, 0, Nvars * sizeof(Double_t));
-  if( gHaVars ) {
+  if( fContext->GetVars() ) {
     if( fDebugFile )
-      *fDebugFile << "THaScalerEVtHandler:: Have gHaVars " << gHaVars << endl;
+      *fDebugFile << "THaScalerEVtHandler:: Have gHaVars " << fContext->GetVars() << endl;
   } else {
     cout << "No gHaVars ?!  Well, that's a problem !!" << endl;
     return;
@@ -459,7 +581,7 @@ void THaScalerEvtHandler::DefVars()
     *fDebugFile << "THaScalerEvtHandler:: scalerloc size " << scalerloc.size() << endl;
   const Int_t* count = nullptr;
   for( size_t i = 0; i < scalerloc.size(); i++ ) {
-    gHaVars->DefineByType(scalerloc[i]->name.Data(),
+    fContext->GetVars()->DefineByType(scalerloc[i]->name.Data(),
                           scalerloc[i]->description.Data(),
                           &dvars[i], kDouble, count);
   }
@@ -51,6 +51,15 @@ public:
    virtual EStatus Init( const TDatime& run_time);
    virtual Int_t End( THaRunBase* r=nullptr );
 
+   // Store the scaler history tree as integer columns: raw counts for
+   // count variables, count increments for rate variables, plus the time
+   // since the previous reading of each scaler ("dtime"). Rate variables
+   // are available as tree aliases; they are 0 in entries where dtime is 0.
+   // Scalers not read out in an event have zero increments and dtime.
+   // Must be set before the first event.
+   void   EnableCompactHistory( Bool_t b = true ) { fCompactHistory = b; }
+   Bool_t CompactHistoryEnabled() const { return fCompactHistory; }
+
 
 protected:
 
@@ -62,6 +71,16 @@ protected:
    void VerifySlots();
    void SetIndices();
    void AssignNormScaler();
+   void BuildHeaderIndex();
+   void VerifyVars();
+   void MakeTree();
+   UInt_t FindScaler( UInt_t word ) const;
+
+   // Scalers indexed by header, for each distinct header mask
+   struct HeaderIndex {
+     UInt_t mask;
+     std::vector<std::pair<UInt_t,UInt_t>> headers; // (header, scaler index)
+   };
 
    std::vector<Decoder::GenScaler*> scalers;
    std::vector<ScalerLoc*> scalerloc;
@@ -69,6 +88,10 @@ protected:
    UInt_t fNormIdx, fNormSlot;
    Double_t *dvars;
    TTree *fScalerTree;
+   Bool_t fCompactHistory;               // Integer history columns
+   std::vector<HeaderIndex> fHeaderIndex; //! Header lookup tables
+   std::vector<UInt_t> fCounts;           //! Compact history: counts/deltas
+   std::vector<Double_t> fDeltaT;         //! Compact history: time intervals
 
    ClassDef(THaScalerEvtHandler,0)  // Scaler Event handler
 
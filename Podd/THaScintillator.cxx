@@ -178,6 +178,7 @@ Int_t THaScintillator::ReadDatabase( const TDatime& date )
   }
   fPadData.resize(nval);
   fHits.reserve(nval);
+  fHitIdx.reserve(2*nval);
 
   // Read calibration parameters
 
@@ -357,8 +358,13 @@ Int_t THaScintillator::StoreHit( const DigitizerHitInfo_t& hitinfo, UInt_t data
   Int_t pad = hitinfo.lchan % fNelem;
   auto side = static_cast<ESide>(GetView(hitinfo));
 
-  // Make a note that this side/pad registered some kind of data
-  fHitIdx.emplace(side, pad);
+  // Make a note that this side/pad registered some kind of data.
+  // fHitIdx is kept sorted like a std::set, but does not allocate memory
+  // for each new element.
+  Idx_t idx(side, pad);
+  auto pos = lower_bound(ALL(fHitIdx), idx);
+  if( pos == fHitIdx.end() || *pos != idx )
+    fHitIdx.insert(pos, idx);
 
   // Store data for either left or right PMTs, as determined by 'side'
   Podd::PMTData* pmtData = (side == kRight) ? fRightPMTs : fLeftPMTs;
@@ -472,7 +478,7 @@ Int_t THaScintillator::FindPaddleHits()
       break;
     assert(side == kRight);
     const Int_t pad = idx.second;
-    if( fHitIdx.find(make_pair(kLeft, pad)) != fHitIdx.end()) {
+    if( binary_search(ALL(fHitIdx), make_pair(kLeft, pad)) ) {
       // There are data from both PMTs of this paddle
       const auto &RPMT = fRightPMTs->GetPMT(pad), &LPMT = fLeftPMTs->GetPMT(pad);
 
@@ -510,7 +516,7 @@ Int_t THaScintillator::CoarseProcess( TClonesArray& tracks )
       break;
     assert(side == kRight);
     const Int_t pad = idx.second;
-    if( fHitIdx.find(make_pair(kLeft, pad)) != fHitIdx.end()) {
+    if( binary_search(ALL(fHitIdx), make_pair(kLeft, pad)) ) {
       const auto &RPMT = fRightPMTs->GetPMT(pad), &LPMT = fLeftPMTs->GetPMT(pad);
 
       // rough calculation of position from ADC reading
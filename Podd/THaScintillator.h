@@ -10,7 +10,6 @@
 #include "THaNonTrackingDetector.h"
 #include "DetectorData.h"
 #include <vector>
-#include <set>
 
 class TClonesArray;
 
@@ -44,6 +43,8 @@ public:
 
   virtual void      Clear( Option_t* opt="" );
   virtual Int_t     Decode( const THaEvData& );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& cs ) const
+  { return DetMapCrateSlots(cs); }
   virtual Int_t     CoarseProcess( TClonesArray& tracks );
   virtual Int_t     FineProcess( TClonesArray& tracks );
 
@@ -61,7 +62,7 @@ protected:
   // Per-event data
   Podd::PMTData*         fRightPMTs;      // Raw PMT data (right side)
   Podd::PMTData*         fLeftPMTs;       // Raw PMT data (left side)
-  std::set<Idx_t>        fHitIdx;         // Indices of PMTs with data
+  std::vector<Idx_t>     fHitIdx;         // Indices of PMTs with data, sorted
   std::vector<HitData_t> fHits;           // Calculated hit data, per hit
   // fPadData duplicates the info in fHits for direct access via paddle number
   std::vector<HitData_t> fPadData;        // Calculated hit data, per paddle
@@ -74,6 +75,7 @@ protected:
   virtual Int_t  FindPaddleHits();
 
   virtual Int_t  ReadDatabase( const TDatime& date );
+  virtual Bool_t IsDBReadThreadSafe() const { return true; }
   virtual Int_t  DefineVariables( EMode mode = kDefine );
 
   ClassDef(THaScintillator,1)   // Generic scintillator class
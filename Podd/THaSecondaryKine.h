@@ -62,6 +62,7 @@ public:
 
   virtual EStatus   Init( const TDatime& run_time );
   virtual Int_t     Process( const THaEvData& );
+  virtual Bool_t    GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
           void      SetSpectrometer( const char* name );
           void      SetPrimary( const char* name );
           void      SetMX( Double_t m );
@@ -25,6 +25,8 @@ public:
   virtual void       Clear( Option_t* ="" );
   virtual Int_t      CoarseProcess( TClonesArray& tracks );
   virtual Int_t      FineProcess( TClonesArray& tracks );
+  virtual Bool_t     GetUsedCrateSlots( CrateSlots_t& cs ) const
+  { return DetMapCrateSlots(cs); }
           UInt_t     GetMainClusterSize() const { return fClBlk.size(); }
           UInt_t     GetNclust() const { return fNclust; }
           UInt_t     GetNhits() const  { return fADCData->GetHitCount(); }
@@ -81,6 +83,7 @@ protected:
   virtual void   PrintDecodedData( const THaEvData& evdata ) const;
 
   virtual Int_t  ReadDatabase( const TDatime& date );
+  virtual Bool_t IsDBReadThreadSafe() const { return true; }
   virtual Int_t  DefineVariables( EMode mode = kDefine );
 
   ClassDef(THaShower,0)     //Generic shower detector class
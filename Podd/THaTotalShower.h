@@ -25,6 +25,8 @@ public:
   virtual Int_t      Decode( const THaEvData& );
   virtual Int_t      CoarseProcess( TClonesArray& tracks );
   virtual Int_t      FineProcess( TClonesArray& tracks );
+  virtual Bool_t     GetUsedCrateSlots( CrateSlots_t& cs ) const
+  { return DetMapCrateSlots(cs); }
           Data_t     GetE() const           { return fE; }
 	  Int_t      GetID() const          { return fID; }
       	  THaShower* GetShower() const      { return fShower; }
@@ -30,6 +30,10 @@ public:
     kHasTarget     = BIT(3),  // Target coordinates reconstructed
     kHasVertex     = BIT(4)   // Vertex reconstructed
   };
+  // Bits for TObject::fBits
+  enum {
+    kSharedID      = BIT(14)  // fID is not owned by this track
+  };
 
   // Default constructor
   THaTrack()
@@ -164,7 +168,10 @@ public:
 
   void              SetChi2( Double_t chi2, Int_t ndof ) { fChi2=chi2; fNDoF=ndof; }
 
-  void              SetID( THaTrackID* id )   { fID   = id; }
+  // By default, the track takes ownership of 'id'. Tracking detectors
+  // that recycle their track IDs pass owned = false.
+  void              SetID( THaTrackID* id, Bool_t owned = true )
+  { fID = id; SetBit(kSharedID, !owned); }
   void              SetFlag( UInt_t flag )    { fFlag = flag; }
   void              SetType( UInt_t flag )    { fType = flag; }
   void              SetMomentum( Double_t p ) { fP    = p; }
@@ -4,6 +4,7 @@
 #include <TTree.h>
 #include "THaOutput.h"
 #include "THaTrackingModule.h"
+#include "AnalysisContext.h"
 
 using namespace std;
 
@@ -100,7 +101,7 @@ Int_t THaTrackOut::Process( const THaEvData& )
 {
   // Calculate the 4-vector for the golden track from fSrc
   
-  if ( !IsOK() || !gHaRun ) return -1;
+  if ( !IsOK() || !fContext->GetRun() ) return -1;
   
   THaTrackInfo *trkifo = fSrc->GetTrackInfo();
   if ( !trkifo || !trkifo->IsOK() ) return 1;
@@ -25,6 +25,7 @@ class THaTrackOut : public THaPhysicsModule {
           void         SetMass ( Double_t m );
 	  void         SetSpectrometer( const char* name );
   virtual Int_t        Process( const THaEvData& evdata );
+  virtual Bool_t       GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
 	  
  protected:
   Double_t fM;                // Mass of detected particle
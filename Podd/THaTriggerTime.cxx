@@ -196,5 +196,17 @@ Int_t THaTriggerTime::DefineVariables( EMode mode )
   return DefineVarsFromList( vars, mode );
 }
 
+//____________________________________________________________________________
+Bool_t THaTriggerTime::GetUsedCrateSlots( CrateSlots_t& crateslots ) const
+{
+  // Add the crates/slots of the trigger TDC channels to 'crateslots'
+
+  for( UInt_t i = 0; i < fDetMap->GetSize(); ++i ) {
+    const THaDetMap::Module* d = fDetMap->GetModule(i);
+    crateslots.emplace(d->crate, d->slot);
+  }
+  return true;
+}
+
 //____________________________________________________________________________
 ClassImp(THaTriggerTime)
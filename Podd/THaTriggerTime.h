@@ -27,6 +27,7 @@ public:
 
   virtual void        Clear( Option_t* opt="" );
   virtual Int_t       Process( const THaEvData& );
+  virtual Bool_t      GetUsedCrateSlots( CrateSlots_t& crateslots ) const;
 
  protected:
   // Configuration
@@ -19,6 +19,7 @@ public:
   virtual ~THaUnRasteredBeam() = default;
   
   virtual Int_t Reconstruct();
+  virtual Bool_t GetUsedCrateSlots( CrateSlots_t& ) const { return true; }
 
   void ClearRunningSum();
 
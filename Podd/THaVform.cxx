@@ -258,6 +258,19 @@ vector<string> THaVform::GetVars() const
   return fVarName;
 }
 
+//_____________________________________________________________________________
+void THaVform::GetVariables( std::set<const THaVar*>& vars ) const
+{
+  // Add pointers to global variables used by this object to 'vars'
+
+  THaFormula::GetVariables(vars);
+  if( fVarPtr ) vars.insert(fVarPtr);
+  for( const auto* form : fFormula )
+    if( form ) form->GetVariables(vars);
+  for( const auto* cut : fCut )
+    if( cut ) cut->GetVariables(vars);
+}
+
 
 //_____________________________________________________________________________
 Int_t THaVform::Init()
@@ -29,7 +29,8 @@ public:
     fData(0), fType(kUnknown), fDebug(0), fVarPtr(nullptr), fOdata(nullptr),
     fPrefix(0) {}
   THaVform( const char* type, const char* name, const char* formula,
-      const THaVarList* vlst=gHaVars, const THaCutList* clst=gHaCuts );
+      const THaVarList* vlst=Podd::AnalysisContext::Current()->GetVars(),
+      const THaCutList* clst=Podd::AnalysisContext::Current()->GetCuts() );
   virtual  ~THaVform();
   THaVform(const THaVform& vform);
   THaVform& operator=(const THaVform& vform);
@@ -68,6 +69,8 @@ public:
   Int_t GetSize() const { return fObjSize; };
 // Get names of variable that are used by this formula.
   std::vector<std::string> GetVars() const;
+// Add pointers to global variables used by this object to 'vars'
+  virtual void GetVariables( std::set<const THaVar*>& vars ) const;
 
 protected:
 
@@ -39,13 +39,17 @@
 using namespace std;
 using namespace THaString;
 
+Bool_t THaVhist::fgUseBuffers = false;
+UInt_t THaVhist::fgFlushInterval = 10000;
+
 //_____________________________________________________________________________
 THaVhist::THaVhist( string type, string name, string title ) :
   fType(std::move(type)), fName(std::move(name)), fTitle(std::move(title)),
   fNbinX(0), fNbinY(0), fSize(0), fInitStat(0), fScalar(0), fEye(0),
   fEyeOffset(0), fXlo(0.), fXhi(0.), fYlo(0.), fYhi(0.),
-  fFirst(true), fProc(true), fFormX(nullptr), fFormY(nullptr), fCut(nullptr),
-  fMyFormX(false), fMyFormY(false), fMyCut(false), fDebug(0)
+  fFirst(true), fProc(true), fNproc(0), fUseBuffers(fgUseBuffers),
+  fFlushInterval(fgFlushInterval), fFormX(nullptr), fFormY(nullptr),
+  fCut(nullptr), fMyFormX(false), fMyFormY(false), fMyCut(false), fDebug(0)
 { 
   fH1.clear();
 }
@@ -99,6 +103,8 @@ Int_t THaVhist::Init( )
     for( auto& ith : fH1 ) delete ith;
   }
   fH1.clear();
+  fBuf.clear();
+  fNproc = 0;
   fInitStat = 0;
 
   if (fDebug) cout << "THaVhist :: init " << fName << endl;
@@ -200,6 +206,14 @@ Int_t THaVhist::Init( )
   return fInitStat;
 }
 
+//_____________________________________________________________________________
+void THaVhist::GetVariables( std::set<const THaVar*>& vars ) const
+{
+  if (fFormX) fFormX->GetVariables(vars);
+  if (fFormY) fFormY->GetVariables(vars);
+  if (fCut) fCut->GetVariables(vars);
+}
+
 //_____________________________________________________________________________
 void THaVhist::ReAttach( ) 
 {
@@ -423,8 +437,37 @@ Int_t THaVhist::BookHisto(Int_t hfirst, Int_t hlast)
       }
     }
   }
+  // Set up fill buffers for the new histograms. Buffers only handle
+  // unit-weight fills, so a 1D histogram with a Y variable (i.e. weighted)
+  // is filled directly.
+  for (size_t i = fBuf.size(); i < fH1.size(); ++i) {
+    TH1* h = fH1[i];
+    bool use = fUseBuffers && Podd::HistBuffer::IsSupported(h) &&
+      (h->GetDimension() == 2) == (fFormY != nullptr);
+    fBuf.emplace_back(use ? new Podd::HistBuffer(h) : nullptr);
+  }
   return 0;
 }
+
+//_____________________________________________________________________________
+inline void THaVhist::Fill(Int_t i, Double_t x)
+{
+  if( Podd::HistBuffer* buf = fBuf[i].get() ) {
+    if( buf->NeedFlush() ) buf->Flush(fH1[i]);
+    buf->Fill(x);
+  } else
+    fH1[i]->Fill(x);
+}
+
+//_____________________________________________________________________________
+inline void THaVhist::Fill(Int_t i, Double_t x, Double_t y)
+{
+  if( Podd::HistBuffer* buf = fBuf[i].get() ) {
+    if( buf->NeedFlush() ) buf->Flush(fH1[i]);
+    buf->Fill(x, y);
+  } else
+    fH1[i]->Fill(x, y);
+}
  
 //_____________________________________________________________________________
 Int_t THaVhist::Process() 
@@ -491,7 +534,7 @@ Int_t THaVhist::Process()
 	//        cout << "THaVhist :: proc loop: data  "<<i<<"  "<<fFormX->GetData(*ix)<<"   "<<fFormY->GetData(*iy)<<"  *ic "<<*ic<<endl<<flush;
 	if ( CheckCut(*ic)==0 ) continue;
 	//  cout << "THaVhist :: proc loop:     FILLING HISTO "<<i<<endl;
- 	fH1[0]->Fill(fFormX->GetData(*ix), fFormY->GetData(*iy));
+ 	Fill(0, fFormX->GetData(*ix), fFormY->GetData(*iy));
       }
 
     } else {  // 1D histo
@@ -503,7 +546,7 @@ Int_t THaVhist::Process()
 	} else {
  	   if ( CheckCut()==0 ) continue;
 	}
-	fH1[0]->Fill(fFormX->GetData(i));
+	Fill(0, fFormX->GetData(i));
       }
     }
 
@@ -523,22 +566,36 @@ Int_t THaVhist::Process()
     if( fFormY ) {
       for( ; i < fSize; ++i ) {
 	if ( CheckCut(i)==0 ) continue; 
-	fH1[*idx]->Fill(fFormX->GetData(i), fFormY->GetData(i));
+	Fill(*idx, fFormX->GetData(i), fFormY->GetData(i));
       }
     } else {
       for( ; i < fSize; ++i ) {
 	if ( CheckCut(i)==0 ) continue; 
-	fH1[*idx]->Fill(fFormX->GetData(i));
+	Fill(*idx, fFormX->GetData(i));
       }
     }
   }
 
+  if (fFlushInterval > 0 && ++fNproc >= fFlushInterval)
+    Flush();
+
   return 0;
 }
 
+//_____________________________________________________________________________
+void THaVhist::Flush()
+{
+  // Merge the contents of the fill buffers into the histograms
+  for (size_t i = 0; i < fBuf.size(); ++i) {
+    if (fBuf[i]) fBuf[i]->Flush(fH1[i]);
+  }
+  fNproc = 0;
+}
+
 //_____________________________________________________________________________
 Int_t THaVhist::End() 
 {
+  Flush();
   for( auto& ith : fH1 ) ith->Write();
   return 0;
 }
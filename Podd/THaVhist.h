@@ -8,9 +8,12 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "THaVform.h"
+#include "HistBuffer.h"
 #include "TTree.h"
 #include <vector>
 #include <string>
+#include <memory>
+#include <set>
 
 class THaVar;
 class TH1F;
@@ -48,6 +51,9 @@ public:
    Int_t Process();
 // Must End() to write histogram to output at end of analysis.
    Int_t End();
+// Merge buffered fills into the histograms. Done automatically at End()
+// and every fFlushInterval events.
+   void  Flush();
 // Self-explanatory printouts.
    void  Print() const;
    void  ErrPrint() const;
@@ -57,6 +63,19 @@ public:
 // IsScalar() is true if histogram is a scalar.
    Bool_t IsScalar() const { return (fScalar==1); };
    Int_t GetSize() const { return fSize; };
+// Add pointers to global variables used by this histogram to 'vars'
+   void  GetVariables( std::set<const THaVar*>& vars ) const;
+// Fill buffers for this histogram (default off). Takes effect at Init().
+// While buffering, the histogram lags the processed events by up to
+// the flush interval.
+   void  SetFillBuffers( Bool_t b = true ) { fUseBuffers = b; }
+// Events between buffer flushes. 0 = flush only at End().
+   void  SetFlushIntervalEvents( UInt_t n ) { fFlushInterval = n; }
+// Defaults of the above for all subsequently created histograms. Set these
+// during configuration only; each histogram copies them when created.
+   static void EnableFillBuffers( Bool_t b = true ) { fgUseBuffers = b; }
+   static Bool_t FillBuffersEnabled() { return fgUseBuffers; }
+   static void SetFlushInterval( UInt_t n ) { fgFlushInterval = n; }
 
 protected:
 
@@ -65,6 +84,8 @@ protected:
    Int_t FindVarSize();
    Bool_t FindEye(const string& var);
    Bool_t FindEyeOffset(const string& var);
+   void   Fill(Int_t i, Double_t x);
+   void   Fill(Int_t i, Double_t x, Double_t y);
 //   Int_t GetCut(Int_t index=0);
 
    enum FEr { kOK = 0, kNoBinX, kIllFox, kIllFoy, kIllCut,
@@ -73,6 +94,8 @@ protected:
 
    static const int fgVERBOSE = 1;
    static const int fgVHIST_HUGE = 10000;
+   static Bool_t fgUseBuffers;
+   static UInt_t fgFlushInterval;
 
    string fType, fName, fTitle, fVarX, fVarY, fScut;
    Int_t fNbinX, fNbinY, fSize, fInitStat, fScalar, fEye, fEyeOffset;
@@ -80,6 +103,11 @@ protected:
    Bool_t fFirst, fProc;
 
    std::vector<TH1* > fH1;
+   // Fill buffers, parallel to fH1. Null if the histogram is filled directly.
+   std::vector<std::unique_ptr<Podd::HistBuffer>> fBuf;  //!
+   UInt_t fNproc;     //! Events processed since last flush
+   Bool_t fUseBuffers;    //! Use fill buffers
+   UInt_t fFlushInterval; //! Events between flushes
    THaVform *fFormX, *fFormY, *fCut;
    Bool_t fMyFormX, fMyFormY, fMyCut;
    Int_t fDebug;
@@ -24,6 +24,7 @@
 #include "UserEvtHandler.h"
 #include "THaEvData.h"
 #include "THaVarList.h"
+#include "AnalysisContext.h"
 #include <cstdlib>   // for atof
 #include <iostream>
 #include <sstream>
@@ -179,10 +180,10 @@ THaAnalysisObject::EStatus UserEvtHandler::Init(const TDatime& /* date */ )
     dvars = new Double_t[Nvars];  // dvars is a member of this class
 		 // the index of the dvars array tracks the index of dataKeys
     memset(dvars, 0, Nvars*sizeof(Double_t));
-    if (gHaVars) {
+    if (fContext->GetVars()) {
 #ifdef WITH_DEBUG
       if( fDebug>1 )
-	cout << "EvtHandler:: Have gHaVars.  Good thing. "<<gHaVars<<endl;
+	cout << "EvtHandler:: Have gHaVars.  Good thing. "<<fContext->GetVars()<<endl;
 #endif
     } else {
       Error( Here("UserEvtHandler::Init"),
@@ -191,7 +192,7 @@ THaAnalysisObject::EStatus UserEvtHandler::Init(const TDatime& /* date */ )
     }
     const Int_t* count = nullptr;
     for( UInt_t i = 0; i < Nvars; i++ ) {
-      gHaVars->DefineByType(dataKeys[i].c_str(), "epics data",
+      fContext->GetVars()->DefineByType(dataKeys[i].c_str(), "epics data",
                             &dvars[i], kDouble, count);
     }
   }
@@ -9,11 +9,13 @@ thisdir_fullpath = Dir('.').path
 thisdir = os.path.basename(os.path.normpath(thisdir_fullpath))
 
 # Executables
-appnames = ['analyzer', 'dbconvert']
+appnames = ['analyzer', 'analyzer_batch', 'dbconvert', 'mergeshards']
 apps = []
 sources = []
 # SCons seems to ignore $RPATH on macOS... sigh
 env = baseenv.Clone()
+# The allocation hooks must come first to replace operator new
+env.Prepend(LIBS=['PoddAllocHooks'])
 if env['PLATFORM'] == 'darwin':
     try:
         for rp in env['RPATH']:
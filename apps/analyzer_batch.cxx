@@ -0,0 +1,144 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// analyzer_batch.cxx
+//
+// Replay several runs in one process. The analysis is set up once by a
+// setup macro and kept between runs. Modules re-read their databases only
+// when the database files relevant for a run have changed. See
+// Podd::BatchReplay.
+//
+// Usage: analyzer_batch [options] SETUP_MACRO [RAWFILE ...]
+//
+// The setup macro must create the analyzer and define apparatuses,
+// physics modules, output definitions etc., but must not call
+// THaAnalyzer::Process().
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaInterface.h"
+#include "THaAnalyzer.h"
+#include "BatchReplay.h"
+#include "TROOT.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>    // for strdup
+#include <getopt.h>
+#include <libgen.h>   // for POSIX basename()
+#include <memory>
+#include <string>
+
+using namespace std;
+
+static string prgname;
+static const char* outpattern = nullptr;
+static const char* listfile = nullptr;
+static const char* setupmacro = nullptr;
+static UInt_t nev = 0;
+static UInt_t nthreads = 1;
+static bool stop_on_error = false;
+
+//-----------------------------------------------------------------------------
+static void usage()
+{
+  // Print usage message and exit with error code
+
+  cerr << "Usage: " << prgname << " [options] SETUP_MACRO [RAWFILE ...]"
+       << endl
+       << " -o PATTERN  output file name pattern, %d = run number "
+       << "(default run_%d.root)" << endl
+       << " -l FILE     read raw data file names from FILE" << endl
+       << " -n NEV      analyze at most NEV events per run" << endl
+       << " -j N        initialize modules with N threads" << endl
+       << " -s          stop at the first failed run" << endl
+       << " -h          print this help" << endl;
+  exit(255);
+}
+
+//-----------------------------------------------------------------------------
+static UInt_t getuint( const char* arg )
+{
+  char* end = nullptr;
+  unsigned long val = strtoul(arg, &end, 10);
+  if( !end || *end || *arg == '-' ) {
+    cerr << "Invalid number: " << arg << endl;
+    usage();
+  }
+  return static_cast<UInt_t>(val);
+}
+
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  char* argv0 = strdup(argv[0]);
+  prgname = basename(argv0);
+  free(argv0);
+
+  int opt;
+  while( (opt = getopt(argc, argv, "ho:l:n:j:s")) != -1 ) {
+    switch( opt ) {
+    case 'o':
+      outpattern = optarg;
+      break;
+    case 'l':
+      listfile = optarg;
+      break;
+    case 'n':
+      nev = getuint(optarg);
+      break;
+    case 'j':
+      nthreads = getuint(optarg);
+      break;
+    case 's':
+      stop_on_error = true;
+      break;
+    case 'h':
+    default:
+      usage();
+    }
+  }
+  if( optind >= argc ) {
+    cerr << "Error: Must specify SETUP_MACRO" << endl;
+    usage();
+  }
+  setupmacro = argv[optind++];
+  if( optind == argc && !listfile ) {
+    cerr << "Error: No runs given" << endl;
+    usage();
+  }
+
+  // The interface sets up the environment (include paths, libraries,
+  // interpreter). Do not pass our command line on to ROOT.
+  int rootargc = 1;
+  unique_ptr<TApplication> theApp{
+    new THaInterface("The Hall A analyzer", &rootargc, argv, nullptr, 0, true)};
+
+  int err = 0;
+  gROOT->Macro(setupmacro, &err);
+  if( err ) {
+    cerr << "Error executing setup macro " << setupmacro << endl;
+    return 1;
+  }
+  THaAnalyzer* analyzer = THaAnalyzer::GetInstance();
+  unique_ptr<THaAnalyzer> own_analyzer;
+  if( !analyzer ) {
+    own_analyzer.reset(new THaAnalyzer);
+    analyzer = own_analyzer.get();
+  }
+  if( nthreads > 1 )
+    analyzer->SetInitThreads(nthreads);
+
+  Podd::BatchReplay batch(analyzer);
+  if( outpattern )
+    batch.SetOutFilePattern(outpattern);
+  batch.SetLastEvent(nev);
+  batch.SetContinueOnError(!stop_on_error);
+  if( listfile && batch.AddRunList(listfile) < 0 )
+    return 1;
+  for( int i = optind; i < argc; ++i )
+    batch.AddRun(argv[i]);
+
+  Int_t nfail = batch.Process();
+  batch.Print();
+
+  return (nfail != 0) ? 2 : 0;
+}
@@ -0,0 +1,160 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// mergeshards.cxx
+//
+// Utility to combine the output files of a run analyzed in several parts
+// ("shards", see THaAnalyzer::SetShard) into a single file.
+//
+// Usage: mergeshards [-f] [-p] [-v] OUTPUT INPUT ...
+//
+// The inputs must be shards of the same run. They are merged in shard
+// order, so trees (T, E, scaler trees) are continuous. Histograms are
+// added. The run objects (Run_Data) and shard statistics (Shard_Info) are
+// combined, and the combined event counters and cut statistics are
+// printed.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "THaAnalyzer.h"
+#include "ShardInfo.h"
+#include "TFile.h"
+#include "TFileMerger.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>    // for strdup
+#include <getopt.h>
+#include <libgen.h>   // for POSIX basename()
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using Podd::ShardInfo;
+
+static string prgname;
+static bool force = false, partial = false, verbose = false;
+
+//-----------------------------------------------------------------------------
+static void usage()
+{
+  // Print usage message and exit with error code
+
+  cerr << "Usage: " << prgname << " [-f] [-p] [-v] OUTPUT INPUT ..." << endl
+       << " -f  overwrite existing output file" << endl
+       << " -p  allow merging an incomplete set of shards" << endl
+       << " -v  verbose" << endl
+       << " -h  print this help" << endl;
+  exit(255);
+}
+
+//-----------------------------------------------------------------------------
+static unique_ptr<ShardInfo> GetShardInfo( const char* filename )
+{
+  // Read the shard description from the given analysis output file
+
+  unique_ptr<TFile> file{TFile::Open(filename, "READ")};
+  if( !file || file->IsZombie() ) {
+    cerr << "Cannot open " << filename << endl;
+    return nullptr;
+  }
+  unique_ptr<ShardInfo> info{
+    dynamic_cast<ShardInfo*>(file->Get(THaAnalyzer::kShardInfoName))};
+  if( !info )
+    cerr << filename << " is not the output of a sharded analysis" << endl;
+  return info;
+}
+
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  char* argv0 = strdup(argv[0]);
+  prgname = basename(argv0);
+  free(argv0);
+
+  int opt;
+  while( (opt = getopt(argc, argv, "hfpv")) != -1 ) {
+    switch( opt ) {
+    case 'f':
+      force = true;
+      break;
+    case 'p':
+      partial = true;
+      break;
+    case 'v':
+      verbose = true;
+      break;
+    case 'h':
+    default:
+      usage();
+    }
+  }
+  if( argc - optind < 2 ) {
+    cerr << "Error: Must specify OUTPUT and at least one INPUT" << endl;
+    usage();
+  }
+  const char* outfile = argv[optind++];
+
+  // Check that the inputs are distinct shards of the same run
+  vector<pair<UInt_t,const char*>> inputs;
+  unique_ptr<ShardInfo> first;
+  vector<bool> seen;
+  for( int i = optind; i < argc; ++i ) {
+    auto info = GetShardInfo(argv[i]);
+    if( !info )
+      return 1;
+    if( !first ) {
+      first.reset(new ShardInfo(*info));
+      seen.assign(first->GetNshards(), false);
+    } else if( !first->IsCompatible(*info) ) {
+      cerr << argv[i] << " is not a shard of the same run as "
+           << inputs.front().second << endl;
+      return 1;
+    }
+    UInt_t shard = info->GetShard();
+    if( shard >= seen.size() || seen[shard] ) {
+      cerr << argv[i] << ": duplicate or invalid shard " << shard << endl;
+      return 1;
+    }
+    seen[shard] = true;
+    inputs.emplace_back(shard, argv[i]);
+  }
+  if( find(seen.begin(), seen.end(), false) != seen.end() ) {
+    cerr << (partial ? "Warning" : "Error") << ": missing shards:";
+    for( size_t i = 0; i < seen.size(); ++i )
+      if( !seen[i] )
+        cerr << " " << i;
+    cerr << endl;
+    if( !partial )
+      return 1;
+  }
+
+  // Merge in shard order so that the trees are continuous
+  sort(inputs.begin(), inputs.end());
+  TFileMerger merger(false, false);
+  merger.SetPrintLevel(verbose ? 1 : 0);
+  if( !merger.OutputFile(outfile, force) ) {
+    cerr << "Cannot create output file " << outfile
+         << (force ? "" : " (use -f to overwrite)") << endl;
+    return 1;
+  }
+  for( const auto& input : inputs ) {
+    if( verbose )
+      cout << "Adding shard " << input.first << ": " << input.second << endl;
+    if( !merger.AddFile(input.second, false) ) {
+      cerr << "Cannot add " << input.second << endl;
+      return 1;
+    }
+  }
+  if( !merger.Merge() ) {
+    cerr << "Merging failed" << endl;
+    return 2;
+  }
+
+  auto merged = GetShardInfo(outfile);
+  if( !merged )
+    return 2;
+  merged->Print();
+  return 0;
+}
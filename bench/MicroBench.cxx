@@ -0,0 +1,382 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::MicroBench
+//
+// Each benchmark body is first run for about a tenth of the requested
+// minimum time to warm up caches and to estimate its duration. It is
+// then timed in several repetitions of equal iteration count. The
+// report gives the median, mean, minimum and standard deviation of the
+// time per iteration over the repetitions, the throughput in items per
+// second (based on the median), and the heap allocations per iteration
+// counted by Podd::AllocCounter.
+//
+// The JSON report has the form
+//
+//   { "suite": "decoder", "version": "1.7.6", "gitrev": "...",
+//     "date": "...", "host": "...", "min_time": 0.5, "repetitions": 5,
+//     "benchmarks": [
+//       { "name": "...", "items": 500, "iterations": 1234,
+//         "repetitions": 5, "ns_per_iter": 12345.6, "ns_mean": ...,
+//         "ns_min": ..., "ns_stddev": ..., "items_per_sec": ...,
+//         "allocs_per_iter": 0, "bytes_per_iter": 0 }, ... ] }
+//
+// Benchmarks that could not be set up are listed with an "error" key
+// instead of the timing results.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MicroBench.h"
+#include "AllocCounter.h"
+#include "ha_compiledata.h"
+#include "TDatime.h"
+#include "TSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>    // for strdup
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <getopt.h>
+#include <libgen.h>   // for POSIX basename()
+
+using namespace std;
+
+#ifndef PODD_BENCH_DATADIR
+#define PODD_BENCH_DATADIR "."
+#endif
+
+namespace Podd {
+
+//_____________________________________________________________________________
+MicroBench::State::State()
+  : fElapsed(0), fAllocStart(0), fBytesStart(0), fAllocs(0), fBytes(0),
+    fIteration(0), fRunning(false)
+{
+}
+
+//_____________________________________________________________________________
+void MicroBench::State::PauseTiming()
+{
+  // Stop the clock and the allocation count
+
+  if( !fRunning )
+    return;
+  auto now = clock_type::now();
+  fAllocs += AllocCounter::GetCount() - fAllocStart;
+  fBytes  += AllocCounter::GetBytes() - fBytesStart;
+  fElapsed += chrono::duration<Double_t>(now - fStart).count();
+  fRunning = false;
+}
+
+//_____________________________________________________________________________
+void MicroBench::State::ResumeTiming()
+{
+  // Restart the clock and the allocation count
+
+  if( fRunning )
+    return;
+  fAllocStart = AllocCounter::GetCount();
+  fBytesStart = AllocCounter::GetBytes();
+  fRunning = true;
+  fStart = clock_type::now();
+}
+
+//_____________________________________________________________________________
+void MicroBench::State::Start()
+{
+  // Reset the accumulated time and allocations and start timing
+
+  fElapsed = 0;
+  fAllocs = fBytes = 0;
+  fRunning = false;
+  ResumeTiming();
+}
+
+//_____________________________________________________________________________
+void MicroBench::State::Stop()
+{
+  PauseTiming();
+}
+
+//_____________________________________________________________________________
+MicroBench::MicroBench( const char* suite )
+  : fSuite(suite ? suite : ""), fDataDir(PODD_BENCH_DATADIR), fMinTime(0.5),
+    fRepetitions(5), fListOnly(false)
+{
+}
+
+//_____________________________________________________________________________
+void MicroBench::Usage() const
+{
+  // Print usage message and exit with error code
+
+  cerr << "Usage: " << fPrgName << " [options]" << endl
+       << " -f STRING   run only benchmarks whose name contains STRING" << endl
+       << " -t SECONDS  minimum timed duration per benchmark (default 0.5)"
+       << endl
+       << " -r N        number of timing repetitions (default 5)" << endl
+       << " -o FILE     write JSON report to FILE (\"-\" = stdout)" << endl
+       << " -d DIR      benchmark input directory (default "
+       << PODD_BENCH_DATADIR << ")" << endl
+       << " -l          list benchmarks and exit" << endl
+       << " -h          print this help" << endl;
+  exit(255);
+}
+
+//_____________________________________________________________________________
+Int_t MicroBench::ParseArgs( int argc, char** argv )
+{
+  // Parse the command line. Exits with an error code on invalid options.
+  // Sets DB_DIR to the database in the benchmark input directory.
+
+  char* argv0 = strdup(argv[0]);
+  fPrgName = basename(argv0);
+  free(argv0);
+
+  int opt;
+  while( (opt = getopt(argc, argv, "hf:t:r:o:d:l")) != -1 ) {
+    switch( opt ) {
+    case 'f':
+      fFilter = optarg;
+      break;
+    case 't':
+      fMinTime = atof(optarg);
+      if( fMinTime <= 0 ) {
+        cerr << "Invalid time: " << optarg << endl;
+        Usage();
+      }
+      break;
+    case 'r':
+      fRepetitions = strtoul(optarg, nullptr, 10);
+      if( fRepetitions == 0 ) {
+        cerr << "Invalid number of repetitions: " << optarg << endl;
+        Usage();
+      }
+      break;
+    case 'o':
+      fOutFile = optarg;
+      break;
+    case 'd':
+      fDataDir = optarg;
+      break;
+    case 'l':
+      fListOnly = true;
+      break;
+    case 'h':
+    default:
+      Usage();
+    }
+  }
+  if( optind < argc ) {
+    cerr << "Unexpected argument: " << argv[optind] << endl;
+    Usage();
+  }
+
+  string dbdir = fDataDir + "/DB";
+  if( gSystem->AccessPathName(dbdir.c_str()) ) {
+    cerr << "Cannot find benchmark database " << dbdir << endl;
+    return 1;
+  }
+  gSystem->Setenv("DB_DIR", dbdir.c_str());
+  return 0;
+}
+
+//_____________________________________________________________________________
+Bool_t MicroBench::IsSelected( const char* name ) const
+{
+  return fFilter.empty() || (name && strstr(name, fFilter.c_str()));
+}
+
+//_____________________________________________________________________________
+void MicroBench::Run( const char* name, const Body_t& body, Double_t items )
+{
+  // Time the benchmark 'body'
+
+  if( !IsSelected(name) )
+    return;
+  if( fListOnly ) {
+    cout << name << endl;
+    return;
+  }
+
+  Result res{name, "", items, 0, fRepetitions, 0, 0, 0, 0, 0, 0};
+  Bool_t enabled = AllocCounter::IsEnabled();
+  AllocCounter::Enable();
+  try {
+    State st;
+
+    // Warm-up. Also estimates the duration of one iteration
+    ULong64_t nwarm = 0;
+    st.Start();
+    do {
+      body(st);
+      ++st.fIteration;
+      ++nwarm;
+      st.PauseTiming();  // Read the elapsed time
+      st.ResumeTiming();
+    } while( st.fElapsed < 0.1 * fMinTime );
+    st.Stop();
+
+    Double_t t_iter = st.fElapsed / static_cast<Double_t>(nwarm);
+    Double_t t_rep = fMinTime / fRepetitions;
+    res.iterations = (t_iter > 0) ? static_cast<ULong64_t>(ceil(t_rep / t_iter)) : 1;
+    if( res.iterations == 0 )
+      res.iterations = 1;
+
+    // Timed repetitions
+    vector<Double_t> times;
+    ULong64_t nalloc = 0, nbytes = 0;
+    for( UInt_t irep = 0; irep < fRepetitions; ++irep ) {
+      st.Start();
+      for( ULong64_t i = 0; i < res.iterations; ++i ) {
+        body(st);
+        ++st.fIteration;
+      }
+      st.Stop();
+      times.push_back(1e9 * st.fElapsed / static_cast<Double_t>(res.iterations));
+      nalloc += st.fAllocs;
+      nbytes += st.fBytes;
+    }
+
+    sort(times.begin(), times.end());
+    size_t n = times.size();
+    res.median = (n % 2) ? times[n/2] : 0.5 * (times[n/2-1] + times[n/2]);
+    res.min = times.front();
+    Double_t sum = 0, sum2 = 0;
+    for( auto t : times ) {
+      sum += t;
+      sum2 += t * t;
+    }
+    res.mean = sum / n;
+    res.stddev = (n > 1) ? sqrt(max(0.0, (sum2 - sum * res.mean) / (n - 1))) : 0;
+    Double_t ntot = static_cast<Double_t>(res.iterations) * fRepetitions;
+    res.allocs = nalloc / ntot;
+    res.bytes = nbytes / ntot;
+  }
+  catch( const exception& e ) {
+    res.error = string("exception: ") + e.what();
+  }
+  AllocCounter::Enable(enabled);
+
+  if( res.error.empty() ) {
+    printf("%-50s %12.1f ns %6.1f%% %14.4g items/s %9.2f allocs\n",
+           name, res.median, res.median > 0 ? 100. * res.stddev / res.median : 0.,
+           res.median > 0 ? 1e9 * items / res.median : 0., res.allocs);
+  } else {
+    printf("%-50s FAILED: %s\n", name, res.error.c_str());
+  }
+  fflush(stdout);
+  fResults.push_back(std::move(res));
+}
+
+//_____________________________________________________________________________
+void MicroBench::Fail( const char* name, const char* reason )
+{
+  // Record benchmark 'name' as failed
+
+  if( !IsSelected(name) || fListOnly )
+    return;
+  Result res{name, reason ? reason : "setup failed", 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  printf("%-50s FAILED: %s\n", name, res.error.c_str());
+  fResults.push_back(std::move(res));
+}
+
+//_____________________________________________________________________________
+void MicroBench::WriteJSONString( ostream& os, const string& str )
+{
+  os << '"';
+  for( char c : str ) {
+    switch( c ) {
+    case '"':  os << "\\\""; break;
+    case '\\': os << "\\\\"; break;
+    case '\n': os << "\\n";  break;
+    case '\t': os << "\\t";  break;
+    default:
+      if( static_cast<unsigned char>(c) < 0x20 ) {
+        char buf[8];
+        snprintf(buf, sizeof(buf), "\\u%04x", c);
+        os << buf;
+      } else
+        os << c;
+    }
+  }
+  os << '"';
+}
+
+//_____________________________________________________________________________
+Int_t MicroBench::WriteJSON( ostream& os ) const
+{
+  // Write the results as a JSON document
+
+  os << setprecision(8);
+  os << "{" << endl << "  \"suite\": ";
+  WriteJSONString(os, fSuite);
+  os << "," << endl << "  \"version\": ";
+  WriteJSONString(os, HA_VERSION);
+  os << "," << endl << "  \"gitrev\": ";
+  WriteJSONString(os, HA_GITREV);
+  os << "," << endl << "  \"date\": ";
+  WriteJSONString(os, TDatime().AsSQLString());
+  os << "," << endl << "  \"host\": ";
+  WriteJSONString(os, gSystem->HostName());
+  os << "," << endl
+     << "  \"min_time\": " << fMinTime << "," << endl
+     << "  \"repetitions\": " << fRepetitions << "," << endl
+     << "  \"benchmarks\": [";
+  const char* sep = "";
+  for( const auto& res : fResults ) {
+    os << sep << endl << "    { \"name\": ";
+    WriteJSONString(os, res.name);
+    if( !res.error.empty() ) {
+      os << ", \"error\": ";
+      WriteJSONString(os, res.error);
+    } else {
+      os << ", \"items\": " << res.items
+         << ", \"iterations\": " << res.iterations
+         << ", \"repetitions\": " << res.repetitions
+         << ", \"ns_per_iter\": " << res.median
+         << ", \"ns_mean\": " << res.mean
+         << ", \"ns_min\": " << res.min
+         << ", \"ns_stddev\": " << res.stddev
+         << ", \"items_per_sec\": "
+         << (res.median > 0 ? 1e9 * res.items / res.median : 0.)
+         << ", \"allocs_per_iter\": " << res.allocs
+         << ", \"bytes_per_iter\": " << res.bytes;
+    }
+    os << " }";
+    sep = ",";
+  }
+  os << endl << "  ]" << endl << "}" << endl;
+  return os.good() ? 0 : 1;
+}
+
+//_____________________________________________________________________________
+Int_t MicroBench::Finish()
+{
+  // Write the JSON report, if requested
+
+  if( fListOnly )
+    return 0;
+
+  Int_t ret = 0;
+  if( fOutFile == "-" )
+    ret = WriteJSON(cout);
+  else if( !fOutFile.empty() ) {
+    ofstream ofs(fOutFile);
+    if( !ofs ) {
+      cerr << "Cannot open output file " << fOutFile << endl;
+      return 1;
+    }
+    ret = WriteJSON(ofs);
+  }
+  for( const auto& res : fResults ) {
+    if( !res.error.empty() )
+      ret = 1;
+  }
+  return ret;
+}
+
+} // namespace Podd
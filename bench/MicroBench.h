@@ -0,0 +1,113 @@
+#ifndef Podd_MicroBench_h_
+#define Podd_MicroBench_h_
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Podd::MicroBench
+//
+// Small harness for the Podd micro-benchmarks: repeated timing of a
+// benchmark body, allocation counting, and table and JSON reports.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Rtypes.h"
+#include <chrono>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace Podd {
+
+class MicroBench {
+public:
+  // Timing state of the benchmark currently running. The body may exclude
+  // setup work (e.g. loading the next event) from the measurement with
+  // PauseTiming()/ResumeTiming().
+  class State {
+  public:
+    State();
+    void      PauseTiming();
+    void      ResumeTiming();
+    ULong64_t GetIteration() const { return fIteration; }
+
+  private:
+    friend class MicroBench;
+    using clock_type = std::chrono::steady_clock;
+
+    void      Start();
+    void      Stop();
+
+    clock_type::time_point fStart;
+    Double_t  fElapsed;      // Timed seconds since Start()
+    ULong64_t fAllocStart;   // Allocation count at last resume
+    ULong64_t fBytesStart;   // Allocated bytes at last resume
+    ULong64_t fAllocs;       // Allocations while timing
+    ULong64_t fBytes;        // Bytes allocated while timing
+    ULong64_t fIteration;    // Calls of the body so far
+    Bool_t    fRunning;
+  };
+  using Body_t = std::function<void(State&)>;
+
+  // Results of one benchmark
+  struct Result {
+    std::string name;
+    std::string error;       // Non-empty if the benchmark could not run
+    Double_t  items;         // Items processed per iteration
+    ULong64_t iterations;    // Iterations per repetition
+    UInt_t    repetitions;
+    Double_t  median;        // Time per iteration (ns) ...
+    Double_t  mean;
+    Double_t  min;
+    Double_t  stddev;
+    Double_t  allocs;        // Heap allocations per iteration
+    Double_t  bytes;         // Heap bytes allocated per iteration
+  };
+
+  explicit MicroBench( const char* suite );
+
+  // Parse the command line options common to all benchmark programs.
+  // Returns 0 on success.
+  Int_t  ParseArgs( int argc, char** argv );
+
+  // Directory with the benchmark input files (database etc.)
+  const std::string& GetDataDir() const { return fDataDir; }
+
+  // Test whether benchmark 'name' is selected on the command line.
+  // Use to skip expensive setup of unselected benchmarks.
+  Bool_t IsSelected( const char* name ) const;
+
+  // Time 'body', which processes 'items' items (events, hits, lookups)
+  // per call, if 'name' is selected
+  void   Run( const char* name, const Body_t& body, Double_t items = 1.0 );
+
+  // Record that benchmark 'name' could not be set up
+  void   Fail( const char* name, const char* reason );
+
+  // Print the results and write the JSON report. Returns the exit code
+  // for main(): 0 if all benchmarks ran, 1 otherwise.
+  Int_t  Finish();
+
+  const std::vector<Result>& GetResults() const { return fResults; }
+
+  // Write a string to 'os' as a quoted and escaped JSON string
+  static void WriteJSONString( std::ostream& os, const std::string& str );
+
+private:
+  std::string fSuite;       // Name of this benchmark program
+  std::string fPrgName;
+  std::string fFilter;      // Run only benchmarks containing this string
+  std::string fOutFile;     // JSON output file ("-" = stdout)
+  std::string fDataDir;     // Benchmark input directory
+  Double_t    fMinTime;     // Minimum timed seconds per benchmark
+  UInt_t      fRepetitions; // Repetitions of the timing loop
+  Bool_t      fListOnly;    // Only list the benchmark names
+  std::vector<Result> fResults;
+
+  void  Usage() const;
+  Int_t WriteJSON( std::ostream& os ) const;
+};
+
+} // namespace Podd
+
+#endif
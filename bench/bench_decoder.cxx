@@ -0,0 +1,213 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// bench_decoder
+//
+// Micro-benchmarks of the raw data decoder: CodaDecoder::LoadEvent for
+// each supported module type, THaSlotData hit loading and access, and
+// the detector map hit iterator.
+//
+// The input events are made with Decoder::CodaEventGenerator from the
+// benchmark crate maps (bench/DB/DEFAULT/db_bench_*.dat) with a fixed
+// random seed and run time, so results are comparable across commits.
+// One iteration decodes the complete event sample; the throughput is
+// given in triggers per second.
+//
+// Usage: bench_decoder [options], see MicroBench
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MicroBench.h"
+#include "CodaDecoder.h"
+#include "CodaEventGenerator.h"
+#include "THaSlotData.h"
+#include "THaDetMap.h"
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace Decoder;
+using Podd::MicroBench;
+
+static const ULong64_t kRunTime = 1577836800;  // 2020-01-01 00:00:00 UTC
+static const ULong64_t kNtrig   = 500;         // Triggers per sample
+
+// Event sample for one decoder benchmark
+struct DecoderCase {
+  const char* name;
+  const char* cratemap;
+  Int_t       coda_version;
+  UInt_t      block_level;
+  UInt_t      fadc_mode;
+  Double_t    occupancy;
+};
+
+using EventList_t = vector<vector<UInt_t>>;
+
+//-----------------------------------------------------------------------------
+static Int_t MakeSample( const DecoderCase& bc, CodaDecoder& evdata,
+                         EventList_t& events, ULong64_t& ntrig )
+{
+  // Generate the event sample for 'bc' and feed it once through 'evdata'.
+  // Keeps the physics events in 'events'. Returns 0 on success.
+
+  CodaEventGenerator gen(bc.cratemap);
+  gen.SetCodaVersion(bc.coda_version);
+  gen.SetBlockLevel(bc.block_level);
+  gen.SetFadcMode(bc.fadc_mode);
+  gen.SetOccupancy(bc.occupancy);
+  gen.SetEpicsInterval(0);
+  gen.SetScalerInterval(0);
+  if( gen.Init(kRunTime) != 0 )
+    return -1;
+
+  evdata.SetCodaVersion(bc.coda_version);
+  evdata.SetCrateMapName(bc.cratemap);
+  events.clear();
+  while( gen.GetNtrig() < kNtrig ) {
+    const UInt_t* evbuf = gen.NextEvent(kNtrig - gen.GetNtrig());
+    if( evdata.LoadEvent(evbuf) != THaEvData::HED_OK )
+      return -2;
+    if( evdata.IsPhysicsTrigger() )
+      events.emplace_back(evbuf, evbuf + gen.GetEvLength());
+    while( evdata.DataCached() ) {
+      if( evdata.LoadFromMultiBlock() != THaEvData::HED_OK )
+        return -2;
+    }
+  }
+  ntrig = gen.GetNtrig();
+  return events.empty() ? -3 : 0;
+}
+
+//-----------------------------------------------------------------------------
+static void BenchLoadEvent( MicroBench& bench )
+{
+  // CodaDecoder::LoadEvent for each module type
+
+  static const DecoderCase cases[] = {
+    { "CodaDecoder::LoadEvent/FADC250 mode 1",      "bench_fadc250",  3,  1,  1, 0.2 },
+    { "CodaDecoder::LoadEvent/FADC250 mode 10",     "bench_fadc250",  3,  1, 10, 0.2 },
+    { "CodaDecoder::LoadEvent/FADC250 mode 10 b10", "bench_fadc250",  3, 10, 10, 0.2 },
+    { "CodaDecoder::LoadEvent/Caen1190",            "bench_caen1190", 3,  1, 10, 0.1 },
+    { "CodaDecoder::LoadEvent/Caen1190 b10",        "bench_caen1190", 3, 10, 10, 0.1 },
+    { "CodaDecoder::LoadEvent/Lecroy1877",          "bench_lecroy1877", 2, 1, 10, 0.1 },
+    { "CodaDecoder::LoadEvent/Lecroy1881",          "bench_lecroy1881", 2, 1, 10, 0.3 },
+    { "CodaDecoder::LoadEvent/Lecroy1875",          "bench_lecroy1875", 2, 1, 10, 0.1 },
+    { "CodaDecoder::LoadEvent/Scaler3801",          "bench_scaler",   3,  1, 10, 0.1 },
+  };
+
+  for( const auto& bc : cases ) {
+    if( !bench.IsSelected(bc.name) )
+      continue;
+    unique_ptr<CodaDecoder> evdata(new CodaDecoder);
+    EventList_t events;
+    ULong64_t ntrig = 0;
+    if( MakeSample(bc, *evdata, events, ntrig) != 0 ) {
+      bench.Fail(bc.name, "cannot generate or decode event sample");
+      continue;
+    }
+    bench.Run(bc.name, [&]( MicroBench::State& ) {
+      for( const auto& ev : events ) {
+        evdata->LoadEvent(ev.data());
+        while( evdata->DataCached() )
+          evdata->LoadFromMultiBlock();
+      }
+    }, static_cast<Double_t>(ntrig));
+  }
+}
+
+//-----------------------------------------------------------------------------
+static void BenchSlotData( MicroBench& bench )
+{
+  // THaSlotData hit loading and retrieval, 1024 hits in 128 channels
+
+  const UInt_t nchan = 128, nhits = 1024;
+  vector<UInt_t> chan(nhits), data(nhits);
+  for( UInt_t i = 0; i < nhits; ++i ) {
+    chan[i] = (i * 37) % nchan;
+    data[i] = 1000 + (i * 7919) % 2000;
+  }
+  THaSlotData sldat;
+  sldat.define(1, 5, nchan);
+
+  bench.Run("THaSlotData::loadData", [&]( MicroBench::State& ) {
+    sldat.clearEvent();
+    for( UInt_t i = 0; i < nhits; ++i )
+      sldat.loadData(chan[i], data[i], data[i]);
+  }, nhits);
+
+  bench.Run("THaSlotData::loadData (bulk)", [&]( MicroBench::State& ) {
+    sldat.clearEvent();
+    sldat.loadData(nullptr, chan.data(), data.data(), data.data(), nhits);
+  }, nhits);
+
+  sldat.clearEvent();
+  sldat.loadData(nullptr, chan.data(), data.data(), data.data(), nhits);
+  volatile UInt_t sink = 0;
+  bench.Run("THaSlotData::getData", [&]( MicroBench::State& ) {
+    UInt_t sum = 0;
+    for( UInt_t i = 0; i < sldat.getNumChan(); ++i ) {
+      UInt_t ch = sldat.getNextChan(i);
+      for( UInt_t hit = 0; hit < sldat.getNumHits(ch); ++hit )
+        sum += sldat.getData(ch, hit);
+    }
+    sink = sum;
+  }, nhits);
+  (void)sink;
+}
+
+//-----------------------------------------------------------------------------
+static void BenchDetMap( MicroBench& bench )
+{
+  // THaDetMap::MultiHitIterator over one Fastbus crate with eight 1877s,
+  // the access pattern of the wire chamber Decode() methods
+
+  const char* const name = "THaDetMap::MultiHitIterator";
+  if( !bench.IsSelected(name) )
+    return;
+
+  DecoderCase bc{ name, "bench_lecroy1877", 2, 1, 10, 0.3 };
+  unique_ptr<CodaDecoder> evdata(new CodaDecoder);
+  EventList_t events;
+  ULong64_t ntrig = 0;
+  if( MakeSample(bc, *evdata, events, ntrig) != 0 ) {
+    bench.Fail(name, "cannot generate or decode event sample");
+    return;
+  }
+  evdata->LoadEvent(events.back().data());
+
+  THaDetMap detmap;
+  for( UInt_t slot = 3; slot <= 10; ++slot )
+    detmap.AddModule(1, slot, 0, 95, 96 * (slot - 3), 1877);
+
+  UInt_t nhits = 0;
+  for( auto it = detmap.MakeMultiHitIterator(*evdata); it; ++it )
+    ++nhits;
+
+  volatile UInt_t sink = 0;
+  bench.Run(name, [&]( MicroBench::State& ) {
+    UInt_t sum = 0;
+    auto it = detmap.MakeMultiHitIterator(*evdata);
+    while( it ) {
+      const auto& hitinfo = *it;
+      sum += evdata->GetData(hitinfo.crate, hitinfo.slot, hitinfo.chan,
+                             hitinfo.hit);
+      ++it;
+    }
+    sink = sum;
+  }, nhits);
+  (void)sink;
+}
+
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  MicroBench bench("decoder");
+  if( bench.ParseArgs(argc, argv) != 0 )
+    return 1;
+
+  BenchLoadEvent(bench);
+  BenchSlotData(bench);
+  BenchDetMap(bench);
+
+  return bench.Finish();
+}
@@ -0,0 +1,181 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// bench_formula
+//
+// Micro-benchmarks of global variable lookup and of formula and cut
+// evaluation, the per-event work of tests, cuts and output formulas.
+//
+// The benchmarks use their own analysis context with a variable list of
+// the size of a typical two-arm replay. The values of the variables
+// change between evaluations. One iteration performs kNeval lookups or
+// evaluations.
+//
+// Usage: bench_formula [options], see MicroBench
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MicroBench.h"
+#include "AnalysisContext.h"
+#include "THaVarList.h"
+#include "THaFormula.h"
+#include "THaCut.h"
+#include "THaCutList.h"
+#include "TString.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using Podd::MicroBench;
+
+static const UInt_t kNeval  = 100;  // Evaluations per iteration
+static const UInt_t kNdet   = 40;   // Detectors in the variable list ...
+static const UInt_t kNvar   = 25;   // ... with this many variables each
+static const Int_t  kMaxTrk = 10;   // Size of track arrays
+static const char*  kBlock  = "bench";
+
+// Variables used in the formulas, filled with kNeval sets of values
+struct EventVars {
+  Int_t    ntr;
+  Double_t x[kMaxTrk], y[kMaxTrk], th[kMaxTrk], ph[kMaxTrk];
+  Double_t p, dp, gth, gph;
+};
+
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  MicroBench bench("formula");
+  if( bench.ParseArgs(argc, argv) != 0 )
+    return 1;
+
+  // Keep the variables and cuts of this test out of the global lists
+  Podd::AnalysisContext context;
+  Podd::AnalysisContext::Scope scope(&context);
+  THaVarList* vars = context.GetVars();
+  THaCutList* cuts = context.GetCuts();
+
+  // Filler variables, as defined by the detectors of a typical replay
+  vector<Double_t> filler(kNdet * kNvar);
+  vector<string> names, missing;
+  for( UInt_t idet = 0; idet < kNdet; ++idet ) {
+    for( UInt_t ivar = 0; ivar < kNvar; ++ivar ) {
+      string name = Form("%c.det%u.var%u", idet % 2 ? 'L' : 'R', idet, ivar);
+      vars->Define(name.c_str(), "filler", filler[idet * kNvar + ivar]);
+      if( names.size() < kNeval && (idet * kNvar + ivar) % 7 == 0 )
+        names.push_back(name);
+      if( missing.size() < kNeval && ivar % 5 == 0 )
+        missing.push_back(string(Form("%c.det%u.nothere%u", idet % 2 ? 'L' : 'R',
+                                      idet, ivar)));
+    }
+  }
+
+  // Variables used in the formulas
+  EventVars ev{};
+  vars->Define("R.tr.n",   "Number of tracks",  ev.ntr);
+  vars->Define("R.tr.x",   "Track x",  ev.x[0],  &ev.ntr);
+  vars->Define("R.tr.y",   "Track y",  ev.y[0],  &ev.ntr);
+  vars->Define("R.tr.th",  "Track th", ev.th[0], &ev.ntr);
+  vars->Define("R.tr.ph",  "Track ph", ev.ph[0], &ev.ntr);
+  vars->Define("R.gold.p",  "Golden track p",  ev.p);
+  vars->Define("R.gold.dp", "Golden track dp", ev.dp);
+  vars->Define("R.gold.th", "Golden track th", ev.gth);
+  vars->Define("R.gold.ph", "Golden track ph", ev.gph);
+
+  // Value sets
+  mt19937 rng(4357);
+  uniform_real_distribution<> uniform(-1.0, 1.0);
+  vector<EventVars> values(kNeval);
+  for( auto& v : values ) {
+    v.ntr = 1 + static_cast<Int_t>(rng() % 4);
+    for( Int_t i = 0; i < kMaxTrk; ++i ) {
+      v.x[i]  = 0.5 * uniform(rng);
+      v.y[i]  = 0.03 * uniform(rng);
+      v.th[i] = 0.03 * uniform(rng);
+      v.ph[i] = 0.03 * uniform(rng);
+    }
+    v.p   = 0.8 * (1.0 + 0.05 * uniform(rng));
+    v.dp  = 0.05 * uniform(rng);
+    v.gth = v.th[0];
+    v.gph = v.ph[0];
+  }
+
+  volatile Double_t sink = 0;
+
+  bench.Run("THaVarList::Find", [&]( MicroBench::State& ) {
+    for( const auto& name : names )
+      sink = (vars->Find(name.c_str()) != nullptr);
+  }, static_cast<Double_t>(names.size()));
+
+  bench.Run("THaVarList::Find (miss)", [&]( MicroBench::State& ) {
+    for( const auto& name : missing )
+      sink = (vars->Find(name.c_str()) != nullptr);
+  }, static_cast<Double_t>(missing.size()));
+
+  // Formulas
+  struct FormulaDef {
+    const char* name;
+    const char* expr;
+  };
+  static const FormulaDef formulas[] = {
+    { "THaFormula::Eval (arithmetic)", "R.gold.p*(1+R.gold.dp)-0.8" },
+    { "THaFormula::Eval (math)",
+      "sqrt(R.gold.th*R.gold.th+R.gold.ph*R.gold.ph)+abs(R.gold.dp)" },
+    { "THaFormula::Eval (array element)", "R.tr.x[0]+R.tr.y[0]*R.tr.th[0]" },
+  };
+  for( const auto& fd : formulas ) {
+    if( !bench.IsSelected(fd.name) )
+      continue;
+    THaFormula f("f", fd.expr, false, vars, cuts);
+    if( f.IsError() ) {
+      bench.Fail(fd.name, "formula error");
+      continue;
+    }
+    bench.Run(fd.name, [&]( MicroBench::State& ) {
+      for( const auto& v : values ) {
+        ev = v;
+        sink = f.Eval();
+      }
+    }, kNeval);
+  }
+
+  // Single cut
+  const char* const cutname = "THaCut::EvalCut";
+  if( bench.IsSelected(cutname) ) {
+    THaCut cut("cut", "R.tr.n==1&&abs(R.gold.dp)<0.04&&abs(R.tr.y[0])<0.02",
+               kBlock, vars, cuts);
+    if( cut.IsError() )
+      bench.Fail(cutname, "cut error");
+    else {
+      bench.Run(cutname, [&]( MicroBench::State& ) {
+        for( const auto& v : values ) {
+          ev = v;
+          sink = cut.EvalCut();
+        }
+      }, kNeval);
+    }
+  }
+
+  // Block of cuts, some of which depend on others, as in a cut file
+  const char* const blockname = "THaCutList::EvalBlock";
+  if( bench.IsSelected(blockname) ) {
+    for( Int_t i = 0; i < 4; ++i ) {
+      TString pre = Form("c%d_", i);
+      Double_t lim = 0.01 * (i + 1);
+      cuts->Define(pre + "ntr",  "R.tr.n==1", kBlock);
+      cuts->Define(pre + "dp",   Form("abs(R.gold.dp)<%g", lim), kBlock);
+      cuts->Define(pre + "th",   Form("abs(R.gold.th)<%g", lim), kBlock);
+      cuts->Define(pre + "ph",   Form("abs(R.gold.ph)<%g", lim), kBlock);
+      cuts->Define(pre + "good", pre + "ntr&&" + pre + "dp&&" + pre + "th&&"
+                                 + pre + "ph", kBlock);
+    }
+    bench.Run(blockname, [&]( MicroBench::State& ) {
+      for( const auto& v : values ) {
+        ev = v;
+        sink = cuts->EvalBlock(kBlock);
+      }
+    }, kNeval);
+  }
+  (void)sink;
+
+  return bench.Finish();
+}
@@ -0,0 +1,137 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// bench_output
+//
+// Micro-benchmark of THaOutput::Process, i.e. copying global variables,
+// formulas and cut results into the output tree and filling the
+// histograms of an output definition file (bench/bench_output.def).
+//
+// The variables are defined in a separate analysis context. Their values
+// change from event to event. The tree is written to a scratch file in
+// the system's temporary directory, which is removed at the end. One
+// iteration processes kNevents events.
+//
+// Usage: bench_output [options], see MicroBench
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MicroBench.h"
+#include "AnalysisContext.h"
+#include "THaVarList.h"
+#include "THaOutput.h"
+#include "TFile.h"
+#include "TString.h"
+#include "TSystem.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace std;
+using Podd::MicroBench;
+
+static const UInt_t kNevents = 100;   // Events per iteration
+static const Int_t  kNpad    = 6;     // Scintillator paddles
+static const Int_t  kMaxHit  = 50;    // Maximum VDC hits
+
+// Event data of the variables in bench_output.def
+struct EventVars {
+  Int_t    ntr;
+  Double_t lt[kNpad], rt[kNpad];
+  Int_t    nhit;
+  Int_t    rawtime[kMaxHit];
+  vector<Int_t> wire;
+  Double_t p, dp, th, ph;
+};
+
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  MicroBench bench("output");
+  if( bench.ParseArgs(argc, argv) != 0 )
+    return 1;
+
+  const char* const name = "THaOutput::Process";
+  TString deffile = bench.GetDataDir() + "/bench_output.def";
+  if( gSystem->AccessPathName(deffile) ) {
+    bench.Fail(name, Form("cannot find %s", deffile.Data()));
+    return bench.Finish();
+  }
+
+  // Keep the variables of this test out of the global lists
+  Podd::AnalysisContext context;
+  Podd::AnalysisContext::Scope scope(&context);
+  THaVarList* vars = context.GetVars();
+
+  EventVars ev{};
+  vars->Define("R.tr.n",           "Number of tracks",  ev.ntr);
+  vars->Define("R.s1.lt",          "S1 left TDC",  ev.lt[0], &kNpad);
+  vars->Define("R.s1.rt",          "S1 right TDC", ev.rt[0], &kNpad);
+  vars->Define("R.vdc.u1.nhit",    "U1 hits",      ev.nhit);
+  vars->Define("R.vdc.u1.rawtime", "U1 raw TDC",   ev.rawtime[0], &ev.nhit);
+  vars->Define("R.vdc.u1.wire",    "U1 wires",     ev.wire);
+  vars->Define("R.gold.p",  "Golden track p",  ev.p);
+  vars->Define("R.gold.dp", "Golden track dp", ev.dp);
+  vars->Define("R.gold.th", "Golden track th", ev.th);
+  vars->Define("R.gold.ph", "Golden track ph", ev.ph);
+
+  // Event samples
+  mt19937 rng(4357);
+  uniform_real_distribution<> uniform(-1.0, 1.0);
+  vector<EventVars> events(kNevents);
+  for( auto& v : events ) {
+    v.ntr = 1 + static_cast<Int_t>(rng() % 3);
+    for( Int_t i = 0; i < kNpad; ++i ) {
+      v.lt[i] = 1500 + 200 * uniform(rng);
+      v.rt[i] = 1500 + 200 * uniform(rng);
+    }
+    v.nhit = 5 + static_cast<Int_t>(rng() % 20);
+    Int_t wire0 = static_cast<Int_t>(rng() % 340);
+    for( Int_t i = 0; i < v.nhit; ++i ) {
+      v.rawtime[i] = 1600 + static_cast<Int_t>(200 * uniform(rng));
+      v.wire.push_back(wire0 + i);
+    }
+    v.p  = 0.8 * (1.0 + 0.05 * uniform(rng));
+    v.dp = 0.05 * uniform(rng);
+    v.th = 0.03 * uniform(rng);
+    v.ph = 0.03 * uniform(rng);
+  }
+
+  // Scratch output file
+  TString filename = Form("%s/bench_output_%d.root",
+                          gSystem->TempDirectory(), gSystem->GetPid());
+  unique_ptr<TFile> file(TFile::Open(filename, "RECREATE"));
+  if( !file || file->IsZombie() ) {
+    bench.Fail(name, Form("cannot open scratch file %s", filename.Data()));
+    return bench.Finish();
+  }
+  unique_ptr<THaOutput> output(new THaOutput);
+  if( output->Init(deffile) != 0 || !output->TreeDefined() ) {
+    bench.Fail(name, "cannot initialize output");
+  } else {
+    // Copy the event values while keeping the address of the vector
+    // variable unchanged
+    bench.Run(name, [&]( MicroBench::State& ) {
+      for( const auto& v : events ) {
+        ev.ntr = v.ntr;
+        copy(v.lt, v.lt + kNpad, ev.lt);
+        copy(v.rt, v.rt + kNpad, ev.rt);
+        ev.nhit = v.nhit;
+        copy(v.rawtime, v.rawtime + v.nhit, ev.rawtime);
+        ev.wire.assign(v.wire.begin(), v.wire.end());
+        ev.p  = v.p;
+        ev.dp = v.dp;
+        ev.th = v.th;
+        ev.ph = v.ph;
+        output->Process();
+      }
+    }, kNevents);
+    output->End();
+  }
+  output.reset();
+  file->Close();
+  file.reset();
+  gSystem->Unlink(filename);
+
+  return bench.Finish();
+}
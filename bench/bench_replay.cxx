@@ -0,0 +1,604 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// bench_replay
+//
+// End-to-end replay benchmark: runs complete analyses of synthetic CODA
+// files with THaAnalyzer and reports the event throughput, the data
+// rate, the time spent in each analysis stage and module, the heap
+// allocations per event and the peak resident memory.
+//
+// Three reference configurations are defined:
+//
+//   hrs    CODA 2, right-arm HRS with VDC, S1 and S2 (Fastbus 1877/1881),
+//          golden track
+//   coinc  CODA 2, both arms as above, ideal beam, electron kinematics
+//          of each arm, left-arm scaler events and EPICS events
+//   fadc   CODA 3, block level 10, right-arm S0 scintillator and gas and
+//          aerogel Cherenkovs read out by FADC250s and a Caen 1190 TDC
+//
+// The data files are made with Decoder::CodaEventGenerator from the crate
+// maps bench/DB/DEFAULT/db_replay_<config>.dat with a fixed random seed
+// and run time. The VDC events contain wire clusters as left by tracks.
+// Detector, output and cut definitions are in bench/DB/DEFAULT and
+// bench/replay_<config>_{output,cuts}.def. Data and ROOT files are
+// written to the system's temporary directory and removed at the end.
+//
+// Each configuration is replayed several times, each time with a fresh
+// analysis context and analyzer. The results of the repetition with the
+// median processing time are reported. Initialization (database, output
+// setup) is timed separately and not included in the throughput.
+//
+// The JSON report has the form
+//
+//   { "suite": "replay", "version": "1.7.6", "gitrev": "...",
+//     "date": "...", "host": "...", "ntrig": 20000, "repetitions": 3,
+//     "configs": [
+//       { "name": "hrs", "coda_version": 2, "block_level": 1,
+//         "ntrig": 20000, "nevents": 20012, "file_bytes": 12345678,
+//         "init_sec": 0.2, "process_sec": 1.5, "process_sec_min": 1.4,
+//         "events_per_sec": 13333.3, "mb_per_sec": 8.2,
+//         "allocs_per_event": 12.5, "bytes_per_event": 1024.0,
+//         "peak_rss_mb": 180.5,
+//         "stages": { "RawDecode": 0.3, "EvtHandlers": 0.01, ... },
+//         "modules": [ { "name": "R", "ns_per_event": 25000.0,
+//                        "allocs_per_event": 3.0 }, ... ] }, ... ] }
+//
+// Per-event quantities are per trigger. The peak memory is measured for
+// each configuration on Linux (after resetting the high-water mark via
+// /proc/self/clear_refs); elsewhere it is the peak of the process so far.
+//
+// Usage: bench_replay [options], see Usage()
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MicroBench.h"
+#include "AllocCounter.h"
+#include "AnalysisContext.h"
+#include "CodaEventGenerator.h"
+#include "ModuleStats.h"
+#include "THaAnalyzer.h"
+#include "THaBenchmark.h"
+#include "THaRun.h"
+#include "THaHRS.h"
+#include "THaVDC.h"
+#include "THaScintillator.h"
+#include "FadcScintillator.h"
+#include "FadcCherenkov.h"
+#include "THaGoldenTrack.h"
+#include "THaIdealBeam.h"
+#include "THaPrimaryKine.h"
+#include "THaScalerEvtHandler.h"
+#include "ha_compiledata.h"
+#include "TDatime.h"
+#include "TList.h"
+#include "TString.h"
+#include "TSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>    // for strdup, strstr
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <getopt.h>
+#include <libgen.h>   // for POSIX basename()
+#include <sys/resource.h>
+
+using namespace std;
+using Podd::AnalysisContext;
+using Podd::MicroBench;
+
+#ifndef PODD_BENCH_DATADIR
+#define PODD_BENCH_DATADIR "."
+#endif
+
+static const ULong64_t kRunTime    = 1577836800;  // 2020-01-01 00:00:00 UTC
+static const UInt_t    kSeed       = 4357;
+static const Double_t  kProtonMass = 0.938272;   // GeV
+
+// Analysis stages timed by THaAnalyzer, see THaAnalyzer::EnableBenchmarks
+static const char* const kStages[] = {
+  "RawDecode", "EvtHandlers", "Decode", "CoarseTracking", "CoarseReconstruct",
+  "Tracking", "Reconstruct", "Physics", "Output", "Cuts"
+};
+
+// Reference replay configuration
+struct ReplayConfig {
+  const char* name;
+  const char* description;
+  Int_t       coda_version;
+  UInt_t      block_level;
+  Double_t    occupancy;       // Noise hit probability per channel
+  UInt_t      cluster_size;    // Wires per track cluster in the VDCs
+  Double_t    cluster_prob;    // Probability of a cluster per TDC
+  UInt_t      epics_interval;  // Triggers between EPICS events (0 = none)
+  UInt_t      scaler_interval; // Triggers between scaler events (0 = none)
+  void      (*setup)( AnalysisContext& ctx );
+};
+
+// Results of one replay
+struct ReplayResult {
+  Double_t  init_time;         // Init() (s)
+  Double_t  process_time;      // Process() (s)
+  Long64_t  nevents;           // Events read
+  ULong64_t nalloc;            // Heap allocations during Process()
+  ULong64_t nbytes;            // Heap bytes allocated during Process()
+  vector<pair<string,Double_t>> stages;   // Time per stage (s)
+  struct Module {
+    string    name;
+    Double_t  time;            // Total time (s)
+    ULong64_t nalloc;          // Heap allocations
+  };
+  vector<Module> modules;
+};
+
+// Summary for one configuration
+struct ConfigResult {
+  const ReplayConfig* config;
+  string    error;             // Non-empty if the replay failed
+  ULong64_t ntrig;
+  Long64_t  file_bytes;
+  Double_t  process_min;       // Fastest repetition (s)
+  Double_t  peak_rss;          // MB
+  ReplayResult median;
+};
+
+//-----------------------------------------------------------------------------
+static THaHRS* MakeHRS( const char* arm, const char* description )
+{
+  // Spectrometer with the standard VDC and S1/S2 scintillators
+
+  auto* hrs = new THaHRS(arm, description);
+  hrs->AutoStandardDetectors(false);
+  hrs->AddDetector(new THaVDC("vdc", "Vertical Drift Chamber"));
+  hrs->AddDetector(new THaScintillator("s1", "S1 scintillator"));
+  hrs->AddDetector(new THaScintillator("s2", "S2 scintillator"));
+  return hrs;
+}
+
+//-----------------------------------------------------------------------------
+static void SetupHRS( AnalysisContext& ctx )
+{
+  ctx.GetApps()->Add(MakeHRS("R", "Right arm HRS"));
+  ctx.GetPhysics()->Add(new THaGoldenTrack("R.gold", "Right arm golden track", "R"));
+}
+
+//-----------------------------------------------------------------------------
+static void SetupCoinc( AnalysisContext& ctx )
+{
+  ctx.GetApps()->Add(MakeHRS("R", "Right arm HRS"));
+  ctx.GetApps()->Add(MakeHRS("L", "Left arm HRS"));
+  ctx.GetApps()->Add(new THaIdealBeam("IB", "Ideal beam"));
+  ctx.GetPhysics()->Add(new THaGoldenTrack("R.gold", "Right arm golden track", "R"));
+  ctx.GetPhysics()->Add(new THaGoldenTrack("L.gold", "Left arm golden track", "L"));
+  ctx.GetPhysics()->Add(new THaPrimaryKine("R.ekine", "Right arm kinematics",
+                                           "R", "IB", kProtonMass));
+  ctx.GetPhysics()->Add(new THaPrimaryKine("L.ekine", "Left arm kinematics",
+                                           "L", "IB", kProtonMass));
+  ctx.GetEvtHandlers()->Add(new THaScalerEvtHandler("Left", "Left arm scalers"));
+}
+
+//-----------------------------------------------------------------------------
+static void SetupFADC( AnalysisContext& ctx )
+{
+  auto* hrs = new THaHRS("R", "Right arm HRS");
+  hrs->AutoStandardDetectors(false);
+  hrs->AddDetector(new HallA::FadcScintillator("s0", "S0 scintillator"));
+  hrs->AddDetector(new HallA::FadcCherenkov("cer", "Gas Cherenkov"));
+  hrs->AddDetector(new HallA::FadcCherenkov("a1", "A1 aerogel Cherenkov"));
+  hrs->AddDetector(new HallA::FadcCherenkov("a2", "A2 aerogel Cherenkov"));
+  ctx.GetApps()->Add(hrs);
+}
+
+static const ReplayConfig kConfigs[] = {
+  { "hrs",   "Single-arm HRS, CODA 2",               2,  1, 0.02, 5, 0.25,
+    0,    0,    SetupHRS   },
+  { "coinc", "Two-arm coincidence, scalers, EPICS",  2,  1, 0.02, 5, 0.25,
+    1000, 500,  SetupCoinc },
+  { "fadc",  "FADC250 detectors, CODA 3, block 10",  3, 10, 0.3,  0, 0,
+    0,    0,    SetupFADC  },
+};
+
+//-----------------------------------------------------------------------------
+static void ResetPeakRSS()
+{
+  // Reset the resident memory high-water mark of the process (Linux only)
+
+#ifdef __linux__
+  ofstream ofs("/proc/self/clear_refs");
+  if( ofs )
+    ofs << "5" << endl;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+static Double_t GetPeakRSS()
+{
+  // Peak resident memory (MB) since the last ResetPeakRSS(), if supported,
+  // otherwise since the start of the process
+
+#ifdef __linux__
+  ifstream ifs("/proc/self/status");
+  string line;
+  while( getline(ifs, line) ) {
+    if( line.compare(0, 6, "VmHWM:") == 0 )
+      return strtod(line.c_str() + 6, nullptr) / 1024.;  // kB
+  }
+#endif
+  struct rusage usage{};
+  if( getrusage(RUSAGE_SELF, &usage) != 0 )
+    return 0;
+#ifdef __APPLE__
+  return static_cast<Double_t>(usage.ru_maxrss) / (1024. * 1024.);  // bytes
+#else
+  return static_cast<Double_t>(usage.ru_maxrss) / 1024.;  // kB
+#endif
+}
+
+//-----------------------------------------------------------------------------
+static Long64_t MakeDataFile( const ReplayConfig& cfg, const char* filename,
+                              ULong64_t ntrig, ULong64_t& ntrig_written )
+{
+  // Generate the CODA file for 'cfg'. Returns its size in bytes, or a
+  // negative number on error.
+
+  Decoder::CodaEventGenerator gen(Form("replay_%s", cfg.name));
+  gen.SetCodaVersion(cfg.coda_version);
+  gen.SetBlockLevel(cfg.block_level);
+  gen.SetOccupancy(cfg.occupancy);
+  gen.SetClusterSize(cfg.cluster_size, cfg.cluster_prob);
+  gen.SetEpicsInterval(cfg.epics_interval);
+  gen.SetScalerInterval(cfg.scaler_interval);
+  gen.SetSeed(kSeed);
+  if( gen.Init(kRunTime) != 0 || gen.WriteFile(filename, ntrig) <= 0 )
+    return -1;
+  ntrig_written = gen.GetNtrig();
+
+  FileStat_t info;
+  if( gSystem->GetPathInfo(filename, info) != 0 )
+    return -1;
+  return info.fSize;
+}
+
+//-----------------------------------------------------------------------------
+static Int_t Replay( const ReplayConfig& cfg, const string& datadir,
+                     const char* datafile, const char* rootfile,
+                     Int_t verbose, ReplayResult& res )
+{
+  // Analyze 'datafile' with a new analysis context and analyzer set up
+  // for 'cfg'. Returns 0 on success.
+
+  using clock_type = chrono::steady_clock;
+
+  AnalysisContext ctx;
+  AnalysisContext::Scope scope(&ctx);
+  cfg.setup(ctx);
+
+  Int_t ret = 0;
+  {
+    THaRun run(datafile);
+    run.SetDataVersion(cfg.coda_version);
+
+    unique_ptr<THaAnalyzer> analyzer(new THaAnalyzer(&ctx));
+    string prefix = datadir + "/replay_" + cfg.name;
+    analyzer->SetCrateMapFileName(Form("replay_%s", cfg.name));
+    analyzer->SetOdefFile((prefix + "_output.def").c_str());
+    analyzer->SetCutFile((prefix + "_cuts.def").c_str());
+    analyzer->SetOutFile(rootfile);
+    analyzer->EnableOverwrite();
+    analyzer->EnableBenchmarks();
+    analyzer->EnableModuleBenchmarks();
+    analyzer->SetVerbosity(verbose);
+
+    auto start = clock_type::now();
+    if( analyzer->Init(run) != 0 )
+      ret = -1;
+    else {
+      auto init_done = clock_type::now();
+      Bool_t enabled = Podd::AllocCounter::IsEnabled();
+      Podd::AllocCounter::Enable();
+      ULong64_t nalloc = Podd::AllocCounter::GetCount();
+      ULong64_t nbytes = Podd::AllocCounter::GetBytes();
+      res.nevents = analyzer->Process(run);
+      res.nalloc = Podd::AllocCounter::GetCount() - nalloc;
+      res.nbytes = Podd::AllocCounter::GetBytes() - nbytes;
+      Podd::AllocCounter::Enable(enabled);
+      auto end = clock_type::now();
+
+      res.init_time = chrono::duration<Double_t>(init_done - start).count();
+      res.process_time = chrono::duration<Double_t>(end - init_done).count();
+      if( res.nevents <= 0 )
+        ret = -2;
+      else {
+        THaBenchmark* bench = analyzer->GetBenchmark();
+        res.stages.clear();
+        for( auto stage : kStages )
+          res.stages.emplace_back(stage, bench->GetRealTime(stage));
+        res.modules.clear();
+        for( const auto& stats : analyzer->GetModuleStats() ) {
+          if( !stats.GetModule() )
+            continue;
+          res.modules.push_back({stats.GetModule()->GetPrefixName().Data(),
+                                 stats.GetTotalTime(), stats.GetNalloc()});
+        }
+      }
+    }
+  }
+  // The analyzer does not own the modules in the context's lists
+  ctx.GetPhysics()->Delete();
+  ctx.GetApps()->Delete();
+  ctx.GetEvtHandlers()->Delete();
+
+  return ret;
+}
+
+//-----------------------------------------------------------------------------
+static void RunConfig( const ReplayConfig& cfg, const string& datadir,
+                       ULong64_t ntrig, UInt_t nrep, Int_t verbose,
+                       ConfigResult& res )
+{
+  // Generate the data file for 'cfg' and replay it 'nrep' times
+
+  res.config = &cfg;
+  TString tmpdir = gSystem->TempDirectory();
+  TString datafile = Form("%s/bench_replay_%s_%d.dat", tmpdir.Data(),
+                          cfg.name, gSystem->GetPid());
+  TString rootfile = Form("%s/bench_replay_%s_%d.root", tmpdir.Data(),
+                          cfg.name, gSystem->GetPid());
+
+  res.file_bytes = MakeDataFile(cfg, datafile, ntrig, res.ntrig);
+  if( res.file_bytes <= 0 ) {
+    res.error = "cannot generate data file";
+    gSystem->Unlink(datafile);
+    return;
+  }
+
+  ResetPeakRSS();
+  vector<ReplayResult> reps(nrep);
+  for( auto& rep : reps ) {
+    if( Replay(cfg, datadir, datafile, rootfile, verbose, rep) != 0 ) {
+      res.error = "replay failed";
+      break;
+    }
+  }
+  res.peak_rss = GetPeakRSS();
+  gSystem->Unlink(datafile);
+  gSystem->Unlink(rootfile);
+  if( !res.error.empty() )
+    return;
+
+  sort(reps.begin(), reps.end(),
+       []( const ReplayResult& a, const ReplayResult& b ) {
+         return a.process_time < b.process_time;
+       });
+  res.process_min = reps.front().process_time;
+  res.median = std::move(reps[reps.size() / 2]);
+}
+
+//-----------------------------------------------------------------------------
+static void PrintResult( const ConfigResult& res )
+{
+  // Print summary table for one configuration
+
+  const ReplayConfig& cfg = *res.config;
+  if( !res.error.empty() ) {
+    printf("%-6s FAILED: %s\n", cfg.name, res.error.c_str());
+    fflush(stdout);
+    return;
+  }
+  const ReplayResult& rep = res.median;
+  Double_t ntrig = static_cast<Double_t>(res.ntrig);
+  printf("%-6s %-36s %10.1f ev/s %8.2f MB/s %9.2f allocs/ev %8.1f MB peak"
+         " (init %.2f s)\n",
+         cfg.name, cfg.description, ntrig / rep.process_time,
+         1e-6 * static_cast<Double_t>(res.file_bytes) / rep.process_time,
+         static_cast<Double_t>(rep.nalloc) / ntrig, res.peak_rss,
+         rep.init_time);
+  for( const auto& stage : rep.stages ) {
+    if( stage.second > 0 )
+      printf("         stage  %-24s %10.1f ns/ev\n", stage.first.c_str(),
+             1e9 * stage.second / ntrig);
+  }
+  for( const auto& mod : rep.modules ) {
+    printf("         module %-24s %10.1f ns/ev %9.2f allocs/ev\n",
+           mod.name.c_str(), 1e9 * mod.time / ntrig,
+           static_cast<Double_t>(mod.nalloc) / ntrig);
+  }
+  fflush(stdout);
+}
+
+//-----------------------------------------------------------------------------
+static Int_t WriteJSON( ostream& os, const vector<ConfigResult>& results,
+                        ULong64_t ntrig, UInt_t nrep )
+{
+  // Write the results as a JSON document
+
+  os << setprecision(8);
+  os << "{" << endl << "  \"suite\": ";
+  MicroBench::WriteJSONString(os, "replay");
+  os << "," << endl << "  \"version\": ";
+  MicroBench::WriteJSONString(os, HA_VERSION);
+  os << "," << endl << "  \"gitrev\": ";
+  MicroBench::WriteJSONString(os, HA_GITREV);
+  os << "," << endl << "  \"date\": ";
+  MicroBench::WriteJSONString(os, TDatime().AsSQLString());
+  os << "," << endl << "  \"host\": ";
+  MicroBench::WriteJSONString(os, gSystem->HostName());
+  os << "," << endl
+     << "  \"ntrig\": " << ntrig << "," << endl
+     << "  \"repetitions\": " << nrep << "," << endl
+     << "  \"configs\": [";
+  const char* sep = "";
+  for( const auto& res : results ) {
+    const ReplayConfig& cfg = *res.config;
+    os << sep << endl << "    { \"name\": ";
+    MicroBench::WriteJSONString(os, cfg.name);
+    os << ", \"coda_version\": " << cfg.coda_version
+       << ", \"block_level\": " << cfg.block_level;
+    if( !res.error.empty() ) {
+      os << ", \"error\": ";
+      MicroBench::WriteJSONString(os, res.error);
+    } else {
+      const ReplayResult& rep = res.median;
+      Double_t n = static_cast<Double_t>(res.ntrig);
+      os << "," << endl
+         << "      \"ntrig\": " << res.ntrig
+         << ", \"nevents\": " << rep.nevents
+         << ", \"file_bytes\": " << res.file_bytes << "," << endl
+         << "      \"init_sec\": " << rep.init_time
+         << ", \"process_sec\": " << rep.process_time
+         << ", \"process_sec_min\": " << res.process_min << "," << endl
+         << "      \"events_per_sec\": " << n / rep.process_time
+         << ", \"mb_per_sec\": "
+         << 1e-6 * static_cast<Double_t>(res.file_bytes) / rep.process_time
+         << "," << endl
+         << "      \"allocs_per_event\": " << static_cast<Double_t>(rep.nalloc) / n
+         << ", \"bytes_per_event\": " << static_cast<Double_t>(rep.nbytes) / n
+         << ", \"peak_rss_mb\": " << res.peak_rss << "," << endl
+         << "      \"stages\": {";
+      const char* ssep = " ";
+      for( const auto& stage : rep.stages ) {
+        os << ssep;
+        MicroBench::WriteJSONString(os, stage.first);
+        os << ": " << stage.second;
+        ssep = ", ";
+      }
+      os << " }," << endl << "      \"modules\": [";
+      const char* msep = "";
+      for( const auto& mod : rep.modules ) {
+        os << msep << endl << "        { \"name\": ";
+        MicroBench::WriteJSONString(os, mod.name);
+        os << ", \"ns_per_event\": " << 1e9 * mod.time / n
+           << ", \"allocs_per_event\": " << static_cast<Double_t>(mod.nalloc) / n
+           << " }";
+        msep = ",";
+      }
+      os << " ]";
+    }
+    os << " }";
+    sep = ",";
+  }
+  os << endl << "  ]" << endl << "}" << endl;
+  return os.good() ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+static void Usage( const char* prgname )
+{
+  // Print usage message and exit with error code
+
+  cerr << "Usage: " << prgname << " [options]" << endl
+       << " -c STRING   run only configurations whose name contains STRING"
+       << endl
+       << " -n N        triggers per replay (default 20000)" << endl
+       << " -r N        number of replays per configuration (default 3)"
+       << endl
+       << " -o FILE     write JSON report to FILE (\"-\" = stdout)" << endl
+       << " -d DIR      benchmark input directory (default "
+       << PODD_BENCH_DATADIR << ")" << endl
+       << " -v LEVEL    analyzer verbosity (default 0)" << endl
+       << " -l          list configurations and exit" << endl
+       << " -h          print this help" << endl;
+  exit(255);
+}
+
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  char* argv0 = strdup(argv[0]);
+  string prgname = basename(argv0);
+  free(argv0);
+
+  string filter, outfile, datadir = PODD_BENCH_DATADIR;
+  ULong64_t ntrig = 20000;
+  UInt_t nrep = 3;
+  Int_t verbose = 0;
+  Bool_t list_only = false;
+
+  int opt;
+  while( (opt = getopt(argc, argv, "hc:n:r:o:d:v:l")) != -1 ) {
+    switch( opt ) {
+    case 'c':
+      filter = optarg;
+      break;
+    case 'n':
+      ntrig = strtoull(optarg, nullptr, 10);
+      if( ntrig == 0 ) {
+        cerr << "Invalid number of triggers: " << optarg << endl;
+        Usage(prgname.c_str());
+      }
+      break;
+    case 'r':
+      nrep = strtoul(optarg, nullptr, 10);
+      if( nrep == 0 ) {
+        cerr << "Invalid number of replays: " << optarg << endl;
+        Usage(prgname.c_str());
+      }
+      break;
+    case 'o':
+      outfile = optarg;
+      break;
+    case 'd':
+      datadir = optarg;
+      break;
+    case 'v':
+      verbose = atoi(optarg);
+      break;
+    case 'l':
+      list_only = true;
+      break;
+    case 'h':
+    default:
+      Usage(prgname.c_str());
+    }
+  }
+  if( optind < argc ) {
+    cerr << "Unexpected argument: " << argv[optind] << endl;
+    Usage(prgname.c_str());
+  }
+
+  string dbdir = datadir + "/DB";
+  if( gSystem->AccessPathName(dbdir.c_str()) ) {
+    cerr << "Cannot find benchmark database " << dbdir << endl;
+    return 1;
+  }
+  gSystem->Setenv("DB_DIR", dbdir.c_str());
+
+  vector<ConfigResult> results;
+  for( const auto& cfg : kConfigs ) {
+    if( !filter.empty() && !strstr(cfg.name, filter.c_str()) )
+      continue;
+    if( list_only ) {
+      cout << cfg.name << "  " << cfg.description << endl;
+      continue;
+    }
+    ConfigResult res{};
+    RunConfig(cfg, datadir, ntrig, nrep, verbose, res);
+    PrintResult(res);
+    results.push_back(std::move(res));
+  }
+  if( list_only )
+    return 0;
+
+  Int_t ret = 0;
+  if( outfile == "-" )
+    ret = WriteJSON(cout, results, ntrig, nrep);
+  else if( !outfile.empty() ) {
+    ofstream ofs(outfile);
+    if( !ofs ) {
+      cerr << "Cannot open output file " << outfile << endl;
+      return 1;
+    }
+    ret = WriteJSON(ofs, results, ntrig, nrep);
+  }
+  for( const auto& res : results ) {
+    if( !res.error.empty() )
+      ret = 1;
+  }
+  return ret;
+}
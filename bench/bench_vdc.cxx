@@ -0,0 +1,245 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// bench_vdc
+//
+// Micro-benchmarks of the VDC tracking chain: hit decoding, cluster
+// finding, cluster fitting, coarse tracking and the target
+// reconstruction matrix.
+//
+// The VDC is set up in a right-arm HRS with the database in
+// bench/DB/DEFAULT. Events are synthetic: each holds one track, which
+// fires five consecutive wires in each plane with drift times that
+// follow the track, plus random noise hits. Events are fed to the
+// detector through Podd::HitCacheDecoder, so no raw data decoding
+// enters the measurements. One iteration processes the complete event
+// sample. Steps preceding the measured one are excluded from the timing.
+//
+// Usage: bench_vdc [options], see MicroBench
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "MicroBench.h"
+#include "AnalysisContext.h"
+#include "HitCache.h"
+#include "HitCacheDecoder.h"
+#include "THaHRS.h"
+#include "THaVDC.h"
+#include "THaVDCChamber.h"
+#include "THaVDCPlane.h"
+#include "THaVDCWire.h"
+#include "THaDetMap.h"
+#include "THaTrack.h"
+#include "Decoder.h"
+#include "TClonesArray.h"
+#include "TDatime.h"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace std;
+using Podd::MicroBench;
+using Podd::HitCacheEvent;
+
+static const ULong64_t kRunTime  = 1577836800;  // 2020-01-01 00:00:00 UTC
+static const UInt_t    kNevents  = 200;         // Events per sample
+static const UInt_t    kNtracks  = 1000;        // Tracks for CalcTargetCoords
+static const Int_t     kClustHalf = 2;          // Track cluster: 2*2+1 wires
+static const Double_t  kDistStep = 3.0e-3;      // Drift distance step per wire (m)
+static const Double_t  kNoise    = 0.01;        // Noise hit probability per wire
+
+using EventList_t = vector<unique_ptr<HitCacheEvent>>;
+
+//-----------------------------------------------------------------------------
+static Bool_t WireToChannel( const THaVDCPlane* plane, Int_t wire,
+                             UInt_t& slotidx, UInt_t& chan )
+{
+  // Find the TDC channel of 'wire' in the detector map of 'plane'
+
+  const THaDetMap* detmap = plane->GetDetMap();
+  for( UInt_t i = 0; i < detmap->GetSize(); ++i ) {
+    const THaDetMap::Module* d = detmap->GetModule(i);
+    if( wire >= static_cast<Int_t>(d->first) &&
+        wire <= static_cast<Int_t>(d->first + d->hi - d->lo) ) {
+      slotidx = d->crate * Decoder::MAXSLOT + d->slot;
+      chan = d->lo + wire - d->first;
+      return true;
+    }
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+static void MakeEvents( const vector<THaVDCPlane*>& planes, EventList_t& events )
+{
+  // Generate the event sample
+
+  mt19937 rng(4357);
+  uniform_real_distribution<> uniform;
+
+  events.clear();
+  for( UInt_t iev = 0; iev < kNevents; ++iev ) {
+    // Raw TDC values by slot and channel
+    map<UInt_t, map<UInt_t, vector<UInt_t>>> hits;
+    for( auto* plane : planes ) {
+      Int_t nwires = plane->GetNWires();
+      Double_t tdcres = plane->GetTDCRes(), driftvel = plane->GetDriftVel();
+      UInt_t slotidx = 0, chan = 0;
+
+      // Track
+      Int_t pivot = 10 + static_cast<Int_t>(uniform(rng) * (nwires - 20));
+      Double_t frac = uniform(rng);
+      for( Int_t i = -kClustHalf; i <= kClustHalf; ++i ) {
+        Int_t wire = pivot + i;
+        if( !WireToChannel(plane, wire, slotidx, chan) )
+          continue;
+        Double_t dist = fabs(i - frac) * kDistStep;
+        Double_t toff = plane->GetWire(wire)->GetTOffset();
+        hits[slotidx][chan].push_back(
+          static_cast<UInt_t>(toff - dist / driftvel / tdcres));
+      }
+      // Noise
+      for( Int_t wire = 0; wire < nwires; ++wire ) {
+        if( uniform(rng) >= kNoise || !WireToChannel(plane, wire, slotidx, chan) )
+          continue;
+        Double_t tmin = plane->GetMinTime(), tmax = plane->GetMaxTime();
+        hits[slotidx][chan].push_back(
+          static_cast<UInt_t>(tmin + uniform(rng) * (tmax - tmin)));
+      }
+    }
+
+    unique_ptr<HitCacheEvent> ev(new HitCacheEvent);
+    ev->hdr.evtype   = 1;
+    ev->hdr.evnum    = iev + 1;
+    ev->hdr.evlen    = 0;
+    ev->hdr.trigbits = 1U << 1;
+    ev->hdr.evtime   = 1000 * iev;
+    for( const auto& slot : hits ) {
+      UInt_t nhit = 0;
+      for( const auto& chan : slot.second ) {
+        for( auto raw : chan.second ) {
+          ev->chan.push_back(chan.first);
+          ev->data.push_back(raw);
+          ev->raw.push_back(raw);
+          ++nhit;
+        }
+      }
+      ev->slot.push_back(slot.first);
+      ev->nhit.push_back(nhit);
+    }
+    events.push_back(std::move(ev));
+  }
+}
+
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  MicroBench bench("vdc");
+  if( bench.ParseArgs(argc, argv) != 0 )
+    return 1;
+
+  const char* const names[] = {
+    "THaVDC::Decode", "THaVDCPlane::FindClusters", "THaVDCPlane::FitTracks",
+    "THaVDC::CoarseTrack", "THaVDC::CalcTargetCoords"
+  };
+
+  // Keep the global variables of this test out of the global lists
+  Podd::AnalysisContext context;
+  Podd::AnalysisContext::Scope scope(&context);
+
+  THaHRS hrs("R", "Right HRS");
+  hrs.AutoStandardDetectors(false);
+  auto* vdc = new THaVDC("vdc", "Vertical Drift Chamber");
+  hrs.AddDetector(vdc);
+  TDatime run_date(static_cast<UInt_t>(kRunTime), kFALSE);
+  if( hrs.Init(run_date) != THaAnalysisObject::kOK ) {
+    for( auto name : names )
+      bench.Fail(name, "cannot initialize VDC");
+    return bench.Finish();
+  }
+  Podd::HitCacheDecoder evdata;
+  evdata.SetCrateMapName("bench_vdc");
+  evdata.SetRunTime(kRunTime);
+
+  vector<THaVDCPlane*> planes = {
+    vdc->GetLower()->GetUPlane(), vdc->GetLower()->GetVPlane(),
+    vdc->GetUpper()->GetUPlane(), vdc->GetUpper()->GetVPlane()
+  };
+  EventList_t events;
+  MakeEvents(planes, events);
+  TClonesArray tracks("THaTrack", 10);
+
+  // Load event 'ev' into the VDC, up to and including step 'nsteps'
+  // (1: decode, 2: time correction, 3: cluster finding)
+  auto prepare = [&]( const HitCacheEvent& ev, Int_t nsteps ) {
+    tracks.Clear("C");
+    vdc->Clear();
+    evdata.LoadEvent(reinterpret_cast<const UInt_t*>(&ev));
+    if( nsteps < 1 )
+      return;
+    vdc->Decode(evdata);
+    for( auto* plane : planes ) {
+      if( nsteps >= 2 )
+        plane->ApplyTimeCorrection();
+      if( nsteps >= 3 )
+        plane->FindClusters();
+    }
+  };
+
+  bench.Run("THaVDC::Decode", [&]( MicroBench::State& st ) {
+    for( const auto& ev : events ) {
+      st.PauseTiming();
+      prepare(*ev, 0);
+      st.ResumeTiming();
+      vdc->Decode(evdata);
+    }
+  }, kNevents);
+
+  bench.Run("THaVDCPlane::FindClusters", [&]( MicroBench::State& st ) {
+    for( const auto& ev : events ) {
+      st.PauseTiming();
+      prepare(*ev, 2);
+      st.ResumeTiming();
+      for( auto* plane : planes )
+        plane->FindClusters();
+    }
+  }, kNevents);
+
+  bench.Run("THaVDCPlane::FitTracks", [&]( MicroBench::State& st ) {
+    for( const auto& ev : events ) {
+      st.PauseTiming();
+      prepare(*ev, 3);
+      st.ResumeTiming();
+      for( auto* plane : planes )
+        plane->FitTracks();
+    }
+  }, kNevents);
+
+  bench.Run("THaVDC::CoarseTrack", [&]( MicroBench::State& st ) {
+    for( const auto& ev : events ) {
+      st.PauseTiming();
+      prepare(*ev, 1);
+      st.ResumeTiming();
+      vdc->CoarseTrack(tracks);
+    }
+  }, kNevents);
+
+  // Target reconstruction of fixed focal-plane tracks. FindVertices
+  // calls CalcTargetCoords for each track.
+  tracks.Clear("C");
+  mt19937 rng(4357);
+  uniform_real_distribution<> uniform(-1.0, 1.0);
+  for( UInt_t i = 0; i < kNtracks; ++i ) {
+    Double_t x = 0.5 * uniform(rng), y = 0.03 * uniform(rng);
+    Double_t th = 0.03 * uniform(rng), ph = 0.03 * uniform(rng);
+    auto* track = new( tracks[static_cast<Int_t>(i)] ) THaTrack(x, y, th, ph, vdc);
+    track->SetR(x, y, th, ph);
+  }
+  bench.Run("THaVDC::CalcTargetCoords", [&]( MicroBench::State& ) {
+    vdc->FindVertices(tracks);
+  }, kNtracks);
+  tracks.Clear("C");
+
+  return bench.Finish();
+}
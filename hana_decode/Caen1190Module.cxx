@@ -14,6 +14,7 @@
 #include <iostream>
 #include <sstream>
 #include <cassert>
+#include <algorithm>
 
 using namespace std;
 
@@ -74,12 +75,67 @@ UInt_t Caen1190Module::LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer,
   const auto* p = evbuffer + pos;
   const auto* const q = p + len;
   while( p != q ) {
+    // Runs of measurement words for this slot are decoded in bulk.
+    // All other words go through Decode().
+    if( (*p >> 27) == kTDCData && tdc_data.glb_hdr_slno == fSlot
+#ifdef WITH_DEBUG
+        && !fDebugFile
+#endif
+      ) {
+      const auto* r = p + 1;
+      while( r != q && (*r >> 27) == kTDCData )
+        ++r;
+      if( !DecodeDataWords(p, r) )
+        break;  // slot data error
+      continue;
+    }
     if( Decode(p++) != 0 )
       break;  // global trailer found
   }
   return fWordsSeen = p - (evbuffer + pos);
 }
 
+//_____________________________________________________________________________
+Bool_t Caen1190Module::DecodeDataWords( const UInt_t*& p, const UInt_t* r )
+{
+  // Decode the measurement words in [p,r) for the current slot. Equivalent
+  // to calling Decode() for each word, but the fields of each chunk of
+  // words are extracted in one simple loop and the hits are stored with
+  // a single call to THaSlotData::loadData. Advances 'p' past the last
+  // word decoded. Returns false if a hit could not be stored in the slot
+  // data. Decoding then stops after the offending word, like Decode().
+
+  const UInt_t kChunk = 128;
+  UInt_t chan[kChunk], raw[kChunk], opt[kChunk];
+  while( p != r ) {
+    auto n = static_cast<UInt_t>(min<size_t>(r - p, kChunk));
+    for( UInt_t i = 0; i < n; ++i ) {
+      UInt_t w = p[i];
+      chan[i] = (w >> 19) & 0x7f;   // bits 25-19
+      raw[i]  = w & 0x0007ffff;     // bits 18-0
+      opt[i]  = (w >> 26) & 1;      // bit 26
+    }
+    UInt_t nok = fSlotData->loadData("tdc", chan, raw, opt, n);
+    // As in Decode(), the hit at which loading stopped is still recorded
+    UInt_t ndone = min(nok + 1, n);
+    for( UInt_t i = 0; i < ndone; ++i ) {
+      if( chan[i] < NTDCCHAN && fNumHits[chan[i]] < MAXHIT ) {
+        UInt_t idx = chan[i] * MAXHIT + fNumHits[chan[i]]++;
+        fTdcData[idx] = raw[i];
+        fTdcOpt[idx] = opt[i];
+      }
+    }
+    tdc_data.chan = chan[ndone-1];
+    tdc_data.raw = raw[ndone-1];
+    tdc_data.opt = opt[ndone-1];
+    tdc_data.status = (nok < n) ? SD_WARN : SD_OK;
+    p += ndone;
+    if( nok < n )
+      return false;
+  }
+  return true;
+}
+
 //_____________________________________________________________________________
 Int_t Caen1190Module::Decode( const UInt_t* p )
 {
@@ -319,6 +375,8 @@ UInt_t Caen1190Module::LoadBank( THaSlotData* sldat, const UInt_t* evbuffer,
     fEvBuf = evbuffer;
     // Multi-block: decode first event, using event positions from evtblk[]
     index_buffer = 0;
+    if( fBatchMode )
+      DecodeBatch(sldat);
     return LoadNextEvBuffer(sldat);
 
   } else {
@@ -330,37 +388,85 @@ UInt_t Caen1190Module::LoadBank( THaSlotData* sldat, const UInt_t* evbuffer,
 }
 
 //_____________________________________________________________________________
-UInt_t Caen1190Module::LoadNextEvBuffer( THaSlotData* sldat )
+UInt_t Caen1190Module::LoadBlockEvent( THaSlotData* sldat, UInt_t iev )
 {
-  // In multi-block mode, load the next event from the current block.
-  // Returns number of words consumed
+  // Decode event 'iev' of the current block, directly from the event buffer
 
-  UInt_t ii = index_buffer;
-  assert( ii+1 < evtblk.size() );
+  assert( iev+1 < evtblk.size() );
 
   // ibeg = event header, iend = one past last word of this event ( = next
   // event header if more events pending)
-  auto ibeg = evtblk[ii], iend = evtblk[ii+1];
+  auto ibeg = evtblk[iev], iend = evtblk[iev+1];
   assert(ibeg > 0 && iend > ibeg);  // else bug in LoadBank
 
   assert(fEvBuf);  // We should never get here without a prior call to LoadBank
   // or after fBlockIsDone is set
 
   // Load slot starting with event header at ibeg
-  ii = LoadSlot(sldat, fEvBuf, ibeg, iend-ibeg);
+  return LoadSlot(sldat, fEvBuf, ibeg, iend-ibeg);
+}
 
-  // Next cached buffer. Set flag if we've exhausted the cache.
-  ++index_buffer;
-  if( index_buffer+1 >= evtblk.size() ) {
-    fBlockIsDone = true;
-    fEvBuf = nullptr;
-  }
+//_____________________________________________________________________________
+UInt_t Caen1190Module::LoadNextEvBuffer( THaSlotData* sldat )
+{
+  // In multi-block mode, load the next event from the current block.
+  // Returns number of words consumed
+
+  UInt_t ii = PipeliningModule::LoadNextEvBuffer(sldat);
 
-  if( fBlockIsDone )
+  if( fBlockIsDone ) {
+    fEvBuf = nullptr;
     ii += fNfill; // filler words
+  }
   return ii;
 }
 
+//_____________________________________________________________________________
+void Caen1190Module::BeginBatchEvent()
+{
+  // Batch mode: reset the hit arrays before decoding the next event
+
+  fNumHits.assign(NTDCCHAN, 0);
+}
+
+//_____________________________________________________________________________
+void Caen1190Module::SaveBatchEvent( UInt_t iev )
+{
+  // Batch mode: append the hits of the event just decoded
+
+  if( iev == 0 ) {
+    fBatchHitIdx.clear();
+    fBatchTdc.clear();
+    fBatchOpt.clear();
+    fBatchEvOff.assign(1, 0);
+  }
+  assert( fBatchEvOff.size() == iev+1 );
+  for( UInt_t chan = 0; chan < NTDCCHAN; ++chan ) {
+    for( UInt_t hit = 0; hit < fNumHits[chan]; ++hit ) {
+      UInt_t idx = chan * MAXHIT + hit;
+      fBatchHitIdx.push_back(idx);
+      fBatchTdc.push_back(fTdcData[idx]);
+      fBatchOpt.push_back(fTdcOpt[idx]);
+    }
+  }
+  fBatchEvOff.push_back(fBatchHitIdx.size());
+}
+
+//_____________________________________________________________________________
+void Caen1190Module::LoadBatchEvent( UInt_t iev )
+{
+  // Batch mode: make the saved hits of event 'iev' current
+
+  assert( iev+1 < fBatchEvOff.size() );
+  fNumHits.assign(NTDCCHAN, 0);
+  for( UInt_t i = fBatchEvOff[iev]; i < fBatchEvOff[iev+1]; ++i ) {
+    UInt_t idx = fBatchHitIdx[i];
+    fTdcData[idx] = fBatchTdc[i];
+    fTdcOpt[idx] = fBatchOpt[i];
+    ++fNumHits[idx / MAXHIT];
+  }
+}
+
 //_____________________________________________________________________________
 string Caen1190Module::Here( const char* function )
 {
@@ -24,7 +24,7 @@ public:
   virtual ~Caen1190Module() = default;
 
   using VmeModule::GetData;
-  using VmeModule::Init;
+  using PipeliningModule::Init;
 
   virtual void Init();
   virtual void Clear( Option_t* opt = "" );
@@ -44,7 +44,12 @@ public:
 
 private:
   virtual UInt_t LoadNextEvBuffer( THaSlotData* sldat );
+  virtual UInt_t LoadBlockEvent( THaSlotData* sldat, UInt_t iev );
+  virtual void   BeginBatchEvent();
+  virtual void   SaveBatchEvent( UInt_t iev );
+  virtual void   LoadBatchEvent( UInt_t iev );
   std::string Here( const char* function );
+  Bool_t DecodeDataWords( const UInt_t*& p, const UInt_t* r );
 
   enum EDataType {
     kTDCData = 0, kTDCHeader = 1, kTDCTrailer = 3, kTDCError = 4,
@@ -61,6 +66,12 @@ private:
   const UInt_t* fEvBuf;    // Pointer to current event buffer (for multi-block)
   UInt_t        fNfill;    // Number of filler words at end of current bank
 
+  // Hits of all events of the current block in batch mode
+  std::vector<UInt_t> fBatchHitIdx; // Index into fTdcData of each hit
+  std::vector<UInt_t> fBatchTdc;    // Raw data of each hit
+  std::vector<UInt_t> fBatchOpt;    // Edge flag of each hit
+  std::vector<UInt_t> fBatchEvOff;  // [iev] Index of first hit of event iev
+
   class tdcData {
   public:
     tdcData()
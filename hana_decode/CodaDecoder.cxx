@@ -13,8 +13,10 @@
 #include "THaUsrstrutils.h"
 #include "DAQconfig.h"
 #include "Helper.h"
+#include "PipeliningModule.h"
 #include "TError.h"
 #include "TList.h"
+#include "TROOT.h"
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
@@ -22,6 +24,12 @@
 #include <cstring>
 #include <sstream>
 #include <iomanip>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <system_error>
+#include <thread>
 
 using namespace std;
 
@@ -29,6 +37,147 @@ namespace Decoder {
 
 static constexpr auto MAXROCSLOT_FB = MAXROC * MAXSLOT_FB;
 
+//_____________________________________________________________________________
+// Parallel decoding of event blocks.
+//
+// The banks of all slots of a multiblock event are collected by
+// bank_decode and then loaded concurrently by a pool of worker threads.
+// Each slot has its own module and THaSlotData, so different slots can be
+// decoded independently. Pipelining modules load the block in batch mode,
+// so they decode all events of the block while their bank is loaded. The
+// following events of the block are then served from the modules'
+// per-event hit arrays by LoadFromMultiBlock, in order, as before. Batch
+// mode applies to that block only and leaves the module configuration
+// unchanged. Modules with batch mode disabled in the crate map
+// ("batch=0") are loaded sequentially by bank_decode.
+struct CodaDecoder::ParallelBlock {
+  explicit ParallelBlock( UInt_t nthreads );
+  ~ParallelBlock();
+
+  struct Task {
+    Task( THaSlotData* sd, PipeliningModule* mod, UInt_t pos, UInt_t len )
+      : sd(sd), mod(mod), pos(pos), len(len) {}
+    THaSlotData* sd;
+    PipeliningModule* mod;   // Module to load in batch mode, if any
+    UInt_t       pos, len;   // Bank data position and length
+    string       error;      // Message of exception thrown, if any
+  };
+
+  void Run( const UInt_t* evbuffer );
+  void Work();
+  void Drain();
+
+  UInt_t          nthreads;  // Number of threads including the caller
+  Bool_t          active;    // Collect banks of the current event
+  vector<Task>    tasks;
+  const UInt_t*   evbuf;     // Event buffer of the current block
+  atomic<size_t>  next;      // Next task to run
+  vector<thread>  threads;   // Workers in addition to the calling thread
+  mutex           mtx;
+  condition_variable cv_work, cv_done;
+  ULong64_t       generation;  // Number of Run() calls
+  UInt_t          nbusy;     // Workers still working on current generation
+  Bool_t          stop;
+  set<UInt_t>     sequential;  // Slots reported as loaded sequentially
+};
+
+//_____________________________________________________________________________
+CodaDecoder::ParallelBlock::ParallelBlock( UInt_t nthreads )
+  : nthreads(max(nthreads, 1U)), active(false), evbuf(nullptr), next(0),
+    generation(0), nbusy(0), stop(false)
+{
+  if( this->nthreads > 1 )
+    ROOT::EnableThreadSafety();
+  // The calling thread is one of the workers, so decoding proceeds even
+  // if no threads can be started
+  try {
+    for( UInt_t i = 1; i < this->nthreads; ++i )
+      threads.emplace_back(&ParallelBlock::Work, this);
+  }
+  catch( const system_error& e ) {
+    ::Warning("CodaDecoder::ParallelBlock", "Cannot start thread: %s. "
+            "Continuing with %lu threads.", e.what(),
+            static_cast<unsigned long>(threads.size()+1));
+  }
+}
+
+//_____________________________________________________________________________
+CodaDecoder::ParallelBlock::~ParallelBlock()
+{
+  {
+    lock_guard<mutex> lock(mtx);
+    stop = true;
+  }
+  cv_work.notify_all();
+  for( auto& t : threads )
+    t.join();
+}
+
+//_____________________________________________________________________________
+void CodaDecoder::ParallelBlock::Drain()
+{
+  // Run tasks until none are left
+
+  size_t i;
+  while( (i = next++) < tasks.size() ) {
+    auto& task = tasks[i];
+    try {
+      if( task.mod )
+        task.mod->LoadBankBatch(task.sd, evbuf, task.pos, task.len);
+      else
+        task.sd->LoadBank(evbuf, task.pos, task.len);
+    }
+    catch( const exception& e ) {
+      task.error = e.what();
+    }
+  }
+}
+
+//_____________________________________________________________________________
+void CodaDecoder::ParallelBlock::Work()
+{
+  // Worker thread: run the tasks of each generation
+
+  ULong64_t seen = 0;
+  while( true ) {
+    {
+      unique_lock<mutex> lock(mtx);
+      cv_work.wait(lock, [&]{ return stop || generation != seen; });
+      if( stop )
+        return;
+      seen = generation;
+    }
+    Drain();
+    {
+      lock_guard<mutex> lock(mtx);
+      if( --nbusy == 0 )
+        cv_done.notify_one();
+    }
+  }
+}
+
+//_____________________________________________________________________________
+void CodaDecoder::ParallelBlock::Run( const UInt_t* evbuffer )
+{
+  // Load all collected banks of 'evbuffer'. Returns when all are done.
+
+  evbuf = evbuffer;
+  next = 0;
+  if( threads.empty() || tasks.size() <= 1 ) {
+    Drain();
+    return;
+  }
+  {
+    lock_guard<mutex> lock(mtx);
+    ++generation;
+    nbusy = threads.size();
+  }
+  cv_work.notify_all();
+  Drain();
+  unique_lock<mutex> lock(mtx);
+  cv_done.wait(lock, [&]{ return nbusy == 0; });
+}
+
 //_____________________________________________________________________________
 CodaDecoder::CodaDecoder()
   : nroc(0)
@@ -117,6 +266,10 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
     return HED_FATAL;
   }
 
+  ResetBit(kHeaderChecked);
+  ResetBit(kHeaderRejected);
+  ClearDeferred();
+
   if( DataCached() ) {
     if( evbuffer[0]+1 != event_length ) {
       throw std::logic_error("Event buffer changed while processing multiblock "
@@ -198,6 +351,14 @@ Int_t CodaDecoder::LoadEvent( const UInt_t* evbuffer )
         (ret = trigBankDecode(evbuffer)) != HED_OK ) {
       return ret;
     }
+    // Header-only event selection. Skip decoding if rejected. Multiblock
+    // data must always be decoded because the whole block is unpacked
+    // with its first event.
+    if( HeaderFilterEnabled() && block_size <= 1 && !fMultiBlockMode ) {
+      event_num = (fDataVersion == 3) ? tbank.evtNum : evbuffer[4];
+      if( !TestHeader() )
+        return HED_OK;
+    }
     ret = physics_decode(evbuffer);
   }
 
@@ -232,60 +393,42 @@ Int_t CodaDecoder::physics_decode( const UInt_t* evbuffer )
     CompareRocs();
   }
 
-  // Decode each ROC
+  // Decode each ROC, or defer decoding until first access if lazy
+  // decoding is enabled. Multiblock data are always decoded right away.
   // From this point onwards there is no diff between CODA 2.* and CODA 3.*
 
-  for( UInt_t i = 0; i < nroc; i++ ) {
+  bool lazy = LazyDecodingEnabled() && block_size <= 1 && !fMultiBlockMode;
 
-    UInt_t iroc = irn[i];
-    const RocDat_t& ROC = rocdat[iroc];
-    UInt_t ipt = ROC.pos + 1;
-    UInt_t iptmax = ROC.pos + ROC.len; // last word of data
-
-    if( fMap->isFastBus(iroc) ) {  // checking that slots found = expected
-      if( GetEvNum() > 200 && chkfbstat < 3 ) chkfbstat = 2;
-      if( chkfbstat == 1 ) ChkFbSlot(iroc, evbuffer, ipt, iptmax);
-      if( chkfbstat == 2 ) {
-        ChkFbSlots();
-        chkfbstat = 3;
-      }
-    }
-
-    // If at least one module is in a bank, must split the banks for this roc
+  // With more than one decode thread, the banks of CODA3 event blocks are
+  // loaded in parallel after all ROCs have been scanned
+  bool parallel = GetDecodeThreads() > 1 && fDataVersion == 3 && block_size > 1;
+  if( parallel ) {
+    if( !fParallel || fParallel->nthreads != GetDecodeThreads() )
+      fParallel.reset(new ParallelBlock(GetDecodeThreads()));
+    fParallel->tasks.clear();
+    fParallel->active = true;
+  } else if( fParallel )
+    fParallel->active = false;
 
-    Int_t status;
-    if( fMap->isBankStructure(iroc) ) {
-      if( fDebugFile )
-        *fDebugFile << "\nCodaDecode::Calling bank_decode "
-                    << iroc << "  " << ipt << "  " << iptmax
-                    << endl;
-      try {
-        status = bank_decode(iroc, evbuffer, ipt, iptmax);
-      }
-      catch( const logic_error& e ) {
-        Error("CodaDecoder::bank_decode", "ERROR: %s", e.what());
-        return HED_ERR;
-      }
-      if( status != HED_OK )
-        return status;
-    }
-
-    if( !fMap->isAllBanks(iroc) ) {
-      if( fDebugFile )
-        *fDebugFile << "\nCodaDecode::Calling roc_decode "
-                    << iroc << "  " << ipt << "  " << iptmax
-                    << endl;
+  for( UInt_t i = 0; i < nroc; i++ ) {
 
-      try {
-        status = roc_decode(iroc, evbuffer, ipt, iptmax);
-      }
-      catch( const logic_error& e ) {
-        Error("CodaDecoder::roc_decode", "ERROR: %s", e.what());
-        return HED_ERR;
-      }
-      if( status != HED_OK )
-        return status;
+    UInt_t iroc = irn[i];
+    CountPresent(iroc);
+    // Skip the whole bank of crates not used by the analysis
+    if( !IsCrateSelected(iroc) )
+      continue;
+    if( lazy ) {
+      DeferCrate(iroc);
+      continue;
     }
+    Int_t status = DecodeRocData(iroc, evbuffer);
+    if( status != HED_OK )
+      return status;
+  }
+  if( parallel ) {
+    Int_t status = DecodeBlockParallel(evbuffer);
+    if( status != HED_OK )
+      return status;
   }
   // Print summary of discovered banks
   constexpr UInt_t bankinfo_bit = 65;
@@ -300,6 +443,105 @@ Int_t CodaDecoder::physics_decode( const UInt_t* evbuffer )
   return HED_OK;
 }
 
+//_____________________________________________________________________________
+Int_t CodaDecoder::DecodeRocData( UInt_t iroc, const UInt_t* evbuffer )
+{
+  // Decode the data of ROC 'iroc' in the current event
+
+  const RocDat_t& ROC = rocdat[iroc];
+  UInt_t ipt = ROC.pos + 1;
+  UInt_t iptmax = ROC.pos + ROC.len; // last word of data
+
+  if( fMap->isFastBus(iroc) ) {  // checking that slots found = expected
+    if( GetEvNum() > 200 && chkfbstat < 3 ) chkfbstat = 2;
+    if( chkfbstat == 1 ) ChkFbSlot(iroc, evbuffer, ipt, iptmax);
+    if( chkfbstat == 2 ) {
+      ChkFbSlots();
+      chkfbstat = 3;
+    }
+  }
+
+  // If at least one module is in a bank, must split the banks for this roc
+
+  Int_t status;
+  if( fMap->isBankStructure(iroc) ) {
+    if( fDebugFile )
+      *fDebugFile << "\nCodaDecode::Calling bank_decode "
+                  << iroc << "  " << ipt << "  " << iptmax
+                  << endl;
+    try {
+      status = bank_decode(iroc, evbuffer, ipt, iptmax);
+    }
+    catch( const logic_error& e ) {
+      Error("CodaDecoder::bank_decode", "ERROR: %s", e.what());
+      return HED_ERR;
+    }
+    if( status != HED_OK )
+      return status;
+  }
+
+  if( !fMap->isAllBanks(iroc) ) {
+    if( fDebugFile )
+      *fDebugFile << "\nCodaDecode::Calling roc_decode "
+                  << iroc << "  " << ipt << "  " << iptmax
+                  << endl;
+
+    try {
+      status = roc_decode(iroc, evbuffer, ipt, iptmax);
+    }
+    catch( const logic_error& e ) {
+      Error("CodaDecoder::roc_decode", "ERROR: %s", e.what());
+      return HED_ERR;
+    }
+    if( status != HED_OK )
+      return status;
+  }
+
+  for( auto slot : fMap->GetUsedSlots(iroc) )
+    CountDecoded(iroc, slot);
+
+  return HED_OK;
+}
+
+//_____________________________________________________________________________
+Int_t CodaDecoder::DecodeBlockParallel( const UInt_t* evbuffer )
+{
+  // Load the banks collected by bank_decode for the current event block,
+  // using the worker pool
+
+  assert( fParallel && fParallel->active );
+  fParallel->active = false;
+  if( fDoBench ) fBench->Begin("DecodeBlockParallel");
+  fParallel->Run(evbuffer);
+  if( fDoBench ) fBench->Stop("DecodeBlockParallel");
+
+  Int_t ret = HED_OK;
+  for( auto& task : fParallel->tasks ) {
+    if( !task.error.empty() ) {
+      Error("CodaDecoder::bank_decode", "ERROR: %s", task.error.c_str());
+      ret = HED_ERR;
+      continue;
+    }
+    if( task.sd->IsMultiBlockMode() )
+      fMultiBlockMode = true;
+    if( task.sd->BlockIsDone() )
+      fBlockIsDone = true;
+  }
+  return ret;
+}
+
+//_____________________________________________________________________________
+Int_t CodaDecoder::DecodeDeferred( UInt_t crate )
+{
+  // Lazy decoding: decode the data of 'crate' in the current event buffer
+
+  assert( buffer && crate < MAXROC && rocdat[crate].len > 0 );
+  if( fDoBench ) fBench->Begin("DecodeDeferred");
+  Int_t ret = DecodeRocData(crate, buffer);
+  if( fDoBench ) fBench->Stop("DecodeDeferred");
+  return ret;
+}
+
 //_____________________________________________________________________________
 Int_t CodaDecoder::interpretCoda3(const UInt_t* evbuffer)
 {
@@ -859,6 +1101,8 @@ Int_t CodaDecoder::LoadFromMultiBlock()
 
   for( UInt_t i = 0; i < nroc; i++ ) {
     UInt_t roc = irn[i];
+    if( !IsCrateSelected(roc) )
+      continue;
     for( auto slot : fMap->GetUsedSlots(roc) ) {
       assert(fMap->slotUsed(roc, slot));
       // Skip modules in banks if the bank is not present in the current event
@@ -947,7 +1191,9 @@ Int_t CodaDecoder::roc_decode( UInt_t roc, const UInt_t* evbuffer,
     assert(fMap->GetUsedSlots(roc).size() == Nslot); // else bug in THaCrateMap
 
     // Build the to-do list of slots based on the contents of the crate map
-    vector<pair<UInt_t,THaSlotData*>> slots_todo; slots_todo.reserve(Nslot);
+    auto& slots_todo = fSlotsTodo;
+    slots_todo.clear();
+    slots_todo.reserve(Nslot);
     for( auto slot : fMap->GetUsedSlots(roc) ) {
       assert(fMap->slotUsed(roc, slot));   // else bug in THaCrateMap
       // ignore bank structure slots; they are decoded with bank_decode
@@ -1089,6 +1335,19 @@ Int_t CodaDecoder::bank_decode( UInt_t roc, const UInt_t* evbuffer,
                   << roc << "  " << slot << "   " << bank << "  "
                   << theBank->pos << "   " << theBank->len << endl;
     auto* sd = crateslot[idx(roc, slot)].get();
+    if( fParallel && fParallel->active ) {
+      // Event block: load later, in parallel with the other slots, unless
+      // batch decoding has been disabled for this module
+      auto* mod = dynamic_cast<PipeliningModule*>(sd->GetModule());
+      if( !mod || mod->IsBatchAllowed() ) {
+        fParallel->tasks.emplace_back(sd, mod, theBank->pos, theBank->len);
+        continue;
+      }
+      if( fParallel->sequential.insert(idx(roc, slot)).second )
+        Warning("CodaDecoder::bank_decode", "Crate %u slot %u: batch "
+                "decoding disabled in crate map. Loading event blocks of "
+                "this module sequentially.", roc, slot);
+    }
     sd->LoadBank(evbuffer, theBank->pos, theBank->len);
     if( sd->IsMultiBlockMode() )
       fMultiBlockMode = true;
@@ -15,6 +15,7 @@
 #include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <memory>
 
 namespace Decoder {
 
@@ -92,6 +93,9 @@ protected:
   Int_t roc_decode( UInt_t roc, const UInt_t* evbuffer, UInt_t ipt, UInt_t istop );
   Int_t bank_decode( UInt_t roc, const UInt_t* evbuffer, UInt_t ipt, UInt_t istop );
   Int_t physics_decode( const UInt_t* evbuffer );
+  Int_t DecodeRocData( UInt_t iroc, const UInt_t* evbuffer );
+  Int_t DecodeBlockParallel( const UInt_t* evbuffer );
+  virtual Int_t DecodeDeferred( UInt_t crate );
 
   void CompareRocs();
   void ChkFbSlot( UInt_t roc, const UInt_t* evbuffer, UInt_t ipt, UInt_t istop );
@@ -129,11 +133,19 @@ protected:
   std::vector<BankDat_t> bankdat;
   BankDat_t* CheckForBank( UInt_t roc, UInt_t slot );
 
+  // Slots of the ROC being decoded by roc_decode. Kept as a member so
+  // that its memory is reused from event to event.
+  std::vector<std::pair<UInt_t,THaSlotData*>> fSlotsTodo; //!
+
   // CODA3 stuff
   UInt_t blkidx;  // Event block index (0 <= blkidx < block_size)
   Bool_t fMultiBlockMode, fBlockIsDone;
   UInt_t tsEvType, bank_tag, block_size;
 
+  // Parallel decoding of event blocks
+  struct ParallelBlock;
+  std::unique_ptr<ParallelBlock> fParallel; //! Worker pool and bank list
+
 public:
   class TBOBJ {
   public:
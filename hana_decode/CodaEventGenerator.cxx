@@ -0,0 +1,796 @@
+/////////////////////////////////////////////////////////////////////
+//
+//   Decoder::CodaEventGenerator
+//
+//   Generates synthetic CODA event streams without beam. The crates,
+//   slots, module models and bank numbers come from a crate map, so
+//   the output can be replayed with the same crate map and decoded by
+//   the standard module decoders. Supported modules:
+//
+//     250                FADC250, modes 1 (raw window), 3 (integral and
+//                        time, old firmware), 9 (pulse parameters),
+//                        10 (raw window and pulse parameters)
+//     1190               Caen 1190 TDC
+//     1875, 1877, 1881   Fastbus TDCs and ADC
+//     560, 1151, 3800,   Scalers. Modules in scaler crates are read out
+//     3801               in scaler events (type 140), otherwise in every
+//                        physics event.
+//
+//   Other models are left empty. Each channel fires with the given
+//   occupancy. Optionally, 1877 TDCs also get a cluster of adjacent hits
+//   with a given probability per event. The hit times peak in the middle
+//   of the cluster, as for a track crossing a drift chamber plane.
+//   Trigger times follow a Poisson process at the given event rate; they
+//   appear in the trigger bank (CODA 3), the module trigger time words
+//   and the scaler counts.
+//
+//   The run begins with prestart, go and prescale events (and, for
+//   CODA 3, a DAQ configuration event), followed by physics events with
+//   EPICS and scaler events at the configured intervals. For CODA 3,
+//   physics events hold blocks of up to GetBlockLevel() triggers. Only
+//   the pipelining modules (FADC250, 1190) support event blocks; other
+//   modules are left empty when the block level is larger than 1.
+//
+//   Events can be written to a CODA file with WriteFile() or used
+//   directly from memory via NextEvent(). Note that CODA files are
+//   written with the installed EVIO library, so files with CODA 2
+//   events may need SetCodaVersion(2) when replaying them.
+//
+//   Example:
+//
+//     Decoder::CodaEventGenerator gen("cratemap");
+//     gen.SetBlockLevel(10);
+//     gen.SetOccupancy(0.05);
+//     gen.Init();
+//     gen.WriteFile("synthetic.evio", 100000);
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "CodaEventGenerator.h"
+#include "Decoder.h"
+#include "THaCrateMap.h"
+#include "THaCodaFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+using namespace std;
+
+namespace Decoder {
+
+static const Double_t kClockFreq  = 250e6;   // Trigger time clock (Hz)
+static const UInt_t   kMiscBank   = 0xfff;   // Bank for modules without bank
+static const UInt_t   kFiller1190 = 24U << 27;
+
+//_____________________________________________________________________________
+CodaEventGenerator::CodaEventGenerator( const char* cratemap )
+  : fMapName(cratemap), fCodaVersion(3), fBlockLevel(1), fOccupancy(0.1),
+    fEventRate(1e3), fSeed(4357), fFadcMode(10), fFadcWindow(50),
+    fClusterSize(0), fClusterProb(1.0), fEpicsInterval(10000),
+    fScalerInterval(1000), fRunNumber(1), fRunType(0),
+    fTSROC(0), fState(kPrestart), fRunTime(0), fClock(0),
+    fNtrig(0), fNevents(0), fNextEpics(0), fNextScaler(0), fNblocks(0),
+    fIsInit(false)
+{
+  // Constructor. 'cratemap' is the database name of the crate map.
+
+  AddEpicsVariable("HALLA:p", 2200.0, 0.05, "MeV");
+  AddEpicsVariable("hac_bcm_average", 50.0, 0.5, "uA");
+  AddEpicsVariable("IPM1H04A.XPOS", 0.0, 0.05, "mm");
+  AddEpicsVariable("IPM1H04A.YPOS", 0.0, 0.05, "mm");
+  AddEpicsVariable("haBDSPOS.VAL", 1.5, 0.0);
+}
+
+//_____________________________________________________________________________
+CodaEventGenerator::~CodaEventGenerator() = default;
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddDaqConfig( const char* text )
+{
+  // Add a DAQ configuration file to the DAQ configuration event (CODA 3).
+  // Without any, a configuration describing the generator is written.
+
+  if( text )
+    fDaqConfig.emplace_back(text);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddEpicsVariable( const char* name, Double_t mean,
+                                           Double_t sigma, const char* units )
+{
+  // Add a variable to the EPICS events. Values are Gaussian distributed.
+
+  if( name && *name )
+    fEpicsVars.push_back({name, units ? units : "", mean, sigma});
+}
+
+//_____________________________________________________________________________
+Bool_t CodaEventGenerator::IsScaler( Int_t model )
+{
+  return model == 560 || model == 1151 || model == 3800 || model == 3801;
+}
+
+//_____________________________________________________________________________
+Bool_t CodaEventGenerator::IsFastbus( Int_t model )
+{
+  return model == 1875 || model == 1877 || model == 1881;
+}
+
+//_____________________________________________________________________________
+Bool_t CodaEventGenerator::IsMultiBlock( Int_t model )
+{
+  return model == 250 || model == 1190;
+}
+
+//_____________________________________________________________________________
+Bool_t CodaEventGenerator::IsSupported( Int_t model )
+{
+  return IsMultiBlock(model) || IsFastbus(model) || IsScaler(model);
+}
+
+//_____________________________________________________________________________
+Int_t CodaEventGenerator::Init( ULong64_t run_time )
+{
+  // Load the crate map and set up the generators for the modules found
+  // in it. Resets the run, i.e. the next event is the prestart event.
+
+  const char* const here = "Init";
+
+  fIsInit = false;
+  if( fCodaVersion != 2 && fCodaVersion != 3 ) {
+    Error(here, "Unsupported CODA version %d. Must be 2 or 3.", fCodaVersion);
+    return -1;
+  }
+  if( fBlockLevel == 0 || fBlockLevel > 255 ) {
+    Error(here, "Invalid block level %u. Must be between 1 and 255.",
+          fBlockLevel);
+    return -2;
+  }
+  if( fCodaVersion == 2 && fBlockLevel > 1 ) {
+    Warning(here, "CODA 2 does not support event blocks. "
+                  "Using block level 1.");
+    fBlockLevel = 1;
+  }
+  if( fOccupancy < 0 || fOccupancy > 1 || fEventRate <= 0 ) {
+    Error(here, "Invalid occupancy %g or event rate %g. Must be 0-1 and > 0.",
+          fOccupancy, fEventRate);
+    return -3;
+  }
+  if( fFadcMode != 1 && fFadcMode != 3 && fFadcMode != 9 && fFadcMode != 10 ) {
+    Error(here, "Unsupported FADC250 mode %u. Must be 1, 3, 9 or 10.",
+          fFadcMode);
+    return -4;
+  }
+  if( fFadcWindow == 0 || fFadcWindow > 0xfff ) {
+    Error(here, "Invalid FADC250 window %u samples.", fFadcWindow);
+    return -4;
+  }
+
+  fRunTime = run_time ? run_time : static_cast<ULong64_t>(time(nullptr));
+  fMap.reset(new THaCrateMap(fMapName));
+  Int_t st = fMapText.empty() ? fMap->init(fRunTime) : fMap->init(fMapText);
+  if( st != THaCrateMap::CM_OK ) {
+    Error(here, "Cannot initialize crate map \"%s\"", fMapName.Data());
+    return -5;
+  }
+  fTSROC = fMap->getTSROC();
+  fRandom.seed(fSeed);
+
+  // Module generators, by crate
+  fRocs.clear();
+  fScalerRocs.clear();
+  set<Int_t> unsupported, noblock;
+  for( auto crate : fMap->GetUsedCrates() ) {
+    RocGen roc{crate, fMap->isBankStructure(crate), fMap->isFastBus(crate), {}};
+    Bool_t scaler_crate = fMap->isScalerCrate(crate);
+    for( auto slot : fMap->GetUsedSlots(crate) ) {
+      Int_t model = fMap->getModel(crate, slot);
+      if( !IsSupported(model) ) {
+        unsupported.insert(model);
+        continue;
+      }
+      if( fBlockLevel > 1 && !IsMultiBlock(model) && !scaler_crate ) {
+        noblock.insert(model);
+        continue;
+      }
+      ModuleGen mod{crate, slot, model, fMap->getBank(crate, slot),
+                    fMap->getNchan(crate, slot), fMap->getHeader(crate, slot),
+                    0, {}, {}};
+      UInt_t maxchan = 255;  // Scaler headers have 8 bits for the count
+      switch( model ) {
+        case 250:  maxchan = 16;  break;
+        case 1190: maxchan = 128; break;
+        case 1877: maxchan = 96;  break;
+        case 1875:
+        case 1881: maxchan = 64;  break;
+        default: break;
+      }
+      if( mod.nchan == 0 || mod.nchan > maxchan )
+        mod.nchan = maxchan;
+      if( IsScaler(model) ) {
+        mod.counts.assign(mod.nchan, 0);
+        mod.rates.resize(mod.nchan);
+        for( auto& rate : mod.rates )
+          rate = pow(10.0, 2.0 + 4.0 * Uniform());  // 100 Hz - 1 MHz
+      }
+      roc.modules.push_back(std::move(mod));
+    }
+    // Fastbus crates are read out from the highest slot down
+    if( roc.fastbus )
+      reverse(roc.modules.begin(), roc.modules.end());
+    if( scaler_crate )
+      fScalerRocs.push_back(std::move(roc));
+    else
+      fRocs.push_back(std::move(roc));
+  }
+  for( auto model : unsupported )
+    Warning(here, "Modules of model %d not supported. They will be empty.",
+            model);
+  for( auto model : noblock )
+    Warning(here, "Model %d does not support event blocks. Modules of this "
+                  "model will be empty with block level %u.", model,
+            fBlockLevel);
+
+  // Reset the run
+  fBuffer.clear();
+  fState = kPrestart;
+  fClock = fNtrig = fNevents = 0;
+  fNextEpics = fEpicsInterval;
+  fNextScaler = fScalerInterval;
+  fNblocks = 0;
+  fIsInit = true;
+  return 0;
+}
+
+//_____________________________________________________________________________
+UInt_t CodaEventGenerator::Code( UInt_t evtype ) const
+{
+  // Tag of the event bank for event type 'evtype'
+
+  if( fCodaVersion == 2 )
+    return evtype;
+  switch( evtype ) {
+    case PRESTART_EVTYPE: return 0xffd1;
+    case GO_EVTYPE:       return 0xffd2;
+    case END_EVTYPE:      return 0xffd4;
+    default:
+      return (evtype <= MAX_PHYS_EVTYPE) ? 0xff50 : evtype;
+  }
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::BeginEvent( UInt_t type, UInt_t datatype, UInt_t nev )
+{
+  // Start a new event of the given type. The length is set by EndBank(0).
+
+  fBuffer.clear();
+  fBuffer.push_back(0);
+  UInt_t num = (fCodaVersion == 2) ? 0xcc : nev;
+  fBuffer.push_back(Code(type) << 16 | datatype << 8 | num);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::EndBank( size_t pos )
+{
+  // Set the length word of the bank starting at 'pos'
+
+  fBuffer[pos] = static_cast<UInt_t>(fBuffer.size() - pos - 1);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddUInt64( ULong64_t val )
+{
+  fBuffer.push_back(static_cast<UInt_t>(val));
+  fBuffer.push_back(static_cast<UInt_t>(val >> 32));
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddString( const string& text )
+{
+  // Add 'text' as a bank of 8-bit data, padded with NULs
+
+  size_t pos = fBuffer.size();
+  UInt_t nw = static_cast<UInt_t>((text.size() + 3) / 4);
+  UInt_t npad = 4 * nw - static_cast<UInt_t>(text.size());
+  fBuffer.push_back(0);
+  fBuffer.push_back(npad << 14 | 0x03U << 8);
+  fBuffer.resize(fBuffer.size() + nw, 0);
+  copy(text.begin(), text.end(),
+       reinterpret_cast<char*>(fBuffer.data() + pos + 2));
+  EndBank(pos);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::MakeControlEvent( UInt_t type, UInt_t w2, UInt_t w3,
+                                           UInt_t w4 )
+{
+  BeginEvent(type, 0x01, 0);
+  fBuffer.push_back(w2);
+  fBuffer.push_back(w3);
+  fBuffer.push_back(w4);
+  EndBank(0);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::MakeStringEvent( UInt_t type,
+                                          const vector<string>& texts )
+{
+  // Event with one bank of character data per string
+
+  BeginEvent(type, 0x10, 0);
+  for( const auto& text : texts )
+    AddString(text);
+  EndBank(0);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::MakeEpicsEvent()
+{
+  // EPICS event: time stamp line followed by one line per variable
+
+  time_t t = static_cast<time_t>(fRunTime + fClock / kClockFreq);
+  char tstamp[64];
+  strftime(tstamp, sizeof(tstamp), "%a %b %d %H:%M:%S %Y", localtime(&t));
+  ostringstream ostr;
+  ostr << tstamp << "\n";
+  for( const auto& var : fEpicsVars ) {
+    ostr << var.name << "  " << Gaus(var.mean, var.sigma);
+    if( !var.units.IsNull() )
+      ostr << "  " << var.units;
+    ostr << "\n";
+  }
+  MakeStringEvent(EPICS_EVTYPE, {ostr.str()});
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::MakeScalerEvent()
+{
+  // Scaler event: the crates flagged as scaler crates in the crate map
+
+  vector<ULong64_t> ts(1, fClock);
+  BeginEvent(SCALER_EVTYPE, 0x10, 0);
+  for( auto& roc : fScalerRocs )
+    AddRoc(roc, 1, ts);
+  EndBank(0);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::MakePhysicsEvent( UInt_t nev )
+{
+  // Physics event with 'nev' triggers
+
+  vector<ULong64_t> ts(nev);
+  for( auto& t : ts ) {
+    fClock += static_cast<ULong64_t>(-log(1.0 - Uniform()) / fEventRate
+                                     * kClockFreq);
+    t = fClock;
+  }
+  BeginEvent(1, 0x10, nev);
+  if( fCodaVersion == 2 ) {
+    // Event ID bank: event number, classification, status
+    fBuffer.insert(fBuffer.end(),
+                   {4U, 0xC0000100, static_cast<UInt_t>(fNtrig + 1), 0U, 0U});
+  } else
+    AddTriggerBank(nev, ts);
+  for( auto& roc : fRocs )
+    AddRoc(roc, nev, ts);
+  EndBank(0);
+  fNtrig += nev;
+  ++fNblocks;
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddTriggerBank( UInt_t nev,
+                                         const vector<ULong64_t>& ts )
+{
+  // CODA 3 trigger bank: bank of segments with the event number, the time
+  // stamps and event types of the triggers in the block, and the time
+  // stamps of each ROC. The segment of the trigger supervisor also holds
+  // the trigger bits.
+
+  size_t pos = fBuffer.size();
+  fBuffer.push_back(0);
+  fBuffer.push_back(0xff21U << 16 | 0x20U << 8 |
+                    static_cast<UInt_t>(fRocs.size()));
+  fBuffer.push_back(1U << 24 | 0x0aU << 16 | 2 * (1 + nev));
+  AddUInt64(fNtrig + 1);
+  for( auto t : ts )
+    AddUInt64(t);
+  UInt_t npad = (nev % 2) ? 2 : 0;
+  fBuffer.push_back(2U << 24 | npad << 22 | 0x05U << 16 | ((nev - 1) / 2 + 1));
+  for( UInt_t i = 0; i < nev; i += 2 )
+    fBuffer.push_back((i + 1 < nev) ? 0x00010001 : 0x00000001);
+  for( const auto& roc : fRocs ) {
+    Bool_t is_ts = (roc.crate == fTSROC);
+    fBuffer.push_back(roc.crate << 24 | 0x01U << 16 | (is_ts ? 3 : 2) * nev);
+    for( auto t : ts ) {
+      AddUInt64(t);
+      if( is_ts )
+        fBuffer.push_back(1);
+    }
+  }
+  EndBank(pos);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddRoc( RocGen& roc, UInt_t nev,
+                                 const vector<ULong64_t>& ts )
+{
+  // Data bank of one crate. In crates with bank structure, each bank holds
+  // the modules with its bank number.
+
+  size_t pos = fBuffer.size();
+  UInt_t num = (fCodaVersion == 3) ? nev : 0;
+  fBuffer.push_back(0);
+  fBuffer.push_back(roc.crate << 16 | (roc.banks ? 0x10U : 0x01U) << 8 | num);
+  if( roc.banks ) {
+    vector<Int_t> banks;
+    for( const auto& mod : roc.modules ) {
+      if( find(banks.begin(), banks.end(), mod.bank) == banks.end() )
+        banks.push_back(mod.bank);
+    }
+    for( auto bank : banks ) {
+      size_t bpos = fBuffer.size();
+      fBuffer.push_back(0);
+      fBuffer.push_back((bank >= 0 ? static_cast<UInt_t>(bank) : kMiscBank) << 16 | 0x01U << 8 | num);
+      Bool_t have1190 = false;
+      for( auto& mod : roc.modules ) {
+        if( mod.bank == bank ) {
+          AddModule(mod, nev, ts);
+          have1190 = have1190 || mod.model == 1190;
+        }
+      }
+      // Caen1190Module rejects banks shorter than 10 words
+      while( have1190 && fBuffer.size() - bpos < 12 )
+        fBuffer.push_back(kFiller1190);
+      EndBank(bpos);
+    }
+  } else {
+    for( auto& mod : roc.modules )
+      AddModule(mod, nev, ts);
+  }
+  EndBank(pos);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddModule( ModuleGen& mod, UInt_t nev,
+                                    const vector<ULong64_t>& ts )
+{
+  if( mod.model == 250 )
+    AddFadc250(mod, nev, ts);
+  else if( mod.model == 1190 )
+    AddCaen1190(mod, nev, ts);
+  else if( IsFastbus(mod.model) )
+    AddFastbus(mod);
+  else if( IsScaler(mod.model) )
+    AddScaler(mod);
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddFadc250( const ModuleGen& mod, UInt_t nev,
+                                     const vector<ULong64_t>& ts )
+{
+  // FADC250 block: block header, per event an event header, the trigger
+  // time and the channel data, block trailer. In the raw window modes,
+  // all channels are read out; the pulse data only exist for channels
+  // that fired.
+
+  const UInt_t slot = mod.slot;
+  const Bool_t raw = (fFadcMode == 1 || fFadcMode == 10);
+  size_t ibeg = fBuffer.size();
+  fBuffer.push_back(BIT(31) | slot << 22 | 1U << 18 |
+                    (fNblocks & 0x3ff) << 8 | nev);
+  for( UInt_t iev = 0; iev < nev; ++iev ) {
+    ULong64_t t = ts[iev];
+    fBuffer.push_back(BIT(31) | 2U << 27 | slot << 22 |
+                      ((fNtrig + 1 + iev) & 0xfff));
+    fBuffer.push_back(BIT(31) | 3U << 27 | (t & 0xffffff));
+    fBuffer.push_back((t >> 24) & 0xffffff);
+    for( UInt_t chan = 0; chan < mod.nchan; ++chan ) {
+      Bool_t hit = Fired();
+      Double_t ped = 100.0 + 10.0 * (chan % 8);
+      Double_t amp = hit ? 50.0 + 2000.0 * Uniform() : 0.0;
+      Double_t tpeak = fFadcWindow * (0.25 + 0.5 * Uniform());  // samples
+      if( raw ) {
+        // Gaussian pulse with sigma of 2 samples on top of the pedestal
+        auto sample = [&]( UInt_t i ) -> UInt_t {
+          Double_t x = (i - tpeak) / 2.0;
+          Double_t v = ped + amp * exp(-0.5 * x * x) + Gaus(0, 1);
+          return static_cast<UInt_t>(max(0.0, min(v, 4095.0)));
+        };
+        fBuffer.push_back(BIT(31) | 4U << 27 | chan << 23 | fFadcWindow);
+        for( UInt_t i = 0; i < fFadcWindow; i += 2 ) {
+          UInt_t s2 = (i + 1 < fFadcWindow) ? sample(i + 1) : BIT(13);
+          fBuffer.push_back(sample(i) << 16 | s2);
+        }
+      }
+      if( !hit )
+        continue;
+      UInt_t integral = static_cast<UInt_t>(5.0 * amp);
+      UInt_t peak = static_cast<UInt_t>(min(ped + amp, 4095.0));
+      UInt_t time = static_cast<UInt_t>(64.0 * tpeak) & 0x7fff;  // 62.5 ps
+      if( fFadcMode == 9 || fFadcMode == 10 ) {
+        UInt_t pedsum = static_cast<UInt_t>(4.0 * ped) & 0x3fff;
+        fBuffer.push_back(BIT(31) | 9U << 27 | (iev & 0xff) << 19 |
+                          chan << 15 | pedsum);
+        fBuffer.push_back(BIT(30) | (integral & 0x3ffff) << 12);
+        fBuffer.push_back((time >> 6) << 21 | (time & 0x3f) << 15 | peak << 3);
+      } else if( fFadcMode == 3 ) {
+        fBuffer.push_back(BIT(31) | 7U << 27 | chan << 23 | (integral & 0x7ffff));
+        fBuffer.push_back(BIT(31) | 8U << 27 | chan << 23 | time);
+      }
+    }
+  }
+  UInt_t nw = static_cast<UInt_t>(fBuffer.size() - ibeg + 1);
+  fBuffer.push_back(BIT(31) | 1U << 27 | slot << 22 | (nw & 0x3fffff));
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddCaen1190( const ModuleGen& mod, UInt_t nev,
+                                      const vector<ULong64_t>& ts )
+{
+  // Caen 1190: per event a global header, one TDC header/trailer pair
+  // around the leading edge hits, the extended trigger time tag and the
+  // global trailer
+
+  for( UInt_t iev = 0; iev < nev; ++iev ) {
+    UInt_t evnum = static_cast<UInt_t>(fNtrig + 1 + iev);
+    size_t ibeg = fBuffer.size();
+    fBuffer.push_back(8U << 27 | (evnum & 0x3fffff) << 5 | mod.slot);
+    size_t itdc = fBuffer.size();
+    fBuffer.push_back(1U << 27 | (evnum & 0xfff) << 12);
+    for( UInt_t chan = 0; chan < mod.nchan; ++chan ) {
+      if( !Fired() )
+        continue;
+      Double_t t = max(0.0, Gaus(20000, 2000));
+      fBuffer.push_back(chan << 19 | (static_cast<UInt_t>(t) & 0x7ffff));
+    }
+    UInt_t ntdc = static_cast<UInt_t>(fBuffer.size() - itdc + 1);
+    fBuffer.push_back(3U << 27 | (evnum & 0xfff) << 12 | (ntdc & 0xfff));
+    fBuffer.push_back(17U << 27 | (ts[iev] & 0x7ffffff));
+    UInt_t nw = static_cast<UInt_t>(fBuffer.size() - ibeg + 1);
+    fBuffer.push_back(16U << 27 | (nw & 0xffff) << 5 | mod.slot);
+  }
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddFastbus( const ModuleGen& mod )
+{
+  // Fastbus module: optional header with word count, one word per hit
+  // with the slot in the upper 5 bits
+
+  UInt_t chanshift = 17, datamask = 0xffff, wdcntmask = 0x7ff;  // 1877
+  Bool_t adc = false;
+  if( mod.model == 1875 ) {
+    chanshift = 16; datamask = 0xfff; wdcntmask = 0;
+  } else if( mod.model == 1881 ) {
+    datamask = 0x3fff; wdcntmask = 0x7f; adc = true;
+  }
+  const UInt_t sl = mod.slot << 27;
+  size_t ihdr = fBuffer.size();
+  if( wdcntmask )
+    fBuffer.push_back(sl);
+  for( UInt_t chan = 0; chan < mod.nchan; ++chan ) {
+    if( !Fired() )
+      continue;
+    Double_t val = adc ? 300.0 - 500.0 * log(1.0 - Uniform())
+                       : Gaus(1500, 100);
+    UInt_t data = min(static_cast<UInt_t>(max(0.0, val)), datamask);
+    fBuffer.push_back(sl | chan << chanshift | data);
+  }
+  if( mod.model == 1877 )
+    AddCluster(mod, chanshift, datamask);
+  if( wdcntmask )
+    fBuffer[ihdr] |= static_cast<UInt_t>(fBuffer.size() - ihdr) & wdcntmask;
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddCluster( const ModuleGen& mod, UInt_t chanshift,
+                                     UInt_t datamask )
+{
+  // Cluster of fClusterSize adjacent TDC hits at a random position,
+  // generated with probability fClusterProb. The drift distance, and so
+  // the time before the common stop, grows linearly with the distance
+  // from the crossing point of the track.
+
+  const Double_t kPeak = 1800, kSlope = 120;  // TDC channels
+  if( fClusterSize == 0 || fClusterSize > mod.nchan ||
+      Uniform() >= fClusterProb )
+    return;
+  UInt_t first =
+    static_cast<UInt_t>(Uniform() * (mod.nchan - fClusterSize + 1));
+  Double_t cross = (fClusterSize - 1) * Uniform();
+  for( UInt_t i = 0; i < fClusterSize; ++i ) {
+    Double_t val = kPeak - kSlope * fabs(i - cross) + Gaus(0, 5);
+    UInt_t data = min(static_cast<UInt_t>(max(0.0, val)), datamask);
+    fBuffer.push_back(mod.slot << 27 | (first + i) << chanshift | data);
+  }
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::AddScaler( ModuleGen& mod )
+{
+  // Scaler: header with the number of channels, followed by the counts,
+  // which accumulate at the channel rates since the previous readout
+
+  Double_t dt = (fClock - mod.lastclock) / kClockFreq;
+  mod.lastclock = fClock;
+  UInt_t nchan = static_cast<UInt_t>(mod.counts.size());
+  UInt_t header = (mod.bank >= 0) ? mod.slot << 8 : mod.header;
+  fBuffer.push_back(header | nchan);
+  for( UInt_t i = 0; i < nchan; ++i ) {
+    mod.counts[i] += static_cast<UInt_t>(mod.rates[i] * dt + Uniform());
+    fBuffer.push_back(mod.counts[i]);
+  }
+}
+
+//_____________________________________________________________________________
+string CodaEventGenerator::DefaultDaqConfig() const
+{
+  // DAQ configuration describing the generator settings and the modules
+
+  ostringstream ostr;
+  ostr << "# Generated by Decoder::CodaEventGenerator\n"
+       << "BLOCKLEVEL " << fBlockLevel << "\n"
+       << "FADC250_MODE " << fFadcMode << "\n"
+       << "FADC250_W_WIDTH " << 4 * fFadcWindow << "\n"
+       << "OCCUPANCY " << fOccupancy << "\n"
+       << "CLUSTER_SIZE " << fClusterSize << "\n"
+       << "CLUSTER_PROB " << fClusterProb << "\n"
+       << "TRIGGER_RATE " << fEventRate << "\n";
+  for( const auto* rocs : {&fRocs, &fScalerRocs} ) {
+    for( const auto& roc : *rocs ) {
+      ostr << "ROC" << roc.crate << "_MODULES";
+      for( const auto& mod : roc.modules )
+        ostr << " " << mod.slot << ":" << mod.model;
+      ostr << "\n";
+    }
+  }
+  ostr << "end\n";
+  return ostr.str();
+}
+
+//_____________________________________________________________________________
+const UInt_t* CodaEventGenerator::NextEvent( UInt_t maxtrig )
+{
+  // Generate the next event. Returns a pointer to the event buffer, which
+  // remains valid until the next call, or nullptr if not initialized.
+
+  if( !fIsInit ) {
+    Error("NextEvent", "Not initialized. Call Init() first.");
+    return nullptr;
+  }
+  UInt_t now = static_cast<UInt_t>(fRunTime + fClock / kClockFreq);
+  switch( fState ) {
+    case kPrestart:
+      MakeControlEvent(PRESTART_EVTYPE, now, fRunNumber, fRunType);
+      fState = kGo;
+      break;
+    case kGo:
+      MakeControlEvent(GO_EVTYPE, now, 0, 0);
+      fState = kPrescale;
+      break;
+    case kPrescale: {
+      // CODA 3 prescale factors are exponents, 0 = no prescaling
+      string ps = fPrescales.Data();
+      if( ps.empty() ) {
+        const char* val = (fCodaVersion == 2) ? "=1" : "=0";
+        for( Int_t i = 1; i <= 8; ++i )
+          ps += (i > 1 ? ",ps" : "ps") + to_string(i) + val;
+      }
+      MakeStringEvent(PRESCALE_EVTYPE, {ps});
+      // DAQ configuration events are decoded only for CODA 3
+      fState = (fCodaVersion == 3) ? kDaqConfig : kRunning;
+      break;
+    }
+    case kDaqConfig:
+      if( fDaqConfig.empty() )
+        MakeStringEvent(DAQCONFIG_FILE1, {DefaultDaqConfig()});
+      else
+        MakeStringEvent(DAQCONFIG_FILE1, fDaqConfig);
+      fState = kRunning;
+      break;
+    case kRunning:
+      if( fEpicsInterval > 0 && !fEpicsVars.empty() && fNtrig >= fNextEpics ) {
+        MakeEpicsEvent();
+        fNextEpics += fEpicsInterval;
+      } else if( fScalerInterval > 0 && !fScalerRocs.empty() &&
+                 fNtrig >= fNextScaler ) {
+        MakeScalerEvent();
+        fNextScaler += fScalerInterval;
+      } else
+        MakePhysicsEvent(max(1U, min(fBlockLevel, maxtrig)));
+      break;
+  }
+  ++fNevents;
+  return fBuffer.data();
+}
+
+//_____________________________________________________________________________
+const UInt_t* CodaEventGenerator::EndEvent()
+{
+  // Generate the end event with the number of triggers in the run
+
+  if( !fIsInit ) {
+    Error("EndEvent", "Not initialized. Call Init() first.");
+    return nullptr;
+  }
+  UInt_t now = static_cast<UInt_t>(fRunTime + fClock / kClockFreq);
+  MakeControlEvent(END_EVTYPE, now, 0, static_cast<UInt_t>(fNtrig));
+  ++fNevents;
+  return fBuffer.data();
+}
+
+//_____________________________________________________________________________
+Long64_t CodaEventGenerator::WriteFile( const char* filename, ULong64_t ntrig )
+{
+  // Write a complete run with 'ntrig' triggers to the CODA file 'filename'.
+  // Returns the number of events written or a negative number on error.
+
+  const char* const here = "WriteFile";
+
+  if( !filename || !*filename ) {
+    Error(here, "No output file name given");
+    return -1;
+  }
+  if( (!fIsInit || fNevents > 0) && Init(fRunTime) != 0 )
+    return -2;
+  THaCodaFile file;
+  if( file.codaOpen(filename, "w") != CODA_OK ) {
+    Error(here, "Cannot open output file %s", filename);
+    return -3;
+  }
+  Long64_t nwritten = 0;
+  while( fState != kRunning || fNtrig < ntrig ) {
+    UInt_t maxtrig = static_cast<UInt_t>(min<ULong64_t>(ntrig - fNtrig, kMaxUInt));
+    if( file.codaWrite(NextEvent(maxtrig)) != CODA_OK ) {
+      Error(here, "Error writing event %lld to %s", nwritten + 1, filename);
+      file.codaClose();
+      return -4;
+    }
+    ++nwritten;
+  }
+  if( file.codaWrite(EndEvent()) != CODA_OK || file.codaClose() != CODA_OK ) {
+    Error(here, "Error closing %s", filename);
+    return -4;
+  }
+  return nwritten + 1;
+}
+
+//_____________________________________________________________________________
+void CodaEventGenerator::Print( Option_t* /* opt */ ) const
+{
+  cout << "CodaEventGenerator: crate map \"" << fMapName << "\""
+       << (fMapText.empty() ? "" : " (from text)") << endl
+       << "  CODA version " << fCodaVersion << ", block level " << fBlockLevel
+       << ", occupancy " << fOccupancy << ", rate " << fEventRate << " Hz"
+       << ", seed " << fSeed << endl
+       << "  FADC250 mode " << fFadcMode << ", window " << fFadcWindow
+       << " samples";
+  if( fClusterSize > 0 )
+    cout << ", 1877 cluster size " << fClusterSize
+         << " (probability " << fClusterProb << ")";
+  cout << endl
+       << "  EPICS every " << fEpicsInterval << ", scalers every "
+       << fScalerInterval << " triggers" << endl;
+  for( const auto* rocs : {&fRocs, &fScalerRocs} ) {
+    for( const auto& roc : *rocs ) {
+      cout << "  ROC " << roc.crate << (roc.banks ? " (banks)" : "")
+           << (rocs == &fScalerRocs ? " (scaler events)" : "") << ":";
+      for( const auto& mod : roc.modules )
+        cout << " " << mod.slot << ":" << mod.model;
+      cout << endl;
+    }
+  }
+  if( fIsInit )
+    cout << "  Generated " << fNevents << " events, " << fNtrig
+         << " triggers" << endl;
+}
+
+} // namespace Decoder
+
+ClassImp(Decoder::CodaEventGenerator)
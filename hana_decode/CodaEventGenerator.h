@@ -0,0 +1,189 @@
+#ifndef Podd_CodaEventGenerator_h_
+#define Podd_CodaEventGenerator_h_
+
+/////////////////////////////////////////////////////////////////////
+//
+//   Decoder::CodaEventGenerator
+//
+//   Synthetic CODA 2 and CODA 3 event streams for decoder and
+//   analysis benchmarks and regression tests. The data layout is
+//   taken from a crate map; the modules are filled with random hits
+//   at a configurable occupancy.
+//
+/////////////////////////////////////////////////////////////////////
+
+#include "TObject.h"
+#include "TString.h"
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Decoder {
+
+class THaCrateMap;
+
+class CodaEventGenerator : public TObject {
+
+public:
+  explicit CodaEventGenerator( const char* cratemap = "cratemap" );
+  CodaEventGenerator( const CodaEventGenerator& ) = delete;
+  CodaEventGenerator& operator=( const CodaEventGenerator& ) = delete;
+  virtual ~CodaEventGenerator();
+
+  // Load the crate map valid at Unix time 'run_time' (0 = now) and set
+  // up the module generators. Call again after changing the configuration.
+  Int_t  Init( ULong64_t run_time = 0 );
+
+  // Configuration
+  void   SetCrateMapName( const char* name ) { fMapName = name; }
+  void   SetCrateMapText( const char* text ) { fMapText = text ? text : ""; }
+  void   SetCodaVersion( Int_t version )     { fCodaVersion = version; }
+  void   SetBlockLevel( UInt_t n )           { fBlockLevel = n; }
+  void   SetOccupancy( Double_t occ )        { fOccupancy = occ; }
+  void   SetEventRate( Double_t hz )         { fEventRate = hz; }
+  void   SetSeed( UInt_t seed )              { fSeed = seed; }
+  void   SetFadcMode( UInt_t mode )          { fFadcMode = mode; }
+  void   SetFadcWindow( UInt_t nsamples )    { fFadcWindow = nsamples; }
+  // Add a cluster of 'n' adjacent hits, as left by a track in a wire
+  // chamber, to each 1877 TDC with probability 'prob' per event (0 = none)
+  void   SetClusterSize( UInt_t n, Double_t prob = 1.0 )
+  { fClusterSize = n; fClusterProb = prob; }
+  void   SetEpicsInterval( UInt_t n )        { fEpicsInterval = n; }
+  void   SetScalerInterval( UInt_t n )       { fScalerInterval = n; }
+  void   SetRunNumber( UInt_t run )          { fRunNumber = run; }
+  void   SetRunType( UInt_t type )           { fRunType = type; }
+  void   SetPrescales( const char* str )     { fPrescales = str ? str : ""; }
+  void   AddDaqConfig( const char* text );
+  void   AddEpicsVariable( const char* name, Double_t mean, Double_t sigma,
+                           const char* units = "" );
+
+  Int_t    GetCodaVersion() const { return fCodaVersion; }
+  UInt_t   GetBlockLevel()  const { return fBlockLevel; }
+  Double_t GetOccupancy()   const { return fOccupancy; }
+
+  // Produce the next event of the run. The first events are the control
+  // and configuration events, followed by physics events (event blocks
+  // for block level > 1) with EPICS and scaler events interspersed.
+  // A physics event block holds at most 'maxtrig' triggers.
+  const UInt_t* NextEvent( UInt_t maxtrig = kMaxUInt );
+  // End-of-run event
+  const UInt_t* EndEvent();
+  const UInt_t* GetEvBuffer() const { return fBuffer.data(); }
+  UInt_t   GetEvLength()    const { return static_cast<UInt_t>(fBuffer.size()); }
+  ULong64_t GetNtrig()      const { return fNtrig; }
+  ULong64_t GetNevents()    const { return fNevents; }
+
+  // Write a run with 'ntrig' triggers to the CODA file 'filename'.
+  // Returns the number of events written or a negative number on error.
+  Long64_t WriteFile( const char* filename, ULong64_t ntrig );
+
+  virtual void Print( Option_t* opt="" ) const;
+
+protected:
+  // Generator state of one module
+  struct ModuleGen {
+    UInt_t   crate, slot;
+    Int_t    model;
+    Int_t    bank;
+    UInt_t   nchan;
+    UInt_t   header;                 // Header word (scalers)
+    ULong64_t lastclock;             // Time of last readout (scalers)
+    std::vector<UInt_t>   counts;    // Running counts (scalers)
+    std::vector<Double_t> rates;     // Counting rates (scalers)
+  };
+  // Generator state of one crate (ROC)
+  struct RocGen {
+    UInt_t   crate;
+    Bool_t   banks;                  // Modules are read out in banks
+    Bool_t   fastbus;
+    std::vector<ModuleGen> modules;
+  };
+  struct EpicsVar {
+    TString  name, units;
+    Double_t mean, sigma;
+  };
+  enum EState { kPrestart, kGo, kPrescale, kDaqConfig, kRunning };
+
+  // Configuration
+  TString   fMapName;         // Crate map database name
+  std::string fMapText;       // Crate map text (overrides fMapName if set)
+  Int_t     fCodaVersion;     // CODA version to generate (2 or 3)
+  UInt_t    fBlockLevel;      // Triggers per physics event (CODA 3)
+  Double_t  fOccupancy;       // Probability that a channel fires
+  Double_t  fEventRate;       // Mean trigger rate (Hz)
+  UInt_t    fSeed;            // Random number seed
+  UInt_t    fFadcMode;        // FADC250 readout mode (1, 3, 9 or 10)
+  UInt_t    fFadcWindow;      // FADC250 readout window (samples)
+  UInt_t    fClusterSize;     // Track cluster size in 1877 TDCs (0 = none)
+  Double_t  fClusterProb;     // Probability of a cluster per 1877 and event
+  UInt_t    fEpicsInterval;   // Triggers between EPICS events (0 = none)
+  UInt_t    fScalerInterval;  // Triggers between scaler events (0 = none)
+  UInt_t    fRunNumber;
+  UInt_t    fRunType;
+  TString   fPrescales;       // Contents of the prescale event
+  std::vector<std::string> fDaqConfig;  // DAQ configuration files (CODA 3)
+  std::vector<EpicsVar>    fEpicsVars;  // EPICS variables
+
+  // Crate layout
+  std::unique_ptr<THaCrateMap> fMap;  //! Crate map
+  std::vector<RocGen> fRocs;          // Crates read out in physics events
+  std::vector<RocGen> fScalerRocs;    // Crates read out in scaler events
+  UInt_t    fTSROC;                   // Trigger supervisor crate
+
+  // Run state
+  std::mt19937 fRandom;               //! Random number engine
+  std::vector<UInt_t> fBuffer;        // Current event
+  EState    fState;
+  ULong64_t fRunTime;                 // Start of run (Unix time)
+  ULong64_t fClock;                   // Current time (250 MHz ticks)
+  ULong64_t fNtrig;                   // Triggers generated
+  ULong64_t fNevents;                 // Events generated
+  ULong64_t fNextEpics;               // Trigger count for next EPICS event
+  ULong64_t fNextScaler;              // Trigger count for next scaler event
+  UInt_t    fNblocks;                 // Physics event blocks generated
+  Bool_t    fIsInit;
+
+  // Event builders
+  void     MakeControlEvent( UInt_t type, UInt_t w2, UInt_t w3, UInt_t w4 );
+  void     MakeStringEvent( UInt_t type,
+                            const std::vector<std::string>& texts );
+  void     MakePhysicsEvent( UInt_t nev );
+  void     MakeEpicsEvent();
+  void     MakeScalerEvent();
+  void     BeginEvent( UInt_t type, UInt_t datatype, UInt_t nev );
+  void     EndBank( size_t pos );
+  void     AddTriggerBank( UInt_t nev, const std::vector<ULong64_t>& ts );
+  void     AddRoc( RocGen& roc, UInt_t nev,
+                   const std::vector<ULong64_t>& ts );
+  void     AddModule( ModuleGen& mod, UInt_t nev,
+                      const std::vector<ULong64_t>& ts );
+  void     AddFadc250( const ModuleGen& mod, UInt_t nev,
+                       const std::vector<ULong64_t>& ts );
+  void     AddCaen1190( const ModuleGen& mod, UInt_t nev,
+                        const std::vector<ULong64_t>& ts );
+  void     AddFastbus( const ModuleGen& mod );
+  void     AddCluster( const ModuleGen& mod, UInt_t chanshift, UInt_t datamask );
+  void     AddScaler( ModuleGen& mod );
+  void     AddString( const std::string& text );
+  void     AddUInt64( ULong64_t val );
+  UInt_t   Code( UInt_t evtype ) const;
+  std::string DefaultDaqConfig() const;
+
+  Double_t Uniform()    { return std::uniform_real_distribution<>()(fRandom); }
+  Bool_t   Fired()      { return Uniform() < fOccupancy; }
+  Double_t Gaus( Double_t mean, Double_t sigma ) {
+    return std::normal_distribution<>(mean, sigma)(fRandom);
+  }
+
+  static Bool_t IsScaler( Int_t model );
+  static Bool_t IsFastbus( Int_t model );
+  static Bool_t IsMultiBlock( Int_t model );
+  static Bool_t IsSupported( Int_t model );
+
+  ClassDef(CodaEventGenerator,0)  // Synthetic CODA event generator
+};
+
+} // namespace Decoder
+
+#endif
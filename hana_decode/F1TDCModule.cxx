@@ -57,6 +57,42 @@ UInt_t F1TDCModule::GetData( UInt_t chan, UInt_t hit ) const
   return fTdcData[idx];
 }
 
+const UInt_t* F1TDCModule::ChannelMap( Bool_t hires )
+{
+  // Tables mapping the internal channel numbers (6 bits) to the channel
+  // numbers used by hana, see LoadSlot
+
+  struct ChanMap {
+    UInt_t lo[64], hi[64];
+    ChanMap() {
+      for( UInt_t ch = 0; ch < 64; ++ch ) {
+        // drop last bit for channel renumbering
+        hi[ch] = ch >> 1;
+        // do the reordering of the channels, for contiguous groups
+        // odd numbered TDC channels from the board -> +16
+        lo[ch] = (ch & 0x20) + ((ch & 0x01) << 4) + ((ch & 0x1e) >> 1);
+      }
+    }
+  };
+  static const ChanMap chanmap;
+  return hires ? chanmap.hi : chanmap.lo;
+}
+
+void F1TDCModule::StoreHits( THaSlotData* sldat, const UInt_t* chan,
+                             const UInt_t* raw, UInt_t nhits )
+{
+  // Load 'nhits' hits into the slot data and the module's data array.
+  // Hits that cannot be stored in the slot data are skipped.
+
+  UInt_t i = 0;
+  while( i < nhits )
+    i += sldat->loadData("tdc", chan+i, raw+i, raw+i, nhits-i) + 1;
+  for( i = 0; i < nhits; ++i ) {
+    UInt_t idx = chan[i] * MAXHIT + 0;  // 1 hit per chan ???
+    if( idx < MAXHIT * NTDCCHAN ) fTdcData[idx] = raw[i];
+  }
+}
+
 void F1TDCModule::Clear(Option_t* opt) {
   VmeModule::Clear(opt);
   fNumHits = 0;
@@ -106,13 +142,20 @@ UInt_t F1TDCModule::LoadSlot( THaSlotData *sldat, const UInt_t *evbuffer,
    const UInt_t F1_RES_LOCK = BIT(26); // good
    const UInt_t DATA_CHK = F1_HIT_OFLW | F1_OUT_OFLW | F1_RES_LOCK;
    const UInt_t DATA_MARKER = BIT(23);
+   // Hits are collected in chunks and stored in the slot data in bulk
+   const UInt_t kChunk = 128;
+   UInt_t chan[kChunk], raw[kChunk];
+   UInt_t nhits = 0;
+   const UInt_t* chanmap = ChannelMap(IsHiResolution());
    // look at all the data
    const UInt_t *loc = evbuffer;
 #ifdef WITH_DEBUG
    if(fDebug > 1 && fDebugFile)
      *fDebugFile<< "Debug of F1TDC data, fResol =  "<<fResol<<"  model num  "<<fModelNum<<endl;
 #endif
-   while ( loc <= pstop && IsSlot(*loc) ) {
+   while ( loc <= pstop &&
+           (fDebugFile ? IsSlot(*loc)
+            : (*loc != 0xffffffff && ((*loc) & fHeaderMask) == fHeader)) ) {
      if ( !( (*loc) & DATA_MARKER ) ) {
        // header/trailer word, to be ignored
 #ifdef WITH_DEBUG
@@ -121,26 +164,18 @@ UInt_t F1TDCModule::LoadSlot( THaSlotData *sldat, const UInt_t *evbuffer,
          <<hex<<*loc<<dec<<endl;
 #endif
      } else {
-       UInt_t chan = ((*loc) >> 16) & 0x3f;  // internal channel number
+       // internal channel number -> hana channel number
+       UInt_t ch = chanmap[((*loc) >> 16) & 0x3f];
 #ifdef WITH_DEBUG
-       UInt_t chn = chan; // save original for debug message below
        if (fDebug > 1 && fDebugFile)
          *fDebugFile<< "[" << (loc-evbuffer) << "] data            0x"
          <<hex<<*loc<<dec<<endl;
 #endif
-       if( IsHiResolution() ) {
-         // drop last bit for channel renumbering
-         chan >>= 1;
-       } else {
-         // do the reordering of the channels, for contiguous groups
-         // odd numbered TDC channels from the board -> +16
-         chan = (chan & 0x20) + ((chan & 0x01) << 4) + ((chan & 0x1e) >> 1);
-       }
        //FIXME: cross-check slot number here
        if( ((*loc) & DATA_CHK) != F1_RES_LOCK ) {
          UInt_t f1slot = ((*loc) & 0xf8000000) >> 27;
          cout << "\tWarning: F1 TDC " << hex << (*loc) << dec;
-         cout << "\tSlot (Ch) = " << f1slot << "(" << chan << ")";
+         cout << "\tSlot (Ch) = " << f1slot << "(" << ch << ")";
          if( (*loc) & F1_HIT_OFLW ) {
            cout << "\tHit-FIFO overflow";
          }
@@ -153,20 +188,23 @@ UInt_t F1TDCModule::LoadSlot( THaSlotData *sldat, const UInt_t *evbuffer,
          cout << endl;
        }
 
-       UInt_t raw = (*loc) & 0xffff;
+       chan[nhits] = ch;
+       raw[nhits] = (*loc) & 0xffff;
 #ifdef WITH_DEBUG
        if(fDebug > 1 && fDebugFile) {
-         *fDebugFile<<" int_chn chan data "<<dec<<chn<<"  "<<chan
-             <<"  0x"<<hex<<raw<<dec<<endl;
+         *fDebugFile<<" int_chn chan data "<<dec<<(((*loc) >> 16) & 0x3f)
+             <<"  "<<ch<<"  0x"<<hex<<raw[nhits]<<dec<<endl;
        }
 #endif
-       /*Int_t status = */sldat->loadData("tdc",chan,raw,raw);
-       UInt_t idx = chan * MAXHIT + 0;  // 1 hit per chan ???
-       if( idx < MAXHIT * NTDCCHAN ) fTdcData[idx] = raw;
+       if( ++nhits == kChunk ) {
+         StoreHits(sldat, chan, raw, nhits);
+         nhits = 0;
+       }
        fWordsSeen++;
      }
      loc++;
    }
+   StoreHits(sldat, chan, raw, nhits);
 
   return fWordsSeen;
 }
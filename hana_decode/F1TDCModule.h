@@ -46,6 +46,9 @@ private:
 
 // Loads sldat and increments ptr to evbuffer
   UInt_t LoadSlot( THaSlotData* sldat, const UInt_t* evbuffer, const UInt_t* pstop );
+  void   StoreHits( THaSlotData* sldat, const UInt_t* chan, const UInt_t* raw,
+                    UInt_t nhits );
+  static const UInt_t* ChannelMap( Bool_t hires );
 
    UInt_t fNumHits;
    EResolution fResol;
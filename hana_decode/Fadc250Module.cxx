@@ -120,6 +120,41 @@ void Fadc250Module::ClearDataVectors()
   }
 }
 
+//_____________________________________________________________________________
+void Fadc250Module::BeginBatchEvent()
+{
+  // Batch mode: start decoding the next event of the block with empty
+  // pulse data
+
+  ClearDataVectors();
+}
+
+//_____________________________________________________________________________
+void Fadc250Module::SaveBatchEvent( UInt_t iev )
+{
+  // Batch mode: keep the data of the event just decoded as event 'iev'.
+  // The vectors are swapped, so their allocations are recycled from
+  // block to block.
+
+  if( fBatchPulseData.size() <= iev ) {
+    fBatchPulseData.resize(iev+1);
+    fBatchTrigTime.resize(iev+1);
+  }
+  std::swap(fBatchPulseData[iev], fPulseData);
+  fBatchTrigTime[iev] = fadc_data.trig_time;
+  fPulseData.resize(NADCCHAN);
+}
+
+//_____________________________________________________________________________
+void Fadc250Module::LoadBatchEvent( UInt_t iev )
+{
+  // Batch mode: make the saved data of event 'iev' current
+
+  assert( iev < fBatchPulseData.size() );
+  std::swap(fBatchPulseData[iev], fPulseData);
+  fadc_data.trig_time = fBatchTrigTime[iev];
+}
+
 //_____________________________________________________________________________
 // Require that slot from base class and slot from
 //   data match before populating data vectors
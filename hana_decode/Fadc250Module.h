@@ -106,10 +106,17 @@ namespace Decoder {
     } __attribute__((aligned(128)));
     std::vector<fadc_pulse_data> fPulseData; // Pulse data for each channel
 
+    // Pulse data and trigger times of all events of the block in batch mode
+    std::vector<std::vector<fadc_pulse_data>> fBatchPulseData;
+    std::vector<uint64_t> fBatchTrigTime;
+
     Bool_t data_type_4, data_type_6, data_type_7, data_type_8, data_type_9, data_type_10;
     Bool_t block_header_found, block_trailer_found, event_header_found, slots_match;
 
     void ClearDataVectors();
+    virtual void BeginBatchEvent();
+    virtual void SaveBatchEvent( UInt_t iev );
+    virtual void LoadBatchEvent( UInt_t iev );
     void PopulateDataVector( std::vector<uint32_t>& data_vector, uint32_t data ) const;
     static uint32_t SumVectorElements( const std::vector<uint32_t>& data_vector );
     void LoadTHaSlotDataObj( THaSlotData* sldat );
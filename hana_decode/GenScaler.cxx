@@ -19,7 +19,7 @@ namespace Decoder {
 
   GenScaler::GenScaler( UInt_t crate, UInt_t slot) :
     VmeModule(crate, slot),
-    fIsDecoded(false), fFirstTime(true), fDeltaT(0.0),
+    fIsDecoded(false), fFirstTime(true), fHasPrev(false), fDeltaT(0.0),
     fClockChan(0), fNumChanMask(0), fNumChanShift(0),
     fHasClock(false), fClockRate(0), fNormScaler(nullptr),
     firsttime(true), firstwarn(true)
@@ -38,6 +38,7 @@ namespace Decoder {
   {
     fHasClock = false;
     fFirstTime = true;
+    fHasPrev = false;
     fIsDecoded = false;
     fClockChan = -1;
     fClockRate = 0;
@@ -120,12 +121,17 @@ namespace Decoder {
       fFirstTime = false;
     } else {
       doload=1;
-      fPrevData = fDataArray;
     }
     if ( !IsSlot(*evbuffer) ) return nfound;
     if (fDebugFile) *fDebugFile << "is slot 0x"<<hex<<*evbuffer<<dec<<" num chan "<<fNumChan<<endl;
     evbuffer++;
     fIsDecoded = true;
+    // Save the previous reading only for our own header, not for every
+    // word the caller tries
+    if (doload) {
+      fPrevData.swap(fDataArray);
+      fHasPrev = true;
+    }
     fDataArray.assign( evbuffer, evbuffer+fNumChan );
     nfound += fNumChan;
     if (fDebugFile) {
@@ -150,14 +156,8 @@ namespace Decoder {
       if (fHasClock) *fDebugFile << "has Clock "<<endl;
     }
     if (IsDecoded() && fHasClock && fClockRate>0 && checkchan(fClockChan)) {
-      // Check for scaler overflow
-      UInt_t clockdif;
-      if(fDataArray[fClockChan] < fPrevData[fClockChan]) {
-	clockdif = (kMaxUInt-(fPrevData[fClockChan]-1))
-	  + fDataArray[fClockChan];
-      } else {
-	clockdif = fDataArray[fClockChan]-fPrevData[fClockChan];
-      }
+      // Unsigned difference is correct across scaler overflow
+      UInt_t clockdif = fDataArray[fClockChan]-fPrevData[fClockChan];
       dtime = clockdif/fClockRate;
       if (fDebugFile) *fDebugFile << "GetTimeSincePrev  "<<fClockRate<<"   "<<fClockChan<<"   "<<dtime<<endl;
     } else {
@@ -173,16 +173,13 @@ namespace Decoder {
 	fRate.assign(fRate.size(), 0);
 	return;
       }
-      for( UInt_t i = 0; i < fWordsExpect; i++ ) {
-	// Check for scaler overflow
-	UInt_t diff;
-	if(fDataArray[i] < fPrevData[i]) {
-	  diff = (kMaxUInt-(fPrevData[i]-1)) + fDataArray[i];
-	} else {
-	  diff = fDataArray[i]-fPrevData[i];
-	}
-	fRate[i] = diff/dtime;
-      }
+      // Branch-free so that the compiler can vectorize this loop.
+      // The unsigned difference is correct across scaler overflow.
+      const UInt_t* cur = fDataArray.data();
+      const UInt_t* prev = fPrevData.data();
+      Double_t* rate = fRate.data();
+      for( UInt_t i = 0; i < fWordsExpect; i++ )
+	rate[i] = static_cast<UInt_t>(cur[i]-prev[i])/dtime;
     }
   }
 
@@ -194,6 +191,15 @@ namespace Decoder {
     }
   }
 
+  UInt_t GenScaler::GetDelta( UInt_t chan ) const {
+    // Counts since the previous reading. Zero at the first reading.
+    if (fHasPrev && checkchan(chan)) {
+      return fDataArray[chan]-fPrevData[chan];
+    } else {
+      return 0;
+    }
+  }
+
   Double_t GenScaler::GetRate( UInt_t chan) const {
     if (checkchan(chan)) {
       return fRate[chan];
@@ -18,7 +18,7 @@ namespace Decoder {
   public:
 
     GenScaler() :
-      fIsDecoded(false), fFirstTime(true), fDeltaT(0.0),
+      fIsDecoded(false), fFirstTime(true), fHasPrev(false), fDeltaT(0.0),
       fClockChan(0), fNumChanMask(0), fNumChanShift(0),
       fHasClock(false), fClockRate(0.0), fNormScaler(nullptr),
       firsttime(true), firstwarn(true) {}
@@ -35,6 +35,7 @@ namespace Decoder {
     void GenInit();
     Int_t    SetClock( Double_t deltaT, UInt_t clockchan = 0, Double_t clockrate = 0 );
     Double_t GetRate( UInt_t chan) const;  // Scaler rate
+    UInt_t   GetDelta( UInt_t chan ) const; // Counts since previous reading
     Double_t GetTimeSincePrev() const;  // returns deltaT since last reading
     Bool_t   IsDecoded() const { return fIsDecoded; };
     void LoadNormScaler(GenScaler *scal);  // loads pointer to norm. scaler
@@ -52,7 +53,7 @@ namespace Decoder {
 
     void LoadRates();
     Bool_t checkchan( UInt_t chan ) const { return (chan < fWordsExpect); }
-    Bool_t fIsDecoded, fFirstTime;
+    Bool_t fIsDecoded, fFirstTime, fHasPrev;
     Double_t fDeltaT;
     std::vector<UInt_t> fDataArray, fPrevData;
     std::vector<Double_t> fRate;
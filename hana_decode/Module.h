@@ -110,6 +110,8 @@ namespace Decoder {
       fHeader = header;
       fHeaderMask = mask;
     }
+    UInt_t GetHeader()     const { return fHeader; }
+    UInt_t GetHeaderMask() const { return fHeaderMask; }
 
     virtual void DoPrint() const;
 
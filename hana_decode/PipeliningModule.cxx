@@ -68,7 +68,9 @@ PipeliningModule::PipeliningModule( UInt_t crate, UInt_t slot )
   : VmeModule(crate, slot),
     fBlockHeader(0),
     data_type_def(15),  // initialize to FILLER WORD
-    index_buffer(0)
+    index_buffer(0),
+    fBatchMode(false),
+    fBatchAllowed(true)
 {
 }
 
@@ -82,14 +84,18 @@ void PipeliningModule::Init( const char* configstr )
   // ==== Crate 30 type vme
   // # slot   model   bank   configuration string
   //   10      250    2501   cfg: debug=1
+  //
+  // With "batch=0", the module is excluded from parallel block decoding,
+  // which requires batch mode.
 
   Init();  // standard Init
 
-  UInt_t debug = 0;
-  vector<ConfigStrReq> req = { { "debug", debug } };
+  UInt_t debug = 0, batch = kMaxUInt;
+  vector<ConfigStrReq> req = { { "debug", debug }, { "batch", batch } };
   ParseConfigStr(configstr, req);
 
   fDebug = static_cast<Int_t>(debug);
+  fBatchAllowed = (batch != 0);
 }
 
 //_____________________________________________________________________________
@@ -98,6 +104,7 @@ void PipeliningModule::Clear( Option_t* opt )
   VmeModule::Clear(opt);
   evtblk.clear();
   index_buffer = 0;
+  fBatchMode = false;
 }
 
 //_____________________________________________________________________________
@@ -206,6 +213,8 @@ UInt_t PipeliningModule::LoadBank( THaSlotData* sldat,
               [ibeg]( UInt_t pos ) { return pos-ibeg; });
 
     index_buffer = 0;
+    if( fBatchMode )
+      DecodeBatch(sldat);
     return LoadNextEvBuffer(sldat);
 
   } else {
@@ -228,20 +237,33 @@ UInt_t PipeliningModule::LoadBank( THaSlotData* sldat,
 }
 
 //_____________________________________________________________________________
-UInt_t PipeliningModule::LoadNextEvBuffer( THaSlotData* sldat )
+UInt_t PipeliningModule::LoadBankBatch( THaSlotData* sldat,
+                                        const UInt_t* evbuffer,
+                                        UInt_t pos, UInt_t len )
 {
-  // In multi-block mode, load the next event from the current block
+  // Load event block in batch mode: decode all events of a multi-block
+  // block now, see DecodeBatch. Batch mode applies to this block only;
+  // the next block loaded with LoadBank is decoded normally.
+
+  Clear();
+  fBatchMode = true;
+  return LoadBank(sldat, evbuffer, pos, len);
+}
+
+//_____________________________________________________________________________
+UInt_t PipeliningModule::LoadBlockEvent( THaSlotData* sldat, UInt_t iev )
+{
+  // Decode event 'iev' of the current block, copied to fBuffer by LoadBank
 
-  UInt_t ii = index_buffer;
-  assert( ii+1 < evtblk.size() );
+  assert( iev+1 < evtblk.size() );
 
   // ibeg = event header, iend = one past last word of this event ( = next
   // event header if more events pending)
-  auto ibeg = evtblk[ii], iend = evtblk[ii+1];
+  auto ibeg = evtblk[iev], iend = evtblk[iev+1];
   assert(ibeg > 0 && iend > ibeg && static_cast<size_t>(iend) <= fBuffer.size());
 
   // Let ibeg point to the block header, or one before event header
-  if( ii == 0 )
+  if( iev == 0 )
     ibeg = 0;
   else {
     --ibeg;
@@ -250,17 +272,29 @@ UInt_t PipeliningModule::LoadNextEvBuffer( THaSlotData* sldat )
   }
 
   // Load slot starting with block header at ibeg
+  UInt_t nwords = 0;
   try {
-    ii = LoadSlot(sldat, fBuffer.data(), ibeg, iend-ibeg);
+    nwords = LoadSlot(sldat, fBuffer.data(), ibeg, iend-ibeg);
   }
 
   catch( ... ) {
     // In case the calling code wants to continue, put the buffer back in a
     // consistent state
-    if( ii != 0 ) std::swap(fBlockHeader, fBuffer[ibeg]);
+    if( iev != 0 ) std::swap(fBlockHeader, fBuffer[ibeg]);
     throw;
   }
-  if( ii != 0 ) std::swap(fBlockHeader, fBuffer[ibeg]);
+  if( iev != 0 ) std::swap(fBlockHeader, fBuffer[ibeg]);
+
+  return nwords;
+}
+
+//_____________________________________________________________________________
+UInt_t PipeliningModule::LoadNextEvBuffer( THaSlotData* sldat )
+{
+  // In multi-block mode, load the next event from the current block
+
+  UInt_t ii = fBatchMode ? LoadBatchHits(sldat, index_buffer)
+                         : LoadBlockEvent(sldat, index_buffer);
 
   // Next cached buffer. Set flag if we've exhausted the cache.
   ++index_buffer;
@@ -270,6 +304,52 @@ UInt_t PipeliningModule::LoadNextEvBuffer( THaSlotData* sldat )
   return ii;
 }
 
+//_____________________________________________________________________________
+void PipeliningModule::DecodeBatch( THaSlotData* sldat )
+{
+  // Batch mode: decode all events of the current block in one pass and
+  // save their hits. 'sldat' is used as scratch space and is cleared
+  // on return.
+
+  assert( !evtblk.empty() );
+  auto nev = static_cast<UInt_t>(evtblk.size() - 1);
+  fBatchChan.clear();
+  fBatchData.clear();
+  fBatchRaw.clear();
+  fBatchHitOff.resize(nev+1);
+  fBatchWords.resize(nev);
+
+  fBatchHitOff[0] = 0;
+  for( UInt_t iev = 0; iev < nev; ++iev ) {
+    sldat->clearEvent();
+    BeginBatchEvent();
+    fBatchWords[iev] = LoadBlockEvent(sldat, iev);
+    SaveBatchEvent(iev);
+    for( UInt_t i = 0; i < sldat->getNumChan(); ++i ) {
+      UInt_t chan = sldat->getNextChan(i);
+      for( UInt_t hit = 0; hit < sldat->getNumHits(chan); ++hit ) {
+        fBatchChan.push_back(chan);
+        fBatchData.push_back(sldat->getData(chan, hit));
+        fBatchRaw.push_back(sldat->getRawData(chan, hit));
+      }
+    }
+    fBatchHitOff[iev+1] = fBatchChan.size();
+  }
+  sldat->clearEvent();
+}
+
+//_____________________________________________________________________________
+UInt_t PipeliningModule::LoadBatchHits( THaSlotData* sldat, UInt_t iev )
+{
+  // Batch mode: load the saved hits of event 'iev' of the current block
+
+  assert( iev < fBatchWords.size() );
+  LoadBatchEvent(iev);
+  for( UInt_t i = fBatchHitOff[iev]; i < fBatchHitOff[iev+1]; ++i )
+    sldat->loadData(fBatchChan[i], fBatchData[i], fBatchRaw[i]);
+  return fBatchWords[iev];
+}
+
 //_____________________________________________________________________________
 } //namespace Decoder
 
@@ -25,6 +25,13 @@
 //   the last event buffer will have the block trailer
 //   and all event buffers will have an event header
 //
+//   In batch mode, all events of a block are decoded in one pass when the
+//   block is loaded, and their hits are kept in compact per-block arrays.
+//   The following events of the block are then served from these arrays
+//   without decoding their buffers again. Batch mode is not faster by
+//   itself; it is used by CodaDecoder to decode the blocks of different
+//   slots in parallel.
+//
 /////////////////////////////////////////////////////////////////////
 
 #include "VmeModule.h"
@@ -57,9 +64,21 @@ public:
   virtual UInt_t LoadBank( THaSlotData* sldat, const UInt_t* evbuffer,
                            UInt_t pos, UInt_t len );
 
+  // Load event block like LoadBank, but in batch mode. Used by CodaDecoder
+  // for parallel block decoding.
+  UInt_t LoadBankBatch( THaSlotData* sldat, const UInt_t* evbuffer,
+                        UInt_t pos, UInt_t len );
+  // True if the current block was loaded in batch mode
+  Bool_t IsBatchMode() const { return fBatchMode; }
+  // False if batch mode is disabled with "batch=0" in the module's
+  // configuration string in the crate map
+  Bool_t IsBatchAllowed() const { return fBatchAllowed; }
+
 protected:
 
    virtual UInt_t LoadNextEvBuffer( THaSlotData *sldat );
+   // Decode event 'iev' of the current block in multi-block mode
+   virtual UInt_t LoadBlockEvent( THaSlotData* sldat, UInt_t iev );
    UInt_t fBlockHeader;    // Copy of block header word
    UInt_t data_type_def;   // Data type indicated by most recent header word
 
@@ -68,6 +87,24 @@ protected:
    std::vector<Long64_t> evtblk;  // Event header positions
    UInt_t index_buffer;    // Index of next block to be decoded
 
+   // Support for batch mode
+   Bool_t fBatchMode;          // Current block decoded all at once
+   Bool_t fBatchAllowed;       // Batch mode not disabled in configuration
+   VectorUIntNI fBatchChan;    // Channel of each hit of all events in block
+   VectorUIntNI fBatchData;    // Data of each hit
+   VectorUIntNI fBatchRaw;     // Raw data of each hit
+   VectorUIntNI fBatchHitOff;  // [iev] Index of first hit of event iev
+   VectorUIntNI fBatchWords;   // [iev] Number of words decoded for event iev
+
+   void   DecodeBatch( THaSlotData* sldat );
+   UInt_t LoadBatchHits( THaSlotData* sldat, UInt_t iev );
+   // Hooks for modules with per-event data beyond what they load into
+   // THaSlotData: reset the data before decoding an event of the batch,
+   // save the decoded data as event 'iev', make event 'iev' current.
+   virtual void BeginBatchEvent() {}
+   virtual void SaveBatchEvent( UInt_t /* iev */ ) {}
+   virtual void LoadBatchEvent( UInt_t /* iev */ ) {}
+
    enum { kBlockHeader = 0, kBlockTrailer = 1, kEventHeader = 2 };
    static Long64_t FindIDWord( const uint32_t* buf, size_t start, size_t len,
                                uint32_t type );
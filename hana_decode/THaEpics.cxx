@@ -11,9 +11,12 @@
 //   All data are received as characters and are parsed.
 //   'tags' remain characters, 'values' are either character 
 //   or double, and 'units' are characters.
-//   Data are stored in an STL map and retrievable by
-//   'tag' (e.g. IPM1H04B.XPOS) and by proximity to
-//   a physics event number (closest one is picked).
+//   Data are stored per tag, sorted by event number, and are
+//   retrievable by 'tag' (e.g. IPM1H04B.XPOS) and by proximity to
+//   a physics event number (the most recent reading at or before
+//   the event is picked). Each tag is assigned an integer ID when
+//   first seen; frequent clients may look up the ID once with
+//   GetTagID() and use the ID-based accessors thereafter.
 //
 //   Replaces THaEpicsStack (obsolete)
 //
@@ -22,9 +25,16 @@
 /////////////////////////////////////////////////////////////////////
 
 #include "THaEpics.h"
+#include "Helper.h"   // for ALL
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
-#include <sstream>
+#if __cplusplus >= 201703L && __has_include(<charconv>)
+#include <charconv>
+#endif
 #ifdef __GLIBC__
 #include "Textvars.h"   // for Podd::Tokenize
 #endif
@@ -32,6 +42,9 @@
 using namespace std;
 
 static int DEBUGL = 0;  // FIXME: -> fDebug member variable
+// Readings this many events or more before the requested event are not
+// considered nearest to it (historical limit of FindEvent)
+static const UInt_t kMaxEvDiff = 9999999;
 
 namespace Decoder {
 
@@ -72,8 +85,8 @@ void THaEpics::Print()
   cout << "\n\n====================== \n";
   cout << "Print of Epics Data : "<<endl;
   Int_t j = 0;
-  for( auto& pm : epicsData ) {
-    const vector<EpicsChan>& vepics = pm.second;
+  for( auto& pm : fTagIndex ) {
+    const vector<EpicsChan>& vepics = fChanData[pm.second];
     const string& tag = pm.first;
     j++;
     cout << "\n\nEpics Var #" << j;
@@ -93,70 +106,182 @@ void THaEpics::Print()
 }
 
 //_____________________________________________________________________________
-Bool_t THaEpics::IsLoaded(const char* tag) const
+UInt_t THaEpics::GetTagID( const char* tag ) const
 {
-  const vector<EpicsChan> ep = GetChan(tag);
-  return !ep.empty();
+  // Return the ID of the Epics variable 'tag', or kMaxUInt if no data
+  // for this variable have been loaded.
+
+  if( !tag )
+    return kMaxUInt;
+  auto pm = fTagIndex.find(tag);
+  if( pm == fTagIndex.end() )
+    return kMaxUInt;
+  return pm->second;
 }
 
 //_____________________________________________________________________________
-Double_t THaEpics::GetData ( const char* tag, UInt_t event) const
+Bool_t THaEpics::IsLoaded( const char* tag ) const
 {
-  const vector<EpicsChan> ep = GetChan(tag);
-  UInt_t k = FindEvent(ep, event);
-  if( k == kMaxUInt ) return 0;
-  return ep[k].GetData();
+  return IsLoadedByID(GetTagID(tag));
 }
 
 //_____________________________________________________________________________
-string THaEpics::GetString ( const char* tag, UInt_t event) const
+Bool_t THaEpics::IsLoadedByID( UInt_t id ) const
 {
-  const vector<EpicsChan> ep = GetChan(tag);
-  UInt_t k = FindEvent(ep, event);
-  if( k == kMaxUInt ) return "";
-  return ep[k].GetString();
+  return id < fChanData.size() && !fChanData[id].empty();
 }
 
 //_____________________________________________________________________________
-time_t THaEpics::GetTimeStamp( const char* tag, UInt_t event) const
+Double_t THaEpics::GetData( const char* tag, UInt_t event ) const
 {
-  const vector<EpicsChan> ep = GetChan(tag);
-  UInt_t k = FindEvent(ep, event);
-  if( k == kMaxUInt ) return 0;
-  return ep[k].GetTimeStamp();
+  return GetDataByID(GetTagID(tag), event);
+}
+
+//_____________________________________________________________________________
+Double_t THaEpics::GetDataByID( UInt_t id, UInt_t event ) const
+{
+  const EpicsChan* chan = FindChan(id, event);
+  if( !chan ) return 0;
+  return chan->GetData();
+}
+
+//_____________________________________________________________________________
+string THaEpics::GetString( const char* tag, UInt_t event ) const
+{
+  return GetStringByID(GetTagID(tag), event);
+}
+
+//_____________________________________________________________________________
+string THaEpics::GetStringByID( UInt_t id, UInt_t event ) const
+{
+  const EpicsChan* chan = FindChan(id, event);
+  if( !chan ) return "";
+  return chan->GetString();
+}
+
+//_____________________________________________________________________________
+time_t THaEpics::GetTimeStamp( const char* tag, UInt_t event ) const
+{
+  return GetTimeStampByID(GetTagID(tag), event);
+}
+
+//_____________________________________________________________________________
+time_t THaEpics::GetTimeStampByID( UInt_t id, UInt_t event ) const
+{
+  const EpicsChan* chan = FindChan(id, event);
+  if( !chan ) return 0;
+  return chan->GetTimeStamp();
 }
 
 //_____________________________________________________________________________
-vector<EpicsChan> THaEpics::GetChan(const char *tag) const
+const EpicsChan* THaEpics::FindChan( UInt_t id, UInt_t event ) const
 {
-  // Return the vector of Epics data for 'tag' 
-  // where 'tag' is the name of the Epics variable.
-  auto pm = epicsData.find(string(tag));
-  if (pm != epicsData.end())
-    return pm->second;
-  else
-    return {};
+  // Return the reading of Epics variable 'id' nearest event 'event',
+  // or nullptr if there is none.
+  if( id >= fChanData.size() )
+    return nullptr;
+  const vector<EpicsChan>& ep = fChanData[id];
+  UInt_t k = FindEvent(ep, event);
+  if( k == kMaxUInt )
+    return nullptr;
+  return &ep[k];
 }
 
 //_____________________________________________________________________________
 UInt_t THaEpics::FindEvent( const vector<EpicsChan>& ep, UInt_t event )
 {
-  // Return the index in the vector of Epics data 
-  // nearest in event number to event 'event'.
+  // Return the index in the vector of Epics data 'ep' (sorted by event
+  // number) nearest in event number to event 'event'. This is the first
+  // of the most recent readings taken at or before 'event'. If 'event'
+  // is zero or precedes all readings, return the last one. As before,
+  // readings kMaxEvDiff or more events before 'event' are not
+  // considered nearby, so the last one is returned in that case, too.
   if (ep.empty())
     return kMaxUInt;
   UInt_t myidx = ep.size()-1;
-  if (event == 0) return myidx;  // return last event 
-  Long64_t min = 9999999;
-  for( size_t k = 0; k < ep.size(); k++ ) {
-    Long64_t diff = event - ep[k].GetEvNum();
-    if( diff < 0 ) diff = -diff;
-    if( diff < min ) {
-      min = diff;
-      myidx = k;
-    }
+  if (event == 0) return myidx;  // return last event
+  auto it = upper_bound(ALL(ep), event,
+                        []( UInt_t ev, const EpicsChan& chan ) {
+                          return ev < chan.GetEvNum();
+                        });
+  if( it == ep.begin() )
+    return myidx;
+  UInt_t evnum = (--it)->GetEvNum();
+  if( event - evnum >= kMaxEvDiff )
+    return myidx;
+  it = lower_bound(ep.begin(), it, evnum,
+                   []( const EpicsChan& chan, UInt_t ev ) {
+                     return chan.GetEvNum() < ev;
+                   });
+  return it - ep.begin();
+}
+
+//_____________________________________________________________________________
+void THaEpics::AddChan( const string& tag, EpicsChan&& chan )
+{
+  // Add a reading for Epics variable 'tag', keeping the readings for each
+  // tag sorted by event number. Readings normally arrive in event order,
+  // so this is almost always an append.
+
+  auto ins = fTagIndex.emplace(tag, fChanData.size());
+  if( ins.second )
+    fChanData.emplace_back();
+  vector<EpicsChan>& ep = fChanData[ins.first->second];
+  if( ep.empty() || chan.GetEvNum() >= ep.back().GetEvNum() ) {
+    ep.push_back(std::move(chan));
+  } else {
+    auto it = upper_bound(ALL(ep), chan.GetEvNum(),
+                          []( UInt_t ev, const EpicsChan& c ) {
+                            return ev < c.GetEvNum();
+                          });
+    ep.insert(it, std::move(chan));
   }
-  return myidx;
+}
+
+//_____________________________________________________________________________
+static inline bool IsSpace( char c )
+{
+  return isspace(static_cast<unsigned char>(c));
+}
+
+//_____________________________________________________________________________
+static inline const char* SkipSpace( const char* p, const char* end )
+{
+  while( p != end && IsSpace(*p) ) ++p;
+  return p;
+}
+
+//_____________________________________________________________________________
+static inline const char* FindSpace( const char* p, const char* end )
+{
+  while( p != end && !IsSpace(*p) ) ++p;
+  return p;
+}
+
+//_____________________________________________________________________________
+static bool ParseValue( const char* b, const char* e, Double_t& val )
+{
+  // Convert the leading part of [b,e) to a number, as istream >> double
+  // would: an optional sign followed by digits or a decimal point.
+  // Trailing characters are ignored. Returns false if no conversion.
+
+  const char* p = b;
+  if( p != e && (*p == '+' || *p == '-') ) ++p;
+  if( p == e || !(isdigit(static_cast<unsigned char>(*p)) || *p == '.') )
+    return false;
+  if( *b == '+' ) ++b;  // from_chars does not accept a leading '+'
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  auto r = std::from_chars(b, e, val);
+  return r.ec == std::errc();
+#else
+  char tmp[64];
+  auto n = std::min<size_t>(e-b, sizeof(tmp)-1);
+  memcpy(tmp, b, n);
+  tmp[n] = '\0';
+  char* q = nullptr;
+  val = strtod(tmp, &q);
+  return q != tmp;
+#endif
 }
 
 //_____________________________________________________________________________
@@ -165,7 +290,7 @@ int THaEpics::LoadData( const UInt_t* evbuffer, UInt_t event)
   // load data from the event buffer 'evbuffer' 
   // for event nearest 'evnum'.
 
-  const string::size_type MAX_VAL_LEN = 32;
+  const size_t MAX_VAL_LEN = 32;
 
   const char* cbuff = (const char*)evbuffer;
   size_t len = sizeof(UInt_t)*(evbuffer[0]+1);
@@ -174,51 +299,51 @@ int THaEpics::LoadData( const UInt_t* evbuffer, UInt_t event)
   // The first 16 bytes of the buffer are the event header
   len -= 16;
   cbuff += 16;
-  
-  // Copy data to internal string buffer
-  string buf( cbuff, len );
+  // The text is padded with NULs at the end
+  const char* const bend = cbuff + strnlen(cbuff, len);
 
   // The first line is the time stamp
-  string date;
-  istringstream ib(buf);
-  if( !getline(ib,date) || date.size() < 16 ) {
+  const char* eol = std::find(cbuff, bend, '\n');
+  if( eol-cbuff < 16 ) {
     cerr << "Invalid time stamp for EPICS event at evnum = " << event << endl;
     return 0;
   }
+  const string date(cbuff, eol);
   if(DEBUGL>1) cout << "Timestamp: " << date <<endl;
 
-  string line;
-  istringstream il, iv;
-  while( getline(ib,line) ) {
-    // Here we parse each line
-    if(DEBUGL>2) cout << "epics line : "<<line<<endl;
-    il.clear(); il.str(line);
-    string wtag, wval, wunits;
-    il >> wtag;
-    if( wtag.empty() || wtag[0] == 0 ) continue;
-    istringstream::pos_type spos = il.tellg();
-    il >> wval;
+  // Parse the remaining lines in place
+  for( const char* p = eol; p != bend; p = eol ) {
+    const char* line = p + (*p == '\n');
+    eol = std::find(line, bend, '\n');
+    if(DEBUGL>2) cout << "epics line : "<<string(line,eol)<<endl;
+    const char* tb = SkipSpace(line, eol);
+    const char* te = FindSpace(tb, eol);
+    if( tb == te ) continue;
+    const char* vb = SkipSpace(te, eol);
+    const char* ve = FindSpace(vb, eol);
     Double_t dval = 0;
     bool got_val = false;
-    if( !wval.empty() && wval.length() <= MAX_VAL_LEN ) {
-      iv.clear(); iv.str(wval);
-      if( iv >> dval )
-        got_val = true;
-    }
+    if( vb != ve && size_t(ve-vb) <= MAX_VAL_LEN )
+      got_val = ParseValue(vb, ve, dval);
+    string wtag(tb, te), wval, wunits;
     if( got_val ) {
-      il >> wunits; // Assumes that wunits contains no whitespace
+      wval.assign(vb, ve);
+      const char* ub = SkipSpace(ve, eol);
+      wunits.assign(ub, FindSpace(ub, eol)); // Assumes that units contain no whitespace
     } else {
       // Mimic the old behavior: if the string doesn't convert to a number,
       // then wval = rest of string after tag, dval = 0, sunit = empty
-      string::size_type lpos = line.find_first_not_of(" \t",spos);
-      wval = ( lpos != string::npos ) ? line.substr(lpos) : "";
+      const char* lpos = te;
+      while( lpos != eol && (*lpos == ' ' || *lpos == '\t') ) ++lpos;
+      wval.assign(lpos, eol);
       dval = 0;
     }
     if(DEBUGL>2) cout << "wtag = "<<wtag<<"   wval = "<<wval
 		      << "   dval = "<<dval<<"   wunits = "<<wunits<<endl;
 
-    // Add tag/value/units to the EPICS data.    
-    epicsData[wtag].push_back( EpicsChan(wtag, date, event, wval, wunits, dval) );
+    // Add tag/value/units to the EPICS data.
+    AddChan(wtag, EpicsChan(wtag, date, event, std::move(wval),
+                            std::move(wunits), dval));
   }
   if(DEBUGL) Print();
   return 1;
@@ -28,6 +28,10 @@ public:
     tag(std::move(_tg)), dtime(std::move(_dt)), evnum(_ev),
     svalue(std::move(_sv)), units(std::move(_un)), dvalue(_dv),
     timestamp(0) { MakeTime(); }
+  EpicsChan( const EpicsChan& ) = default;
+  EpicsChan( EpicsChan&& ) = default;
+  EpicsChan& operator=( const EpicsChan& ) = default;
+  EpicsChan& operator=( EpicsChan&& ) = default;
   virtual ~EpicsChan() = default;
   void Load( char *tg, char *dt, UInt_t ev,
              char *sv, char *un, Double_t dv ) {
@@ -69,10 +73,25 @@ public:
    Bool_t IsLoaded(const char* tag) const;
    void Print();
 
+// Fast access by tag ID. IDs are assigned when a tag is first loaded and
+// remain valid for the lifetime of this object. GetTagID returns kMaxUInt
+// for tags not (yet) loaded.
+   UInt_t GetTagID( const char* tag ) const;
+   UInt_t GetNTags() const { return fChanData.size(); }
+   Double_t GetDataByID( UInt_t id, UInt_t event= 0 ) const;
+   std::string GetStringByID( UInt_t id, UInt_t event= 0 ) const;
+   time_t GetTimeStampByID( UInt_t id, UInt_t event= 0 ) const;
+   Bool_t IsLoadedByID( UInt_t id ) const;
+
 private:
 
-   std::map< std::string, std::vector<EpicsChan> > epicsData;
-   std::vector<EpicsChan> GetChan(const char *tag) const;
+   // Tag name -> tag ID, index into fChanData
+   std::map< std::string, UInt_t > fTagIndex;
+   // Readings per tag ID, sorted by event number
+   std::vector< std::vector<EpicsChan> > fChanData;
+
+   const EpicsChan* FindChan( UInt_t id, UInt_t event ) const;
+   void AddChan( const std::string& tag, EpicsChan&& chan );
    static UInt_t FindEvent( const std::vector<EpicsChan>& ep, UInt_t event );
 
    ClassDef(THaEpics,0)  // EPICS data
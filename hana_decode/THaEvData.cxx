@@ -35,10 +35,19 @@
 #include <utility>
 #include <stdexcept>
 #include <sstream>
+#include <mutex>
 
 using namespace std;
 using namespace Decoder;
 
+// State of lazy decoding: crates whose decoding is pending for the
+// current event, and a lock that serializes their decoding
+struct THaEvData::LazyState {
+  LazyState() { for( auto& p : pending ) p = false; }
+  std::array<std::atomic<bool>, MAXROC> pending;
+  std::mutex mutex;
+};
+
 // Instances of this object
 TBits THaEvData::fgInstances;
 
@@ -79,7 +88,10 @@ THaEvData::THaEvData() :
   fInstance{fgInstances.FirstNullBit()},
   fNeedInit{true},
   fDebug{0},
-  fExtra{nullptr}
+  fExtra{nullptr},
+  fLazy{new LazyState},
+  fNdeferred{0},
+  fDecodeThreads{1}
 {
   fSlotUsed.reserve(MAXROCSLOT/4);  // Generous space for a typical setup
   fSlotClear.reserve(MAXROCSLOT/4);
@@ -178,6 +190,209 @@ void THaEvData::EnablePrescanMode( Bool_t enable )
   SetBit(kPrescanMode, enable);
 }
 
+//_____________________________________________________________________________
+void THaEvData::SetHeaderFilter( HeaderFilter_t filter )
+{
+  // Set filter function for physics events to be evaluated before any ROC
+  // data are decoded. The filter is passed this decoder object, for which
+  // only the event type, event number, trigger bits and event time are
+  // valid at that point. If the filter returns false, the event is not
+  // decoded, and IsHeaderRejected() returns true.
+  //
+  // Multiblock events are always decoded since all events of a block are
+  // unpacked together. The caller should test such events itself, which
+  // it can recognize by IsHeaderChecked() being false.
+  //
+  // An empty filter (nullptr) disables filtering.
+
+  fHeaderFilter = std::move(filter);
+}
+
+//_____________________________________________________________________________
+void THaEvData::EnableLazyDecoding( Bool_t enable )
+{
+  // Enable/disable lazy decoding. If enabled, physics events are only
+  // scanned for the positions of the crate data when loaded. The data of
+  // a crate are decoded when any of its slots is first accessed via
+  // GetNumHits(), GetData(), GetModule() etc. Crates that are never
+  // consulted for an event (e.g. because an early cut rejected it) are
+  // not decoded at all.
+  //
+  // Decoding of a deferred crate is serialized by a lock, so several
+  // threads may access the slot data of the same event concurrently.
+  // A new event must not be loaded while other threads are still
+  // accessing the current one.
+  //
+  // Decoders without lazy decoding support ignore this setting. So does
+  // CodaDecoder for multiblock data, which must be decoded up front.
+
+  SetBit(kLazyDecoding, enable);
+  if( !enable )
+    ClearDeferred();
+}
+
+//_____________________________________________________________________________
+void THaEvData::DeferCrate( UInt_t crate )
+{
+  // Mark the data of 'crate' in the current event for decoding on demand
+
+  assert( crate < MAXROC );
+  if( !fLazy->pending[crate].exchange(true) )
+    ++fNdeferred;
+}
+
+//_____________________________________________________________________________
+void THaEvData::ClearDeferred()
+{
+  // Forget any crates still deferred. Called when a new event is loaded.
+
+  if( fNdeferred.load() == 0 )
+    return;
+  for( auto& p : fLazy->pending )
+    p = false;
+  fNdeferred = 0;
+}
+
+//_____________________________________________________________________________
+void THaEvData::LoadDeferred( UInt_t crate ) const
+{
+  // Decode 'crate' if its decoding is pending. Thread-safe.
+
+  if( crate >= MAXROC || !fLazy->pending[crate].load(memory_order_acquire) )
+    return;
+  lock_guard<mutex> lock(fLazy->mutex);
+  if( !fLazy->pending[crate].load(memory_order_relaxed) )
+    return;  // Decoded by another thread in the meantime
+  // The decoded data are logically part of the (const) event
+  Int_t ret = const_cast<THaEvData*>(this)->DecodeDeferred(crate);
+  if( ret != HED_OK && ret != HED_WARN )
+    Error("THaEvData::LoadDeferred", "Error %d decoding crate %u of "
+          "event %u. Data of this crate are incomplete.", ret, crate,
+          event_num);
+  fLazy->pending[crate].store(false, memory_order_release);
+  --fNdeferred;
+}
+
+//_____________________________________________________________________________
+Int_t THaEvData::DecodeDeferred( UInt_t /* crate */ )
+{
+  // Decode deferred crate data. Must be implemented by decoders that call
+  // DeferCrate().
+
+  assert(fgAllowUnimpl);
+  return HED_ERR;
+}
+
+//_____________________________________________________________________________
+void THaEvData::CountPresent( UInt_t crate )
+{
+  if( fPresentCount.empty() )
+    fPresentCount.assign(MAXROC, 0);
+  assert( crate < MAXROC );
+  ++fPresentCount[crate];
+}
+
+//_____________________________________________________________________________
+void THaEvData::CountDecoded( UInt_t crate, UInt_t slot )
+{
+  if( fDecodeCount.empty() )
+    fDecodeCount.assign(MAXROCSLOT, 0);
+  assert( GoodCrateSlot(crate,slot) );
+  ++fDecodeCount[idx(crate,slot)];
+}
+
+//_____________________________________________________________________________
+ULong64_t THaEvData::GetSlotDecodeCount( UInt_t crate, UInt_t slot ) const
+{
+  // Number of events in which the data of (crate,slot) were decoded
+
+  if( fDecodeCount.empty() || !GoodCrateSlot(crate,slot) )
+    return 0;
+  return fDecodeCount[idx(crate,slot)];
+}
+
+//_____________________________________________________________________________
+ULong64_t THaEvData::GetCratePresentCount( UInt_t crate ) const
+{
+  // Number of physics events in which data of 'crate' were present
+
+  if( fPresentCount.empty() || crate >= MAXROC )
+    return 0;
+  return fPresentCount[crate];
+}
+
+//_____________________________________________________________________________
+void THaEvData::ResetDecodeCounts()
+{
+  fDecodeCount.clear();
+  fPresentCount.clear();
+}
+
+//_____________________________________________________________________________
+void THaEvData::PrintDecodeCounts() const
+{
+  // Print per-crate and per-slot decoding statistics
+
+  if( fPresentCount.empty() )
+    return;
+  auto flags = cout.flags();
+  auto prec = cout.precision();
+  cout << "Decoding statistics (events with crate present / slot decoded):"
+       << endl;
+  for( UInt_t crate = 0; crate < MAXROC; ++crate ) {
+    if( fPresentCount[crate] == 0 )
+      continue;
+    cout << "  crate " << setw(2) << crate << ": "
+         << setw(10) << fPresentCount[crate];
+    if( !IsCrateSelected(crate) )
+      cout << "  (not selected)";
+    cout << endl;
+    if( fDecodeCount.empty() )
+      continue;
+    for( UInt_t slot = 0; slot < MAXSLOT; ++slot ) {
+      ULong64_t n = fDecodeCount[idx(crate,slot)];
+      if( n > 0 )
+        cout << "    slot " << setw(2) << slot << ": " << setw(10) << n
+             << "  (" << fixed << setprecision(1)
+             << 100.*n/fPresentCount[crate] << "%)" << endl;
+    }
+  }
+  cout.flags(flags);
+  cout.precision(prec);
+}
+
+//_____________________________________________________________________________
+void THaEvData::SetCrateSelection( const std::vector<UInt_t>& crates )
+{
+  // Decode only the data of the given crates. Decoders skip the data banks
+  // of all other crates in physics events, which saves time if the
+  // analysis uses only a few of the crates present in the data.
+  // An empty list means that no crate is decoded.
+  // Use ClearCrateSelection() to decode all crates again.
+
+  fCrateSel.assign(MAXROC, false);
+  for( auto crate : crates ) {
+    if( crate < MAXROC )
+      fCrateSel[crate] = true;
+  }
+}
+
+//_____________________________________________________________________________
+Bool_t THaEvData::TestHeader()
+{
+  // Evaluate the header filter for the current event and set the status bits
+  // accordingly. Decoders call this after loading the event header data.
+  // Returns false if the event should not be decoded.
+
+  if( !fHeaderFilter )
+    return true;
+  SetBit(kHeaderChecked);
+  if( fHeaderFilter(this) )
+    return true;
+  SetBit(kHeaderRejected);
+  return false;
+}
+
 //_____________________________________________________________________________
 void THaEvData::SetVerbose( Int_t level )
 {
@@ -353,6 +568,7 @@ void THaEvData::PrintOut() const {
 void THaEvData::PrintSlotData( UInt_t crate, UInt_t slot) const {
   // Print the contents of (crate, slot).
   if( GoodIndex(crate,slot)) {
+    DecodeIfDeferred(crate);
     crateslot[idx(crate,slot)]->print();
   } else {
       cout << "THaEvData: Warning: Crate, slot combination";
@@ -412,6 +628,7 @@ void THaEvData::FindUsedSlots() {
 //_____________________________________________________________________________
 Module* THaEvData::GetModule( UInt_t roc, UInt_t slot) const
 {
+  DecodeIfDeferred(roc);
   if( crateslot[idx(roc,slot)] )
     return crateslot[idx(roc,slot)]->GetModule();
   return nullptr;
@@ -21,6 +21,8 @@
 #include <array>
 #include <memory>
 #include <string>
+#include <functional>
+#include <atomic>
 
 class THaBenchmark;
 
@@ -114,6 +116,9 @@ public:
   { return GetScaler(0,0,0); }
   virtual void SetDebugFile( std::ofstream *file ) { fDebugFile = file; };
   virtual Decoder::Module* GetModule( UInt_t roc, UInt_t slot ) const;
+  // False for decoders that read the event records of a special run type
+  // (see THaRunBase::GetRequiredDecoder) instead of raw CODA data
+  virtual Bool_t ReadsRawData() const { return true; }
 
   // Access functions for EPICS (slow control) data
   virtual double GetEpicsData( const char* tag, UInt_t event= 0 ) const;
@@ -123,6 +128,8 @@ public:
   { return false; }
 
   UInt_t GetNslots() const { return fSlotUsed.size(); };
+  // Slot data of used slot #i (i < GetNslots())
+  const Decoder::THaSlotData* GetSlotData( UInt_t i ) const;
   virtual void PrintSlotData( UInt_t crate, UInt_t slot ) const;
   virtual void PrintOut() const;
   virtual void SetRunTime( ULong64_t tloc );
@@ -139,6 +146,41 @@ public:
   void    SetOrigPS( Int_t event_type );
   TString GetOrigPS() const;
 
+  // Optional filter for physics events, called by LoadEvent with only the
+  // event header data (event type, number and trigger bits) available.
+  // If it returns false, the event's ROC data are not decoded.
+  using HeaderFilter_t = std::function<bool(const THaEvData*)>;
+  void    SetHeaderFilter( HeaderFilter_t filter );
+  Bool_t  HeaderFilterEnabled() const { return static_cast<bool>(fHeaderFilter); }
+  // Status of the most recent event with respect to the header filter
+  Bool_t  IsHeaderChecked() const;
+  Bool_t  IsHeaderRejected() const;
+
+  // Selective decoding. If a crate selection is set, only the data of the
+  // selected crates are decoded. Raw data of all crates remain available.
+  void    SetCrateSelection( const std::vector<UInt_t>& crates );
+  void    ClearCrateSelection() { fCrateSel.clear(); }
+  Bool_t  HasCrateSelection() const { return !fCrateSel.empty(); }
+  Bool_t  IsCrateSelected( UInt_t crate ) const;
+
+  // Lazy decoding. If enabled, decoders supporting it only locate the crate
+  // data of physics events in LoadEvent(). Each crate is then decoded the
+  // first time one of its slots is accessed.
+  void    EnableLazyDecoding( Bool_t enable=true );
+  Bool_t  LazyDecodingEnabled() const;
+
+  // Parallel decoding of event blocks. Decoders supporting it decode the
+  // data of multiblock events with up to 'n' threads. 1 = sequential.
+  void    SetDecodeThreads( UInt_t n ) { fDecodeThreads = n > 0 ? n : 1; }
+  UInt_t  GetDecodeThreads() const { return fDecodeThreads; }
+
+  // Decoding statistics: number of events in which a slot was decoded,
+  // and in which a crate was present in the data
+  ULong64_t GetSlotDecodeCount( UInt_t crate, UInt_t slot ) const;
+  ULong64_t GetCratePresentCount( UInt_t crate ) const;
+  void    ResetDecodeCounts();
+  void    PrintDecodeCounts() const;
+
   UInt_t  GetInstance() const { return fInstance; }
   static UInt_t GetInstances() { return fgInstances.CountBits(); }
 
@@ -164,9 +206,26 @@ protected:
   enum {
     kHelicityEnabled = BIT(14),
     kScalersEnabled  = BIT(15),
-    kPrescanMode     = BIT(16)
+    kPrescanMode     = BIT(16),
+    kHeaderChecked   = BIT(17),  // Header filter evaluated for this event
+    kHeaderRejected  = BIT(18),  // Header filter rejected this event
+    kLazyDecoding    = BIT(19)
   };
 
+  // Apply header filter, if any. Returns false if event is rejected.
+  Bool_t  TestHeader();
+
+  // Lazy decoding support. Decoders defer crates with DeferCrate() and
+  // implement DecodeDeferred(). The data access functions call
+  // DecodeIfDeferred() before accessing any slot data.
+  void    DeferCrate( UInt_t crate );
+  void    ClearDeferred();
+  void    DecodeIfDeferred( UInt_t crate ) const;
+  void    LoadDeferred( UInt_t crate ) const;
+  virtual Int_t DecodeDeferred( UInt_t crate );
+  void    CountPresent( UInt_t crate );
+  void    CountDecoded( UInt_t crate, UInt_t slot );
+
   // Initialization routines
   virtual Int_t init_cmap();
   virtual Int_t init_slotdata();
@@ -231,6 +290,16 @@ protected:
 
   TObject* fExtra;   // additional member data, for binary compatibility
 
+  HeaderFilter_t fHeaderFilter;  //! Pre-decode event filter
+  std::vector<bool> fCrateSel;   //! Crates to decode (empty = all)
+
+  struct LazyState;
+  std::unique_ptr<LazyState> fLazy;    //! Deferred crates and lock
+  mutable std::atomic<UInt_t> fNdeferred; //! Number of crates still deferred
+  std::vector<ULong64_t> fDecodeCount; //! Per-slot decode counters
+  std::vector<ULong64_t> fPresentCount;//! Per-crate presence counters
+  UInt_t fDecodeThreads;               //! Threads for decoding event blocks
+
   ClassDef(THaEvData,0)  // Base class for raw data decoders
 
 };
@@ -256,6 +325,18 @@ inline Bool_t THaEvData::GoodIndex( UInt_t crate, UInt_t slot ) const {
   return (GoodCrateSlot(crate,slot) && crateslot[idx(crate,slot)] );
 }
 
+inline void THaEvData::DecodeIfDeferred( UInt_t crate ) const {
+  // Decode 'crate' now if its decoding was deferred (lazy decoding)
+  if( fNdeferred.load(std::memory_order_acquire) > 0 )
+    LoadDeferred(crate);
+}
+
+inline const Decoder::THaSlotData* THaEvData::GetSlotData( UInt_t i ) const {
+  assert( i < fSlotUsed.size() );
+  DecodeIfDeferred(fSlotUsed[i] / Decoder::MAXSLOT);
+  return crateslot[fSlotUsed[i]].get();
+}
+
 inline UInt_t THaEvData::GetRocLength( UInt_t crate ) const {
   assert( crate < rocdat.size() );
   return rocdat[crate].len;
@@ -265,6 +346,7 @@ inline UInt_t THaEvData::GetNumHits( UInt_t crate, UInt_t slot,
                                      UInt_t chan ) const {
   // Number hits in crate, slot, channel
   assert( GoodCrateSlot(crate,slot) );
+  DecodeIfDeferred(crate);
   if( crateslot[idx(crate,slot)] )
     return crateslot[idx(crate,slot)]->getNumHits(chan);
   return 0;
@@ -274,12 +356,14 @@ inline UInt_t THaEvData::GetData( UInt_t crate, UInt_t slot, UInt_t chan,
                                   UInt_t hit ) const {
   // Return the data in crate, slot, channel #chan and hit# hit
   assert( GoodIndex(crate,slot) );
+  DecodeIfDeferred(crate);
   return crateslot[idx(crate,slot)]->getData(chan,hit);
 }
 
 inline UInt_t THaEvData::GetNumRaw( UInt_t crate, UInt_t slot ) const {
   // Number of raw words in crate, slot
   assert( GoodCrateSlot(crate,slot) );
+  DecodeIfDeferred(crate);
   if( crateslot[idx(crate,slot)] )
     return crateslot[idx(crate,slot)]->getNumRaw();
   return 0;
@@ -289,6 +373,7 @@ inline UInt_t THaEvData::GetRawData( UInt_t crate, UInt_t slot,
                                      UInt_t hit ) const {
   // Raw words in crate, slot
   assert( GoodIndex(crate,slot) );
+  DecodeIfDeferred(crate);
   return crateslot[idx(crate,slot)]->getRawData(hit);
 }
 
@@ -296,13 +381,15 @@ inline UInt_t THaEvData::GetRawData( UInt_t crate, UInt_t slot, UInt_t chan,
                                      UInt_t hit ) const {
   // Return the Rawdata in crate, slot, channel #chan and hit# hit
   assert( GoodIndex(crate,slot) );
+  DecodeIfDeferred(crate);
   return crateslot[idx(crate,slot)]->getRawData(chan,hit);
 }
 
 inline UInt_t THaEvData::GetRawData( UInt_t i ) const {
-  // Raw words in evbuffer at location #i.
-  assert( buffer && i < GetEvLength() );
-  return buffer[i];
+  // Raw words in evbuffer at location #i. Returns 0 if the raw buffer
+  // is not available (e.g. physics events replayed from a hit cache).
+  assert( i < GetEvLength() );
+  return buffer ? buffer[i] : 0;
 }
 
 inline UInt_t THaEvData::GetRawData( UInt_t crate, UInt_t i ) const {
@@ -313,9 +400,9 @@ inline UInt_t THaEvData::GetRawData( UInt_t crate, UInt_t i ) const {
 
 inline const UInt_t* THaEvData::GetRawDataBuffer( UInt_t crate ) const {
   // Direct access to the event buffer for the given crate,
-  // e.g. for fast header word searches
+  // e.g. for fast header word searches. nullptr if there is no raw buffer.
   assert( crate < rocdat.size() );
-  return buffer+rocdat[crate].pos;
+  return buffer ? buffer+rocdat[crate].pos : nullptr;
 }
 
 inline Bool_t THaEvData::InCrate( UInt_t crate, UInt_t i ) const {
@@ -331,6 +418,7 @@ inline Bool_t THaEvData::InCrate( UInt_t crate, UInt_t i ) const {
 inline UInt_t THaEvData::GetNumChan( UInt_t crate, UInt_t slot ) const {
   // Get number of unique channels hit
   assert( GoodCrateSlot(crate,slot) );
+  DecodeIfDeferred(crate);
   if( crateslot[idx(crate,slot)] )
     return crateslot[idx(crate,slot)]->getNumChan();
   return 0;
@@ -340,6 +428,7 @@ inline UInt_t THaEvData::GetNextChan( UInt_t crate, UInt_t slot,
                                       UInt_t index ) const {
   // Get list of unique channels hit (indexed by index=0,getNumChan()-1)
   assert( GoodIndex(crate,slot) );
+  DecodeIfDeferred(crate);
   assert( index < GetNumChan(crate,slot) );
   return crateslot[idx(crate,slot)]->getNextChan(index);
 }
@@ -393,12 +482,37 @@ Bool_t THaEvData::ScalersEnabled() const {
   return TestBit(kScalersEnabled);
 }
 
+inline
+Bool_t THaEvData::LazyDecodingEnabled() const {
+  // Test if lazy decoding enabled
+  return TestBit(kLazyDecoding);
+}
+
 inline
 Bool_t THaEvData::PrescanModeEnabled() const {
   // Test if prescan mode enabled
   return TestBit(kPrescanMode);
 }
 
+inline
+Bool_t THaEvData::IsHeaderChecked() const {
+  // Test if header filter was evaluated for the current event
+  return TestBit(kHeaderChecked);
+}
+
+inline
+Bool_t THaEvData::IsCrateSelected( UInt_t crate ) const {
+  // Test if data of the given crate are to be decoded
+  return fCrateSel.empty() || (crate < fCrateSel.size() && fCrateSel[crate]);
+}
+
+inline
+Bool_t THaEvData::IsHeaderRejected() const {
+  // Test if current event was rejected by the header filter. If so, no
+  // crate/slot data are available for this event.
+  return TestBit(kHeaderRejected);
+}
+
 // Dummy versions of EPICS data access functions. These will always fail
 // in debug mode unless IsLoadedEpics is changed. This is by design -
 // clients should never try to retrieve data that are not loaded.
@@ -24,6 +24,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <sstream>
+#include <algorithm>
 
 using namespace std;
 
@@ -220,17 +221,10 @@ UInt_t THaSlotData::LoadNextEvBuffer() {
 }
 
 //_____________________________________________________________________________
-Int_t THaSlotData::loadData(const char* type, UInt_t chan, UInt_t dat, UInt_t raw) {
-
-  const int very_verb=1;
+inline
+Int_t THaSlotData::loadHit(const char* type, UInt_t chan, UInt_t dat, UInt_t raw) {
+  // Store one hit. Implementation of loadData() for an initialized slot.
 
-  if( !didini ) {
-    if (very_verb) {  // this might be your problem.
-      cout << "THaSlotData: ERROR: Did not init slot."<<endl;
-      cout << "  Fix your cratemap."<<endl;
-    }
-    return SD_ERR;
-  }
   if ( chan >= fNchan) {
     if (VERBOSE) {
       cout << "THaSlotData: Warning in loadData: channel ";
@@ -302,6 +296,46 @@ Int_t THaSlotData::loadData(const char* type, UInt_t chan, UInt_t dat, UInt_t ra
   return SD_OK;
 }
 
+//_____________________________________________________________________________
+Int_t THaSlotData::loadData(const char* type, UInt_t chan, UInt_t dat, UInt_t raw) {
+
+  const int very_verb=1;
+
+  if( !didini ) {
+    if (very_verb) {  // this might be your problem.
+      cout << "THaSlotData: ERROR: Did not init slot."<<endl;
+      cout << "  Fix your cratemap."<<endl;
+    }
+    return SD_ERR;
+  }
+  return loadHit(type, chan, dat, raw);
+}
+
+//_____________________________________________________________________________
+UInt_t THaSlotData::loadData( const char* type, const UInt_t* chan,
+                              const UInt_t* dat, const UInt_t* raw, UInt_t n ) {
+  // Load 'n' hits at once. Equivalent to calling loadData() for each hit,
+  // but the data arrays are grown at most once. Stops at the first hit for
+  // which loadData() would not return SD_OK. Returns the index of that
+  // hit, or 'n' if all hits returned SD_OK.
+
+  if( !didini ) {
+    cout << "THaSlotData: ERROR: Did not init slot."<<endl;
+    cout << "  Fix your cratemap."<<endl;
+    return 0;
+  }
+  if( numraw + n > data.size() ) {
+    size_t allocd = std::max<size_t>(2*data.size(), numraw + n);
+    rawData.resize(allocd);
+    data.resize(allocd);
+  }
+  for( UInt_t i = 0; i < n; ++i ) {
+    if( loadHit(type, chan[i], dat[i], raw[i]) != SD_OK )
+      return i;
+  }
+  return n;
+}
+
 //_____________________________________________________________________________
 int THaSlotData::loadData(UInt_t chan, UInt_t dat, UInt_t raw) {
   // NEW (6/2014).
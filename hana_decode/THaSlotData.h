@@ -60,6 +60,9 @@ public:
        void   clearEvent();                          // clear event counters
        Int_t  loadData( const char* type, UInt_t chan, UInt_t dat, UInt_t raw );
        Int_t  loadData( UInt_t chan, UInt_t dat, UInt_t raw );
+       // Bulk version, see implementation
+       UInt_t loadData( const char* type, const UInt_t* chan,
+                        const UInt_t* dat, const UInt_t* raw, UInt_t n );
 
        // new
        UInt_t LoadIfSlot( const UInt_t* evbuffer, const UInt_t* pstop );
@@ -102,6 +105,7 @@ private:
        UInt_t fNchan;       // Number of channels for this device
 
        void compressdataindexImpl(UInt_t numidx);
+       Int_t loadHit( const char* type, UInt_t chan, UInt_t dat, UInt_t raw );
 
        ClassDef(THaSlotData,0)   //  Data in one slot of fastbus, vme, camac
 };
@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// codagen
+//
+// Write a synthetic CODA run for decoder and analysis benchmarks, see
+// Decoder::CodaEventGenerator.
+//
+// Usage: codagen [options] OUTPUT
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "CodaEventGenerator.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>    // for strdup
+#include <getopt.h>
+#include <libgen.h>   // for POSIX basename()
+#include <string>
+
+using namespace std;
+using Decoder::CodaEventGenerator;
+
+static string prgname;
+
+//-----------------------------------------------------------------------------
+static void usage()
+{
+  // Print usage message and exit with error code
+
+  cerr << "Usage: " << prgname << " [options] OUTPUT" << endl
+       << " -n NTRIG    number of triggers (default 10000)" << endl
+       << " -c NAME     crate map database name (default \"cratemap\")" << endl
+       << " -m FILE     read crate map from FILE" << endl
+       << " -v VERSION  CODA version, 2 or 3 (default 3)" << endl
+       << " -b LEVEL    block level, CODA 3 only (default 1)" << endl
+       << " -o OCC      channel occupancy, 0-1 (default 0.1)" << endl
+       << " -r RATE     trigger rate in Hz (default 1000)" << endl
+       << " -f MODE     FADC250 mode, 1, 3, 9 or 10 (default 10)" << endl
+       << " -w NSAMP    FADC250 window in samples (default 50)" << endl
+       << " -k SIZE     track cluster size in 1877 TDCs, 0 = none (default 0)" << endl
+       << " -p PROB     probability of a track cluster per 1877 (default 1)" << endl
+       << " -e N        EPICS event every N triggers, 0 = none (default 10000)" << endl
+       << " -S N        scaler event every N triggers, 0 = none (default 1000)" << endl
+       << " -R RUN      run number (default 1)" << endl
+       << " -t TIME     run start as Unix time (default now)" << endl
+       << " -s SEED     random number seed (default 4357)" << endl
+       << " -h          print this help" << endl;
+  exit(255);
+}
+
+//-----------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+  char* argv0 = strdup(argv[0]);
+  prgname = basename(argv0);
+  free(argv0);
+
+  CodaEventGenerator gen;
+  ULong64_t ntrig = 10000, run_time = 0;
+  UInt_t clsize = 0;
+  Double_t clprob = 1.0;
+  string mapfile;
+
+  int opt;
+  while( (opt = getopt(argc, argv, "hn:c:m:v:b:o:r:f:w:k:p:e:S:R:t:s:")) != -1 ) {
+    switch( opt ) {
+    case 'n':
+      ntrig = strtoull(optarg, nullptr, 10);
+      break;
+    case 'c':
+      gen.SetCrateMapName(optarg);
+      break;
+    case 'm':
+      mapfile = optarg;
+      break;
+    case 'v':
+      gen.SetCodaVersion(atoi(optarg));
+      break;
+    case 'b':
+      gen.SetBlockLevel(strtoul(optarg, nullptr, 10));
+      break;
+    case 'o':
+      gen.SetOccupancy(atof(optarg));
+      break;
+    case 'r':
+      gen.SetEventRate(atof(optarg));
+      break;
+    case 'f':
+      gen.SetFadcMode(strtoul(optarg, nullptr, 10));
+      break;
+    case 'w':
+      gen.SetFadcWindow(strtoul(optarg, nullptr, 10));
+      break;
+    case 'k':
+      clsize = strtoul(optarg, nullptr, 10);
+      break;
+    case 'p':
+      clprob = atof(optarg);
+      break;
+    case 'e':
+      gen.SetEpicsInterval(strtoul(optarg, nullptr, 10));
+      break;
+    case 'S':
+      gen.SetScalerInterval(strtoul(optarg, nullptr, 10));
+      break;
+    case 'R':
+      gen.SetRunNumber(strtoul(optarg, nullptr, 10));
+      break;
+    case 't':
+      run_time = strtoull(optarg, nullptr, 10);
+      break;
+    case 's':
+      gen.SetSeed(strtoul(optarg, nullptr, 10));
+      break;
+    case 'h':
+    default:
+      usage();
+    }
+  }
+  if( argc - optind != 1 ) {
+    cerr << "Error: Must specify exactly one OUTPUT file" << endl;
+    usage();
+  }
+  const char* outfile = argv[optind];
+  gen.SetClusterSize(clsize, clprob);
+
+  if( !mapfile.empty() ) {
+    ifstream ifs(mapfile);
+    if( !ifs ) {
+      cerr << "Cannot open crate map file " << mapfile << endl;
+      return 1;
+    }
+    ostringstream ostr;
+    ostr << ifs.rdbuf();
+    gen.SetCrateMapText(ostr.str().c_str());
+  }
+
+  if( gen.Init(run_time) != 0 )
+    return 1;
+  gen.Print();
+  Long64_t nev = gen.WriteFile(outfile, ntrig);
+  if( nev < 0 )
+    return 1;
+  cout << "Wrote " << nev << " events with " << gen.GetNtrig()
+       << " triggers to " << outfile << endl;
+  return 0;
+}
@@ -6,6 +6,7 @@
 
 #pragma link C++ class Decoder::CodaDecoder+;
 #pragma link C++ class Decoder::CodaDecoder::BankInfo+;
+#pragma link C++ class Decoder::CodaEventGenerator+;
 #pragma link C++ class Decoder::Module+;
 #pragma link C++ class Decoder::Module::ModuleType+;
 #pragma link C++ class Decoder::Module::TypeSet_t+;
@@ -0,0 +1,278 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// CheckpointHelicity - Test that the helicity predicted by QWEAK helicity   //
+// detectors after resuming a replay from a checkpoint is the same as in an  //
+// uninterrupted replay.                                                     //
+//                                                                           //
+// Two apparatuses each contain a helicity detector named "hel", decoding    //
+// independent synthetic helicity streams. Their states are saved and        //
+// restored with the functions used by THaAnalyzer::WriteCheckpoint and      //
+// THaAnalyzer::EndResume.                                                   //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CheckpointHelicity.h"
+#include "AnalysisContext.h"
+#include "Checkpoint.h"
+#include "THaAnalyzer.h"
+#include "THaApparatus.h"
+#include "THaQWEAKHelicity.h"
+#include "HelicityLFSR.h"
+#include "TRandom3.h"
+#include "TString.h"
+#include <memory>
+#include <vector>
+
+using namespace std;
+using HallA::HelicityLFSR;
+
+namespace {
+
+const char* const kAppNames[] = { "L", "R" };
+
+// Reported helicity within a quartet relative to its first window (+--+)
+const UInt_t kQuartet[] = { 0, 1, 1, 0 };
+
+// Helicity data of one helicity window
+struct Window_t {
+  UInt_t hel;
+  UInt_t pat;
+};
+
+// Helicity data of one event: the windows read from the ring buffer and
+// the input register (TIR) readings
+struct Event_t {
+  UInt_t first;   // First window in the ring
+  UInt_t n;       // Number of windows in the ring
+  UInt_t heltir;
+  UInt_t pattir;
+};
+
+// Synthetic helicity data stream
+struct Stream_t {
+  vector<Window_t> windows;
+  vector<Event_t>  events;
+};
+
+void MakeStream( Stream_t& stream, UInt_t seed, Int_t nev, TRandom3& rnd )
+{
+  // Generate 'nev' events of quartets whose polarities follow the QWEAK
+  // generator starting from 'seed'. The TIR of each event reports the
+  // window that the next event finds at fOffsetTIRvsRing-1 in its ring.
+
+  const HelicityLFSR& lfsr = HelicityLFSR::QWEAK();
+  UInt_t first = 0;
+  stream.events.resize(nev);
+  for( auto& ev : stream.events ) {
+    ev.first = first;
+    ev.n = 1 + rnd.Integer(4);
+    first += ev.n;
+  }
+  UInt_t bit = 0;
+  for( UInt_t w = 0; w < first + 3; ++w ) {
+    UInt_t phase = w % 4;
+    if( phase == 0 ) {
+      bit = lfsr.Bit(seed, 1);
+      seed = lfsr.Jump(seed, 1);
+    }
+    stream.windows.push_back({ bit ^ kQuartet[phase], phase == 0 });
+  }
+  for( auto& ev : stream.events ) {
+    const Window_t& w = stream.windows[ev.first + ev.n + 2];
+    ev.heltir = w.hel;
+    ev.pattir = w.pat;
+  }
+}
+
+// Test apparatus without reconstruction
+class TestApparatus : public THaApparatus {
+public:
+  explicit TestApparatus( const char* name )
+    : THaApparatus(name, "Test apparatus") {}
+  virtual Int_t Reconstruct() { return 0; }
+  using THaApparatus::MakePrefix;
+};
+
+// QWEAK helicity detector decoding a synthetic stream
+class QWEAKDriver : public THaQWEAKHelicity {
+public:
+  explicit QWEAKDriver( const char* name )
+    : THaQWEAKHelicity(name, "Test helicity detector") {}
+  using THaQWEAKHelicity::MakePrefix;
+
+  // Process event 'iev' of 'stream' the way Decode() does
+  void Process( const Stream_t& stream, UInt_t iev ) {
+    Clear();
+    const Event_t& ev = stream.events[iev];
+    fIRing = ev.n;
+    for( UInt_t i = 0; i < ev.n; ++i ) {
+      const Window_t& w = stream.windows[ev.first + i];
+      fHelicityRing[i] = w.hel;
+      fPatternRing[i] = w.pat;
+      fTimeStampRing[i] = ev.first + i + 1;
+    }
+    fHelicityTir = ev.heltir;
+    fPatternTir = ev.pattir;
+    fTSettleTir = 0;
+    LoadHelicity(iev);
+    CheckTIRvsRing(iev);
+    fValidHel = (fErrorCode == 0);
+  }
+};
+
+// Apparatuses with their helicity detectors. The detectors are owned by
+// the apparatuses.
+struct Setup_t {
+  vector<unique_ptr<TestApparatus>> apps;
+  vector<QWEAKDriver*> dets;
+};
+
+void MakeSetup( Setup_t& setup )
+{
+  for( const auto* name : kAppNames ) {
+    auto* app = new TestApparatus(name);
+    auto* det = new QWEAKDriver("hel");
+    app->AddDetector(det);
+    app->MakePrefix();
+    det->MakePrefix();
+    setup.apps.emplace_back(app);
+    setup.dets.push_back(det);
+  }
+}
+
+// Helicity and validity flag of each event of one detector
+struct Result_t {
+  vector<Int_t>  hel;
+  vector<Bool_t> valid;
+};
+
+void Replay( Setup_t& setup, const vector<Stream_t>& streams,
+             Int_t begin, Int_t end, vector<Result_t>& results )
+{
+  results.resize(setup.dets.size());
+  for( Int_t iev = begin; iev < end; ++iev ) {
+    for( size_t i = 0; i < setup.dets.size(); ++i ) {
+      QWEAKDriver* det = setup.dets[i];
+      det->Process(streams[i], iev);
+      results[i].hel.push_back(det->GetHelicity());
+      results[i].valid.push_back(det->HelicityValid());
+    }
+  }
+}
+
+// Access to the module state functions of the analyzer, using the
+// apparatuses of the given setup as analysis modules
+class CkptAnalyzer : public THaAnalyzer {
+public:
+  explicit CkptAnalyzer( const Setup_t& setup ) {
+    for( const auto& app : setup.apps )
+      fAnalysisModules.push_back(app.get());
+  }
+  using THaAnalyzer::SaveModuleStates;
+  using THaAnalyzer::RestoreModuleStates;
+};
+
+} // namespace
+
+namespace Podd {
+namespace Tests {
+
+//_____________________________________________________________________________
+CheckpointHelicity::CheckpointHelicity( const char* name,
+                                        const char* description ) :
+  UnitTest(name,description)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+Int_t CheckpointHelicity::Test()
+{
+  // Compare the helicity of an uninterrupted replay with that of a replay
+  // resumed from a checkpoint
+
+  const char* const here = "Test";
+
+  // Keep the objects of this test out of the global lists
+  AnalysisContext context;
+  AnalysisContext::Scope scope(&context);
+
+  const size_t napps = sizeof(kAppNames)/sizeof(kAppNames[0]);
+  TRandom3 rnd(4357);
+  vector<Stream_t> streams(napps);
+  for( auto& stream : streams )
+    MakeStream(stream, rnd.Integer(HelicityLFSR::QWEAK().GetMask()) + 1,
+               fgNevents, rnd);
+
+  // Uninterrupted replay
+  vector<Result_t> ref;
+  {
+    Setup_t setup;
+    MakeSetup(setup);
+    Replay(setup, streams, 0, fgNevents, ref);
+  }
+  for( size_t i = 0; i < napps; ++i ) {
+    for( Int_t iev = fgNckpt; iev < fgNevents; ++iev ) {
+      if( !ref[i].valid[iev] ) {
+        Error( Here(here), "%s.hel: no valid helicity for event %d of "
+               "uninterrupted replay", kAppNames[i], iev );
+        return 1;
+      }
+    }
+  }
+
+  // Replay interrupted after the checkpoint
+  Checkpoint ckpt(1, "test");
+  {
+    Setup_t setup;
+    MakeSetup(setup);
+    vector<Result_t> results;
+    Replay(setup, streams, 0, fgNckpt, results);
+    CkptAnalyzer analyzer(setup);
+    analyzer.SaveModuleStates(ckpt);
+  }
+  vector<Double_t> state;
+  for( const auto* name : kAppNames ) {
+    TString key = Form("%s.hel.", name);
+    if( !ckpt.GetState(key, state) ) {
+      Error( Here(here), "No state for %s in checkpoint", key.Data() );
+      return 2;
+    }
+  }
+
+  // Resumed replay
+  vector<Result_t> resumed;
+  {
+    Setup_t setup;
+    MakeSetup(setup);
+    CkptAnalyzer analyzer(setup);
+    analyzer.RestoreModuleStates(ckpt);
+    Replay(setup, streams, fgNckpt, fgNevents, resumed);
+  }
+
+  // Compare
+  for( size_t i = 0; i < napps; ++i ) {
+    for( Int_t iev = fgNckpt; iev < fgNevents; ++iev ) {
+      Int_t j = iev - fgNckpt;
+      if( resumed[i].hel[j] != ref[i].hel[iev] ||
+          resumed[i].valid[j] != ref[i].valid[iev] ) {
+        Error( Here(here), "%s.hel: event %d helicity %d (valid %d) after "
+               "resume, expected %d (valid %d)", kAppNames[i], iev,
+               resumed[i].hel[j], resumed[i].valid[j], ref[i].hel[iev],
+               ref[i].valid[iev] );
+        return 3;
+      }
+    }
+  }
+
+  if( fDebug > 0 )
+    Info( Here(here), "All tests passed" );
+  return 0;
+}
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClassImp(Podd::Tests::CheckpointHelicity)
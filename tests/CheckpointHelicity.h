@@ -0,0 +1,40 @@
+#ifndef Podd_Tests_CheckpointHelicity_h_
+#define Podd_Tests_CheckpointHelicity_h_
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// CheckpointHelicity unit test                                              //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UnitTest.h"
+
+namespace Podd {
+namespace Tests {
+
+class CheckpointHelicity : public UnitTest {
+
+public:
+  explicit CheckpointHelicity( const char* name = "checkpoint_helicity",
+                               const char* description =
+                               "Helicity prediction of a resumed replay" );
+
+  virtual Int_t Test();
+
+protected:
+
+  // Number of events of the replay
+  static const Int_t fgNevents = 1000;
+  // Event number of the checkpoint. The predictors must have gathered
+  // their seeds by then.
+  static const Int_t fgNckpt = 400;
+
+  ClassDef(CheckpointHelicity,0)
+};
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
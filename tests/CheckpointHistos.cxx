@@ -0,0 +1,237 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// CheckpointHistos - Test that a replay interrupted at a checkpoint and     //
+// resumed yields the same histograms as an uninterrupted replay.            //
+//                                                                           //
+// The histograms of an output definition are filled from variables that     //
+// change from event to event. At the checkpoint, the histograms are         //
+// collected the way THaAnalyzer::WriteCheckpoint does; the resumed replay   //
+// starts from copies of them, as in THaAnalyzer::ResumeOutput.              //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CheckpointHistos.h"
+#include "AnalysisContext.h"
+#include "Checkpoint.h"
+#include "THaAnalyzer.h"
+#include "THaOutput.h"
+#include "THaVarList.h"
+#include "THaVhist.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TRandom3.h"
+#include "TString.h"
+#include "TSystem.h"
+#include <fstream>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const char* const kHistNames[] = { "hx", "hxy", "hxcut" };
+
+const char* const kOutputDef =
+  "cut   xlow  T.x<0.5\n"
+  "TH1F  hx    'x'        T.x      100 0 1\n"
+  "TH2F  hxy   'x vs y'   T.x T.y  20 0 1 20 0 1\n"
+  "TH1F  hxcut 'x, x<0.5' T.x      50 0 1 xlow\n";
+
+// Access to the checkpoint functions of the analyzer, using the given
+// output file and output definitions
+class CkptAnalyzer : public THaAnalyzer {
+public:
+  CkptAnalyzer( TFile* file, THaOutput* output ) {
+    fFile = file;
+    fOutput = output;
+  }
+  virtual ~CkptAnalyzer() {
+    // Not owned
+    fFile = nullptr;
+    fOutput = nullptr;
+  }
+  using THaAnalyzer::CheckpointOutput;
+};
+
+// Output file with its output definitions
+struct Output_t {
+  unique_ptr<TFile>     file;
+  unique_ptr<THaOutput> output;
+};
+
+Int_t OpenOutput( Output_t& out, const TString& filename,
+                  const TString& deffile )
+{
+  out.file.reset(TFile::Open(filename, "RECREATE"));
+  if( !out.file || out.file->IsZombie() )
+    return -1;
+  out.output.reset(new THaOutput);
+  if( out.output->Init(deffile) != 0 )
+    return -2;
+  return 0;
+}
+
+void CloseOutput( Output_t& out )
+{
+  out.output->End();
+  out.output.reset();
+}
+
+} // namespace
+
+namespace Podd {
+namespace Tests {
+
+//_____________________________________________________________________________
+CheckpointHistos::CheckpointHistos( const char* name, const char* description ) :
+  UnitTest(name,description)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+Int_t CheckpointHistos::Replay( const TString& deffile, const TString& stem )
+{
+  // Run the uninterrupted, interrupted and resumed replays with output
+  // files <stem>_{ref,int,res}.root and compare the histograms
+
+  const char* const here = "Replay";
+
+  Double_t x = 0, y = 0;
+  THaVarList* vars = AnalysisContext::Current()->GetVars();
+  vars->Define("T.x", "x", x);
+  vars->Define("T.y", "y", y);
+
+  TRandom3 rnd(4357);
+  vector<pair<Double_t,Double_t>> events(fgNevents);
+  for( auto& ev : events )
+    ev = make_pair(rnd.Rndm(), rnd.Rndm());
+
+  // Uninterrupted replay
+  Output_t ref;
+  if( OpenOutput(ref, stem + "_ref.root", deffile) != 0 ) {
+    Error( Here(here), "Cannot set up reference output" );
+    return 1;
+  }
+  for( const auto& ev : events ) {
+    x = ev.first; y = ev.second;
+    ref.output->Process();
+  }
+  CloseOutput(ref);
+
+  // Replay interrupted after the checkpoint. Keep copies of the histograms
+  // in the checkpoint.
+  vector<unique_ptr<TH1>> saved;
+  {
+    Output_t interrupted;
+    if( OpenOutput(interrupted, stem + "_int.root", deffile) != 0 ) {
+      Error( Here(here), "Cannot set up interrupted output" );
+      return 2;
+    }
+    for( Int_t i = 0; i < fgNckpt; ++i ) {
+      x = events[i].first; y = events[i].second;
+      interrupted.output->Process();
+    }
+    CkptAnalyzer analyzer(interrupted.file.get(), interrupted.output.get());
+    Checkpoint ckpt(1, "test");
+    vector<TH1*> hists;
+    analyzer.CheckpointOutput(ckpt, hists);
+    for( const auto* hist : hists ) {
+      auto* h = static_cast<TH1*>(hist->Clone());
+      h->SetDirectory(nullptr);
+      saved.emplace_back(h);
+    }
+  }
+  const size_t nhist = sizeof(kHistNames)/sizeof(kHistNames[0]);
+  if( saved.size() != nhist ) {
+    Error( Here(here), "Checkpoint has %lu histograms, expected %lu",
+           static_cast<unsigned long>(saved.size()),
+           static_cast<unsigned long>(nhist) );
+    return 3;
+  }
+
+  // Resumed replay
+  Output_t resumed;
+  if( OpenOutput(resumed, stem + "_res.root", deffile) != 0 ) {
+    Error( Here(here), "Cannot set up resumed output" );
+    return 4;
+  }
+  for( const auto& h : saved ) {
+    auto* hist = dynamic_cast<TH1*>(resumed.file->Get(h->GetName()));
+    if( !hist ) {
+      Error( Here(here), "No histogram %s in resumed output", h->GetName() );
+      return 5;
+    }
+    hist->Add(h.get());
+  }
+  for( Int_t i = fgNckpt; i < fgNevents; ++i ) {
+    x = events[i].first; y = events[i].second;
+    resumed.output->Process();
+  }
+  CloseOutput(resumed);
+
+  // Compare
+  for( const auto* name : kHistNames ) {
+    auto* href = dynamic_cast<TH1*>(ref.file->Get(name));
+    auto* hres = dynamic_cast<TH1*>(resumed.file->Get(name));
+    if( !href || !hres || href->GetNcells() != hres->GetNcells() ) {
+      Error( Here(here), "Histogram %s missing or different", name );
+      return 6;
+    }
+    if( href->GetEntries() != hres->GetEntries() ) {
+      Error( Here(here), "Histogram %s has %.0f entries after resume, "
+             "expected %.0f", name, hres->GetEntries(), href->GetEntries() );
+      return 7;
+    }
+    for( Int_t bin = 0; bin < href->GetNcells(); ++bin ) {
+      if( href->GetBinContent(bin) != hres->GetBinContent(bin) ) {
+        Error( Here(here), "Histogram %s bin %d: %g after resume, "
+               "expected %g", name, bin, hres->GetBinContent(bin),
+               href->GetBinContent(bin) );
+        return 8;
+      }
+    }
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t CheckpointHistos::Test()
+{
+  // Compare the histograms of an uninterrupted replay with those of a
+  // replay resumed from a checkpoint
+
+  // Keep the variables of this test out of the global lists
+  AnalysisContext context;
+  AnalysisContext::Scope scope(&context);
+
+  TString stem = Form("%s/ckpt_histos_%d", gSystem->TempDirectory(),
+                      gSystem->GetPid());
+  TString deffile = stem + ".def";
+  {
+    ofstream def(deffile.Data());
+    def << kOutputDef;
+  }
+
+  // Fills must still be buffered at the checkpoint
+  Bool_t was_buffered = THaVhist::FillBuffersEnabled();
+  THaVhist::EnableFillBuffers();
+  Int_t ret = Replay(deffile, stem);
+  THaVhist::EnableFillBuffers(was_buffered);
+
+  gSystem->Unlink(deffile);
+  for( const char* suffix : { "_ref.root", "_int.root", "_res.root" } )
+    gSystem->Unlink(stem + suffix);
+
+  if( ret == 0 && fDebug > 0 )
+    Info( Here("Test"), "All tests passed" );
+  return ret;
+}
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClassImp(Podd::Tests::CheckpointHistos)
@@ -0,0 +1,45 @@
+#ifndef Podd_Tests_CheckpointHistos_h_
+#define Podd_Tests_CheckpointHistos_h_
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// CheckpointHistos unit test                                                //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UnitTest.h"
+
+class TString;
+
+namespace Podd {
+namespace Tests {
+
+class CheckpointHistos : public UnitTest {
+
+public:
+  explicit CheckpointHistos( const char* name = "checkpoint_histos",
+                             const char* description =
+                             "Histograms of a resumed replay" );
+
+  virtual Int_t Test();
+
+protected:
+
+  // Number of events of the replay
+  static const Int_t fgNevents = 1000;
+  // Event number of the checkpoint. Must be less than the default
+  // THaVhist flush interval so that fills (enabled by the test) are
+  // still buffered.
+  static const Int_t fgNckpt = 400;
+
+  Int_t Replay( const TString& deffile, const TString& stem );
+
+  ClassDef(CheckpointHistos,0)
+};
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// HelicityJump - Test the jump-ahead and seed recovery of                   //
+// HallA::HelicityLFSR against the bitwise helicity generators of            //
+// THaQWEAKHelicity and THaG0Helicity                                        //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HelicityJump.h"
+#include "HelicityLFSR.h"
+#include "THaQWEAKHelicity.h"
+#include "THaG0Helicity.h"
+#include "TRandom3.h"
+#include <vector>
+#include <utility>
+
+using namespace std;
+using HallA::HelicityLFSR;
+
+namespace {
+
+// Access to the bitwise generators of the helicity decoders
+class QWEAKGenerator : public THaQWEAKHelicity {
+public:
+  using THaQWEAKHelicity::RanBit30;
+};
+
+class G0Generator : public THaG0Helicity {
+public:
+  UInt_t Next( UInt_t& seed ) {
+    fIseed = seed;
+    EHelicity hel = RanBit(1);
+    seed = fIseed & 0xFFFFFF;
+    return (hel == kPlus) ? 1 : 0;
+  }
+  UInt_t Seed( const vector<UInt_t>& readings ) {
+    for( Int_t i = 0; i < kNbits; ++i )
+      fHbits[i] = readings[i];
+    return GetSeed();
+  }
+};
+
+} // namespace
+
+namespace Podd {
+namespace Tests {
+
+//_____________________________________________________________________________
+HelicityJump::HelicityJump( const char* name, const char* description ) :
+  UnitTest(name,description)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+Int_t HelicityJump::TestQWEAK()
+{
+  const char* const here = "TestQWEAK";
+
+  const HelicityLFSR& lfsr = HelicityLFSR::QWEAK();
+  const UInt_t nbits = lfsr.GetNbits();
+  QWEAKGenerator gen;
+  TRandom3 rnd(4357);
+
+  for( Int_t iseed = 0; iseed < fgNseeds; ++iseed ) {
+    UInt_t seed0 = rnd.Integer(lfsr.GetMask()) + 1;
+    UInt_t seed = seed0, bits = 0;
+    vector<pair<ULong64_t,UInt_t>> sparse;
+    for( Int_t n = 1; n <= fgMaxSteps; ++n ) {
+      UInt_t bit = gen.RanBit30(seed);
+      if( lfsr.Jump(seed0, n) != seed || lfsr.Bit(seed0, n) != bit ) {
+        Error( Here(here), "Jump of seed 0x%08x by %d steps differs from "
+               "RanBit30", seed0, n );
+        return 1;
+      }
+      if( n <= static_cast<Int_t>(nbits) )
+        bits = (bits << 1) | bit;
+      if( n % 7 == 0 )
+        sparse.emplace_back(n, bit);
+    }
+    if( lfsr.Recover(bits) != seed0 ) {
+      Error( Here(here), "Seed 0x%08x not recovered from %u consecutive "
+             "bits", seed0, nbits );
+      return 2;
+    }
+    UInt_t found = 0;
+    if( !lfsr.Recover(sparse, found) || found != seed0 ) {
+      Error( Here(here), "Seed 0x%08x not recovered from every 7th bit",
+             seed0 );
+      return 3;
+    }
+  }
+  // Maximum-length sequence
+  if( lfsr.Jump(1, lfsr.GetMask()) != 1 ) {
+    Error( Here(here), "Wrong period" );
+    return 4;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HelicityJump::TestG0()
+{
+  const char* const here = "TestG0";
+
+  const HelicityLFSR& lfsr = HelicityLFSR::G0();
+  const UInt_t nbits = lfsr.GetNbits();
+  G0Generator gen;
+  TRandom3 rnd(4357);
+
+  for( Int_t iseed = 0; iseed < fgNseeds; ++iseed ) {
+    UInt_t seed0 = rnd.Integer(lfsr.GetMask()) + 1;
+    UInt_t seed = seed0;
+    vector<UInt_t> readings;
+    vector<pair<ULong64_t,UInt_t>> sparse;
+    for( Int_t n = 1; n <= fgMaxSteps; ++n ) {
+      UInt_t bit = gen.Next(seed);
+      if( lfsr.Jump(seed0, n) != seed || lfsr.Bit(seed0, n) != bit ) {
+        Error( Here(here), "Jump of seed 0x%06x by %d steps differs from "
+               "RanBit", seed0, n );
+        return 11;
+      }
+      if( n <= static_cast<Int_t>(nbits) )
+        readings.push_back(bit);
+      if( n % 5 == 0 )
+        sparse.emplace_back(n, bit);
+    }
+    // GetSeed uses the recovery table
+    if( gen.Seed(readings) != seed0 ) {
+      Error( Here(here), "Seed 0x%06x not recovered from %u readings",
+             seed0, nbits );
+      return 12;
+    }
+    UInt_t found = 0;
+    if( !lfsr.Recover(sparse, found) || found != seed0 ) {
+      Error( Here(here), "Seed 0x%06x not recovered from every 5th bit",
+             seed0 );
+      return 13;
+    }
+  }
+  if( lfsr.Jump(1, lfsr.GetMask()) != 1 ) {
+    Error( Here(here), "Wrong period" );
+    return 14;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t HelicityJump::Test()
+{
+  // Compare jumps and recovered seeds with the bitwise generators
+
+  Int_t ret = TestQWEAK();
+  if( ret == 0 )
+    ret = TestG0();
+  if( ret == 0 && fDebug > 0 )
+    Info( Here("Test"), "All tests passed" );
+  return ret;
+}
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClassImp(Podd::Tests::HelicityJump)
@@ -0,0 +1,42 @@
+#ifndef Podd_Tests_HelicityJump_h_
+#define Podd_Tests_HelicityJump_h_
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// HelicityJump unit test                                                    //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UnitTest.h"
+
+namespace Podd {
+namespace Tests {
+
+class HelicityJump : public UnitTest {
+
+public:
+  explicit HelicityJump( const char* name = "helicity_jump",
+                         const char* description =
+                         "Helicity generator jump-ahead unit test" );
+
+  virtual Int_t Test();
+
+protected:
+
+  // Number of random seeds to test per generator
+  static const Int_t fgNseeds = 200;
+  // Maximum number of steps to compare with the bitwise generators
+  static const Int_t fgMaxSteps = 3000;
+
+  Int_t TestQWEAK();
+  Int_t TestG0();
+
+  ClassDef(HelicityJump,0)
+};
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,446 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// SteadyStateAllocs - Test that the per-event code paths of the event loop  //
+// make no heap allocations once warmed up: the CODA decoder for the         //
+// common module types, the VDC and S1 scintillator of a right-arm HRS from  //
+// Decode through FineTrack/FineProcess, and the per-stage accounting of     //
+// Podd::StageAllocStats itself.                                             //
+//                                                                           //
+// Allocations are counted with Podd::AllocCounter. Any allocation after     //
+// the warm-up events is a regression. Requires libPoddAllocHooks to be      //
+// linked first or preloaded.                                                //
+//                                                                           //
+// The detector test uses the benchmark database and crate map. DB_DIR must  //
+// point to bench/DB.                                                        //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SteadyStateAllocs.h"
+#include "AllocCounter.h"
+#include "StageAllocStats.h"
+#include "CodaDecoder.h"
+#include "CodaEventGenerator.h"
+#include "THaCrateMap.h"
+#include "AnalysisContext.h"
+#include "HitCache.h"
+#include "HitCacheDecoder.h"
+#include "THaHRS.h"
+#include "THaVDC.h"
+#include "THaVDCChamber.h"
+#include "THaVDCPlane.h"
+#include "THaVDCWire.h"
+#include "THaScintillator.h"
+#include "THaDetMap.h"
+#include "THaTrack.h"
+#include "Decoder.h"
+#include "TClonesArray.h"
+#include "TDatime.h"
+#include "TSystem.h"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Decoder;
+
+namespace {
+
+const ULong64_t kRunTime = 1577836800;  // 2020-01-01 00:00:00 UTC
+
+// Decoder configuration
+struct DecoderCase {
+  const char* name;
+  const char* cratemap;
+  Int_t       coda_version;
+  UInt_t      block_level;
+  UInt_t      fadc_mode;
+  Double_t    occupancy;
+};
+
+const char* const kFadcMap =
+  "TSROC 21\n"
+  "==== Crate 10 type vme\n"
+  "  3  250  250\n"
+  "  4  250  250\n"
+  "  5  250  250\n"
+  "  6  250  250\n";
+
+const char* const kCaen1190Map =
+  "TSROC 21\n"
+  "==== Crate 12 type vme\n"
+  "  3  1190  1190\n"
+  "  4  1190  1190\n";
+
+const char* const kLecroy1877Map =
+  "TSROC 21\n"
+  "==== Crate 1 type fastbus\n"
+  "  3  1877\n"
+  "  4  1877\n"
+  "  5  1877\n";
+
+const char* const kScalerMap =
+  "TSROC 21\n"
+  "==== Crate 5 type vme\n"
+  "  1  3801  1  0xabc10000  0xffff0000\n"
+  "  2  3801  1  0xabc20000  0xffff0000\n";
+
+// Hits by slot index (crate*MAXSLOT+slot) and channel
+using SlotHits_t = map<UInt_t, map<UInt_t, vector<UInt_t>>>;
+
+//_____________________________________________________________________________
+void AddVDCHits( const THaVDCPlane* plane, mt19937& rng, SlotHits_t& hits )
+{
+  // Add the hits of one track, five consecutive wires, and of random
+  // noise in 'plane'
+
+  uniform_real_distribution<> uniform;
+  const THaDetMap* detmap = plane->GetDetMap();
+  auto add_hit = [&]( Int_t wire, Double_t tdc ) {
+    for( UInt_t i = 0; i < detmap->GetSize(); ++i ) {
+      const THaDetMap::Module* d = detmap->GetModule(i);
+      if( wire >= static_cast<Int_t>(d->first) &&
+          wire <= static_cast<Int_t>(d->first + d->hi - d->lo) ) {
+        hits[d->crate * Decoder::MAXSLOT + d->slot][d->lo + wire - d->first]
+          .push_back(static_cast<UInt_t>(tdc));
+        return;
+      }
+    }
+  };
+  Int_t nwires = plane->GetNWires();
+  Int_t pivot = 10 + static_cast<Int_t>(uniform(rng) * (nwires - 20));
+  Double_t frac = uniform(rng);
+  for( Int_t i = -2; i <= 2; ++i ) {
+    Double_t dist = fabs(i - frac) * 3.0e-3;
+    add_hit(pivot + i, plane->GetWire(pivot + i)->GetTOffset()
+            - dist / plane->GetDriftVel() / plane->GetTDCRes());
+  }
+  Double_t tmin = plane->GetMinTime(), tmax = plane->GetMaxTime();
+  for( Int_t wire = 0; wire < nwires; ++wire ) {
+    if( uniform(rng) < 0.01 )
+      add_hit(wire, tmin + uniform(rng) * (tmax - tmin));
+  }
+}
+
+//_____________________________________________________________________________
+void AddScintHits( const THaScintillator* scint, mt19937& rng,
+                   SlotHits_t& hits )
+{
+  // Add ADC and TDC hits in all channels of 'scint'
+
+  uniform_real_distribution<> uniform;
+  const THaDetMap* detmap = scint->GetDetMap();
+  for( UInt_t i = 0; i < detmap->GetSize(); ++i ) {
+    const THaDetMap::Module* d = detmap->GetModule(i);
+    UInt_t slotidx = d->crate * Decoder::MAXSLOT + d->slot;
+    for( UInt_t chan = d->lo; chan <= d->hi; ++chan ) {
+      Double_t val = d->IsADC() ? 600 + 400 * uniform(rng)
+                                : 1400 + 50 * uniform(rng);
+      hits[slotidx][chan].push_back(static_cast<UInt_t>(val));
+    }
+  }
+}
+
+// Decoder that takes its crate map from a text block instead of the database
+class TextMapDecoder : public CodaDecoder {
+public:
+  explicit TextMapDecoder( const char* text ) : fText(text) {}
+protected:
+  virtual Int_t init_cmap() {
+    if( !fMap )
+      fMap.reset(new THaCrateMap("steady_state"));
+    if( fMap->init(fText) != THaCrateMap::CM_OK )
+      return HED_FATAL;
+    fNeedInit = false;
+    return HED_OK;
+  }
+private:
+  string fText;
+};
+
+} // namespace
+
+namespace Podd {
+namespace Tests {
+
+//_____________________________________________________________________________
+SteadyStateAllocs::SteadyStateAllocs( const char* name, const char* description ) :
+  UnitTest(name,description)
+{
+  // Constructor
+}
+
+//_____________________________________________________________________________
+Int_t SteadyStateAllocs::TestStageStats()
+{
+  // Allocations are attributed to the right stage and only counted
+  // after the warm-up
+
+  const char* const here = "TestStageStats";
+
+  const UInt_t nwarm = 3, nev = 10;
+  StageAllocStats stats(nwarm);
+  vector<Int_t*> junk;
+  junk.reserve(nev);
+  for( UInt_t iev = 1; iev <= nev; ++iev ) {
+    stats.Begin("Decode");
+    stats.Stop("Decode");
+    stats.Begin("Physics");
+    if( iev == 2 || iev == 7 )
+      junk.push_back(new Int_t(0));
+    stats.Stop("Physics");
+    stats.EndEvent(iev);
+  }
+  for( auto* p : junk )
+    delete p;
+
+  const auto* decode = stats.GetStage("Decode");
+  const auto* physics = stats.GetStage("Physics");
+  if( !decode || !physics || stats.GetStage("Output") ) {
+    Error( Here(here), "Wrong list of stages" );
+    return 1;
+  }
+  if( stats.GetNevents() != nev || stats.GetNsteady() != nev - nwarm ) {
+    Error( Here(here), "Wrong event count %llu/%llu",
+           stats.GetNevents(), stats.GetNsteady() );
+    return 2;
+  }
+  if( decode->total != 0 || physics->total != 2 || physics->steady != 1 ||
+      physics->lastev != 7 ) {
+    Error( Here(here), "Wrong per-stage counts" );
+    return 3;
+  }
+  if( stats.GetNalloc() != 1 || stats.GetNallocEvents() != 1 ||
+      stats.GetLastAllocEvent() != 7 ) {
+    Error( Here(here), "Wrong steady-state totals" );
+    return 4;
+  }
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t SteadyStateAllocs::TestDecoder()
+{
+  // Decode a generated event sample twice. The first pass warms up the
+  // decoder; the second may not allocate any memory.
+
+  const char* const here = "TestDecoder";
+
+  static const DecoderCase cases[] = {
+    { "FADC250 mode 1",      kFadcMap,       3,  1,  1, 0.2 },
+    { "FADC250 mode 10 b10", kFadcMap,       3, 10, 10, 0.2 },
+    { "Caen1190",            kCaen1190Map,   3,  1, 10, 0.1 },
+    { "Caen1190 b10",        kCaen1190Map,   3, 10, 10, 0.1 },
+    { "Lecroy1877",          kLecroy1877Map, 2,  1, 10, 0.1 },
+    { "Scaler3801",          kScalerMap,     3,  1, 10, 0.1 },
+  };
+
+  Int_t ret = 0;
+  for( const auto& tc : cases ) {
+    CodaEventGenerator gen;
+    gen.SetCrateMapText(tc.cratemap);
+    gen.SetCodaVersion(tc.coda_version);
+    gen.SetBlockLevel(tc.block_level);
+    gen.SetFadcMode(tc.fadc_mode);
+    gen.SetOccupancy(tc.occupancy);
+    gen.SetEpicsInterval(0);
+    gen.SetScalerInterval(0);
+    if( gen.Init(kRunTime) != 0 ) {
+      Error( Here(here), "%s: cannot initialize event generator", tc.name );
+      return 20;
+    }
+
+    TextMapDecoder evdata(tc.cratemap);
+    evdata.SetCodaVersion(tc.coda_version);
+    vector<vector<UInt_t>> events;
+    while( gen.GetNtrig() < fgNtrig ) {
+      const UInt_t* evbuf = gen.NextEvent(fgNtrig - gen.GetNtrig());
+      if( evdata.LoadEvent(evbuf) != THaEvData::HED_OK ) {
+        Error( Here(here), "%s: decoding error", tc.name );
+        return 21;
+      }
+      if( evdata.IsPhysicsTrigger() )
+        events.emplace_back(evbuf, evbuf + gen.GetEvLength());
+      while( evdata.DataCached() )
+        evdata.LoadFromMultiBlock();
+    }
+    if( events.empty() ) {
+      Error( Here(here), "%s: no physics events", tc.name );
+      return 22;
+    }
+
+    Bool_t was_enabled = AllocCounter::IsEnabled();
+    AllocCounter::Enable();
+    ULong64_t start = AllocCounter::GetCount();
+    for( const auto& ev : events ) {
+      evdata.LoadEvent(ev.data());
+      while( evdata.DataCached() )
+        evdata.LoadFromMultiBlock();
+    }
+    ULong64_t nalloc = AllocCounter::GetCount() - start;
+    AllocCounter::Enable(was_enabled);
+
+    if( nalloc > 0 ) {
+      Error( Here(here), "%s: %llu allocations in %lu warmed-up events",
+             tc.name, nalloc, static_cast<unsigned long>(events.size()) );
+      ret = 23;
+    } else if( fDebug > 1 )
+      Info( Here(here), "%s: %lu events, no allocations", tc.name,
+            static_cast<unsigned long>(events.size()) );
+  }
+  return ret;
+}
+
+//_____________________________________________________________________________
+Int_t SteadyStateAllocs::TestDetectors()
+{
+  // Process a sample of synthetic events with the VDC and the S1
+  // scintillator of a right-arm HRS, fed through Podd::HitCacheDecoder.
+  // The first pass warms up the detectors; the second may not allocate
+  // any memory.
+
+  const char* const here = "TestDetectors";
+
+  const char* dbdir = gSystem->Getenv("DB_DIR");
+  if( !dbdir || gSystem->AccessPathName(
+        Form("%s/DEFAULT/db_R.vdc.dat", dbdir)) ) {
+    Error( Here(here), "Benchmark database not found. Set DB_DIR to "
+           "bench/DB." );
+    return 30;
+  }
+
+  // Keep the global variables of this test out of the global lists
+  AnalysisContext context;
+  AnalysisContext::Scope scope(&context);
+
+  THaHRS hrs("R", "Right HRS");
+  hrs.AutoStandardDetectors(false);
+  auto* vdc = new THaVDC("vdc", "Vertical Drift Chamber");
+  auto* s1 = new THaScintillator("s1", "S1 scintillator");
+  hrs.AddDetector(vdc);
+  hrs.AddDetector(s1);
+  if( hrs.Init(TDatime(static_cast<UInt_t>(kRunTime), kFALSE))
+      != THaAnalysisObject::kOK ) {
+    Error( Here(here), "Cannot initialize detectors" );
+    return 31;
+  }
+  HitCacheDecoder evdata;
+  evdata.SetCrateMapName("replay_hrs");
+  evdata.SetRunTime(kRunTime);
+
+  const vector<THaVDCPlane*> planes = {
+    vdc->GetLower()->GetUPlane(), vdc->GetLower()->GetVPlane(),
+    vdc->GetUpper()->GetUPlane(), vdc->GetUpper()->GetVPlane()
+  };
+  mt19937 rng(4357);
+  vector<unique_ptr<HitCacheEvent>> events;
+  for( UInt_t iev = 0; iev < fgNdetEvents; ++iev ) {
+    SlotHits_t hits;
+    for( const auto* plane : planes )
+      AddVDCHits(plane, rng, hits);
+    AddScintHits(s1, rng, hits);
+
+    unique_ptr<HitCacheEvent> ev(new HitCacheEvent);
+    ev->hdr.evtype   = 1;
+    ev->hdr.evnum    = iev + 1;
+    ev->hdr.evlen    = 0;
+    ev->hdr.trigbits = 1U << 1;
+    ev->hdr.evtime   = 1000 * iev;
+    for( const auto& slot : hits ) {
+      UInt_t nhit = 0;
+      for( const auto& chan : slot.second ) {
+        for( auto raw : chan.second ) {
+          ev->chan.push_back(chan.first);
+          ev->data.push_back(raw);
+          ev->raw.push_back(raw);
+          ++nhit;
+        }
+      }
+      ev->slot.push_back(slot.first);
+      ev->nhit.push_back(nhit);
+    }
+    events.push_back(std::move(ev));
+  }
+
+  TClonesArray tracks("THaTrack", 10);
+  Int_t ntracks = 0;
+  auto process = [&]( const HitCacheEvent& ev ) -> Int_t {
+    tracks.Clear("C");
+    vdc->Clear();
+    s1->Clear();
+    if( evdata.LoadEvent(reinterpret_cast<const UInt_t*>(&ev))
+        != THaEvData::HED_OK )
+      return -1;
+    vdc->Decode(evdata);
+    s1->Decode(evdata);
+    vdc->CoarseTrack(tracks);
+    s1->CoarseProcess(tracks);
+    vdc->FineTrack(tracks);
+    s1->FineProcess(tracks);
+    ntracks += tracks.GetLast() + 1;
+    return 0;
+  };
+
+  for( const auto& ev : events ) {
+    if( process(*ev) != 0 ) {
+      Error( Here(here), "Error loading event %u", ev->hdr.evnum );
+      return 32;
+    }
+  }
+  if( ntracks == 0 ) {
+    Error( Here(here), "No tracks found" );
+    return 33;
+  }
+
+  Bool_t was_enabled = AllocCounter::IsEnabled();
+  AllocCounter::Enable();
+  ULong64_t start = AllocCounter::GetCount();
+  for( const auto& ev : events )
+    process(*ev);
+  ULong64_t nalloc = AllocCounter::GetCount() - start;
+  AllocCounter::Enable(was_enabled);
+
+  tracks.Clear("C");
+  if( nalloc > 0 ) {
+    Error( Here(here), "%llu allocations in %u warmed-up events",
+           nalloc, fgNdetEvents );
+    return 34;
+  }
+  if( fDebug > 1 )
+    Info( Here(here), "%u events, %d tracks, no allocations",
+          fgNdetEvents, ntracks );
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t SteadyStateAllocs::Test()
+{
+  // Check for heap allocations in the warmed-up event loop
+
+  // Without active allocation hooks, all counts are zero and the tests
+  // would pass vacuously
+  Bool_t was_enabled = AllocCounter::IsEnabled();
+  if( !AllocCounter::Enable() ) {
+    Error( Here("Test"), "Allocation counting not available" );
+    return 10;
+  }
+  AllocCounter::Enable(was_enabled);
+
+  Int_t ret = TestStageStats();
+  if( ret == 0 )
+    ret = TestDecoder();
+  if( ret == 0 )
+    ret = TestDetectors();
+  if( ret == 0 && fDebug > 0 )
+    Info( Here("Test"), "All tests passed" );
+  return ret;
+}
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClassImp(Podd::Tests::SteadyStateAllocs)
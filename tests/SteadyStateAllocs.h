@@ -0,0 +1,43 @@
+#ifndef Podd_Tests_SteadyStateAllocs_h_
+#define Podd_Tests_SteadyStateAllocs_h_
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// SteadyStateAllocs unit test                                               //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UnitTest.h"
+
+namespace Podd {
+namespace Tests {
+
+class SteadyStateAllocs : public UnitTest {
+
+public:
+  explicit SteadyStateAllocs( const char* name = "steady_state_allocs",
+                              const char* description =
+                              "Zero heap allocations per event after warm-up" );
+
+  virtual Int_t Test();
+
+protected:
+
+  // Number of triggers to generate per decoder configuration
+  static const UInt_t fgNtrig = 300;
+  // Number of events for the detector test
+  static const UInt_t fgNdetEvents = 100;
+
+  Int_t TestStageStats();
+  Int_t TestDecoder();
+  Int_t TestDetectors();
+
+  ClassDef(SteadyStateAllocs,0)
+};
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -6,5 +6,10 @@
 
 #pragma link C++ class Podd::Tests::UnitTest+;
 #pragma link C++ class Podd::Tests::ArrayRTTI+;
+#pragma link C++ class Podd::Tests::HelicityJump+;
+#pragma link C++ class Podd::Tests::CheckpointHistos+;
+#pragma link C++ class Podd::Tests::CheckpointHelicity+;
+#pragma link C++ class Podd::Tests::SteadyStateAllocs+;
+#pragma link C++ class Podd::Tests::VDCTargetRecon+;
 
 #endif
@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// VDCTargetRecon - Test that THaVDC reconstructs target coordinates only    //
+// if results depending on them are used (THaVDC::SetUsedOutputs).           //
+//                                                                           //
+// Focal plane track variables and detector variables of the spectrometer    //
+// do not need target coordinates; the tr.tg_* variables, momenta and        //
+// vertices do, as does any module depending on the spectrometer.            //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VDCTargetRecon.h"
+#include "THaHRS.h"
+#include "THaVDC.h"
+#include "THaScintillator.h"
+#include "THaTrack.h"
+#include "THaVarList.h"
+#include "TClonesArray.h"
+#include <set>
+
+using namespace std;
+
+namespace {
+
+// Access to the name prefix of the spectrometer, normally made at Init()
+class TestHRS : public THaHRS {
+public:
+  TestHRS() : THaHRS("R", "Test HRS") { AutoStandardDetectors(false); }
+  using THaHRS::MakePrefix;
+};
+
+} // namespace
+
+namespace Podd {
+namespace Tests {
+
+//_____________________________________________________________________________
+VDCTargetRecon::VDCTargetRecon( const char* name, const char* description )
+  : UnitTest(name, description)
+{
+}
+
+//_____________________________________________________________________________
+Int_t VDCTargetRecon::Test()
+{
+  const char* const here = "Test";
+
+  TestHRS hrs;
+  auto* vdc = new THaVDC("vdc", "Test VDC");
+  hrs.AddDetector(vdc);
+  hrs.AddDetector(new THaScintillator("s1", "Test scintillator"));
+  hrs.MakePrefix();
+
+  Double_t val = 0;
+  THaVarList vars;
+  auto* tr_x   = vars.Define("R.tr.x",     "", val);
+  auto* tr_rth = vars.Define("R.tr.r_th",  "", val);
+  auto* s1_lt  = vars.Define("R.s1.lt",    "", val);
+  auto* vdc_n  = vars.Define("R.vdc.u1.nhit", "", val);
+  auto* tg_th  = vars.Define("R.tr.tg_th", "", val);
+  auto* tr_p   = vars.Define("R.tr.p",     "", val);
+
+  // Focal plane and detector variables only
+  set<const THaVar*> used = { tr_x, tr_rth, s1_lt, vdc_n };
+  hrs.SetUsedOutputs(used, false);
+  if( vdc->IsTargetReconEnabled() ) {
+    Error( Here(here), "Target reconstruction enabled for focal plane "
+           "variables" );
+    return 1;
+  }
+
+  // Target reconstruction is skipped
+  TClonesArray tracks("THaTrack", 1);
+  auto* track = static_cast<THaTrack*>(tracks.ConstructedAt(0));
+  track->SetTarget(0.0, 0.01, 0.02, 0.03);
+  vdc->FindVertices(tracks);
+  if( track->GetTY() != 0.01 || track->GetTTheta() != 0.02 ) {
+    Error( Here(here), "Target coordinates changed while disabled" );
+    return 2;
+  }
+
+  // Target variables
+  for( const auto* var : { tg_th, tr_p } ) {
+    used = { tr_x, var };
+    hrs.SetUsedOutputs(used, false);
+    if( !vdc->IsTargetReconEnabled() ) {
+      Error( Here(here), "Target reconstruction disabled although %s is "
+             "used", var->GetName() );
+      return 3;
+    }
+  }
+
+  // Other modules depend on the spectrometer
+  used = { tr_x };
+  hrs.SetUsedOutputs(used, true);
+  if( !vdc->IsTargetReconEnabled() ) {
+    Error( Here(here), "Target reconstruction disabled for dependent "
+           "modules" );
+    return 4;
+  }
+
+  // Reconstruction runs when enabled. Without optics matrix elements,
+  // all target angles are zero.
+  vdc->FindVertices(tracks);
+  if( track->GetTTheta() != 0.0 ) {
+    Error( Here(here), "Target coordinates not reconstructed" );
+    return 5;
+  }
+
+  if( fDebug > 0 )
+    Info( Here(here), "All tests passed" );
+  return 0;
+}
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+ClassImp(Podd::Tests::VDCTargetRecon)
@@ -0,0 +1,32 @@
+#ifndef Podd_Tests_VDCTargetRecon_h_
+#define Podd_Tests_VDCTargetRecon_h_
+
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// VDCTargetRecon unit test                                                  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UnitTest.h"
+
+namespace Podd {
+namespace Tests {
+
+class VDCTargetRecon : public UnitTest {
+
+public:
+  explicit VDCTargetRecon( const char* name = "vdc_target_recon",
+                           const char* description =
+                           "VDC target reconstruction of used outputs" );
+
+  virtual Int_t Test();
+
+  ClassDef(VDCTargetRecon,0)
+};
+
+} // namespace Tests
+} // namespace Podd
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif